@@ -29,6 +29,15 @@
 
 // *****************************************************************************
 // circular buffer functions
+//
+// The buffer is lock free for one producer and one consumer, which may be an
+// interrupt handler or DMA completion on one side and a task on the other.
+// Only the producer moves wr and only the consumer moves rd. Each side reads
+// the index of the other side once, and publishes its own index only after
+// the data it wrote or read is complete, so no critical section is needed.
+
+// Orders the data accesses against the publication of an index
+#define FIFO_BARRIER() __sync_synchronize()
 
 uint16_t fifoBuf_getSize(t_fifo_buffer *buf)
 { // return the usable size of the buffer
@@ -41,19 +50,17 @@ uint16_t fifoBuf_getSize(t_fifo_buffer *buf)
     }
 }
 
-uint16_t fifoBuf_getUsed(t_fifo_buffer *buf)
-{ // return the number of bytes available in the rx buffer
-    uint16_t rd = buf->rd;
-    uint16_t wr = buf->wr;
-    uint16_t buf_size  = buf->buf_size;
-
-    uint16_t num_bytes = wr - rd;
-
+static inline uint16_t fifoBuf_used(uint16_t rd, uint16_t wr, uint16_t buf_size)
+{ // number of bytes in the buffer for a snapshot of the indexes
     if (wr < rd) {
-        num_bytes = (buf_size - rd) + wr;
+        return (buf_size - rd) + wr;
     }
+    return wr - rd;
+}
 
-    return num_bytes;
+uint16_t fifoBuf_getUsed(t_fifo_buffer *buf)
+{ // return the number of bytes available in the rx buffer
+    return fifoBuf_used(buf->rd, buf->wr, buf->buf_size);
 }
 
 uint16_t fifoBuf_getFree(t_fifo_buffer *buf)
@@ -66,7 +73,7 @@ uint16_t fifoBuf_getFree(t_fifo_buffer *buf)
 }
 
 void fifoBuf_clearData(t_fifo_buffer *buf)
-{ // remove all data from the buffer
+{ // remove all data from the buffer, consumer side or with the consumer stopped
     buf->rd = buf->wr;
 }
 
@@ -76,7 +83,7 @@ void fifoBuf_removeData(t_fifo_buffer *buf, uint16_t len)
     uint16_t buf_size  = buf->buf_size;
 
     // get number of bytes available
-    uint16_t num_bytes = fifoBuf_getUsed(buf);
+    uint16_t num_bytes = fifoBuf_used(rd, buf->wr, buf_size);
 
     if (num_bytes > len) {
         num_bytes = len;
@@ -90,6 +97,8 @@ void fifoBuf_removeData(t_fifo_buffer *buf, uint16_t len)
         rd -= buf_size;
     }
 
+    // the data must have been read before the space is handed back
+    FIFO_BARRIER();
     buf->rd = rd;
 }
 
@@ -98,11 +107,12 @@ int16_t fifoBuf_getBytePeek(t_fifo_buffer *buf)
     uint16_t rd = buf->rd;
 
     // get number of bytes available
-    uint16_t num_bytes = fifoBuf_getUsed(buf);
+    uint16_t num_bytes = fifoBuf_used(rd, buf->wr, buf->buf_size);
 
     if (num_bytes < 1) {
         return -1; // no byte retuened
     }
+    FIFO_BARRIER();
     return buf->buf_ptr[rd]; // return the byte
 }
 
@@ -113,29 +123,47 @@ int16_t fifoBuf_getByte(t_fifo_buffer *buf)
     uint8_t *buff      = buf->buf_ptr;
 
     // get number of bytes available
-    uint16_t num_bytes = fifoBuf_getUsed(buf);
+    uint16_t num_bytes = fifoBuf_used(rd, buf->wr, buf_size);
 
     if (num_bytes < 1) {
         return -1; // no byte returned
     }
+    FIFO_BARRIER();
     uint8_t b = buff[rd];
     if (++rd >= buf_size) {
         rd = 0;
     }
 
+    FIFO_BARRIER();
     buf->rd = rd;
 
     return b; // return the byte
 }
 
+static uint16_t fifoBuf_copyOut(t_fifo_buffer *buf, uint16_t rd, void *data, uint16_t len)
+{ // copy len bytes starting at rd in at most two segments, returns the new rd
+    uint16_t buf_size = buf->buf_size;
+    uint16_t j = buf_size - rd;
+
+    if (j > len) {
+        j = len;
+    }
+    memcpy(data, buf->buf_ptr + rd, j);
+    memcpy((uint8_t *)data + j, buf->buf_ptr, len - j);
+
+    rd += len;
+    if (rd >= buf_size) {
+        rd -= buf_size;
+    }
+    return rd;
+}
+
 uint16_t fifoBuf_getDataPeek(t_fifo_buffer *buf, void *data, uint16_t len)
 { // get data from the buffer without removing it
     uint16_t rd        = buf->rd;
-    uint16_t buf_size  = buf->buf_size;
-    uint8_t *buff      = buf->buf_ptr;
 
     // get number of bytes available
-    uint16_t num_bytes = fifoBuf_getUsed(buf);
+    uint16_t num_bytes = fifoBuf_used(rd, buf->wr, buf->buf_size);
 
     if (num_bytes > len) {
         num_bytes = len;
@@ -144,34 +172,18 @@ uint16_t fifoBuf_getDataPeek(t_fifo_buffer *buf, void *data, uint16_t len)
     if (num_bytes < 1) {
         return 0; // return number of bytes copied
     }
-    uint8_t *p = (uint8_t *)data;
-    uint16_t i = 0;
-
-    while (num_bytes > 0) {
-        uint16_t j = buf_size - rd;
-        if (j > num_bytes) {
-            j = num_bytes;
-        }
-        memcpy(p + i, buff + rd, j);
-        i  += j;
-        num_bytes -= j;
-        rd += j;
-        if (rd >= buf_size) {
-            rd = 0;
-        }
-    }
+    FIFO_BARRIER();
+    fifoBuf_copyOut(buf, rd, data, num_bytes);
 
-    return i; // return number of bytes copied
+    return num_bytes; // return number of bytes copied
 }
 
 uint16_t fifoBuf_getData(t_fifo_buffer *buf, void *data, uint16_t len)
 { // get data from our rx buffer
     uint16_t rd        = buf->rd;
-    uint16_t buf_size  = buf->buf_size;
-    uint8_t *buff      = buf->buf_ptr;
 
     // get number of bytes available
-    uint16_t num_bytes = fifoBuf_getUsed(buf);
+    uint16_t num_bytes = fifoBuf_used(rd, buf->wr, buf->buf_size);
 
     if (num_bytes > len) {
         num_bytes = len;
@@ -180,26 +192,25 @@ uint16_t fifoBuf_getData(t_fifo_buffer *buf, void *data, uint16_t len)
     if (num_bytes < 1) {
         return 0; // return number of bytes copied
     }
-    uint8_t *p = (uint8_t *)data;
-    uint16_t i = 0;
-
-    while (num_bytes > 0) {
-        uint16_t j = buf_size - rd;
-        if (j > num_bytes) {
-            j = num_bytes;
-        }
-        memcpy(p + i, buff + rd, j);
-        i  += j;
-        num_bytes -= j;
-        rd += j;
-        if (rd >= buf_size) {
-            rd = 0;
-        }
-    }
+    FIFO_BARRIER();
+    rd = fifoBuf_copyOut(buf, rd, data, num_bytes);
 
+    FIFO_BARRIER();
     buf->rd = rd;
 
-    return i; // return number of bytes copied
+    return num_bytes; // return number of bytes copied
+}
+
+const uint8_t *fifoBuf_getBlockPeek(t_fifo_buffer *buf, uint16_t *len)
+{ // get the longest contiguous run of data at the read index without removing it
+    uint16_t rd = buf->rd;
+    uint16_t wr = buf->wr;
+
+    // data up to the write index or the end of the memory, whichever comes first
+    *len = (wr < rd) ? buf->buf_size - rd : wr - rd;
+
+    FIFO_BARRIER();
+    return buf->buf_ptr + rd;
 }
 
 uint16_t fifoBuf_putByte(t_fifo_buffer *buf, const uint8_t b)
@@ -208,17 +219,20 @@ uint16_t fifoBuf_putByte(t_fifo_buffer *buf, const uint8_t b)
     uint16_t buf_size  = buf->buf_size;
     uint8_t *buff      = buf->buf_ptr;
 
-    uint16_t num_bytes = fifoBuf_getFree(buf);
+    uint16_t num_bytes = (buf_size - fifoBuf_used(buf->rd, wr, buf_size)) - 1;
 
     if (num_bytes < 1) {
         return 0;
     }
 
+    FIFO_BARRIER();
     buff[wr] = b;
     if (++wr >= buf_size) {
         wr = 0;
     }
 
+    // the byte must be in the buffer before the consumer can see it
+    FIFO_BARRIER();
     buf->wr = wr;
 
     return 1; // return number of bytes copied
@@ -230,7 +244,7 @@ uint16_t fifoBuf_putData(t_fifo_buffer *buf, const void *data, uint16_t len)
     uint16_t buf_size  = buf->buf_size;
     uint8_t *buff      = buf->buf_ptr;
 
-    uint16_t num_bytes = fifoBuf_getFree(buf);
+    uint16_t num_bytes = (buf_size - fifoBuf_used(buf->rd, wr, buf_size)) - 1;
 
     if (num_bytes > len) {
         num_bytes = len;
@@ -239,26 +253,63 @@ uint16_t fifoBuf_putData(t_fifo_buffer *buf, const void *data, uint16_t len)
     if (num_bytes < 1) {
         return 0; // return number of bytes copied
     }
-    uint8_t *p = (uint8_t *)data;
-    uint16_t i = 0;
-
-    while (num_bytes > 0) {
-        uint16_t j = buf_size - wr;
-        if (j > num_bytes) {
-            j = num_bytes;
-        }
-        memcpy(buff + wr, p + i, j);
-        i  += j;
-        num_bytes -= j;
-        wr += j;
-        if (wr >= buf_size) {
-            wr = 0;
-        }
+
+    // copy in at most two segments, up to the end of the memory and from its start
+    uint16_t j = buf_size - wr;
+    if (j > num_bytes) {
+        j = num_bytes;
+    }
+    FIFO_BARRIER();
+    memcpy(buff + wr, data, j);
+    memcpy(buff, (const uint8_t *)data + j, num_bytes - j);
+
+    wr += num_bytes;
+    if (wr >= buf_size) {
+        wr -= buf_size;
     }
 
+    // the data must be in the buffer before the consumer can see it
+    FIFO_BARRIER();
     buf->wr = wr;
 
-    return i; // return number of bytes copied
+    return num_bytes; // return number of bytes copied
+}
+
+uint8_t *fifoBuf_putBlockReserve(t_fifo_buffer *buf, uint16_t *len)
+{ // get the longest contiguous free space at the write index, to be filled in place
+    uint16_t rd = buf->rd;
+    uint16_t wr = buf->wr;
+    uint16_t buf_size = buf->buf_size;
+
+    if (rd > wr) {
+        // free up to one byte short of the read index
+        *len = rd - wr - 1;
+    } else if (rd == 0) {
+        // free up to the end of the memory, less the byte that tells full from empty
+        *len = buf_size - wr - 1;
+    } else {
+        *len = buf_size - wr;
+    }
+
+    FIFO_BARRIER();
+    return buf->buf_ptr + wr;
+}
+
+void fifoBuf_putBlockCommit(t_fifo_buffer *buf, uint16_t len)
+{ // add len bytes written in place at the reserved space to the buffer
+    uint16_t wr = buf->wr;
+    uint16_t buf_size = buf->buf_size;
+
+    if (len < 1) {
+        return;
+    }
+    wr += len;
+    if (wr >= buf_size) {
+        wr -= buf_size;
+    }
+
+    FIFO_BARRIER();
+    buf->wr = wr;
 }
 
 void fifoBuf_init(t_fifo_buffer *buf, const void *buffer, const uint16_t buffer_size)
@@ -30,6 +30,10 @@
 
 // *********************
 
+// Lock free for a single producer and a single consumer, either of which may
+// run from an interrupt. The producer calls the put functions, the consumer
+// the get and remove functions.
+
 typedef struct {
     uint8_t  *buf_ptr;
     volatile uint16_t rd;
@@ -53,10 +57,20 @@ int16_t fifoBuf_getByte(t_fifo_buffer *buf);
 uint16_t fifoBuf_getDataPeek(t_fifo_buffer *buf, void *data, uint16_t len);
 uint16_t fifoBuf_getData(t_fifo_buffer *buf, void *data, uint16_t len);
 
+// Zero copy read: the data at the returned pointer stays valid until it is
+// removed with fifoBuf_removeData(). len is set to the contiguous length,
+// there may be more data from the start of the memory.
+const uint8_t *fifoBuf_getBlockPeek(t_fifo_buffer *buf, uint16_t *len);
+
 uint16_t fifoBuf_putByte(t_fifo_buffer *buf, const uint8_t b);
 
 uint16_t fifoBuf_putData(t_fifo_buffer *buf, const void *data, uint16_t len);
 
+// Zero copy write, e.g. by DMA: fill up to len bytes at the returned pointer,
+// then add what was written with fifoBuf_putBlockCommit().
+uint8_t *fifoBuf_putBlockReserve(t_fifo_buffer *buf, uint16_t *len);
+void fifoBuf_putBlockCommit(t_fifo_buffer *buf, uint16_t len);
+
 void fifoBuf_init(t_fifo_buffer *buf, const void *buffer, const uint16_t buffer_size);
 
 // *********************
@@ -127,22 +127,18 @@ compute_modified_omega ()
 void
 mult_polys (int dst[], int p1[], int p2[])
 {
-  int i, j;
-  int tmp1[MAXDEG*2];
+  int i, j, l;
 	
   for (i=0; i < (MAXDEG*2); i++) dst[i] = 0;
 	
   for (i = 0; i < MAXDEG; i++) {
-    for(j=MAXDEG; j<(MAXDEG*2); j++) tmp1[j]=0;
-		
-    /* scale tmp1 by p1[i] */
-    for(j=0; j<MAXDEG; j++) tmp1[j]=gmult(p2[j], p1[i]);
-    /* and mult (shift) tmp1 right by i */
-    for (j = (MAXDEG*2)-1; j >= i; j--) tmp1[j] = tmp1[j-i];
-    for (j = 0; j < i; j++) tmp1[j] = 0;
-		
-    /* add into partial product */
-    for(j=0; j < (MAXDEG*2); j++) dst[j] ^= tmp1[j];
+    if (p1[i] == 0) continue;
+
+    /* add p2 scaled by p1[i] and shifted right by i into the product */
+    l = glog[p1[i]];
+    for (j = 0; j < MAXDEG; j++) {
+      if (p2[j] != 0) dst[i+j] ^= gexp[glog[p2[j]] + l];
+    }
   }
 }
 
@@ -230,20 +226,35 @@ static void mul_z_poly (int src[])
  * Lambda[j] by evaluating Lambda at successive values of alpha. 
  * 
  * This can be tested with the decoder's equations case.
+ *
+ * Chien search: the log of every nonzero term Lambda[k]*a^(k*r) is kept
+ * and advanced by k for the next r, so each evaluation is one table
+ * lookup per term.
  */
 
 
 void 
 Find_Roots (void)
 {
-  int sum, r, k;	
+  int sum, r, k, n, nterms = 0;
+  int termPow[RS_ECC_NPARITY+1], termLog[RS_ECC_NPARITY+1];
   NErrors = 0;
+
+  for (k = 0; k < RS_ECC_NPARITY+1; k++) {
+    if (Lambda[k] != 0) {
+      termPow[nterms] = k;
+      termLog[nterms] = glog[Lambda[k]];
+      nterms++;
+    }
+  }
   
   for (r = 1; r < 256; r++) {
     sum = 0;
     /* evaluate lambda at r */
-    for (k = 0; k < RS_ECC_NPARITY+1; k++) {
-      sum ^= gmult(gexp[(k*r)%255], Lambda[k]);
+    for (n = 0; n < nterms; n++) {
+      termLog[n] += termPow[n];
+      if (termLog[n] >= 255) termLog[n] -= 255;
+      sum ^= gexp[termLog[n]];
     }
     if (sum == 0) 
       { 
@@ -280,6 +291,9 @@ correct_errors_erasures (unsigned char codeword[],
   NErasures = nerasures;
   for (i = 0; i < NErasures; i++) ErasureLocs[i] = erasures[i];
 
+  /* Without erasures a zero syndrome leaves nothing to locate */
+  if (NErasures == 0 && !check_syndrome()) return(0);
+
   Modified_Berlekamp_Massey();
   Find_Roots();
   
@@ -300,13 +314,13 @@ correct_errors_erasures (unsigned char codeword[],
       /* evaluate Omega at alpha^(-i) */
 
       num = 0;
-      for (j = 0; j < MAXDEG; j++) 
-	num ^= gmult(Omega[j], gexp[((255-i)*j)%255]);
+      for (j = MAXDEG-1; j >= 0; j--) 
+	num = gmult(num, gexp[255-i]) ^ Omega[j];
       
       /* evaluate Lambda' (derivative) at alpha^(-i) ; all odd powers disappear */
       denom = 0;
-      for (j = 1; j < MAXDEG; j += 2) {
-	denom ^= gmult(Lambda[j], gexp[((255-i)*(j-1)) % 255]);
+      for (j = MAXDEG-1; j >= 1; j -= 2) {
+	denom = gmult(denom, gexp[(2*(255-i)) % 255]) ^ Lambda[j];
       }
       
       err = gmult(num, ginv(denom));
@@ -38,6 +38,10 @@ int synBytes[MAXDEG];
 /* generator polynomial */
 int genPoly[MAXDEG*2];
 
+/* logarithms of the generator polynomial coefficients, the encoder
+ * multiplies in the log domain. None of the coefficients is zero. */
+static uint8_t genLog[RS_ECC_NPARITY];
+
 int DEBUG = FALSE;
 
 static void
@@ -47,11 +51,15 @@ compute_genpoly (int nbytes, int genpoly[]);
 void
 initialize_ecc ()
 {
+  int i;
+
   /* Initialize the galois field arithmetic tables */
     init_galois_tables();
 
     /* Compute the encoder generator polynomial */
     compute_genpoly(RS_ECC_NPARITY, genPoly);
+
+    for (i = 0; i < RS_ECC_NPARITY; i++) genLog[i] = glog[genPoly[i]];
 }
 
 void
@@ -105,19 +113,27 @@ build_codeword (unsigned char msg[], int nbytes, unsigned char dst[])
  *
  * Computes the syndrome of a codeword. Puts the results
  * into the synBytes[] array.
+ *
+ * All syndromes are evaluated in a single pass over the data,
+ * multiplying the running sums by a^(j+1) in the log domain.
  */
  
 void
 decode_data(unsigned char data[], int nbytes)
 {
-  int i, j, sum;
-  for (j = 0; j < RS_ECC_NPARITY;  j++) {
-    sum	= 0;
-    for (i = 0; i < nbytes; i++) {
-      sum = data[i] ^ gmult(gexp[j+1], sum);
+  int i, j;
+  uint8_t sum[RS_ECC_NPARITY];
+
+  for (j = 0; j < RS_ECC_NPARITY; j++) sum[j] = 0;
+
+  for (i = 0; i < nbytes; i++) {
+    uint8_t d = data[i];
+    for (j = 0; j < RS_ECC_NPARITY; j++) {
+      sum[j] = d ^ (sum[j] ? gexp[glog[sum[j]] + j + 1] : 0);
     }
-    synBytes[j]  = sum;
   }
+
+  for (j = 0; j < RS_ECC_NPARITY; j++) synBytes[j] = sum[j];
 }
 
 
@@ -187,16 +203,25 @@ compute_genpoly (int nbytes, int genpoly[])
 void
 encode_data (unsigned char msg[], int nbytes, unsigned char dst[])
 {
-  int i, LFSR[RS_ECC_NPARITY+1],dbyte, j;
+  int i, j;
+  uint8_t LFSR[RS_ECC_NPARITY], dbyte, dlog;
 	
-  for(i=0; i < RS_ECC_NPARITY+1; i++) LFSR[i]=0;
+  for(i=0; i < RS_ECC_NPARITY; i++) LFSR[i]=0;
 
   for (i = 0; i < nbytes; i++) {
     dbyte = msg[i] ^ LFSR[RS_ECC_NPARITY-1];
+    if (dbyte == 0) {
+      /* nothing fed back, just shift */
+      for (j = RS_ECC_NPARITY-1; j > 0; j--) LFSR[j] = LFSR[j-1];
+      LFSR[0] = 0;
+      continue;
+    }
+    /* look up the log of the feedback byte once for all taps */
+    dlog = glog[dbyte];
     for (j = RS_ECC_NPARITY-1; j > 0; j--) {
-      LFSR[j] = LFSR[j-1] ^ gmult(genPoly[j], dbyte);
+      LFSR[j] = LFSR[j-1] ^ gexp[genLog[j] + dlog];
     }
-    LFSR[0] = gmult(genPoly[0], dbyte);
+    LFSR[0] = gexp[genLog[0] + dlog];
   }
 
   for (i = 0; i < RS_ECC_NPARITY; i++) 
@@ -377,10 +377,17 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
             command.MaxUpdateTime = command.UpdateTime;
         }
 
-        // Update output object
-        ActuatorCommandSet(&command);
-        // Update in case read only (eg. during servo configuration)
-        ActuatorCommandGet(&command);
+        // Update output object in place
+        ActuatorCommandData *output = ActuatorCommandBorrow();
+        if (output) {
+            memcpy(output->Channel, command.Channel, sizeof(command.Channel));
+            output->UpdateTime    = command.UpdateTime;
+            output->MaxUpdateTime = command.MaxUpdateTime;
+            ActuatorCommandCommit();
+        } else {
+            // Read only (eg. during servo configuration), use what is there
+            ActuatorCommandGet(&command);
+        }
 
 #ifdef DIAG_MIXERSTATUS
         MixerStatusSet(&mixerStatus);
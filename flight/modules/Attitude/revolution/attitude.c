@@ -447,14 +447,13 @@ static int32_t updateAttitudeComplementary(bool first_run)
 
     float q[4];
 
-    AttitudeActualData attitudeActual;
-    AttitudeActualGet(&attitudeActual);
-
     float grot[3];
     float accel_err[3];
 
     // Get the current attitude estimate
-    quat_copy(&attitudeActual.q1, q);
+    AttitudeActualData attitudeEstimate;
+    AttitudeActualGet(&attitudeEstimate);
+    quat_copy(&attitudeEstimate.q1, q);
 
     // Apply smoothing to accel values, to reduce vibration noise before main calculations.
     apply_accel_filter((const float *)&accelsData.x, accels_filtered);
@@ -577,12 +576,16 @@ static int32_t updateAttitudeComplementary(bool first_run)
         q[3] = 0.0f;
     }
 
-    quat_copy(q, &attitudeActual.q1);
+    // Update the attitude in place, it is read only while the GCS drives it
+    AttitudeActualData *attitudeActual = AttitudeActualBorrow();
+    if (attitudeActual) {
+        quat_copy(q, &attitudeActual->q1);
 
-    // Convert into eueler degrees (makes assumptions about RPY order)
-    Quaternion2RPY(&attitudeActual.q1, &attitudeActual.Roll);
+        // Convert into eueler degrees (makes assumptions about RPY order)
+        Quaternion2RPY(&attitudeActual->q1, &attitudeActual->Roll);
 
-    AttitudeActualSet(&attitudeActual);
+        AttitudeActualCommit();
+    }
 
     // Flush these queues for avoid errors
     xQueueReceive(baroQueue, &ev, 0);
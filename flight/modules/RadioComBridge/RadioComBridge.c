@@ -55,7 +55,9 @@
 #define EVENT_QUEUE_SIZE  10
 #define MAX_PORT_DELAY    200
 #define SERIAL_RX_BUF_LEN 100
+#define RELAY_RX_BUF_LEN  64
 #define PPM_INPUT_TIMEOUT 100
+#define RELAY_STATS_PERIOD_MS 1000
 
 // ****************
 // Private types
@@ -80,12 +82,18 @@ typedef struct {
     // The raw serial Rx buffer
     uint8_t  serialRxBuf[SERIAL_RX_BUF_LEN];
 
+    // The Rx buffers of the relayed streams
+    uint8_t  telemetryRxBuf[RELAY_RX_BUF_LEN];
+    uint8_t  radioRxBuf[RELAY_RX_BUF_LEN];
+
     // Error statistics.
     uint32_t comTxErrors;
     uint32_t comTxRetries;
-    uint32_t UAVTalkErrors;
     uint32_t droppedPackets;
 
+    // When the relay statistics were last reported
+    portTickType relayStatsTime;
+
     // Should we parse UAVTalk?
     bool     parseUAVTalk;
 
@@ -104,8 +112,9 @@ static void radioRxTask(void *parameters);
 static void PPMInputTask(void *parameters);
 static int32_t UAVTalkSendHandler(uint8_t *buf, int32_t length);
 static int32_t RadioSendHandler(uint8_t *buf, int32_t length);
-static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte);
-static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte);
+static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t *buf, uint16_t length, uint32_t rxTime);
+static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t *buf, uint16_t length, uint32_t rxTime);
+static void updateRelayStats();
 static void objectPersistenceUpdatedCb(UAVObjEvent *objEv);
 
 // ****************
@@ -235,7 +244,7 @@ static int32_t RadioComBridgeInitialize(void)
     // Initialize the statistics.
     data->comTxErrors   = 0;
     data->comTxRetries  = 0;
-    data->UAVTalkErrors = 0;
+    data->relayStatsTime = xTaskGetTickCount();
     data->parseUAVTalk  = true;
     data->comSpeed = OPLINKSETTINGS_COMSPEED_9600;
     PIOS_COM_RADIO = PIOS_COM_RFM22B;
@@ -258,6 +267,11 @@ static void telemetryTxTask(__attribute__((unused)) void *parameters)
 #ifdef PIOS_INCLUDE_WDG
         PIOS_WDG_UpdateFlag(PIOS_WDG_TELEMETRYTX);
 #endif
+        // Report the relay statistics
+        if (xTaskGetTickCount() - data->relayStatsTime >= RELAY_STATS_PERIOD_MS / portTICK_RATE_MS) {
+            updateRelayStats();
+        }
+
         // Wait for queue message
         if (xQueueReceive(data->uavtalkEventQueue, &ev, MAX_PORT_DELAY) == pdTRUE) {
             if ((ev.event == EV_UPDATED) || (ev.event == EV_UPDATE_REQ)) {
@@ -323,17 +337,14 @@ static void radioRxTask(__attribute__((unused)) void *parameters)
         PIOS_WDG_UpdateFlag(PIOS_WDG_RADIORX);
 #endif
         if (PIOS_COM_RADIO) {
-            uint8_t serial_data[1];
-            uint16_t bytes_to_process = PIOS_COM_ReceiveBuffer(PIOS_COM_RADIO, serial_data, sizeof(serial_data), MAX_PORT_DELAY);
+            uint16_t bytes_to_process = PIOS_COM_ReceiveBuffer(PIOS_COM_RADIO, data->radioRxBuf, sizeof(data->radioRxBuf), MAX_PORT_DELAY);
             if (bytes_to_process > 0) {
                 if (data->parseUAVTalk) {
-                    // Pass the data through the UAVTalk parser.
-                    for (uint8_t i = 0; i < bytes_to_process; i++) {
-                        ProcessRadioStream(data->radioUAVTalkCon, data->telemUAVTalkCon, serial_data[i]);
-                    }
+                    // Relay the UAVTalk frames, timed from their arrival.
+                    ProcessRadioStream(data->radioUAVTalkCon, data->telemUAVTalkCon, data->radioRxBuf, bytes_to_process, xTaskGetTickCount() * portTICK_RATE_MS);
                 } else if (PIOS_COM_TELEMETRY) {
                     // Send the data straight to the telemetry port.
-                    PIOS_COM_SendBufferNonBlocking(PIOS_COM_TELEMETRY, serial_data, bytes_to_process);
+                    PIOS_COM_SendBufferNonBlocking(PIOS_COM_TELEMETRY, data->radioRxBuf, bytes_to_process);
                 }
             }
         } else {
@@ -362,12 +373,9 @@ static void telemetryRxTask(__attribute__((unused)) void *parameters)
         }
 #endif /* PIOS_INCLUDE_USB */
         if (inputPort) {
-            uint8_t serial_data[1];
-            uint16_t bytes_to_process = PIOS_COM_ReceiveBuffer(inputPort, serial_data, sizeof(serial_data), MAX_PORT_DELAY);
+            uint16_t bytes_to_process = PIOS_COM_ReceiveBuffer(inputPort, data->telemetryRxBuf, sizeof(data->telemetryRxBuf), MAX_PORT_DELAY);
             if (bytes_to_process > 0) {
-                for (uint8_t i = 0; i < bytes_to_process; i++) {
-                    ProcessTelemetryStream(data->telemUAVTalkCon, data->radioUAVTalkCon, serial_data[i]);
-                }
+                ProcessTelemetryStream(data->telemUAVTalkCon, data->radioUAVTalkCon, data->telemetryRxBuf, bytes_to_process, xTaskGetTickCount() * portTICK_RATE_MS);
             }
         } else {
             vTaskDelay(5);
@@ -485,55 +493,98 @@ static int32_t RadioSendHandler(uint8_t *buf, int32_t length)
 }
 
 /**
- * @brief Process a byte of data received on the telemetry stream
+ * @brief Process data received on the telemetry stream. The frames are relayed as they are,
+ * frames for objects of this modem are decoded as well.
  *
  * @param[in] inConnectionHandle  The UAVTalk connection handle on the telemetry port
  * @param[in] outConnectionHandle  The UAVTalk connection handle on the radio port.
- * @param[in] rxbyte  The received byte.
+ * @param[in] buf  The received data.
+ * @param[in] length  The number of bytes received.
+ * @param[in] rxTime  When the data was received, in ms.
  */
-static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte)
+static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t *buf, uint16_t length, uint32_t rxTime)
 {
-    // Keep reading until we receive a completed packet.
-    UAVTalkRxState state = UAVTalkProcessInputStream(inConnectionHandle, rxbyte);
-
-    if (state == UAVTALK_STATE_ERROR) {
-        data->UAVTalkErrors++;
-    } else if (state == UAVTALK_STATE_COMPLETE) {
-        UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
+    while (length > 0) {
+        UAVTalkFrame frame;
+        uint16_t used = UAVTalkScanFrame(inConnectionHandle, buf, length, rxTime, &frame);
+
+        buf    += used;
+        length -= used;
+        if (frame.data) {
+            // Requests are answered here too, nacked if the object is not ours.
+            if (frame.type == UAVTALK_TYPE_OBJ_REQ || UAVObjGetByID(frame.objId)) {
+                UAVTalkReceiveFrame(inConnectionHandle, &frame);
+            }
+            UAVTalkRelayFrame(inConnectionHandle, outConnectionHandle, &frame);
+        }
     }
 }
 
 /**
- * @brief Process a byte of data received on the radio data stream.
+ * @brief Process data received on the radio data stream.
  *
  * @param[in] inConnectionHandle  The UAVTalk connection handle on the radio port.
  * @param[in] outConnectionHandle  The UAVTalk connection handle on the telemetry port.
- * @param[in] rxbyte  The received byte.
+ * @param[in] buf  The received data.
+ * @param[in] length  The number of bytes received.
+ * @param[in] rxTime  When the data was received, in ms.
  */
-static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte)
+static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t *buf, uint16_t length, uint32_t rxTime)
 {
-    // Keep reading until we receive a completed packet.
-    UAVTalkRxState state = UAVTalkProcessInputStreamQuiet(inConnectionHandle, rxbyte);
-
-    if (state == UAVTALK_STATE_ERROR) {
-        data->UAVTalkErrors++;
-    } else if (state == UAVTALK_STATE_COMPLETE) {
-        // We only want to unpack certain objects from the remote modem.
-        uint32_t objId = UAVTalkGetPacketObjId(inConnectionHandle);
-        switch (objId) {
-        case OPLINKSTATUS_OBJID:
-        case OPLINKSETTINGS_OBJID:
-            break;
-        case OPLINKRECEIVER_OBJID:
-            UAVTalkReceiveObject(inConnectionHandle);
-            break;
-        default:
-            UAVTalkRelayPacket(inConnectionHandle, outConnectionHandle);
-            break;
+    while (length > 0) {
+        UAVTalkFrame frame;
+        uint16_t used = UAVTalkScanFrame(inConnectionHandle, buf, length, rxTime, &frame);
+
+        buf    += used;
+        length -= used;
+        if (frame.data) {
+            // We only want to unpack certain objects from the remote modem.
+            switch (frame.objId) {
+            case OPLINKSTATUS_OBJID:
+            case OPLINKSETTINGS_OBJID:
+                break;
+            case OPLINKRECEIVER_OBJID:
+                UAVTalkReceiveFrame(inConnectionHandle, &frame);
+                break;
+            default:
+                UAVTalkRelayFrame(inConnectionHandle, outConnectionHandle, &frame);
+                break;
+            }
         }
     }
 }
 
+/**
+ * @brief Report the throughput and latency of the relayed frames in each direction.
+ */
+static void updateRelayStats()
+{
+    UAVTalkRelayStats stats[2];
+    uint16_t rate[OPLINKSTATUS_RELAYRATE_NUMELEM];
+    uint16_t latency[OPLINKSTATUS_RELAYLATENCY_NUMELEM];
+    uint16_t latencyMax[OPLINKSTATUS_RELAYLATENCYMAX_NUMELEM];
+    uint16_t errors;
+    portTickType now = xTaskGetTickCount();
+    uint32_t periodMs = (now - data->relayStatsTime) * portTICK_RATE_MS;
+
+    // The rx tasks keep counting while the counters are read
+    UAVTalkGetRelayStats(data->telemUAVTalkCon, &stats[OPLINKSTATUS_RELAYRATE_TORADIO], true);
+    UAVTalkGetRelayStats(data->radioUAVTalkCon, &stats[OPLINKSTATUS_RELAYRATE_FROMRADIO], true);
+    data->relayStatsTime = now;
+
+    OPLinkStatusUAVTalkErrorsGet(&errors);
+    for (uint8_t i = 0; i < 2; i++) {
+        rate[i]       = stats[i].bytes * 1000 / periodMs;
+        latency[i]    = stats[i].frames ? stats[i].latencySumMs / stats[i].frames : 0;
+        latencyMax[i] = stats[i].latencyMaxMs;
+        errors += stats[i].dropped;
+    }
+    OPLinkStatusRelayRateSet(rate);
+    OPLinkStatusRelayLatencySet(latency);
+    OPLinkStatusRelayLatencyMaxSet(latencyMax);
+    OPLinkStatusUAVTalkErrorsSet(&errors);
+}
+
 /**
  * @brief Callback that is called when the ObjectPersistence UAVObject is changed.
  * @param[in] objEv  The event that precipitated the callback.
@@ -545,6 +596,29 @@ static void objectPersistenceUpdatedCb(__attribute__((unused)) UAVObjEvent *objE
 
     ObjectPersistenceGet(&obj_per);
 
+    // Settings uploaded by the GCS for a batch save
+    if (obj_per.Selection == OBJECTPERSISTENCE_SELECTION_COLLECTEDSETTINGS) {
+        bool success = false;
+        switch (obj_per.Operation) {
+        case OBJECTPERSISTENCE_OPERATION_COLLECT:
+            UAVObjCollectSettings();
+            success = true;
+            break;
+        case OBJECTPERSISTENCE_OPERATION_SAVE:
+#if defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS)
+            success = (UAVObjSaveCollectedSettings() == 0);
+#endif
+            break;
+        default:
+            break;
+        }
+        if (success == true) {
+            obj_per.Operation = OBJECTPERSISTENCE_OPERATION_COMPLETED;
+            ObjectPersistenceSet(&obj_per);
+        }
+        return;
+    }
+
     // Is this concerning or setting object?
     if (obj_per.ObjectID == OPLINKSETTINGS_OBJID) {
         // Is this a save, load, or delete?
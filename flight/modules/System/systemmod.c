@@ -50,6 +50,7 @@
 #include <systemsettings.h>
 #include <i2cstats.h>
 #include <taskinfo.h>
+#include <callbackinfo.h>
 #include <watchdogstatus.h>
 #include <taskinfo.h>
 #include <hwsettings.h>
@@ -104,9 +105,11 @@ static void objectUpdatedCb(UAVObjEvent *ev);
 static void hwSettingsUpdatedCb(UAVObjEvent *ev);
 #ifdef DIAG_TASKS
 static void taskMonitorForEachCallback(uint16_t task_id, const struct pios_task_info *task_info, void *context);
+static void callbackSchedulerForEachCallback(int16_t callback_id, const DelayedCallbackStats *stats, void *context);
 #endif
 static void updateStats();
 static void updateSystemAlarms();
+static void collectFlashGarbage();
 static void systemTask(void *parameters);
 #ifdef DIAG_I2C_WDG_STATS
 static void updateI2Cstats();
@@ -146,6 +149,7 @@ int32_t SystemModInitialize(void)
     ObjectPersistenceInitialize();
 #ifdef DIAG_TASKS
     TaskInfoInitialize();
+    CallbackInfoInitialize();
 #endif
 #ifdef DIAG_I2C_WDG_STATS
     I2CStatsInitialize();
@@ -201,6 +205,7 @@ static void systemTask(__attribute__((unused)) void *parameters)
 
 #ifdef DIAG_TASKS
     TaskInfoData taskInfoData;
+    CallbackInfoData callbackInfoData;
 #endif
 
     // Main system loop
@@ -211,6 +216,9 @@ static void systemTask(__attribute__((unused)) void *parameters)
 
         // Update the system alarms
         updateSystemAlarms();
+
+        // Let the flash filesystems garbage collect in the background
+        collectFlashGarbage();
 #ifdef DIAG_I2C_WDG_STATS
         updateI2Cstats();
         updateWDGstats();
@@ -220,6 +228,10 @@ static void systemTask(__attribute__((unused)) void *parameters)
         // Update the task status object
         PIOS_TASK_MONITOR_ForEachTask(taskMonitorForEachCallback, &taskInfoData);
         TaskInfoSet(&taskInfoData);
+        // Update the callback status object
+        memset((void *)&callbackInfoData, 0, sizeof(CallbackInfoData));
+        CallbackSchedulerForEachCallback(callbackSchedulerForEachCallback, &callbackInfoData);
+        CallbackInfoSet(&callbackInfoData);
 #endif
 
         // Flash the heartbeat LED
@@ -367,6 +379,14 @@ static void objectUpdatedCb(UAVObjEvent *ev)
                 retval = UAVObjSaveSettings();
             } else if (objper.Selection == OBJECTPERSISTENCE_SELECTION_ALLMETAOBJECTS || objper.Selection == OBJECTPERSISTENCE_SELECTION_ALLOBJECTS) {
                 retval = UAVObjSaveMetaobjects();
+            } else if (objper.Selection == OBJECTPERSISTENCE_SELECTION_COLLECTEDSETTINGS) {
+                // Saves and verifies the settings uploaded since the Collect request
+                retval = UAVObjSaveCollectedSettings();
+            }
+        } else if (objper.Operation == OBJECTPERSISTENCE_OPERATION_COLLECT) {
+            if (objper.Selection == OBJECTPERSISTENCE_SELECTION_COLLECTEDSETTINGS) {
+                UAVObjCollectSettings();
+                retval = 0;
             }
         } else if (objper.Operation == OBJECTPERSISTENCE_OPERATION_DELETE) {
             if (objper.Selection == OBJECTPERSISTENCE_SELECTION_SINGLEOBJECT) {
@@ -385,6 +405,7 @@ static void objectUpdatedCb(UAVObjEvent *ev)
         } else if (objper.Operation == OBJECTPERSISTENCE_OPERATION_FULLERASE) {
 #if defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS)
             retval = PIOS_FLASHFS_Format(0);
+            UAVObjMarkSettingsDirty();
 #else
             retval = -1;
 #endif
@@ -430,6 +451,21 @@ static void taskMonitorForEachCallback(uint16_t task_id, const struct pios_task_
     taskData->StackRemaining[task_id] = task_info->stack_remaining;
     taskData->RunningTime[task_id]    = task_info->running_time_percentage;
 }
+
+static void callbackSchedulerForEachCallback(int16_t callback_id, const DelayedCallbackStats *stats, void *context)
+{
+    CallbackInfoData *callbackData = (CallbackInfoData *)context;
+
+    // callbacks beyond the size of the object are not reported
+    if (callback_id < 0 || callback_id >= CALLBACKINFO_RUNCOUNT_NUMELEM) {
+        return;
+    }
+    callbackData->RunCount[callback_id]         = stats->runCount;
+    callbackData->MaxLatency[callback_id]       = stats->maxLatencyUs;
+    callbackData->MaxExecutionTime[callback_id] = stats->maxExecutionUs;
+    callbackData->Priority[callback_id]         = stats->priority; // enum order matches DelayedCallbackPriority
+    callbackData->PriorityTask[callback_id]     = stats->priorityTask;
+}
 #endif
 
 /**
@@ -501,6 +537,30 @@ static uint16_t GetFreeIrqStackSize(void)
     return i;
 }
 
+/**
+ * Called periodically to run a step of any garbage collection pending in the
+ * flash filesystems, so that saving settings rarely has to wait for one.
+ * Only done while disarmed, as erasing internal flash stalls the cpu.
+ */
+static void collectFlashGarbage()
+{
+#if !defined(ARCH_POSIX) && !defined(ARCH_WIN32)
+    uint8_t armed;
+
+    FlightStatusArmedGet(&armed);
+    if (armed != FLIGHTSTATUS_ARMED_DISARMED) {
+        return;
+    }
+
+    if (pios_uavo_settings_fs_id) {
+        PIOS_FLASHFS_Idle(pios_uavo_settings_fs_id);
+    }
+    if (pios_user_fs_id) {
+        PIOS_FLASHFS_Idle(pios_user_fs_id);
+    }
+#endif
+}
+
 /**
  * Called periodically to update the system stats
  */
@@ -625,6 +685,10 @@ static void updateSystemAlarms()
         sysStats.ObjectManagerQueueID    = objStats.lastQueueErrorID;
         SystemStatsSet(&sysStats);
     }
+
+    // Lock contention and coalesced events of the object manager over the last update period
+    SystemStatsObjectManagerLockContentionSet(&objStats.lockContention);
+    SystemStatsObjectManagerEventsCoalescedSet(&objStats.eventsCoalesced);
 }
 
 /**
@@ -36,6 +36,7 @@
 
 #include "flighttelemetrystats.h"
 #include "gcstelemetrystats.h"
+#include "flightstatus.h"
 #include "hwsettings.h"
 #include "taskinfo.h"
 
@@ -50,6 +51,16 @@
 #define MAX_RETRIES            2
 #define STATS_UPDATE_PERIOD_MS 4000
 #define CONNECTION_TIMEOUT_MS  8000
+#define MULTI_OBJECT_DELAY_MS  10
+#define KEYFRAME_INTERVAL      10
+#define RX_BUFFER_SIZE         16
+
+// Update rate control, rates are in percent of the metadata update rates
+#define RATE_MIN               10
+#define RATE_STEP              10
+#define LINK_BUDGET_USE        80 // percent of the link budget the telemetry may take
+#define BACKGROUND_PERIOD_MS   1000
+#define LINK_QUALITY_MAX       128
 
 // Private types
 
@@ -73,7 +84,10 @@ static xTaskHandle radioRxTaskHandle;
 static uint32_t txErrors;
 static uint32_t txRetries;
 static uint32_t timeOfLastObjectUpdate;
+static uint32_t linkCapacity; // bytes/s of the telemetry port, 0 if unknown
+static uint8_t updateRate; // percent of the metadata update rates sent to the GCS
 static UAVTalkConnection uavTalkCon;
+static uint32_t reservedPort; // port the frame being built in place goes out on
 #ifdef PIOS_INCLUDE_RFM22B
 static UAVTalkConnection radioUavTalkCon;
 #endif
@@ -85,14 +99,20 @@ static void telemetryRxTask(void *parameters);
 static void radioRxTask(void *parameters);
 #endif
 static int32_t transmitData(uint8_t *data, int32_t length);
+static uint8_t *reserveData(uint16_t length);
+static int32_t commitData(uint16_t length);
 static void registerObject(UAVObjHandle obj);
 static void updateObject(UAVObjHandle obj, int32_t eventType);
 static int32_t setUpdatePeriod(UAVObjHandle obj, int32_t updatePeriodMs);
+static int32_t scaledUpdatePeriod(UAVObjHandle obj, UAVObjMetadata *metadata);
+static void rescaleObject(UAVObjHandle obj);
+static void updateRateControl(FlightTelemetryStatsData *flightStats, UAVTalkStats *utalkStats, uint32_t errors);
 static void processObjEvent(UAVObjEvent *ev);
 static void updateTelemetryStats();
 static void gcsTelemetryStatsUpdated();
 static void updateSettings();
 static uint32_t getComPort(bool input);
+static portTickType txWaitTicks();
 
 /**
  * Initialise the telemetry module
@@ -138,6 +158,7 @@ int32_t TelemetryInitialize(void)
 
     // Initialize vars
     timeOfLastObjectUpdate = 0;
+    updateRate = 100;
 
     // Create object queues
     queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
@@ -152,6 +173,9 @@ int32_t TelemetryInitialize(void)
 
     // Initialise UAVTalk
     uavTalkCon = UAVTalkInitialize(&transmitData);
+    // Objects are built straight into the tx buffer of the port, the radio
+    // connection sends from another task and keeps copying
+    UAVTalkSetOutputBuffer(uavTalkCon, &reserveData, &commitData);
 #ifdef PIOS_INCLUDE_RFM22B
     radioUavTalkCon = UAVTalkInitialize(&transmitData);
 #endif
@@ -177,7 +201,7 @@ static void registerObject(UAVObjHandle obj)
 {
     if (UAVObjIsMetaobject(obj)) {
         /* Only connect change notifications for meta objects.  No periodic updates */
-        UAVObjConnectQueue(obj, priorityQueue, EV_MASK_ALL_UPDATES);
+        UAVObjConnectQueueCoalesced(obj, priorityQueue, EV_MASK_ALL_UPDATES);
         return;
     } else {
         UAVObjMetadata metadata;
@@ -228,17 +252,17 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
     switch (updateMode) {
     case UPDATEMODE_PERIODIC:
         // Set update period
-        setUpdatePeriod(obj, metadata.telemetryUpdatePeriod);
+        setUpdatePeriod(obj, scaledUpdatePeriod(obj, &metadata));
         // Connect queue
         eventMask = EV_UPDATED_PERIODIC | EV_UPDATED_MANUAL | EV_UPDATE_REQ;
-        UAVObjConnectQueue(obj, priorityQueue, eventMask);
+        UAVObjConnectQueueCoalesced(obj, priorityQueue, eventMask);
         break;
     case UPDATEMODE_ONCHANGE:
         // Set update period
         setUpdatePeriod(obj, 0);
         // Connect queue
         eventMask = EV_UPDATED | EV_UPDATED_MANUAL | EV_UPDATE_REQ;
-        UAVObjConnectQueue(obj, priorityQueue, eventMask);
+        UAVObjConnectQueueCoalesced(obj, priorityQueue, eventMask);
         break;
     case UPDATEMODE_THROTTLED:
         if ((eventType == EV_UPDATED_PERIODIC) || (eventType == EV_NONE)) {
@@ -246,20 +270,20 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
             eventMask = EV_UPDATED | EV_UPDATED_MANUAL | EV_UPDATE_REQ;
             // Set update period on initialization and metadata change
             if (eventType == EV_NONE) {
-                setUpdatePeriod(obj, metadata.telemetryUpdatePeriod);
+                setUpdatePeriod(obj, scaledUpdatePeriod(obj, &metadata));
             }
         } else {
             // Otherwise, we just received an object update, so switch to periodic for the timeout period to prevent more updates
             eventMask = EV_UPDATED_PERIODIC | EV_UPDATED_MANUAL | EV_UPDATE_REQ;
         }
-        UAVObjConnectQueue(obj, priorityQueue, eventMask);
+        UAVObjConnectQueueCoalesced(obj, priorityQueue, eventMask);
         break;
     case UPDATEMODE_MANUAL:
         // Set update period
         setUpdatePeriod(obj, 0);
         // Connect queue
         eventMask = EV_UPDATED_MANUAL | EV_UPDATE_REQ;
-        UAVObjConnectQueue(obj, priorityQueue, eventMask);
+        UAVObjConnectQueueCoalesced(obj, priorityQueue, eventMask);
         break;
     }
 }
@@ -289,13 +313,8 @@ static void processObjEvent(UAVObjEvent *ev)
         retries    = 0;
         success    = -1;
         if (ev->event == EV_UPDATED || ev->event == EV_UPDATED_MANUAL || ((ev->event == EV_UPDATED_PERIODIC) && (updateMode != UPDATEMODE_THROTTLED))) {
-            // Send update to GCS (with retries)
-            while (retries < MAX_RETRIES && success == -1) {
-                success = UAVTalkSendObject(uavTalkCon, ev->obj, ev->instId, UAVObjGetTelemetryAcked(&metadata), REQ_TIMEOUT_MS); // call blocks until ack is received or timeout
-                ++retries;
-            }
-            // Update stats
-            txRetries += (retries - 1);
+            // Send update to GCS, acks and retries are handled while the next updates go out
+            success = UAVTalkSendObjectAsync(uavTalkCon, ev->obj, ev->instId, UAVObjGetTelemetryAcked(&metadata), REQ_TIMEOUT_MS, MAX_RETRIES - 1);
             if (success == -1) {
                 ++txErrors;
             }
@@ -332,8 +351,8 @@ static void telemetryTxTask(__attribute__((unused)) void *parameters)
 
     // Loop forever
     while (1) {
-        // Wait for queue message
-        if (xQueueReceive(queue, &ev, portMAX_DELAY) == pdTRUE) {
+        // Wait for queue message, or until an ack times out or collected updates are due
+        if (UAVObjReceiveEvent(queue, &ev, txWaitTicks()) == pdTRUE) {
             // Process event
             processObjEvent(&ev);
         }
@@ -350,8 +369,8 @@ static void telemetryTxPriTask(__attribute__((unused)) void *parameters)
 
     // Loop forever
     while (1) {
-        // Wait for queue message
-        if (xQueueReceive(priorityQueue, &ev, portMAX_DELAY) == pdTRUE) {
+        // Wait for queue message, or until an ack times out or collected updates are due
+        if (UAVObjReceiveEvent(priorityQueue, &ev, txWaitTicks()) == pdTRUE) {
             // Process event
             processObjEvent(&ev);
         }
@@ -359,6 +378,21 @@ static void telemetryTxPriTask(__attribute__((unused)) void *parameters)
 }
 #endif
 
+/**
+ * Retry the acked sends that timed out and send the collected updates that are due
+ * \return Ticks a tx task can wait for events before more work is due
+ */
+static portTickType txWaitTicks()
+{
+    int32_t waitMs  = UAVTalkProcessTransactions(uavTalkCon);
+    int32_t multiMs = UAVTalkProcessMultiObject(uavTalkCon);
+
+    if (waitMs < 0 || (multiMs >= 0 && multiMs < waitMs)) {
+        waitMs = multiMs;
+    }
+    return UAVTalkWaitTicks(waitMs);
+}
+
 /**
  * Telemetry receive task. Processes queue events and periodic updates.
  */
@@ -370,14 +404,12 @@ static void telemetryRxTask(__attribute__((unused)) void *parameters)
 
         if (inputPort) {
             // Block until data are available
-            uint8_t serial_data[1];
+            uint8_t serial_data[RX_BUFFER_SIZE];
             uint16_t bytes_to_process;
 
             bytes_to_process = PIOS_COM_ReceiveBuffer(inputPort, serial_data, sizeof(serial_data), 500);
             if (bytes_to_process > 0) {
-                for (uint8_t i = 0; i < bytes_to_process; i++) {
-                    UAVTalkProcessInputStream(uavTalkCon, serial_data[i]);
-                }
+                UAVTalkProcessInputBuffer(uavTalkCon, serial_data, bytes_to_process);
             }
         } else {
             vTaskDelay(5);
@@ -395,14 +427,12 @@ static void radioRxTask(__attribute__((unused)) void *parameters)
     while (1) {
         if (telemetryPort) {
             // Block until data are available
-            uint8_t serial_data[1];
+            uint8_t serial_data[RX_BUFFER_SIZE];
             uint16_t bytes_to_process;
 
             bytes_to_process = PIOS_COM_ReceiveBuffer(telemetryPort, serial_data, sizeof(serial_data), 500);
             if (bytes_to_process > 0) {
-                for (uint8_t i = 0; i < bytes_to_process; i++) {
-                    UAVTalkProcessInputStream(radioUavTalkCon, serial_data[i]);
-                }
+                UAVTalkProcessInputBuffer(radioUavTalkCon, serial_data, bytes_to_process);
             }
         } else {
             vTaskDelay(5);
@@ -429,6 +459,35 @@ static int32_t transmitData(uint8_t *data, int32_t length)
     return -1;
 }
 
+/**
+ * Reserve room for a frame in the tx buffer of the modem or USB port.  The
+ * port takes no other data, e.g. from the radio rx task, until commitData().
+ * \param[in] length Length of the frame
+ * \return NULL if there is no room, the frame is sent by transmitData() then
+ * \return the room to build the frame in
+ */
+static uint8_t *reserveData(uint16_t length)
+{
+    reservedPort = getComPort(false);
+
+    if (reservedPort) {
+        return PIOS_COM_SendBufferReserve(reservedPort, length);
+    }
+
+    return NULL;
+}
+
+/**
+ * Transmit the frame built in the room from reserveData().
+ * \param[in] length Length of the frame, 0 to drop it
+ * \return -1 on failure
+ * \return number of bytes transmitted on success
+ */
+static int32_t commitData(uint16_t length)
+{
+    return PIOS_COM_SendBufferCommit(reservedPort, length);
+}
+
 /**
  * Set update period of object (it must be already setup for periodic updates)
  * \param[in] obj The object to update
@@ -447,6 +506,108 @@ static int32_t setUpdatePeriod(UAVObjHandle obj, int32_t updatePeriodMs)
     return EventPeriodicQueueUpdate(&ev, queue, updatePeriodMs);
 }
 
+/**
+ * Get the update period of an object at the current update rate. Critical objects
+ * (acked ones, the connection state and the alarms) always go at full rate, objects
+ * updated every BACKGROUND_PERIOD_MS or slower are slowed down twice as much as the
+ * regular ones.
+ * \param[in] obj The object
+ * \param[in] metadata The object's metadata
+ * \return The update period in ms
+ */
+static int32_t scaledUpdatePeriod(UAVObjHandle obj, UAVObjMetadata *metadata)
+{
+    uint32_t period = metadata->telemetryUpdatePeriod;
+
+    if (updateRate >= 100 || period == 0 || UAVObjGetTelemetryAcked(metadata) ||
+        obj == FlightTelemetryStatsHandle() || obj == GCSTelemetryStatsHandle() ||
+        obj == SystemAlarmsHandle() || obj == FlightStatusHandle()) {
+        return period;
+    }
+    if (period < BACKGROUND_PERIOD_MS) {
+        period = period * 100 / updateRate;
+    } else {
+        period = period * 100 / updateRate * 100 / updateRate;
+    }
+    return period > 0xFFFF ? 0xFFFF : period;
+}
+
+/**
+ * Apply the current update rate to an object
+ * \param[in] obj The object
+ */
+static void rescaleObject(UAVObjHandle obj)
+{
+    UAVObjMetadata metadata;
+    UAVObjUpdateMode updateMode;
+
+    if (UAVObjIsMetaobject(obj)) {
+        return;
+    }
+    UAVObjGetMetadata(obj, &metadata);
+    updateMode = UAVObjGetTelemetryUpdateMode(&metadata);
+    if (updateMode == UPDATEMODE_PERIODIC || updateMode == UPDATEMODE_THROTTLED) {
+        setUpdatePeriod(obj, scaledUpdatePeriod(obj, &metadata));
+    }
+}
+
+/**
+ * Adjust the update rate of the telemetry to the link. The budget is a configured cap,
+ * not a measurement: the byte rate of the port at its configured baud rate, or what the
+ * radio sends at its datarate, reduced by the link quality the radio reports when it is
+ * used. The rate is cut by a quarter when the telemetry uses more than LINK_BUDGET_USE percent of the budget,
+ * fails to send or falls behind, and raised by RATE_STEP when the raised rate still
+ * fits the budget.
+ * \param[in,out] flightStats Reports the budget and the update rates
+ * \param[in] utalkStats The UAVTalk stats of the last period
+ * \param[in] errors The send errors of the last period
+ */
+static void updateRateControl(FlightTelemetryStatsData *flightStats, UAVTalkStats *utalkStats, uint32_t errors)
+{
+    uint8_t newRate = updateRate;
+    float budget    = 0.0f;
+    uint32_t port   = getComPort(false);
+
+    if (port != 0 && port == telemetryPort) {
+        budget = linkCapacity;
+    }
+#ifdef PIOS_INCLUDE_RFM22B
+    if (pios_rfm22b_id && PIOS_RFM22B_LinkStatus(pios_rfm22b_id)) {
+        struct rfm22b_stats radio_stats;
+        PIOS_RFM22B_GetStats(pios_rfm22b_id, &radio_stats);
+        budget = budget * radio_stats.link_quality / LINK_QUALITY_MAX;
+    }
+#endif
+    float limit  = budget * LINK_BUDGET_USE / 100.0f;
+    float txRate = (float)utalkStats->txBytes / ((float)STATS_UPDATE_PERIOD_MS / 1000.0f);
+
+    if (flightStats->Status != FLIGHTTELEMETRYSTATS_STATUS_CONNECTED) {
+        newRate = 100;
+    } else if (port == 0) {
+        // Nothing carries the telemetry, hold the rate until a port is back
+    } else if (errors > 0 || uxQueueMessagesWaiting(queue) > MAX_QUEUE_SIZE / 2 || (budget > 0.0f && txRate > limit)) {
+        newRate = updateRate * 3 / 4;
+        if (newRate < RATE_MIN) {
+            newRate = RATE_MIN;
+        }
+    } else if (updateRate < 100 && (budget == 0.0f || txRate * (updateRate + RATE_STEP) / updateRate < limit)) {
+        newRate = updateRate + RATE_STEP;
+        if (newRate > 100) {
+            newRate = 100;
+        }
+    }
+
+    if (newRate != updateRate) {
+        updateRate = newRate;
+        // The dispatcher keeps the phase of every rescaled object, so this does not burst
+        UAVObjIterate(&rescaleObject);
+    }
+
+    flightStats->LinkBudget = budget;
+    flightStats->UpdateRate[FLIGHTTELEMETRYSTATS_UPDATERATE_REGULAR]    = updateRate;
+    flightStats->UpdateRate[FLIGHTTELEMETRYSTATS_UPDATERATE_BACKGROUND] = (uint16_t)updateRate * updateRate / 100;
+}
+
 /**
  * Called each time the GCS telemetry stats object is updated.
  * Trigger a flight telemetry stats update if a connection is not
@@ -475,6 +636,7 @@ static void updateTelemetryStats()
     uint8_t forceUpdate;
     uint8_t connectionTimeout;
     uint32_t timeNow;
+    uint32_t errors;
 
     // Get stats
     UAVTalkGetStats(uavTalkCon, &utalkStats);
@@ -483,6 +645,7 @@ static void updateTelemetryStats()
     UAVTalkResetStats(radioUavTalkCon);
 #endif
     UAVTalkResetStats(uavTalkCon);
+    errors = txErrors + utalkStats.txErrors;
 
     // Get object data
     FlightTelemetryStatsGet(&flightStats);
@@ -493,8 +656,10 @@ static void updateTelemetryStats()
         flightStats.RxDataRate  = (float)utalkStats.rxBytes / ((float)STATS_UPDATE_PERIOD_MS / 1000.0f);
         flightStats.TxDataRate  = (float)utalkStats.txBytes / ((float)STATS_UPDATE_PERIOD_MS / 1000.0f);
         flightStats.RxFailures += utalkStats.rxErrors;
-        flightStats.TxFailures += txErrors;
-        flightStats.TxRetries  += txRetries;
+        flightStats.TxFailures += txErrors + utalkStats.txErrors;
+        flightStats.TxRetries  += txRetries + utalkStats.txRetries;
+        flightStats.RoundTripTime    = utalkStats.rttSamples ? utalkStats.rttSumMs / utalkStats.rttSamples : 0;
+        flightStats.RoundTripTimeMax = utalkStats.rttMaxMs;
         txErrors = 0;
         txRetries = 0;
     } else {
@@ -503,6 +668,8 @@ static void updateTelemetryStats()
         flightStats.RxFailures = 0;
         flightStats.TxFailures = 0;
         flightStats.TxRetries  = 0;
+        flightStats.RoundTripTime    = 0;
+        flightStats.RoundTripTimeMax = 0;
         txErrors = 0;
         txRetries = 0;
     }
@@ -542,6 +709,23 @@ static void updateTelemetryStats()
         flightStats.Status = FLIGHTTELEMETRYSTATS_STATUS_DISCONNECTED;
     }
 
+    // Collect the updates into multi-object frames when the GCS takes them
+    if (flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED && gcsStats.MultiObjectFrames == GCSTELEMETRYSTATS_MULTIOBJECTFRAMES_TRUE) {
+        UAVTalkSetMultiObjectDelay(uavTalkCon, MULTI_OBJECT_DELAY_MS);
+    } else {
+        UAVTalkSetMultiObjectDelay(uavTalkCon, 0);
+    }
+
+    // Send field deltas of the objects that allow it when the GCS takes them
+    if (flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED && gcsStats.DeltaFrames == GCSTELEMETRYSTATS_DELTAFRAMES_TRUE) {
+        UAVTalkSetDeltaKeyframeInterval(uavTalkCon, KEYFRAME_INTERVAL);
+    } else {
+        UAVTalkSetDeltaKeyframeInterval(uavTalkCon, 0);
+    }
+
+    // Keep the telemetry within what the link carries
+    updateRateControl(&flightStats, &utalkStats, errors);
+
     // Update the telemetry alarm
     if (flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED) {
         AlarmsClear(SYSTEMALARMS_ALARM_TELEMETRY);
@@ -567,36 +751,54 @@ static void updateTelemetryStats()
  */
 static void updateSettings()
 {
-    if (telemetryPort) {
-        // Retrieve settings
-        uint8_t speed;
-        HwSettingsTelemetrySpeedGet(&speed);
-
-        // Set port speed
-        switch (speed) {
-        case HWSETTINGS_TELEMETRYSPEED_2400:
-            PIOS_COM_ChangeBaud(telemetryPort, 2400);
-            break;
-        case HWSETTINGS_TELEMETRYSPEED_4800:
-            PIOS_COM_ChangeBaud(telemetryPort, 4800);
-            break;
-        case HWSETTINGS_TELEMETRYSPEED_9600:
-            PIOS_COM_ChangeBaud(telemetryPort, 9600);
-            break;
-        case HWSETTINGS_TELEMETRYSPEED_19200:
-            PIOS_COM_ChangeBaud(telemetryPort, 19200);
-            break;
-        case HWSETTINGS_TELEMETRYSPEED_38400:
-            PIOS_COM_ChangeBaud(telemetryPort, 38400);
-            break;
-        case HWSETTINGS_TELEMETRYSPEED_57600:
-            PIOS_COM_ChangeBaud(telemetryPort, 57600);
-            break;
-        case HWSETTINGS_TELEMETRYSPEED_115200:
-            PIOS_COM_ChangeBaud(telemetryPort, 115200);
-            break;
-        }
+    if (!telemetryPort) {
+        // No telemetry port, nothing to budget
+        linkCapacity = 0;
+        return;
+    }
+#ifdef PIOS_INCLUDE_RFM22B
+    // The board makes the radio the telemetry port when the radio is on,
+    // it carries what its datarate allows whatever the telemetry speed
+    if (pios_rfm22b_id) {
+        linkCapacity = PIOS_RFM22B_TxCapacity(pios_rfm22b_id);
+        return;
+    }
+#endif
+
+    // Retrieve settings
+    uint8_t speed;
+    uint32_t baud = 0;
+    HwSettingsTelemetrySpeedGet(&speed);
+
+    // Set port speed
+    switch (speed) {
+    case HWSETTINGS_TELEMETRYSPEED_2400:
+        baud = 2400;
+        break;
+    case HWSETTINGS_TELEMETRYSPEED_4800:
+        baud = 4800;
+        break;
+    case HWSETTINGS_TELEMETRYSPEED_9600:
+        baud = 9600;
+        break;
+    case HWSETTINGS_TELEMETRYSPEED_19200:
+        baud = 19200;
+        break;
+    case HWSETTINGS_TELEMETRYSPEED_38400:
+        baud = 38400;
+        break;
+    case HWSETTINGS_TELEMETRYSPEED_57600:
+        baud = 57600;
+        break;
+    case HWSETTINGS_TELEMETRYSPEED_115200:
+        baud = 115200;
+        break;
+    }
+    if (baud) {
+        PIOS_COM_ChangeBaud(telemetryPort, baud);
     }
+    // 10 bits per byte on the wire
+    linkCapacity = baud / 10;
 }
 
 /**
@@ -51,6 +51,7 @@ struct pios_com_dev {
 #if defined(PIOS_INCLUDE_FREERTOS)
     xSemaphoreHandle tx_sem;
     xSemaphoreHandle rx_sem;
+    xSemaphoreHandle sendbuffer_sem; /* one producer at a time, held from reserve to commit */
 #endif
 
     bool has_rx;
@@ -101,8 +102,12 @@ static struct pios_com_dev *PIOS_COM_alloc(void)
 
 static uint16_t PIOS_COM_TxOutCallback(uint32_t context, uint8_t *buf, uint16_t buf_len, uint16_t *headroom, bool *need_yield);
 static uint16_t PIOS_COM_RxInCallback(uint32_t context, uint8_t *buf, uint16_t buf_len, uint16_t *headroom, bool *need_yield);
+static const uint8_t *PIOS_COM_TxSpanCallback(uint32_t context, uint16_t consumed, uint16_t *span_len, bool *need_yield);
 static void PIOS_COM_UnblockRx(struct pios_com_dev *com_dev, bool *need_yield);
 static void PIOS_COM_UnblockTx(struct pios_com_dev *com_dev, bool *need_yield);
+static int32_t PIOS_COM_SendBufferNonBlockingInternal(struct pios_com_dev *com_dev, const uint8_t *buffer, uint16_t len);
+static bool PIOS_COM_TakeSendBuffer(struct pios_com_dev *com_dev, uint32_t ticks);
+static void PIOS_COM_GiveSendBuffer(struct pios_com_dev *com_dev);
 
 /**
  * Initialises COM layer
@@ -152,8 +157,13 @@ int32_t PIOS_COM_Init(uint32_t *com_id, const struct pios_com_driver *driver, ui
         fifoBuf_init(&com_dev->tx, tx_buffer, tx_buffer_len);
 #if defined(PIOS_INCLUDE_FREERTOS)
         vSemaphoreCreateBinary(com_dev->tx_sem);
+        com_dev->sendbuffer_sem = xSemaphoreCreateMutex();
 #endif /* PIOS_INCLUDE_FREERTOS */
         (com_dev->driver->bind_tx_cb)(lower_id, PIOS_COM_TxOutCallback, (uint32_t)com_dev);
+        if (com_dev->driver->bind_tx_span_cb) {
+            /* The driver can send straight out of the tx buffer */
+            (com_dev->driver->bind_tx_span_cb)(lower_id, PIOS_COM_TxSpanCallback, (uint32_t)com_dev);
+        }
     }
 
     *com_id = (uint32_t)com_dev;
@@ -243,6 +253,29 @@ static uint16_t PIOS_COM_TxOutCallback(uint32_t context, uint8_t *buf, uint16_t
     return bytes_from_fifo;
 }
 
+static const uint8_t *PIOS_COM_TxSpanCallback(uint32_t context, uint16_t consumed, uint16_t *span_len, bool *need_yield)
+{
+    struct pios_com_dev *com_dev = (struct pios_com_dev *)context;
+
+    bool valid = PIOS_COM_validate(com_dev);
+
+    PIOS_Assert(valid);
+    PIOS_Assert(com_dev->has_tx);
+
+    *need_yield = false;
+    if (consumed > 0) {
+        fifoBuf_removeData(&com_dev->tx, consumed);
+        /* More space has been made in the buffer */
+        PIOS_COM_UnblockTx(com_dev, need_yield);
+    }
+
+    if (!span_len) {
+        return NULL;
+    }
+
+    return fifoBuf_getBlockPeek(&com_dev->tx, span_len);
+}
+
 /**
  * Change the port speed without re-initializing
  * \param[in] port COM port
@@ -273,8 +306,8 @@ int32_t PIOS_COM_ChangeBaud(uint32_t com_id, uint32_t baud)
  * \param[in] buffer character buffer
  * \param[in] len buffer length
  * \return -1 if port not available
- * \return -2 if non-blocking mode activated: buffer is full
- *            caller should retry until buffer is free again
+ * \return -2 if non-blocking mode activated: buffer is full or another
+ *            producer is sending, caller should retry until buffer is free again
  * \return number of bytes transmitted on success
  */
 int32_t PIOS_COM_SendBufferNonBlocking(uint32_t com_id, const uint8_t *buffer, uint16_t len)
@@ -288,6 +321,24 @@ int32_t PIOS_COM_SendBufferNonBlocking(uint32_t com_id, const uint8_t *buffer, u
 
     PIOS_Assert(com_dev->has_tx);
 
+    if (!PIOS_COM_TakeSendBuffer(com_dev, 0)) {
+        /* Another producer is sending or building a package in place (retry) */
+        return -2;
+    }
+
+    int32_t rc = PIOS_COM_SendBufferNonBlockingInternal(com_dev, buffer, len);
+
+    PIOS_COM_GiveSendBuffer(com_dev);
+
+    return rc;
+}
+
+/**
+ * Puts a package in the tx buffer, with the send buffer held by the caller
+ * \return -2 if the buffer is full, else the number of bytes transmitted
+ */
+static int32_t PIOS_COM_SendBufferNonBlockingInternal(struct pios_com_dev *com_dev, const uint8_t *buffer, uint16_t len)
+{
     if (com_dev->driver->available && !com_dev->driver->available(com_dev->lower_id)) {
         /*
          * Underlying device is down/unconnected.
@@ -338,6 +389,10 @@ int32_t PIOS_COM_SendBuffer(uint32_t com_id, const uint8_t *buffer, uint16_t len
 
     PIOS_Assert(com_dev->has_tx);
 
+    if (!PIOS_COM_TakeSendBuffer(com_dev, 5000)) {
+        return -3;
+    }
+
     uint32_t max_frag_len  = fifoBuf_getSize(&com_dev->tx);
     uint32_t bytes_to_send = len;
     while (bytes_to_send) {
@@ -348,16 +403,12 @@ int32_t PIOS_COM_SendBuffer(uint32_t com_id, const uint8_t *buffer, uint16_t len
         } else {
             frag_size = bytes_to_send;
         }
-        int32_t rc = PIOS_COM_SendBufferNonBlocking(com_id, buffer, frag_size);
+        int32_t rc = PIOS_COM_SendBufferNonBlockingInternal(com_dev, buffer, frag_size);
         if (rc >= 0) {
             bytes_to_send -= rc;
             buffer += rc;
         } else {
             switch (rc) {
-            case -1:
-                /* Device is invalid, this will never work */
-                return -1;
-
             case -2:
                 /* Device is busy, wait for the underlying device to free some space and retry */
                 /* Make sure the transmitter is running while we wait */
@@ -367,20 +418,121 @@ int32_t PIOS_COM_SendBuffer(uint32_t com_id, const uint8_t *buffer, uint16_t len
                 }
 #if defined(PIOS_INCLUDE_FREERTOS)
                 if (xSemaphoreTake(com_dev->tx_sem, 5000) != pdTRUE) {
+                    PIOS_COM_GiveSendBuffer(com_dev);
                     return -3;
                 }
 #endif
                 continue;
             default:
                 /* Unhandled return code */
+                PIOS_COM_GiveSendBuffer(com_dev);
                 return rc;
             }
         }
     }
 
+    PIOS_COM_GiveSendBuffer(com_dev);
+
     return len;
 }
 
+/**
+ * Reserves room for a package in the tx buffer of the given port, so the
+ * caller can build it in place rather than in a buffer of its own.  The
+ * port is held until PIOS_COM_SendBufferCommit, other producers get -2 from
+ * PIOS_COM_SendBufferNonBlocking or wait in PIOS_COM_SendBuffer meanwhile.
+ * \param[in] port COM port
+ * \param[in] len package length
+ * \return pointer to len contiguous bytes of the tx buffer
+ * \return NULL if the port is not available, busy or has no such room right
+ *         now, the caller should fall back to PIOS_COM_SendBuffer
+ */
+uint8_t *PIOS_COM_SendBufferReserve(uint32_t com_id, uint16_t len)
+{
+    struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+    if (!PIOS_COM_validate(com_dev) || !com_dev->has_tx) {
+        return NULL;
+    }
+
+    if (com_dev->driver->available && !com_dev->driver->available(com_dev->lower_id)) {
+        /* Let PIOS_COM_SendBuffer drop the package */
+        return NULL;
+    }
+
+    if (!PIOS_COM_TakeSendBuffer(com_dev, 0)) {
+        return NULL;
+    }
+
+    uint16_t room;
+    uint8_t *buf = fifoBuf_putBlockReserve(&com_dev->tx, &room);
+
+    if (len == 0 || len > room) {
+        PIOS_COM_GiveSendBuffer(com_dev);
+        return NULL;
+    }
+
+    return buf;
+}
+
+/**
+ * Sends a package built in the room from PIOS_COM_SendBufferReserve and
+ * releases the port
+ * \param[in] port COM port
+ * \param[in] len package length, at most the length reserved, 0 to abandon it
+ * \return -1 if port not available
+ * \return number of bytes transmitted on success
+ */
+int32_t PIOS_COM_SendBufferCommit(uint32_t com_id, uint16_t len)
+{
+    struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+    if (!PIOS_COM_validate(com_dev)) {
+        /* Undefined COM port for this board (see pios_board.c) */
+        return -1;
+    }
+
+    PIOS_Assert(com_dev->has_tx);
+
+    if (len > 0) {
+        fifoBuf_putBlockCommit(&com_dev->tx, len);
+
+        /* More data has been put in the tx buffer, make sure the tx is started */
+        if (com_dev->driver->tx_start) {
+            com_dev->driver->tx_start(com_dev->lower_id,
+                                      fifoBuf_getUsed(&com_dev->tx));
+        }
+    }
+
+    PIOS_COM_GiveSendBuffer(com_dev);
+
+    return len;
+}
+
+/**
+ * Take the send buffer of a port, the tx fifo has a single producer
+ * \param[in] ticks how long to wait for the current producer to finish
+ * \return true if the caller may put data in the tx buffer
+ */
+static bool PIOS_COM_TakeSendBuffer(__attribute__((unused)) struct pios_com_dev *com_dev, __attribute__((unused)) uint32_t ticks)
+{
+#if defined(PIOS_INCLUDE_FREERTOS)
+    return xSemaphoreTake(com_dev->sendbuffer_sem, ticks) == pdTRUE;
+#else
+    return true;
+#endif
+}
+
+/**
+ * Release the send buffer taken with PIOS_COM_TakeSendBuffer
+ */
+static void PIOS_COM_GiveSendBuffer(__attribute__((unused)) struct pios_com_dev *com_dev)
+{
+#if defined(PIOS_INCLUDE_FREERTOS)
+    xSemaphoreGive(com_dev->sendbuffer_sem);
+#endif
+}
+
 /**
  * Sends a single character over given port
  * \param[in] port COM port
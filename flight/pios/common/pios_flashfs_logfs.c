@@ -30,6 +30,7 @@
 #ifdef PIOS_INCLUDE_FLASH
 
 #include <stdbool.h>
+#include <string.h> /* memmove */
 #include <openpilot.h>
 #include <pios_math.h>
 #include <pios_wdg.h>
@@ -43,6 +44,26 @@ enum pios_flashfs_logfs_dev_magic {
     PIOS_FLASHFS_LOGFS_DEV_MAGIC = 0x94938201,
 };
 
+struct logfs_index_entry {
+    uint32_t obj_id;
+    uint16_t obj_inst_id;
+    uint16_t slot_id;
+};
+
+/*
+ * Max number of slots copied by one garbage collection step. Erasing the
+ * destination arena takes one step per sector.
+ */
+#ifndef PIOS_FLASHFS_LOGFS_GC_STEP_SLOTS
+#define PIOS_FLASHFS_LOGFS_GC_STEP_SLOTS 8
+#endif
+
+enum logfs_gc_state {
+    LOGFS_GC_IDLE,
+    LOGFS_GC_ERASE, /* erasing the destination arena */
+    LOGFS_GC_COPY, /* copying the active slots to the destination arena */
+};
+
 struct logfs_state {
     enum pios_flashfs_logfs_dev_magic magic;
     const struct flashfs_logfs_cfg    *cfg;
@@ -56,6 +77,29 @@ struct logfs_state {
     uint16_t num_free_slots; /* slots in free state */
     uint16_t num_active_slots; /* slots in active state */
 
+    /* Slot of each active object in the mounted arena, sorted by obj_id and obj_inst_id */
+    struct logfs_index_entry *index;
+    uint16_t index_size; /* cfg->index_size, 0 if there is no index */
+    uint16_t num_indexed;
+    bool     index_complete; /* false if some active objects are missing from the index */
+
+    /* Garbage collection in progress */
+    enum logfs_gc_state gc_state;
+    uint8_t  gc_dst_arena_id;
+    uint16_t gc_sector_id; /* next sector of the destination arena to erase */
+    uint16_t gc_src_slot_id; /* next slot of the active arena to copy */
+    uint16_t gc_dst_slot_id; /* next free slot in the destination arena */
+    uint16_t gc_steps;
+    uint32_t gc_busy_us;
+
+    /* Garbage collection statistics */
+    uint16_t num_gc_runs;
+    uint16_t gc_last_steps;
+    uint32_t gc_last_busy_us;
+    uint32_t gc_max_step_us;
+    uint32_t num_slots_written;
+    uint32_t num_slots_copied;
+
     /* Underlying flash driver glue */
     const struct pios_flash_driver *driver;
     uintptr_t flash_id;
@@ -111,24 +155,31 @@ struct arena_header {
 ****************************************/
 
 /**
- * @brief Erases all sectors within the given arena and sets arena to erased state.
+ * @brief Erases one sector within the given arena.
  * @return 0 if success, < 0 on failure
  * @note Must be called while holding the flash transaction lock
  */
-static int32_t logfs_erase_arena(const struct logfs_state *logfs, uint8_t arena_id)
+static int32_t logfs_erase_arena_sector(const struct logfs_state *logfs, uint8_t arena_id, uint16_t sector_id)
 {
     uintptr_t arena_addr = logfs_get_addr(logfs, arena_id, 0);
 
-    /* Erase all of the sectors in the arena */
-    for (uint8_t sector_id = 0;
-         sector_id < (logfs->cfg->arena_size / logfs->cfg->sector_size);
-         sector_id++) {
-        if (logfs->driver->erase_sector(logfs->flash_id,
-                                        arena_addr + (sector_id * logfs->cfg->sector_size))) {
-            return -1;
-        }
+    if (logfs->driver->erase_sector(logfs->flash_id,
+                                    arena_addr + (sector_id * logfs->cfg->sector_size))) {
+        return -1;
     }
 
+    return 0;
+}
+
+/**
+ * @brief Sets an arena with all of its sectors erased to erased state.
+ * @return 0 if success, < 0 on failure
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_mark_arena_erased(const struct logfs_state *logfs, uint8_t arena_id)
+{
+    uintptr_t arena_addr = logfs_get_addr(logfs, arena_id, 0);
+
     /* Mark this arena as fully erased */
     struct arena_header arena_hdr = {
         .magic = logfs->cfg->fs_magic,
@@ -139,6 +190,30 @@ static int32_t logfs_erase_arena(const struct logfs_state *logfs, uint8_t arena_
                                   arena_addr,
                                   (uint8_t *)&arena_hdr,
                                   sizeof(arena_hdr)) != 0) {
+        return -1;
+    }
+
+    /* Arena is ready to be activated */
+    return 0;
+}
+
+/**
+ * @brief Erases all sectors within the given arena and sets arena to erased state.
+ * @return 0 if success, < 0 on failure
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_erase_arena(const struct logfs_state *logfs, uint8_t arena_id)
+{
+    /* Erase all of the sectors in the arena */
+    for (uint8_t sector_id = 0;
+         sector_id < (logfs->cfg->arena_size / logfs->cfg->sector_size);
+         sector_id++) {
+        if (logfs_erase_arena_sector(logfs, arena_id, sector_id) != 0) {
+            return -1;
+        }
+    }
+
+    if (logfs_mark_arena_erased(logfs, arena_id) != 0) {
         return -2;
     }
 
@@ -416,12 +491,107 @@ static bool logfs_log_is_full(const struct logfs_state *logfs)
     return logfs->num_free_slots == 0;
 }
 
+/*
+ * RAM index of the active objects in the mounted arena.
+ *
+ * Every active slot is recorded when the arena is mounted and the index follows
+ * each append and delete, so lookups don't need to read slot headers from flash.
+ * When the index overflows, or the log holds more than one active copy of an
+ * object, it is flagged incomplete and lookups missing it fall back to a scan.
+ */
+
+/**
+ * @brief Binary search the index for an object
+ * @param[out] pos position of the object, or where it would be inserted
+ * @return true if the object is in the index
+ */
+static bool logfs_index_search(const struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, uint16_t *pos)
+{
+    uint16_t lo = 0;
+    uint16_t hi = logfs->num_indexed;
+
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        const struct logfs_index_entry *entry = &logfs->index[mid];
+        if (entry->obj_id < obj_id ||
+            (entry->obj_id == obj_id && entry->obj_inst_id < obj_inst_id)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    *pos = lo;
+    return lo < logfs->num_indexed &&
+           logfs->index[lo].obj_id == obj_id &&
+           logfs->index[lo].obj_inst_id == obj_inst_id;
+}
+
+static void logfs_index_reset(struct logfs_state *logfs)
+{
+    logfs->num_indexed    = 0;
+    logfs->index_complete = true;
+}
+
+static void logfs_index_insert(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, uint16_t slot_id)
+{
+    uint16_t pos;
+
+    if (logfs_index_search(logfs, obj_id, obj_inst_id, &pos)) {
+        /* Another active copy of this object exists, only a scan finds them all */
+        logfs->index[pos].slot_id = slot_id;
+        logfs->index_complete     = false;
+        return;
+    }
+
+    if (logfs->num_indexed >= logfs->index_size) {
+        /* No room left, this object will have to be found by scanning */
+        logfs->index_complete = false;
+        return;
+    }
+
+    memmove(&logfs->index[pos + 1], &logfs->index[pos], (logfs->num_indexed - pos) * sizeof(logfs->index[0]));
+    logfs->index[pos].obj_id      = obj_id;
+    logfs->index[pos].obj_inst_id = obj_inst_id;
+    logfs->index[pos].slot_id     = slot_id;
+    logfs->num_indexed++;
+}
+
+static void logfs_index_remove(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
+{
+    uint16_t pos;
+
+    if (!logfs_index_search(logfs, obj_id, obj_inst_id, &pos)) {
+        return;
+    }
+
+    logfs->num_indexed--;
+    memmove(&logfs->index[pos], &logfs->index[pos + 1], (logfs->num_indexed - pos) * sizeof(logfs->index[0]));
+}
+
+/*
+ * Number of slots in the log that garbage collection would free
+ */
+static uint16_t logfs_num_obsolete_slots(const struct logfs_state *logfs)
+{
+    return (logfs->cfg->arena_size / logfs->cfg->slot_size) - 1 - logfs->num_free_slots - logfs->num_active_slots;
+}
+
+/*
+ * Number of free slots kept in reserve for the writes made while garbage collection runs
+ */
+static uint16_t logfs_gc_reserve(const struct logfs_state *logfs)
+{
+    return MAX((logfs->cfg->arena_size / logfs->cfg->slot_size) / 8, 2);
+}
+
 static int32_t logfs_unmount_log(struct logfs_state *logfs)
 {
     PIOS_Assert(logfs->mounted);
 
     logfs->num_active_slots = 0;
     logfs->num_free_slots   = 0;
+    logfs_index_reset(logfs);
     logfs->mounted = false;
 
     return 0;
@@ -434,6 +604,7 @@ static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
     logfs->num_active_slots = 0;
     logfs->num_free_slots   = 0;
     logfs->active_arena_id  = arena_id;
+    logfs_index_reset(logfs);
 
     /* Scan the log to find out how full it is */
     for (uint16_t slot_id = 1;
@@ -461,6 +632,7 @@ static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
             break;
         case SLOT_STATE_ACTIVE:
             logfs->num_active_slots++;
+            logfs_index_insert(logfs, slot_hdr.obj_id, slot_hdr.obj_inst_id, slot_id);
             break;
         case SLOT_STATE_RESERVED:
         case SLOT_STATE_OBSOLETE:
@@ -481,16 +653,19 @@ static bool PIOS_FLASHFS_Logfs_validate(const struct logfs_state *logfs)
 }
 
 #if defined(PIOS_INCLUDE_FREERTOS)
-static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(void)
+static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(const struct flashfs_logfs_cfg *cfg)
 {
     struct logfs_state *logfs;
 
-    logfs = (struct logfs_state *)pvPortMalloc(sizeof(*logfs));
+    /* The index goes right behind the state */
+    logfs = (struct logfs_state *)pvPortMalloc(sizeof(*logfs) + cfg->index_size * sizeof(struct logfs_index_entry));
     if (!logfs) {
         return NULL;
     }
 
-    logfs->magic = PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+    logfs->magic      = PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+    logfs->index      = (struct logfs_index_entry *)(logfs + 1);
+    logfs->index_size = cfg->index_size;
     return logfs;
 }
 static void PIOS_FLASHFS_Logfs_free(struct logfs_state *logfs)
@@ -502,7 +677,7 @@ static void PIOS_FLASHFS_Logfs_free(struct logfs_state *logfs)
 #else
 static struct logfs_state pios_flashfs_logfs_devs[PIOS_FLASHFS_LOGFS_MAX_DEVS];
 static uint8_t pios_flashfs_logfs_num_devs;
-static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(void)
+static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(__attribute__((unused)) const struct flashfs_logfs_cfg *cfg)
 {
     struct logfs_state *logfs;
 
@@ -513,6 +688,10 @@ static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(void)
     logfs = &pios_flashfs_logfs_devs[pios_flashfs_logfs_num_devs++];
     logfs->magic = PIOS_FLASHFS_LOGFS_DEV_MAGIC;
 
+    /* No room for an index with this simple allocator, objects are found by scanning the log */
+    logfs->index      = NULL;
+    logfs->index_size = 0;
+
     return logfs;
 }
 static void PIOS_FLASHFS_Logfs_free(struct logfs_state *logfs)
@@ -548,7 +727,7 @@ int32_t PIOS_FLASHFS_Logfs_Init(uintptr_t *fs_id, const struct flashfs_logfs_cfg
 
     struct logfs_state *logfs;
 
-    logfs = (struct logfs_state *)PIOS_FLASHFS_Logfs_alloc();
+    logfs = (struct logfs_state *)PIOS_FLASHFS_Logfs_alloc(cfg);
     if (!logfs) {
         rc = -1;
         goto out_exit;
@@ -560,6 +739,14 @@ int32_t PIOS_FLASHFS_Logfs_Init(uintptr_t *fs_id, const struct flashfs_logfs_cfg
     logfs->flash_id = flash_id; /* lower-level flash device id */
     logfs->mounted  = false;
 
+    logfs->gc_state          = LOGFS_GC_IDLE;
+    logfs->num_gc_runs       = 0;
+    logfs->gc_last_steps     = 0;
+    logfs->gc_last_busy_us   = 0;
+    logfs->gc_max_step_us    = 0;
+    logfs->num_slots_written = 0;
+    logfs->num_slots_copied  = 0;
+
     if (logfs->driver->start_transaction(logfs->flash_id) != 0) {
         rc = -1;
         goto out_exit;
@@ -628,60 +815,44 @@ out_exit:
     return rc;
 }
 
+/*
+ * Garbage collection copies the active slots of the active arena to the next
+ * arena and then makes that one active. It runs in bounded steps, each erasing
+ * one sector or copying up to PIOS_FLASHFS_LOGFS_GC_STEP_SLOTS slots, so that
+ * it can be spread out over PIOS_FLASHFS_Idle() calls. Meanwhile the log keeps
+ * taking writes into its reserve of free slots, the copy simply runs on to the
+ * end of the log. Deleted objects that were already copied are obsoleted in the
+ * destination arena too.
+ */
+
 /* NOTE: Must be called while holding the flash transaction lock */
-static int32_t logfs_garbage_collect(struct logfs_state *logfs)
+static void logfs_gc_start(struct logfs_state *logfs)
 {
     PIOS_Assert(logfs->mounted);
 
-    /* Source arena is the active arena */
-    uint8_t src_arena_id = logfs->active_arena_id;
-
-    /* Compute destination arena */
-    uint8_t dst_arena_id = (logfs->active_arena_id + 1) % (logfs->cfg->total_fs_size / logfs->cfg->arena_size);
-
-    /* Erase destination arena */
-    if (logfs_erase_arena(logfs, dst_arena_id) != 0) {
-        return -1;
+    if (logfs->gc_state != LOGFS_GC_IDLE) {
+        /* Already running */
+        return;
     }
 
-    /* Reserve the destination arena so we can start filling it */
-    if (logfs_reserve_arena(logfs, dst_arena_id) != 0) {
-        /* Unable to reserve the arena */
-        return -2;
-    }
+    logfs->gc_state        = LOGFS_GC_ERASE;
+    logfs->gc_dst_arena_id = (logfs->active_arena_id + 1) % (logfs->cfg->total_fs_size / logfs->cfg->arena_size);
+    logfs->gc_sector_id    = 0;
+    logfs->gc_src_slot_id  = 1;
+    logfs->gc_dst_slot_id  = 1;
+    logfs->gc_steps        = 0;
+    logfs->gc_busy_us      = 0;
+}
 
-    /* Copy active slots from active arena to destination arena */
-    uint16_t dst_slot_id = 1;
-    for (uint16_t src_slot_id = 1;
-         src_slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size);
-         src_slot_id++) {
-        struct slot_header slot_hdr;
-        uintptr_t src_addr = logfs_get_addr(logfs, src_arena_id, src_slot_id);
-        if (logfs->driver->read_data(logfs->flash_id,
-                                     src_addr,
-                                     (uint8_t *)&slot_hdr,
-                                     sizeof(slot_hdr)) != 0) {
-            return -3;
-        }
+/* NOTE: Must be called while holding the flash transaction lock */
+static int32_t logfs_gc_finish(struct logfs_state *logfs)
+{
+    uint8_t src_arena_id = logfs->active_arena_id;
 
-        if (slot_hdr.state == SLOT_STATE_ACTIVE) {
-            uintptr_t dst_addr = logfs_get_addr(logfs, dst_arena_id, dst_slot_id);
-            if (logfs_raw_copy_bytes(logfs,
-                                     src_addr,
-                                     sizeof(slot_hdr) + slot_hdr.obj_size,
-                                     dst_addr) != 0) {
-                /* Failed to copy all bytes */
-                return -4;
-            }
-            dst_slot_id++;
-        }
-#ifdef PIOS_INCLUDE_WDG
-        PIOS_WDG_Clear();
-#endif
-    }
+    logfs->gc_state = LOGFS_GC_IDLE;
 
     /* Activate the destination arena */
-    if (logfs_activate_arena(logfs, dst_arena_id) != 0) {
+    if (logfs_activate_arena(logfs, logfs->gc_dst_arena_id) != 0) {
         return -5;
     }
 
@@ -696,13 +867,180 @@ static int32_t logfs_garbage_collect(struct logfs_state *logfs)
     }
 
     /* Mount the new arena */
-    if (logfs_mount_log(logfs, dst_arena_id) != 0) {
+    if (logfs_mount_log(logfs, logfs->gc_dst_arena_id) != 0) {
         return -8;
     }
 
     return 0;
 }
 
+/**
+ * @brief Runs one step of the garbage collection in progress
+ * @return 0 if success, < 0 on failure
+ * @note A failed garbage collection is abandoned, the next one starts over
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_gc_step(struct logfs_state *logfs)
+{
+    int32_t rc = 0;
+    bool done  = false;
+
+#ifdef PIOS_INCLUDE_DELAY
+    uint32_t start = PIOS_DELAY_GetRaw();
+#endif
+
+    switch (logfs->gc_state) {
+    case LOGFS_GC_IDLE:
+        return 0;
+
+    case LOGFS_GC_ERASE:
+        if (logfs_erase_arena_sector(logfs, logfs->gc_dst_arena_id, logfs->gc_sector_id) != 0) {
+            rc = -1;
+            break;
+        }
+        if (++logfs->gc_sector_id < (logfs->cfg->arena_size / logfs->cfg->sector_size)) {
+            break;
+        }
+        if (logfs_mark_arena_erased(logfs, logfs->gc_dst_arena_id) != 0) {
+            rc = -1;
+            break;
+        }
+        /* Reserve the destination arena so we can start filling it */
+        if (logfs_reserve_arena(logfs, logfs->gc_dst_arena_id) != 0) {
+            /* Unable to reserve the arena */
+            rc = -2;
+            break;
+        }
+        logfs->gc_state = LOGFS_GC_COPY;
+        break;
+
+    case LOGFS_GC_COPY:
+    {
+        /* Copy active slots from active arena to destination arena, up to the end of the log */
+        uint16_t end_slot_id = (logfs->cfg->arena_size / logfs->cfg->slot_size) - logfs->num_free_slots;
+        for (uint16_t n = 0;
+             n < PIOS_FLASHFS_LOGFS_GC_STEP_SLOTS && logfs->gc_src_slot_id < end_slot_id;
+             n++, logfs->gc_src_slot_id++) {
+            struct slot_header slot_hdr;
+            uintptr_t src_addr = logfs_get_addr(logfs, logfs->active_arena_id, logfs->gc_src_slot_id);
+            if (logfs->driver->read_data(logfs->flash_id,
+                                         src_addr,
+                                         (uint8_t *)&slot_hdr,
+                                         sizeof(slot_hdr)) != 0) {
+                rc = -3;
+                break;
+            }
+
+            if (slot_hdr.state == SLOT_STATE_ACTIVE) {
+                uintptr_t dst_addr = logfs_get_addr(logfs, logfs->gc_dst_arena_id, logfs->gc_dst_slot_id);
+                if (logfs_raw_copy_bytes(logfs,
+                                         src_addr,
+                                         sizeof(slot_hdr) + slot_hdr.obj_size,
+                                         dst_addr) != 0) {
+                    /* Failed to copy all bytes */
+                    rc = -4;
+                    break;
+                }
+                logfs->gc_dst_slot_id++;
+                logfs->num_slots_copied++;
+            }
+#ifdef PIOS_INCLUDE_WDG
+            PIOS_WDG_Clear();
+#endif
+        }
+        done = (rc == 0 && logfs->gc_src_slot_id >= end_slot_id);
+        break;
+    }
+    }
+
+    if (done) {
+        rc = logfs_gc_finish(logfs);
+    }
+
+#ifdef PIOS_INCLUDE_DELAY
+    uint32_t step_us = PIOS_DELAY_DiffuS(start);
+    logfs->gc_busy_us += step_us;
+    if (step_us > logfs->gc_max_step_us) {
+        logfs->gc_max_step_us = step_us;
+    }
+#endif
+    logfs->gc_steps++;
+
+    if (rc != 0) {
+        logfs->gc_state = LOGFS_GC_IDLE;
+    } else if (done) {
+        logfs->num_gc_runs++;
+        logfs->gc_last_steps   = logfs->gc_steps;
+        logfs->gc_last_busy_us = logfs->gc_busy_us;
+    }
+
+    return rc;
+}
+
+/**
+ * @brief Starts garbage collection if needed and runs it to completion
+ * @return 0 if success, < 0 on failure
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_gc_run(struct logfs_state *logfs)
+{
+    logfs_gc_start(logfs);
+    while (logfs->gc_state != LOGFS_GC_IDLE) {
+        if (logfs_gc_step(logfs) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Start garbage collection in the background once the log is down to its reserve
+ * of free slots, provided that it frees at least as many slots.
+ */
+static void logfs_gc_poll(struct logfs_state *logfs)
+{
+    uint16_t reserve = logfs_gc_reserve(logfs);
+
+    if (logfs->gc_state == LOGFS_GC_IDLE &&
+        logfs->num_free_slots <= reserve &&
+        logfs_num_obsolete_slots(logfs) >= reserve) {
+        logfs_gc_start(logfs);
+    }
+}
+
+/**
+ * @brief Obsoletes the copies of an object garbage collection already made
+ * @return 0 if success, < 0 on failure
+ * @note Must be called while holding the flash transaction lock
+ */
+static int8_t logfs_gc_delete_copied(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
+{
+    for (uint16_t slot_id = 1; slot_id < logfs->gc_dst_slot_id; slot_id++) {
+        struct slot_header slot_hdr;
+        uintptr_t slot_addr = logfs_get_addr(logfs, logfs->gc_dst_arena_id, slot_id);
+        if (logfs->driver->read_data(logfs->flash_id,
+                                     slot_addr,
+                                     (uint8_t *)&slot_hdr,
+                                     sizeof(slot_hdr)) != 0) {
+            return -1;
+        }
+        if (slot_hdr.state == SLOT_STATE_ACTIVE &&
+            slot_hdr.obj_id == obj_id &&
+            slot_hdr.obj_inst_id == obj_inst_id) {
+            slot_hdr.state = SLOT_STATE_OBSOLETE;
+            if (logfs->driver->write_data(logfs->flash_id,
+                                          slot_addr,
+                                          (uint8_t *)&slot_hdr,
+                                          sizeof(slot_hdr)) != 0) {
+                return -2;
+            }
+        }
+    }
+
+    return 0;
+}
+
 /* NOTE: Must be called while holding the flash transaction lock */
 static int16_t logfs_object_find_next(const struct logfs_state *logfs, struct slot_header *slot_hdr, uint16_t *curr_slot, uint32_t obj_id, uint16_t obj_inst_id)
 {
@@ -745,16 +1083,83 @@ static int16_t logfs_object_find_next(const struct logfs_state *logfs, struct sl
     return -1;
 }
 
+/**
+ * @brief Find the active slot holding an object, using the index when possible
+ * @return 0 if found, -1 if the object is not in the log, -2 on flash read error
+ * @note Must be called while holding the flash transaction lock
+ */
+static int16_t logfs_object_find(const struct logfs_state *logfs, struct slot_header *slot_hdr, uint16_t *slot_id, uint32_t obj_id, uint16_t obj_inst_id)
+{
+    uint16_t pos;
+
+    if (logfs_index_search(logfs, obj_id, obj_inst_id, &pos)) {
+        uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, logfs->index[pos].slot_id);
+        if (logfs->driver->read_data(logfs->flash_id,
+                                     slot_addr,
+                                     (uint8_t *)slot_hdr,
+                                     sizeof(*slot_hdr)) != 0) {
+            return -2;
+        }
+        if (slot_hdr->state == SLOT_STATE_ACTIVE &&
+            slot_hdr->obj_id == obj_id &&
+            slot_hdr->obj_inst_id == obj_inst_id) {
+            *slot_id = logfs->index[pos].slot_id;
+            return 0;
+        }
+        /* Index is out of sync with the log, something is broken */
+        PIOS_DEBUG_Assert(0);
+    } else if (logfs->index_complete) {
+        /* Every active object is indexed, no need to look any further */
+        return -1;
+    }
+
+    *slot_id = 0;
+    return logfs_object_find_next(logfs, slot_hdr, slot_id, obj_id, obj_inst_id);
+}
+
 /* NOTE: Must be called while holding the flash transaction lock */
-/* OPTIMIZE: could trust that there is at most one active version of every object and terminate the search when we find one */
 static int8_t logfs_delete_object(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
 {
     int8_t rc;
 
-    bool more = true;
+    /* A complete index holds the only active copy, otherwise scan the log for all of them */
+    bool more = !logfs->index_complete;
+    bool copied = false; /* garbage collection already copied a deleted slot */
     uint16_t curr_slot_id = 0;
+    uint16_t pos;
+
+    if (logfs->index_complete && logfs_index_search(logfs, obj_id, obj_inst_id, &pos)) {
+        struct slot_header slot_hdr;
+        curr_slot_id = logfs->index[pos].slot_id;
+        uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, curr_slot_id);
 
-    do {
+        if (logfs->driver->read_data(logfs->flash_id,
+                                     slot_addr,
+                                     (uint8_t *)&slot_hdr,
+                                     sizeof(slot_hdr)) != 0) {
+            rc = -1;
+            goto out_exit;
+        }
+        if (slot_hdr.state != SLOT_STATE_ACTIVE) {
+            /* Index is out of sync with the log, something is broken */
+            PIOS_DEBUG_Assert(0);
+            rc = -1;
+            goto out_exit;
+        }
+        slot_hdr.state = SLOT_STATE_OBSOLETE;
+        if (logfs->driver->write_data(logfs->flash_id,
+                                      slot_addr,
+                                      (uint8_t *)&slot_hdr,
+                                      sizeof(slot_hdr)) != 0) {
+            rc = -2;
+            goto out_exit;
+        }
+        logfs->num_active_slots--;
+        copied = (logfs->gc_state == LOGFS_GC_COPY && curr_slot_id < logfs->gc_src_slot_id);
+    }
+    rc = 0;
+
+    while (more) {
         struct slot_header slot_hdr;
         switch (logfs_object_find_next(logfs, &slot_hdr, &curr_slot_id, obj_id, obj_inst_id)) {
         case 0:
@@ -771,6 +1176,7 @@ static int8_t logfs_delete_object(struct logfs_state *logfs, uint32_t obj_id, ui
             }
             /* Object has been successfully obsoleted and is no longer active */
             logfs->num_active_slots--;
+            copied |= (logfs->gc_state == LOGFS_GC_COPY && curr_slot_id < logfs->gc_src_slot_id);
             break;
         case -1:
             /* Search completed, object not found */
@@ -782,7 +1188,13 @@ static int8_t logfs_delete_object(struct logfs_state *logfs, uint32_t obj_id, ui
             rc = -1;
             goto out_exit;
         }
-    } while (more);
+    }
+
+    logfs_index_remove(logfs, obj_id, obj_inst_id);
+
+    if (copied && logfs_gc_delete_copied(logfs, obj_id, obj_inst_id) != 0) {
+        rc = -2;
+    }
 
 out_exit:
     return rc;
@@ -891,6 +1303,8 @@ static int8_t logfs_append_to_log(struct logfs_state *logfs, uint32_t obj_id, ui
 
     /* Object has been successfully written to the slot */
     logfs->num_active_slots++;
+    logfs->num_slots_written++;
+    logfs_index_insert(logfs, obj_id, obj_inst_id, free_slot_id);
     return 0;
 }
 
@@ -902,6 +1316,74 @@ static int8_t logfs_append_to_log(struct logfs_state *logfs, uint32_t obj_id, ui
  *********************************/
 #include "pios_flashfs.h" /* API for flash filesystem */
 
+/**
+ * @brief Replaces any previous version of an object in the log with a new one
+ * @return 0 if success or error code, see PIOS_FLASHFS_ObjSave
+ * @note Must be called while holding the flash transaction lock
+ */
+static int8_t logfs_save_object(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size)
+{
+    PIOS_Assert(obj_size <= (logfs->cfg->slot_size - sizeof(struct slot_header)));
+
+    if (logfs_delete_object(logfs, obj_id, obj_inst_id) != 0) {
+        return -3;
+    }
+
+    /*
+     * All old versions of this object + instance have been invalidated.
+     * Write the new object.
+     */
+
+    /* Check if the arena is entirely full. */
+    if (logfs_fs_is_full(logfs)) {
+        /* Note: Filesystem Full means we're full of *active* records so gc won't help at all. */
+        return -4;
+    }
+
+    /* Is garbage collection required? */
+    if (logfs_log_is_full(logfs)) {
+        /*
+         * Note: Log Full means the log is full but may contain obsolete slots so gc may free some space.
+         * Finish any background gc right away. Slots obsoleted while it was copying are only
+         * reclaimed by the next gc, so run another one if the first did not help.
+         */
+        for (uint8_t attempt = 0; attempt < 2 && logfs_log_is_full(logfs); attempt++) {
+            if (logfs_gc_run(logfs) != 0) {
+                return -5;
+            }
+        }
+        /* Check one more time just to be sure we actually free'd some space */
+        if (logfs_log_is_full(logfs)) {
+            /*
+             * Log is still full even after gc!
+             * NOTE: This should not happen since the filesystem wasn't full
+             *       when we checked above so gc should have helped.
+             */
+            PIOS_DEBUG_Assert(0);
+            return -6;
+        }
+    }
+
+    /* We have room for our new object.  Append it to the log. */
+    if (logfs_append_to_log(logfs, obj_id, obj_inst_id, obj_data, obj_size) != 0) {
+        /* Error during append */
+        return -7;
+    }
+
+    /*
+     * Start gc in the background when running low on free slots, and help it
+     * along if the background is not keeping up with the writes.
+     * A failed gc step doesn't affect this save, gc starts over later.
+     */
+    logfs_gc_poll(logfs);
+    if (logfs->num_free_slots <= logfs_gc_reserve(logfs) / 2) {
+        logfs_gc_step(logfs);
+    }
+
+    /* Object successfully written to the log */
+    return 0;
+}
+
 /**
  * @brief Saves one object instance to the filesystem
  * @param[in] fs_id The filesystem to use for this action
@@ -929,61 +1411,58 @@ int32_t PIOS_FLASHFS_ObjSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst
         goto out_exit;
     }
 
-    PIOS_Assert(obj_size <= (logfs->cfg->slot_size - sizeof(struct slot_header)));
-
     if (logfs->driver->start_transaction(logfs->flash_id) != 0) {
         rc = -2;
         goto out_exit;
     }
 
-    if (logfs_delete_object(logfs, obj_id, obj_inst_id) != 0) {
-        rc = -3;
-        goto out_end_trans;
-    }
+    rc = logfs_save_object(logfs, obj_id, obj_inst_id, obj_data, obj_size);
 
-    /*
-     * All old versions of this object + instance have been invalidated.
-     * Write the new object.
-     */
+    logfs->driver->end_transaction(logfs->flash_id);
 
-    /* Check if the arena is entirely full. */
-    if (logfs_fs_is_full(logfs)) {
-        /* Note: Filesystem Full means we're full of *active* records so gc won't help at all. */
-        rc = -4;
-        goto out_end_trans;
-    }
+out_exit:
+    return rc;
+}
 
-    /* Is garbage collection required? */
-    if (logfs_log_is_full(logfs)) {
-        /* Note: Log Full means the log is full but may contain obsolete slots so gc may free some space */
-        if (logfs_garbage_collect(logfs) != 0) {
-            rc = -5;
-            goto out_end_trans;
-        }
-        /* Check one more time just to be sure we actually free'd some space */
-        if (logfs_log_is_full(logfs)) {
-            /*
-             * Log is still full even after gc!
-             * NOTE: This should not happen since the filesystem wasn't full
-             *       when we checked above so gc should have helped.
-             */
-            PIOS_DEBUG_Assert(0);
-            rc = -6;
-            goto out_end_trans;
-        }
+/**
+ * @brief Saves a batch of object instances to the filesystem in one transaction
+ * @param[in] fs_id The filesystem to use for this action
+ * @param[in] next Supplies the objects to save, called until it returns false
+ * @param[in] context Passed on to next
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 to -7 as for PIOS_FLASHFS_ObjSave, for the object that failed to save
+ * @note Saving stops at the first failure, the objects supplied before it have been saved
+ */
+int32_t PIOS_FLASHFS_ObjSaveBatch(uintptr_t fs_id, PIOS_FLASHFS_ObjIterator next, void *context)
+{
+    int8_t rc;
+
+    struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+    PIOS_Assert(next);
+
+    if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+        rc = -1;
+        goto out_exit;
     }
 
-    /* We have room for our new object.  Append it to the log. */
-    if (logfs_append_to_log(logfs, obj_id, obj_inst_id, obj_data, obj_size) != 0) {
-        /* Error during append */
-        rc = -7;
-        goto out_end_trans;
+    if (logfs->driver->start_transaction(logfs->flash_id) != 0) {
+        rc = -2;
+        goto out_exit;
     }
 
-    /* Object successfully written to the log */
     rc = 0;
 
-out_end_trans:
+    uint32_t obj_id;
+    uint16_t obj_inst_id;
+    uint8_t *obj_data;
+    uint16_t obj_size;
+    while (rc == 0 && next(context, &obj_id, &obj_inst_id, &obj_data, &obj_size)) {
+        rc = logfs_save_object(logfs, obj_id, obj_inst_id, obj_data, obj_size);
+    }
+
     logfs->driver->end_transaction(logfs->flash_id);
 
 out_exit:
@@ -1025,7 +1504,7 @@ int32_t PIOS_FLASHFS_ObjLoad(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst
     /* Find the object in the log */
     uint16_t slot_id = 0;
     struct slot_header slot_hdr;
-    if (logfs_object_find_next(logfs, &slot_hdr, &slot_id, obj_id, obj_inst_id) != 0) {
+    if (logfs_object_find(logfs, &slot_hdr, &slot_id, obj_id, obj_inst_id) != 0) {
         /* Object does not exist in fs */
         rc = -3;
         goto out_end_trans;
@@ -1132,6 +1611,9 @@ int32_t PIOS_FLASHFS_Format(uintptr_t fs_id)
         goto out_exit;
     }
 
+    /* Any garbage collection in progress is moot */
+    logfs->gc_state = LOGFS_GC_IDLE;
+
     if (logfs_erase_all_arenas(logfs) != 0) {
         rc = -3;
         goto out_end_trans;
@@ -1172,10 +1654,61 @@ int32_t PIOS_FLASHFS_GetStats(uintptr_t fs_id, struct PIOS_FLASHFS_Stats *stats)
     if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
         return -1;
     }
-    stats->num_active_slots = logfs->num_active_slots;
-    stats->num_free_slots   = logfs->num_free_slots;
+    stats->num_active_slots  = logfs->num_active_slots;
+    stats->num_free_slots    = logfs->num_free_slots;
+    stats->num_gc_runs       = logfs->num_gc_runs;
+    stats->gc_last_steps     = logfs->gc_last_steps;
+    stats->gc_last_busy_us   = logfs->gc_last_busy_us;
+    stats->gc_max_step_us    = logfs->gc_max_step_us;
+    stats->num_slots_written = logfs->num_slots_written;
+    stats->num_slots_copied  = logfs->num_slots_copied;
     return 0;
 }
+
+/**
+ * @brief Runs one step of a pending garbage collection
+ * @param[in] fs_id The filesystem to use for this action
+ * @return 0 if no garbage collection is pending, 1 if more steps are needed, or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 if the garbage collection step failed
+ * @note Call periodically from a low priority task so saves rarely have to wait for gc
+ */
+int32_t PIOS_FLASHFS_Idle(uintptr_t fs_id)
+{
+    int32_t rc;
+
+    struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+    if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+        rc = -1;
+        goto out_exit;
+    }
+
+    if (logfs->gc_state == LOGFS_GC_IDLE) {
+        /* Nothing to do, don't bother the flash */
+        rc = 0;
+        goto out_exit;
+    }
+
+    if (logfs->driver->start_transaction(logfs->flash_id) != 0) {
+        rc = -2;
+        goto out_exit;
+    }
+
+    if (logfs_gc_step(logfs) != 0) {
+        rc = -3;
+        goto out_end_trans;
+    }
+
+    rc = (logfs->gc_state != LOGFS_GC_IDLE) ? 1 : 0;
+
+out_end_trans:
+    logfs->driver->end_transaction(logfs->flash_id);
+
+out_exit:
+    return rc;
+}
 #endif /* PIOS_INCLUDE_FLASH */
 
 /**
@@ -57,7 +57,6 @@
 
 #ifdef PIOS_INCLUDE_RFM22B
 
-#include <pios_spi_priv.h>
 #include <pios_rfm22b_priv.h>
 #include <pios_ppm_out.h>
 #include <ecc.h>
@@ -497,6 +496,34 @@ uint32_t PIOS_RFM22B_DeviceID(uint32_t rfm22b_id)
     return 0;
 }
 
+/**
+ * The number of data bytes per second this modem can send at the configured datarate.
+ * The modems take turns to send, so this is what one packet per send interval carries.
+ *
+ * @param[in] rfm22b_id The RFM22B device index.
+ * @return The bytes per second, 0 if this modem does not send data.
+ */
+uint32_t PIOS_RFM22B_TxCapacity(uint32_t rfm22b_id)
+{
+    struct pios_rfm22b_dev *rfm22b_dev = (struct pios_rfm22b_dev *)rfm22b_id;
+
+    if (!PIOS_RFM22B_Validate(rfm22b_dev) || rfm22b_dev->ppm_only_mode) {
+        return 0;
+    }
+
+    // Only the coordinator sends on a one-way link, every packet period.
+    uint32_t send_interval = rfm22b_dev->packet_time;
+    if (rfm22b_dev->one_way_link) {
+        if (!rfm22_isCoordinator(rfm22b_dev)) {
+            return 0;
+        }
+    } else {
+        send_interval *= 2;
+    }
+
+    return (uint32_t)(rfm22b_dev->max_packet_len - RS_ECC_NPARITY) * 1000 / send_interval;
+}
+
 /**
  * Are we connected to the remote modem?
  *
@@ -36,6 +36,13 @@
 
 typedef uint16_t (*pios_com_callback)(uint32_t context, uint8_t *buf, uint16_t buf_len, uint16_t *headroom, bool *task_woken);
 
+/*
+ * Lends the driver the transmit buffer in place: drops the consumed bytes of
+ * the span handed out before and returns the next contiguous span of data,
+ * with its length in span_len.  With span_len NULL only the bytes are dropped.
+ */
+typedef const uint8_t *(*pios_com_span_callback)(uint32_t context, uint16_t consumed, uint16_t *span_len, bool *task_woken);
+
 struct pios_com_driver {
     void (*init)(uint32_t id);
     void (*set_baud)(uint32_t id, uint32_t baud);
@@ -44,6 +51,7 @@ struct pios_com_driver {
     void (*bind_rx_cb)(uint32_t id, pios_com_callback rx_in_cb, uint32_t context);
     void (*bind_tx_cb)(uint32_t id, pios_com_callback tx_out_cb, uint32_t context);
     bool (*available)(uint32_t id);
+    void (*bind_tx_span_cb)(uint32_t id, pios_com_span_callback tx_span_cb, uint32_t context);
 };
 
 /* Public Functions */
@@ -52,6 +60,8 @@ extern int32_t PIOS_COM_SendCharNonBlocking(uint32_t com_id, char c);
 extern int32_t PIOS_COM_SendChar(uint32_t com_id, char c);
 extern int32_t PIOS_COM_SendBufferNonBlocking(uint32_t com_id, const uint8_t *buffer, uint16_t len);
 extern int32_t PIOS_COM_SendBuffer(uint32_t com_id, const uint8_t *buffer, uint16_t len);
+extern uint8_t *PIOS_COM_SendBufferReserve(uint32_t com_id, uint16_t len);
+extern int32_t PIOS_COM_SendBufferCommit(uint32_t com_id, uint16_t len);
 extern int32_t PIOS_COM_SendStringNonBlocking(uint32_t com_id, const char *str);
 extern int32_t PIOS_COM_SendString(uint32_t com_id, const char *str);
 extern int32_t PIOS_COM_SendFormattedStringNonBlocking(uint32_t com_id, const char *format, ...);
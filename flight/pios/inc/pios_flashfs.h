@@ -28,15 +28,27 @@
 #define PIOS_FLASHFS_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 struct PIOS_FLASHFS_Stats {
     uint16_t num_free_slots; /* slots in free state */
     uint16_t num_active_slots; /* slots in active state */
+    uint16_t num_gc_runs; /* garbage collections completed */
+    uint16_t gc_last_steps; /* steps the last garbage collection took */
+    uint32_t gc_last_busy_us; /* time spent in the steps of the last garbage collection */
+    uint32_t gc_max_step_us; /* longest garbage collection step */
+    uint32_t num_slots_written; /* slots written by saves */
+    uint32_t num_slots_copied; /* slots rewritten by garbage collection, write amplification is (written + copied) / written */
 };
 
+/* Supplies the next object of a batch save, returns false once there are no more */
+typedef bool (*PIOS_FLASHFS_ObjIterator)(void *context, uint32_t *obj_id, uint16_t *obj_inst_id, uint8_t **obj_data, uint16_t *obj_size);
+
 int32_t PIOS_FLASHFS_Format(uintptr_t fs_id);
 int32_t PIOS_FLASHFS_ObjSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size);
+int32_t PIOS_FLASHFS_ObjSaveBatch(uintptr_t fs_id, PIOS_FLASHFS_ObjIterator next, void *context);
 int32_t PIOS_FLASHFS_ObjLoad(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size);
 int32_t PIOS_FLASHFS_ObjDelete(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id);
 int32_t PIOS_FLASHFS_GetStats(uintptr_t fs_id, struct PIOS_FLASHFS_Stats *stats);
+int32_t PIOS_FLASHFS_Idle(uintptr_t fs_id);
 #endif /* PIOS_FLASHFS_H */
@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup   PIOS_RFM22B Radio Functions
+ * @brief Simulated RFM22B radio for the posix target
+ * @{
+ *
+ * @file       pios_rfm22b_sim.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      Software model of the RFM22B SPI register and FIFO interface.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PIOS_RFM22B_SIM_H
+#define PIOS_RFM22B_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pios_spi.h>
+
+/*
+ * The model stands in for the SPI bus and the external interrupt line of
+ * the radio, so the unmodified pios_rfm22b driver runs on top of it.  Each
+ * simulated radio owns a UDP socket on localhost and sends every packet it
+ * transmits to its peer, which plays it back into its receiver with the
+ * timing of the air datarate programmed into the registers.
+ */
+
+/* The posix EXTI only needs the interrupt handler of the radio */
+struct pios_exti_cfg {
+    bool (*vector)(void);
+};
+
+extern int32_t PIOS_EXTI_Init(const struct pios_exti_cfg *cfg);
+
+struct pios_rfm22b_sim_cfg {
+    uint16_t port; /* UDP port on localhost this radio receives on */
+    uint16_t peer_port; /* UDP port of the radio at the other end of the link */
+    uint8_t  loss; /* percentage of packets lost, applied to both directions */
+    uint32_t latency_us; /* propagation delay added to every packet */
+    uint32_t seed; /* seed of the packet loss generator */
+};
+
+struct pios_rfm22b_sim_stats {
+    uint32_t tx_packets; /* packets put on the air */
+    uint32_t rx_packets; /* packets received completely */
+    uint32_t lost; /* packets dropped by the loss model */
+    uint32_t missed; /* packets sent while not listening on the same channel and datarate */
+    uint32_t rejected; /* packets dropped by the header check */
+    uint32_t aborted; /* receptions cut short by the driver */
+};
+
+extern int32_t PIOS_RFM22B_SIM_Init(uint32_t *spi_id, const struct pios_rfm22b_sim_cfg *cfg);
+extern void PIOS_RFM22B_SIM_SetLoss(uint32_t spi_id, uint8_t loss);
+extern void PIOS_RFM22B_SIM_GetStats(uint32_t spi_id, struct pios_rfm22b_sim_stats *stats);
+
+#endif /* PIOS_RFM22B_SIM_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -81,6 +81,15 @@ extern void PIOS_LED_Init(void);
 #include <pios_crc.h>
 #include <pios_rcvr.h>
 
+#if defined(PIOS_INCLUDE_RFM22B)
+#include <pios_spi.h>
+#include <pios_rfm22b_sim.h>
+#include <pios_rfm22b.h>
+#ifdef PIOS_INCLUDE_RFM22B_COM
+#include <pios_rfm22b_com.h>
+#endif
+#endif
+
 #if defined(PIOS_INCLUDE_IAP)
 #include <pios_iap.h>
 #endif
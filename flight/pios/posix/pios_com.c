@@ -362,6 +362,30 @@ int32_t PIOS_COM_SendBuffer(uint32_t com_id, const uint8_t *buffer, uint16_t len
     return rc;
 }
 
+/**
+ * Reserves room for a package in the tx buffer of the given port.  Several
+ * tasks may send on one port here, so the room is never lent out and the
+ * caller always falls back to PIOS_COM_SendBuffer.
+ * \param[in] port COM port
+ * \param[in] len package length
+ * \return NULL
+ */
+uint8_t *PIOS_COM_SendBufferReserve(__attribute__((unused)) uint32_t com_id, __attribute__((unused)) uint16_t len)
+{
+    return NULL;
+}
+
+/**
+ * Sends a package built in the room from PIOS_COM_SendBufferReserve
+ * \param[in] port COM port
+ * \param[in] len package length
+ * \return -1 as no room is ever reserved
+ */
+int32_t PIOS_COM_SendBufferCommit(__attribute__((unused)) uint32_t com_id, __attribute__((unused)) uint16_t len)
+{
+    return -1;
+}
+
 /**
  * Sends a single character over given port
  * \param[in] port COM port
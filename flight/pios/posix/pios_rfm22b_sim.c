@@ -0,0 +1,835 @@
+/**
+ ******************************************************************************
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup   PIOS_RFM22B Radio Functions
+ * @brief Simulated RFM22B radio for the posix target
+ * @{
+ *
+ * @file       pios_rfm22b_sim.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      Software model of the RFM22B SPI register and FIFO interface.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/* Project Includes */
+#include "pios.h"
+
+#if defined(PIOS_INCLUDE_RFM22B)
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <pios_rfm22b_priv.h>
+#include <pios_rfm22b_sim.h>
+
+/* Local Defines */
+#define PIOS_RFM22B_SIM_MAX_DEVS 2
+#define SIM_TASK_PRIORITY        (configMAX_PRIORITIES - 1)
+#define SIM_TASK_STACK           1024
+#define SIM_FIFO_SIZE            64
+#define SIM_RX_QUEUE_LEN         8
+#define SIM_SYNC_BITS            32
+#define SIM_HEADER_BYTES         4
+#define SIM_RSSI                 ((-60 + 122) * 2) // -60dBm, see rfm22_processRxInt()
+#define SIM_NS_PER_SEC           1000000000ULL
+
+/* A packet on the air, sent as is to the peer over UDP */
+struct sim_packet {
+    uint64_t start_ns; // time the transmitter was switched on
+    uint32_t bps;
+    uint8_t  channel;
+    uint8_t  preamble_nibbles;
+    uint8_t  header[SIM_HEADER_BYTES]; // header byte 0 first
+    uint8_t  length;
+    uint8_t  data[255];
+} __attribute__((packed));
+
+#define SIM_PACKET_OVERHEAD offsetof(struct sim_packet, data)
+
+enum sim_rx_stage {
+    SIM_RX_IDLE, // no packet being received
+    SIM_RX_PREAMBLE, // preamble detected, waiting for the sync word
+    SIM_RX_SYNC, // sync word detected, waiting for the header
+    SIM_RX_DATA, // header accepted, filling the FIFO
+};
+
+struct sim_radio {
+    struct pios_rfm22b_sim_cfg cfg;
+    bool (*vector)(void);
+    int socket;
+    struct sockaddr_in peer;
+    unsigned int seed;
+    struct pios_rfm22b_sim_stats stats;
+
+    uint8_t regs[128];
+    uint8_t int_status[2]; // latched interrupt status 1 and 2
+    bool    irq_asserted;
+
+    // SPI transaction
+    bool    selected;
+    bool    addressed;
+    bool    write;
+    uint8_t addr;
+
+    // Transmitter
+    bool    tx_on;
+    bool    tx_on_air; // packet handed to the peer
+    struct sim_packet tx_packet;
+    uint16_t tx_written; // bytes written to the TX FIFO for this packet
+    uint16_t tx_sent; // bytes that have left the TX FIFO
+
+    // Receiver
+    struct sim_packet rx_queue[SIM_RX_QUEUE_LEN];
+    uint8_t rx_queue_len;
+    struct sim_packet rx_packet;
+    enum sim_rx_stage rx_stage;
+    uint16_t rx_received; // bytes of rx_packet pushed into the RX FIFO
+    uint8_t rx_fifo[SIM_FIFO_SIZE];
+    uint8_t rx_fifo_rd;
+    uint8_t rx_fifo_count;
+};
+
+/* Local Variables */
+static struct sim_radio sim_radios[PIOS_RFM22B_SIM_MAX_DEVS];
+static uint8_t sim_num_radios;
+
+/**
+ * Map an SPI bus id onto its radio.  Ids start at 1 since the driver treats
+ * a zero id as "no bus".
+ */
+static struct sim_radio *sim_find(uint32_t spi_id)
+{
+    if (spi_id == 0 || spi_id > sim_num_radios) {
+        return NULL;
+    }
+    return &sim_radios[spi_id - 1];
+}
+
+static uint64_t sim_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * SIM_NS_PER_SEC + ts.tv_nsec;
+}
+
+/**
+ * The air datarate programmed into the TX datarate registers, which the
+ * receiver shares on the RFM22B.
+ */
+static uint32_t sim_datarate(const struct sim_radio *r)
+{
+    uint64_t txdr = ((uint64_t)r->regs[RFM22_tx_data_rate1] << 8) | r->regs[RFM22_tx_data_rate0];
+
+    if (r->regs[RFM22_modulation_mode_control1] & RFM22_mmc1_txdtrtscale) {
+        return (txdr * 1000000) >> 21;
+    }
+    return (txdr * 1000000) >> 16;
+}
+
+/**
+ * Time at which a number of bits of the packet have been on the air.
+ */
+static uint64_t sim_air_time(const struct sim_packet *p, uint64_t base, uint32_t bits)
+{
+    return base + (uint64_t)bits * SIM_NS_PER_SEC / p->bps;
+}
+
+/**
+ * Number of whole bytes after base by now, limited to max.
+ */
+static uint16_t sim_air_bytes(const struct sim_packet *p, uint64_t base, uint64_t now, uint16_t max)
+{
+    if (now <= base) {
+        return 0;
+    }
+    uint64_t bytes = (now - base) * p->bps / (8 * SIM_NS_PER_SEC);
+    return (bytes > max) ? max : (uint16_t)bytes;
+}
+
+static uint64_t sim_arrival(const struct sim_radio *r, const struct sim_packet *p)
+{
+    return p->start_ns + (uint64_t)r->cfg.latency_us * 1000;
+}
+
+/**
+ * Time the receiver detects the preamble of a packet, which takes the
+ * detection threshold programmed into the receiver.
+ */
+static uint64_t sim_preamble_time(const struct sim_radio *r, const struct sim_packet *p)
+{
+    uint8_t nibbles = r->regs[RFM22_preamble_detection_ctrl1] >> 3;
+
+    if (nibbles > p->preamble_nibbles) {
+        nibbles = p->preamble_nibbles;
+    }
+    return sim_air_time(p, sim_arrival(r, p), nibbles * 4);
+}
+
+static uint64_t sim_sync_time(const struct sim_packet *p, uint64_t base)
+{
+    return sim_air_time(p, base, p->preamble_nibbles * 4 + SIM_SYNC_BITS);
+}
+
+/**
+ * Time the first data byte starts, after the header and the length byte.
+ */
+static uint64_t sim_data_time(const struct sim_packet *p, uint64_t base)
+{
+    return sim_air_time(p, base, p->preamble_nibbles * 4 + SIM_SYNC_BITS + (SIM_HEADER_BYTES + 1) * 8);
+}
+
+static bool sim_lost(struct sim_radio *r)
+{
+    return r->cfg.loss && (uint32_t)(rand_r(&r->seed) % 100) < r->cfg.loss;
+}
+
+static bool sim_irq_level(const struct sim_radio *r)
+{
+    return (r->int_status[0] & r->regs[RFM22_interrupt_enable1]) ||
+           (r->int_status[1] & r->regs[RFM22_interrupt_enable2]);
+}
+
+/**
+ * Latch an interrupt status bit.  Only enabled events are latched, which is
+ * all the driver relies on.
+ */
+static void sim_latch(struct sim_radio *r, uint8_t status, uint8_t bit)
+{
+    if (r->regs[RFM22_interrupt_enable1 + status] & bit) {
+        r->int_status[status] |= bit;
+    }
+}
+
+static void sim_irq_release(struct sim_radio *r)
+{
+    if (!sim_irq_level(r)) {
+        r->irq_asserted = false;
+    }
+}
+
+static void sim_rx_fifo_clear(struct sim_radio *r)
+{
+    r->rx_fifo_rd    = 0;
+    r->rx_fifo_count = 0;
+}
+
+static void sim_rx_abort(struct sim_radio *r)
+{
+    if (r->rx_stage != SIM_RX_IDLE) {
+        r->stats.aborted++;
+        r->rx_stage = SIM_RX_IDLE;
+    }
+}
+
+static void sim_reset(struct sim_radio *r)
+{
+    memset(r->regs, 0, sizeof(r->regs));
+    r->regs[RFM22_DEVICE_TYPE]     = 0x08;
+    r->regs[RFM22_DEVICE_VERSION]  = RFM22_DEVICE_VERSION_B1;
+    r->regs[RFM22_interrupt_enable2] = RFM22_is2_ipor | RFM22_is2_ichiprdy;
+    r->regs[RFM22_op_and_func_ctrl1] = RFM22_opfc1_xton;
+    r->regs[RFM22_header_control1] = 0x0C;
+    r->regs[0x33] = 0x22;
+    r->regs[RFM22_preamble_length] = 0x08;
+    r->regs[RFM22_preamble_detection_ctrl1] = 0x2A;
+    r->regs[RFM22_tx_data_rate1]   = 0x0A;
+    r->regs[RFM22_tx_data_rate0]   = 0x3D;
+    r->regs[RFM22_modulation_mode_control1] = 0x0C;
+    r->regs[RFM22_tx_fifo_control1] = 0x37;
+    r->regs[RFM22_tx_fifo_control2] = 0x04;
+    r->regs[RFM22_rx_fifo_control]  = 0x37;
+
+    r->int_status[0] = 0;
+    r->int_status[1] = 0;
+    r->tx_on      = false;
+    r->tx_on_air  = false;
+    r->tx_written = 0;
+    r->tx_sent    = 0;
+    r->rx_stage   = SIM_RX_IDLE;
+    sim_rx_fifo_clear(r);
+
+    // The crystal is up straight away.
+    sim_latch(r, 1, RFM22_is2_ichiprdy);
+}
+
+/**
+ * Put the packet on the air once the driver has written all of it.
+ */
+static void sim_tx_send(struct sim_radio *r)
+{
+    struct sim_packet *p = &r->tx_packet;
+
+    if (!r->tx_on || r->tx_on_air || r->tx_written < p->length) {
+        return;
+    }
+    r->tx_on_air = true;
+    r->stats.tx_packets++;
+    if (sim_lost(r)) {
+        r->stats.lost++;
+        return;
+    }
+    (void)sendto(r->socket, p, SIM_PACKET_OVERHEAD + p->length, 0, (struct sockaddr *)&r->peer, sizeof(r->peer));
+}
+
+static void sim_tx_start(struct sim_radio *r)
+{
+    struct sim_packet *p = &r->tx_packet;
+
+    p->start_ns = sim_now_ns();
+    p->bps = sim_datarate(r);
+    p->channel = r->regs[RFM22_frequency_hopping_channel_select];
+    p->preamble_nibbles = r->regs[RFM22_preamble_length];
+    for (uint8_t i = 0; i < SIM_HEADER_BYTES; ++i) {
+        p->header[i] = r->regs[RFM22_transmit_header0 - i];
+    }
+    p->length    = r->regs[RFM22_transmit_packet_length];
+    r->tx_on     = true;
+    r->tx_on_air = false;
+    r->tx_sent   = 0;
+    sim_tx_send(r);
+}
+
+static void sim_fifo_write(struct sim_radio *r, uint8_t value)
+{
+    if (r->tx_written >= sizeof(r->tx_packet.data) || r->tx_written - r->tx_sent >= SIM_FIFO_SIZE) {
+        sim_latch(r, 0, RFM22_is1_ifferr);
+        return;
+    }
+    r->tx_packet.data[r->tx_written++] = value;
+    sim_tx_send(r);
+}
+
+static uint8_t sim_fifo_read(struct sim_radio *r)
+{
+    if (!r->rx_fifo_count) {
+        sim_latch(r, 0, RFM22_is1_ifferr);
+        return 0;
+    }
+    uint8_t value = r->rx_fifo[r->rx_fifo_rd];
+    r->rx_fifo_rd = (r->rx_fifo_rd + 1) % SIM_FIFO_SIZE;
+    r->rx_fifo_count--;
+    return value;
+}
+
+static void sim_write(struct sim_radio *r, uint8_t addr, uint8_t value)
+{
+    switch (addr) {
+    case RFM22_DEVICE_TYPE:
+    case RFM22_DEVICE_VERSION:
+    case RFM22_device_status:
+    case RFM22_interrupt_status1:
+    case RFM22_interrupt_status2:
+    case RFM22_rssi:
+    case RFM22_ezmac_status:
+    case RFM22_received_packet_length:
+    case RFM22_received_header0 - 3 ... RFM22_received_header0:
+        // Read only
+        break;
+    case RFM22_op_and_func_ctrl1:
+    {
+        uint8_t old = r->regs[addr];
+        if (value & RFM22_opfc1_swres) {
+            sim_reset(r);
+            break;
+        }
+        r->regs[addr] = value;
+        if ((old & RFM22_opfc1_rxon) && !(value & RFM22_opfc1_rxon)) {
+            sim_rx_abort(r);
+        }
+        if (!(old & RFM22_opfc1_txon) && (value & RFM22_opfc1_txon)) {
+            sim_tx_start(r);
+        } else if (!(value & RFM22_opfc1_txon)) {
+            r->tx_on = false;
+        }
+        break;
+    }
+    case RFM22_op_and_func_ctrl2:
+        if (value & RFM22_opfc2_ffclrtx) {
+            r->tx_written = 0;
+            r->tx_sent    = 0;
+        }
+        if (value & RFM22_opfc2_ffclrrx) {
+            sim_rx_fifo_clear(r);
+            if (r->rx_stage == SIM_RX_DATA) {
+                sim_rx_abort(r);
+            }
+        }
+        r->regs[addr] = value;
+        break;
+    case RFM22_frequency_hopping_channel_select:
+        if (value != r->regs[addr]) {
+            sim_rx_abort(r);
+        }
+        r->regs[addr] = value;
+        break;
+    case RFM22_fifo_access:
+        sim_fifo_write(r, value);
+        break;
+    default:
+        r->regs[addr] = value;
+        break;
+    }
+}
+
+static uint8_t sim_read(struct sim_radio *r, uint8_t addr)
+{
+    uint8_t value;
+
+    switch (addr) {
+    case RFM22_device_status:
+        if (r->tx_on) {
+            value = RFM22_ds_cps_tx;
+        } else if (r->regs[RFM22_op_and_func_ctrl1] & RFM22_opfc1_rxon) {
+            value = RFM22_ds_cps_rx;
+        } else {
+            value = RFM22_ds_cps_idle;
+        }
+        if (!r->rx_fifo_count) {
+            value |= RFM22_ds_rxffem;
+        }
+        return value;
+
+    case RFM22_interrupt_status1:
+    case RFM22_interrupt_status2:
+        value = r->int_status[addr - RFM22_interrupt_status1];
+        r->int_status[addr - RFM22_interrupt_status1] = 0;
+        return value;
+
+    case RFM22_ezmac_status:
+        if (r->tx_on) {
+            return RFM22_ezmac_status_pktx;
+        } else if (r->rx_stage >= SIM_RX_SYNC) {
+            return RFM22_ezmac_status_pkrx;
+        } else if (r->regs[RFM22_op_and_func_ctrl1] & RFM22_opfc1_rxon) {
+            return RFM22_ezmac_status_pksrch;
+        }
+        return 0;
+
+    case RFM22_fifo_access:
+        return sim_fifo_read(r);
+
+    default:
+        return r->regs[addr];
+    }
+}
+
+/**
+ * Clock a byte through the SPI interface.  The first byte after chip select
+ * is the address with the write flag in bit 7, further bytes auto increment
+ * the address except on the FIFO.
+ */
+static uint8_t sim_transfer(struct sim_radio *r, uint8_t out)
+{
+    uint8_t in = 0xFF;
+
+    if (!r->selected) {
+        return in;
+    }
+    if (!r->addressed) {
+        r->addressed = true;
+        r->write     = (out & 0x80) != 0;
+        r->addr = out & 0x7F;
+        return in;
+    }
+    if (r->write) {
+        sim_write(r, r->addr, out);
+    } else {
+        in = sim_read(r, r->addr);
+    }
+    if (r->addr != RFM22_fifo_access) {
+        r->addr = (r->addr + 1) & 0x7F;
+    }
+    sim_irq_release(r);
+    return in;
+}
+
+static void sim_update_tx(struct sim_radio *r, uint64_t now)
+{
+    struct sim_packet *p = &r->tx_packet;
+
+    if (!r->tx_on) {
+        return;
+    }
+
+    uint64_t data_start = sim_data_time(p, p->start_ns);
+    uint16_t sent = sim_air_bytes(p, data_start, now, p->length);
+    if (sent > r->tx_sent) {
+        if (sent > r->tx_written) {
+            // The driver did not keep up with the transmitter.
+            sim_latch(r, 0, RFM22_is1_ifferr);
+            r->tx_on = false;
+            r->regs[RFM22_op_and_func_ctrl1] &= ~RFM22_opfc1_txon;
+            return;
+        }
+        uint8_t threshold = r->regs[RFM22_tx_fifo_control2] & RFM22_tx_fifo_control2_mask;
+        uint16_t before   = r->tx_written - r->tx_sent;
+        uint16_t after    = r->tx_written - sent;
+        r->tx_sent = sent;
+        if (before > threshold && after <= threshold) {
+            sim_latch(r, 0, RFM22_is1_ixtffaem);
+        }
+    }
+
+    // Hold the end of the packet back until the driver has seen the
+    // previous event, it only handles one per interrupt.
+    if (sent == p->length && now >= sim_air_time(p, data_start, p->length * 8) && !sim_irq_level(r)) {
+        sim_latch(r, 0, RFM22_is1_ipksent);
+        r->tx_on = false;
+        r->regs[RFM22_op_and_func_ctrl1] &= ~RFM22_opfc1_txon;
+    }
+}
+
+static bool sim_header_ok(const struct sim_radio *r, const struct sim_packet *p)
+{
+    uint8_t control = r->regs[RFM22_header_control1];
+
+    for (uint8_t i = 0; i < SIM_HEADER_BYTES; ++i) {
+        if (!(control & (RFM22_header_cntl1_hdch_0 << i))) {
+            continue;
+        }
+        if ((control & (RFM22_header_cntl1_bcen_0 << i)) && p->header[i] == 0xFF) {
+            continue;
+        }
+        uint8_t mask = r->regs[RFM22_header_enable0 - i];
+        if ((p->header[i] & mask) != (r->regs[RFM22_check_header0 - i] & mask)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void sim_rx_queue_pop(struct sim_radio *r)
+{
+    r->rx_queue_len--;
+    memmove(&r->rx_queue[0], &r->rx_queue[1], r->rx_queue_len * sizeof(r->rx_queue[0]));
+}
+
+/**
+ * Play the received packets into the receiver up to now.  Each step waits
+ * for the driver to service the previous interrupt first, the sim task only
+ * runs once a tick so events closer together would otherwise merge.
+ */
+static void sim_update_rx(struct sim_radio *r, uint64_t now)
+{
+    while (!sim_irq_level(r)) {
+        if (r->rx_stage == SIM_RX_IDLE) {
+            if (!r->rx_queue_len || now < sim_preamble_time(r, &r->rx_queue[0])) {
+                return;
+            }
+            struct sim_packet *p = &r->rx_packet;
+            *p = r->rx_queue[0];
+            sim_rx_queue_pop(r);
+            if (!(r->regs[RFM22_op_and_func_ctrl1] & RFM22_opfc1_rxon) ||
+                r->regs[RFM22_frequency_hopping_channel_select] != p->channel ||
+                sim_datarate(r) != p->bps) {
+                r->stats.missed++;
+                continue;
+            }
+            if (sim_lost(r)) {
+                r->stats.lost++;
+                continue;
+            }
+            sim_latch(r, 1, RFM22_is2_ipreaval);
+            r->rx_stage = SIM_RX_PREAMBLE;
+            continue;
+        }
+
+        struct sim_packet *p = &r->rx_packet;
+        uint64_t base = sim_arrival(r, p);
+        uint64_t data_start = sim_data_time(p, base);
+        uint64_t end = sim_air_time(p, data_start, p->length * 8);
+
+        // Anything else arriving while this packet is on the air collides with it.
+        while (r->rx_queue_len && now >= sim_preamble_time(r, &r->rx_queue[0]) &&
+               sim_preamble_time(r, &r->rx_queue[0]) < end) {
+            r->stats.missed++;
+            sim_rx_queue_pop(r);
+        }
+
+        switch (r->rx_stage) {
+        case SIM_RX_PREAMBLE:
+            if (now < sim_sync_time(p, base)) {
+                return;
+            }
+            r->regs[RFM22_rssi] = SIM_RSSI;
+            sim_latch(r, 1, RFM22_is2_iswdet);
+            r->rx_stage = SIM_RX_SYNC;
+            break;
+
+        case SIM_RX_SYNC:
+            if (now < data_start) {
+                return;
+            }
+            if (!sim_header_ok(r, p)) {
+                r->stats.rejected++;
+                r->rx_stage = SIM_RX_IDLE;
+                break;
+            }
+            for (uint8_t i = 0; i < SIM_HEADER_BYTES; ++i) {
+                r->regs[RFM22_received_header0 - i] = p->header[i];
+            }
+            r->regs[RFM22_received_packet_length] = p->length;
+            r->rx_received = 0;
+            r->rx_stage    = SIM_RX_DATA;
+            break;
+
+        case SIM_RX_DATA:
+        {
+            uint8_t threshold  = r->regs[RFM22_rx_fifo_control] & RFM22_rx_fifo_control_mask;
+            uint16_t available = sim_air_bytes(p, data_start, now, p->length);
+            while (r->rx_received < available) {
+                if (r->rx_fifo_count == SIM_FIFO_SIZE) {
+                    sim_latch(r, 0, RFM22_is1_ifferr);
+                    sim_rx_abort(r);
+                    return;
+                }
+                r->rx_fifo[(r->rx_fifo_rd + r->rx_fifo_count) % SIM_FIFO_SIZE] = p->data[r->rx_received++];
+                if (++r->rx_fifo_count == threshold) {
+                    sim_latch(r, 0, RFM22_is1_irxffafull);
+                }
+            }
+            if (r->rx_received < p->length || now < end || sim_irq_level(r)) {
+                return;
+            }
+            sim_latch(r, 0, RFM22_is1_ipkvalid);
+            r->stats.rx_packets++;
+            r->regs[RFM22_op_and_func_ctrl1] &= ~RFM22_opfc1_rxon;
+            r->rx_stage = SIM_RX_IDLE;
+            break;
+        }
+
+        default:
+            r->rx_stage = SIM_RX_IDLE;
+            break;
+        }
+    }
+}
+
+/**
+ * Pull the packets the peer sent off the socket.
+ */
+static void sim_receive(struct sim_radio *r)
+{
+    struct sim_packet p;
+    ssize_t len;
+
+    while ((len = recv(r->socket, &p, sizeof(p), MSG_DONTWAIT)) >= 0) {
+        if ((size_t)len < SIM_PACKET_OVERHEAD || (size_t)len != SIM_PACKET_OVERHEAD + p.length || !p.bps) {
+            continue;
+        }
+        if (r->rx_queue_len == SIM_RX_QUEUE_LEN) {
+            r->stats.missed++;
+            continue;
+        }
+        r->rx_queue[r->rx_queue_len++] = p;
+    }
+}
+
+/**
+ * The sim task stands in for the radio hardware.  It runs at the highest
+ * priority once a tick, moves the packets on the air along and calls the
+ * interrupt handler of the driver on a rising edge of the interrupt line.
+ */
+static void sim_task(void *parameters)
+{
+    struct sim_radio *r = (struct sim_radio *)parameters;
+
+    while (1) {
+        vTaskDelay(1);
+
+        portENTER_CRITICAL();
+        sim_receive(r);
+        uint64_t now = sim_now_ns();
+        sim_update_tx(r, now);
+        sim_update_rx(r, now);
+        bool edge = sim_irq_level(r) && !r->irq_asserted;
+        if (edge) {
+            r->irq_asserted = true;
+        }
+        portEXIT_CRITICAL();
+
+        if (edge && r->vector) {
+            r->vector();
+        }
+    }
+}
+
+/**
+ * Initialise a simulated radio and return the SPI bus id to hand to
+ * PIOS_RFM22B_Init()
+ * \param[out] spi_id the SPI bus id of the radio
+ * \param[in] cfg the sockets and link conditions of the radio
+ * \return < 0 if the socket could not be opened
+ */
+int32_t PIOS_RFM22B_SIM_Init(uint32_t *spi_id, const struct pios_rfm22b_sim_cfg *cfg)
+{
+    PIOS_Assert(spi_id);
+    PIOS_Assert(cfg);
+
+    if (sim_num_radios >= PIOS_RFM22B_SIM_MAX_DEVS) {
+        return -1;
+    }
+
+    struct sim_radio *r = &sim_radios[sim_num_radios];
+    memset(r, 0, sizeof(*r));
+    r->cfg  = *cfg;
+    r->seed = cfg->seed ? cfg->seed : cfg->port;
+
+    r->socket = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (r->socket < 0) {
+        return -1;
+    }
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    addr.sin_port = htons(cfg->port);
+    if (bind(r->socket, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(r->socket);
+        return -1;
+    }
+    r->peer = addr;
+    r->peer.sin_port = htons(cfg->peer_port);
+
+    // Power up without a pending chip ready, the driver resets the chip first.
+    sim_reset(r);
+    r->int_status[1] = 0;
+
+    xTaskHandle handle;
+    xTaskCreate(sim_task, (const signed char *)"RFM22B_Sim", SIM_TASK_STACK, r, SIM_TASK_PRIORITY, &handle);
+
+    *spi_id = ++sim_num_radios;
+    return 0;
+}
+
+/**
+ * Change the packet loss of a radio, e.g. to take the link down.
+ * \param[in] spi_id the SPI bus id of the radio
+ * \param[in] loss percentage of packets lost in both directions
+ */
+void PIOS_RFM22B_SIM_SetLoss(uint32_t spi_id, uint8_t loss)
+{
+    struct sim_radio *r = sim_find(spi_id);
+
+    if (r) {
+        portENTER_CRITICAL();
+        r->cfg.loss = loss;
+        portEXIT_CRITICAL();
+    }
+}
+
+/**
+ * Get the packet counters of a radio.
+ * \param[in] spi_id the SPI bus id of the radio
+ * \param[out] stats the counters
+ */
+void PIOS_RFM22B_SIM_GetStats(uint32_t spi_id, struct pios_rfm22b_sim_stats *stats)
+{
+    struct sim_radio *r = sim_find(spi_id);
+
+    if (r) {
+        portENTER_CRITICAL();
+        *stats = r->stats;
+        portEXIT_CRITICAL();
+    }
+}
+
+/**
+ * Attach the interrupt handler of the radio to the last simulated radio
+ * initialised.
+ */
+int32_t PIOS_EXTI_Init(const struct pios_exti_cfg *cfg)
+{
+    if (!sim_num_radios) {
+        return -1;
+    }
+    sim_radios[sim_num_radios - 1].vector = cfg->vector;
+    return 0;
+}
+
+/* SPI bus of the simulated radios */
+
+int32_t PIOS_SPI_ClaimBus(uint32_t spi_id)
+{
+    return sim_find(spi_id) ? 0 : -1;
+}
+
+int32_t PIOS_SPI_ReleaseBus(uint32_t spi_id)
+{
+    return sim_find(spi_id) ? 0 : -1;
+}
+
+int32_t PIOS_SPI_RC_PinSet(uint32_t spi_id, __attribute__((unused)) uint32_t slave_id, uint8_t pin_value)
+{
+    struct sim_radio *r = sim_find(spi_id);
+
+    if (!r) {
+        return -1;
+    }
+    portENTER_CRITICAL();
+    r->selected  = !pin_value;
+    r->addressed = false;
+    portEXIT_CRITICAL();
+    return 0;
+}
+
+int32_t PIOS_SPI_TransferByte(uint32_t spi_id, uint8_t b)
+{
+    struct sim_radio *r = sim_find(spi_id);
+
+    if (!r) {
+        return -1;
+    }
+    portENTER_CRITICAL();
+    uint8_t in = sim_transfer(r, b);
+    portEXIT_CRITICAL();
+    return in;
+}
+
+int32_t PIOS_SPI_TransferBlock(uint32_t spi_id, const uint8_t *send_buffer, uint8_t *receive_buffer, uint16_t len, __attribute__((unused)) void *callback)
+{
+    struct sim_radio *r = sim_find(spi_id);
+
+    if (!r) {
+        return -1;
+    }
+    portENTER_CRITICAL();
+    for (uint16_t i = 0; i < len; ++i) {
+        uint8_t in = sim_transfer(r, send_buffer ? send_buffer[i] : 0xFF);
+        if (receive_buffer) {
+            receive_buffer[i] = in;
+        }
+    }
+    portEXIT_CRITICAL();
+    return 0;
+}
+
+#endif /* PIOS_INCLUDE_RFM22B */
+
+/**
+ * @}
+ * @}
+ */
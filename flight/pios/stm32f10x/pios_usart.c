@@ -34,19 +34,29 @@
 
 #include <pios_usart_priv.h>
 
+/*
+ * Longest run of the tx buffer the ISR sends before handing the bytes back,
+ * so writers waiting for room see it freed up while a long run goes out
+ */
+#ifndef PIOS_USART_TX_SPAN_MAX
+#define PIOS_USART_TX_SPAN_MAX 16
+#endif
+
 /* Provide a COM driver */
 static void PIOS_USART_ChangeBaud(uint32_t usart_id, uint32_t baud);
 static void PIOS_USART_RegisterRxCallback(uint32_t usart_id, pios_com_callback rx_in_cb, uint32_t context);
 static void PIOS_USART_RegisterTxCallback(uint32_t usart_id, pios_com_callback tx_out_cb, uint32_t context);
+static void PIOS_USART_RegisterTxSpanCallback(uint32_t usart_id, pios_com_span_callback tx_span_cb, uint32_t context);
 static void PIOS_USART_TxStart(uint32_t usart_id, uint16_t tx_bytes_avail);
 static void PIOS_USART_RxStart(uint32_t usart_id, uint16_t rx_bytes_avail);
 
 const struct pios_com_driver pios_usart_com_driver = {
-    .set_baud   = PIOS_USART_ChangeBaud,
-    .tx_start   = PIOS_USART_TxStart,
-    .rx_start   = PIOS_USART_RxStart,
-    .bind_tx_cb = PIOS_USART_RegisterTxCallback,
-    .bind_rx_cb = PIOS_USART_RegisterRxCallback,
+    .set_baud        = PIOS_USART_ChangeBaud,
+    .tx_start        = PIOS_USART_TxStart,
+    .rx_start        = PIOS_USART_RxStart,
+    .bind_tx_cb      = PIOS_USART_RegisterTxCallback,
+    .bind_rx_cb      = PIOS_USART_RegisterRxCallback,
+    .bind_tx_span_cb = PIOS_USART_RegisterTxSpanCallback,
 };
 
 enum pios_usart_dev_magic {
@@ -61,6 +71,13 @@ struct pios_usart_dev {
     uint32_t rx_in_context;
     pios_com_callback tx_out_cb;
     uint32_t tx_out_context;
+    pios_com_span_callback tx_span_cb;
+    uint32_t tx_span_context;
+
+    /* Run of the tx buffer being sent, owned by the ISR */
+    const uint8_t *tx_span;
+    uint16_t tx_span_len;
+    uint16_t tx_span_sent;
 
     uint32_t rx_dropped;
 };
@@ -281,6 +298,22 @@ static void PIOS_USART_RegisterTxCallback(uint32_t usart_id, pios_com_callback t
     usart_dev->tx_out_cb = tx_out_cb;
 }
 
+static void PIOS_USART_RegisterTxSpanCallback(uint32_t usart_id, pios_com_span_callback tx_span_cb, uint32_t context)
+{
+    struct pios_usart_dev *usart_dev = (struct pios_usart_dev *)usart_id;
+
+    bool valid = PIOS_USART_validate(usart_dev);
+
+    PIOS_Assert(valid);
+
+    /*
+     * Order is important in these assignments since ISR uses _cb
+     * field to determine if it's ok to dereference _cb and _context
+     */
+    usart_dev->tx_span_context = context;
+    usart_dev->tx_span_cb = tx_span_cb;
+}
+
 static void PIOS_USART_generic_irq_handler(uint32_t usart_id)
 {
     struct pios_usart_dev *usart_dev = (struct pios_usart_dev *)usart_id;
@@ -310,7 +343,25 @@ static void PIOS_USART_generic_irq_handler(uint32_t usart_id)
     /* Check if TXE flag is set */
     bool tx_need_yield = false;
     if (sr & USART_SR_TXE) {
-        if (usart_dev->tx_out_cb) {
+        if (usart_dev->tx_span_cb) {
+            if (usart_dev->tx_span_sent == usart_dev->tx_span_len) {
+                /* Hand back the bytes sent and take the next run of the tx buffer */
+                usart_dev->tx_span = (usart_dev->tx_span_cb)(usart_dev->tx_span_context, usart_dev->tx_span_sent,
+                                                             &usart_dev->tx_span_len, &tx_need_yield);
+                usart_dev->tx_span_sent = 0;
+                if (usart_dev->tx_span_len > PIOS_USART_TX_SPAN_MAX) {
+                    usart_dev->tx_span_len = PIOS_USART_TX_SPAN_MAX;
+                }
+            }
+
+            if (usart_dev->tx_span_len > 0) {
+                /* Send straight out of the tx buffer */
+                usart_dev->cfg->regs->DR = usart_dev->tx_span[usart_dev->tx_span_sent++];
+            } else {
+                /* No bytes to send, disable TXE interrupt */
+                USART_ITConfig(usart_dev->cfg->regs, USART_IT_TXE, DISABLE);
+            }
+        } else if (usart_dev->tx_out_cb) {
             uint8_t b;
             uint16_t bytes_to_send;
 
@@ -40,16 +40,18 @@
 #include "usb_lib.h"
 
 static void PIOS_USB_HID_RegisterTxCallback(uint32_t usbhid_id, pios_com_callback tx_out_cb, uint32_t context);
+static void PIOS_USB_HID_RegisterTxSpanCallback(uint32_t usbhid_id, pios_com_span_callback tx_span_cb, uint32_t context);
 static void PIOS_USB_HID_RegisterRxCallback(uint32_t usbhid_id, pios_com_callback rx_in_cb, uint32_t context);
 static void PIOS_USB_HID_TxStart(uint32_t usbhid_id, uint16_t tx_bytes_avail);
 static void PIOS_USB_HID_RxStart(uint32_t usbhid_id, uint16_t rx_bytes_avail);
 
 const struct pios_com_driver pios_usb_hid_com_driver = {
-    .tx_start   = PIOS_USB_HID_TxStart,
-    .rx_start   = PIOS_USB_HID_RxStart,
-    .bind_tx_cb = PIOS_USB_HID_RegisterTxCallback,
-    .bind_rx_cb = PIOS_USB_HID_RegisterRxCallback,
-    .available  = PIOS_USB_CheckAvailable,
+    .tx_start        = PIOS_USB_HID_TxStart,
+    .rx_start        = PIOS_USB_HID_RxStart,
+    .bind_tx_cb      = PIOS_USB_HID_RegisterTxCallback,
+    .bind_rx_cb      = PIOS_USB_HID_RegisterRxCallback,
+    .available       = PIOS_USB_CheckAvailable,
+    .bind_tx_span_cb = PIOS_USB_HID_RegisterTxSpanCallback,
 };
 
 enum pios_usb_hid_dev_magic {
@@ -66,6 +68,8 @@ struct pios_usb_hid_dev {
     uint32_t rx_in_context;
     pios_com_callback tx_out_cb;
     uint32_t tx_out_context;
+    pios_com_span_callback tx_span_cb;
+    uint32_t tx_span_context;
 
     uint8_t  rx_packet_buffer[PIOS_USB_BOARD_HID_DATA_LENGTH];
     uint8_t  tx_packet_buffer[PIOS_USB_BOARD_HID_DATA_LENGTH];
@@ -153,10 +157,61 @@ out_fail:
 }
 
 
+#ifndef PIOS_USB_BOARD_BL_HID_HAS_NO_LENGTH_BYTE
+/**
+ * Copies the report into the packet memory straight from the tx buffer,
+ * one contiguous run of the buffer per report.
+ */
+static void PIOS_USB_HID_SendSpan(struct pios_usb_hid_dev *usb_hid_dev)
+{
+    uint16_t bytes_to_tx;
+    bool need_yield = false;
+    bool tx_need_yield = false;
+
+    const uint8_t *span = (usb_hid_dev->tx_span_cb)(usb_hid_dev->tx_span_context, 0, &bytes_to_tx, &need_yield);
+
+    if (bytes_to_tx == 0) {
+        return;
+    }
+    if (bytes_to_tx > sizeof(usb_hid_dev->tx_packet_buffer) - 2) {
+        bytes_to_tx = sizeof(usb_hid_dev->tx_packet_buffer) - 2;
+    }
+
+    /* Report ID and length, the data goes in behind them */
+    usb_hid_dev->tx_packet_buffer[0] = 1;
+    usb_hid_dev->tx_packet_buffer[1] = bytes_to_tx;
+    UserToPMABufferCopy(usb_hid_dev->tx_packet_buffer,
+                        GetEPTxAddr(usb_hid_dev->cfg->data_tx_ep),
+                        2);
+    UserToPMABufferCopy(span,
+                        GetEPTxAddr(usb_hid_dev->cfg->data_tx_ep) + 2,
+                        bytes_to_tx);
+
+    /* The report is in the packet memory now, give the room back */
+    (usb_hid_dev->tx_span_cb)(usb_hid_dev->tx_span_context, bytes_to_tx, NULL, &tx_need_yield);
+
+    SetEPTxCount(usb_hid_dev->cfg->data_tx_ep, sizeof(usb_hid_dev->tx_packet_buffer));
+    SetEPTxValid(usb_hid_dev->cfg->data_tx_ep);
+
+#ifdef PIOS_INCLUDE_FREERTOS
+    if (need_yield || tx_need_yield) {
+        vPortYieldFromISR();
+    }
+#endif /* PIOS_INCLUDE_FREERTOS */
+}
+#endif /* PIOS_USB_BOARD_BL_HID_HAS_NO_LENGTH_BYTE */
+
 static void PIOS_USB_HID_SendReport(struct pios_usb_hid_dev *usb_hid_dev)
 {
     uint16_t bytes_to_tx;
 
+#ifndef PIOS_USB_BOARD_BL_HID_HAS_NO_LENGTH_BYTE
+    if (usb_hid_dev->tx_span_cb) {
+        PIOS_USB_HID_SendSpan(usb_hid_dev);
+        return;
+    }
+#endif
+
     if (!usb_hid_dev->tx_out_cb) {
         return;
     }
@@ -282,6 +337,22 @@ static void PIOS_USB_HID_RegisterTxCallback(uint32_t usbhid_id, pios_com_callbac
     usb_hid_dev->tx_out_cb = tx_out_cb;
 }
 
+static void PIOS_USB_HID_RegisterTxSpanCallback(uint32_t usbhid_id, pios_com_span_callback tx_span_cb, uint32_t context)
+{
+    struct pios_usb_hid_dev *usb_hid_dev = (struct pios_usb_hid_dev *)usbhid_id;
+
+    bool valid = PIOS_USB_HID_validate(usb_hid_dev);
+
+    PIOS_Assert(valid);
+
+    /*
+     * Order is important in these assignments since ISR uses _cb
+     * field to determine if it's ok to dereference _cb and _context
+     */
+    usb_hid_dev->tx_span_context = context;
+    usb_hid_dev->tx_span_cb = tx_span_cb;
+}
+
 /**
  * @brief Callback used to indicate a transmission from device INto host completed
  * Checks if any data remains, pads it into HID packet and sends.
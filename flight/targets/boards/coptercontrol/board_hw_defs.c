@@ -420,6 +420,8 @@ static const struct flashfs_logfs_cfg flashfs_w25x_cfg = {
     .start_offset  = 0,          /* start at the beginning of the chip */
     .sector_size   = 0x00001000, /* 4K bytes */
     .page_size     = 0x00000100, /* 256 bytes */
+
+    .index_size    = 0,          /* no RAM to spare, scan the log */
 };
 
 
@@ -432,6 +434,8 @@ static const struct flashfs_logfs_cfg flashfs_m25p_cfg = {
     .start_offset  = 0,          /* start at the beginning of the chip */
     .sector_size   = 0x00010000, /* 64K bytes */
     .page_size     = 0x00000100, /* 256 bytes */
+
+    .index_size    = 0,          /* no RAM to spare, scan the log */
 };
 
 #include "pios_flash.h"
@@ -139,6 +139,8 @@ static const struct flashfs_logfs_cfg flashfs_internal_cfg = {
     .start_offset  = EE_BANK_BASE, /* start after the bootloader */
     .sector_size   = 0x00000400, /* 1K bytes */
     .page_size     = 0x00000400, /* 1K bytes */
+
+    .index_size    = 0,          /* no RAM to spare, scan the log */
 };
 
 #include "pios_flash.h"
@@ -686,6 +686,8 @@ static const struct flashfs_logfs_cfg flashfs_external_user_cfg = {
     .start_offset  = 0x40000,    /* start offset */
     .sector_size   = 0x00010000, /* 64K bytes */
     .page_size     = 0x00000100, /* 256 bytes */
+
+    .index_size    = 64,         /* 512 bytes of RAM */
 };
 
 static const struct flashfs_logfs_cfg flashfs_external_system_cfg = {
@@ -697,6 +699,8 @@ static const struct flashfs_logfs_cfg flashfs_external_system_cfg = {
     .start_offset  = 0,          /* start at the beginning of the chip */
     .sector_size   = 0x00010000, /* 64K bytes */
     .page_size     = 0x00000100, /* 256 bytes */
+
+    .index_size    = 64,         /* 512 bytes of RAM */
 };
 
 
@@ -711,6 +715,8 @@ static const struct flashfs_logfs_cfg flashfs_internal_cfg = {
     .start_offset  = EE_BANK_BASE, /* start after the bootloader */
     .sector_size   = 0x00004000, /* 16K bytes */
     .page_size     = 0x00004000, /* 16K bytes */
+
+    .index_size    = 64,         /* 512 bytes of RAM */
 };
 
 #endif /* PIOS_INCLUDE_FLASH */
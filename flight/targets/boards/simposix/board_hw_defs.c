@@ -69,3 +69,35 @@ const struct pios_udp_cfg pios_udp_aux_cfg = {
 #include <pios_com_priv.h>
 
 #endif /* PIOS_INCLUDE_COM */
+
+#if defined(PIOS_INCLUDE_RFM22B)
+#include <pios_rfm22b_priv.h>
+
+static const struct pios_exti_cfg pios_exti_rfm22b_cfg = {
+    .vector = PIOS_RFM22_EXT_Int,
+};
+
+const struct pios_rfm22b_cfg pios_rfm22b_cfg = {
+    .exti_cfg  = &pios_exti_rfm22b_cfg,
+    .RFXtalCap = 0x7f,
+    .slave_num = 0,
+    .gpio_direction = GPIO0_TX_GPIO1_RX,
+};
+
+/*
+ * Two simposix instances make an OPLink on localhost, one of them set up as
+ * coordinator in OPLinkSettings.  Each radio receives on its own UDP port
+ * and sends to the port of the other.
+ */
+const struct pios_rfm22b_sim_cfg pios_rfm22b_sim_coordinator_cfg = {
+    .port      = 9010,
+    .peer_port = 9011,
+    .seed      = 9010,
+};
+
+const struct pios_rfm22b_sim_cfg pios_rfm22b_sim_remote_cfg = {
+    .port      = 9011,
+    .peer_port = 9010,
+    .seed      = 9011,
+};
+#endif /* PIOS_INCLUDE_RFM22B */
@@ -76,6 +76,9 @@
 #define PIOS_INCLUDE_COM_AUXSBUS
 #define PIOS_INCLUDE_COM_FLEXI
 
+#define PIOS_INCLUDE_RFM22B
+#define PIOS_INCLUDE_RFM22B_COM
+
 #define PIOS_INCLUDE_GPS
 #define PIOS_OVERO_SPI
 /* Supported receiver interfaces */
@@ -33,6 +33,8 @@
 #include <hwsettings.h>
 #include <manualcontrolsettings.h>
 #include <taskinfo.h>
+#include <oplinksettings.h>
+#include <oplinkstatus.h>
 
 /*
  * Pull in the board-specific static HW definitions.
@@ -68,12 +70,20 @@ uint32_t pios_rcvr_group_map[MANUALCONTROLSETTINGS_CHANNELGROUPS_NONE];
 #define PIOS_COM_AUX_RX_BUF_LEN       512
 #define PIOS_COM_AUX_TX_BUF_LEN       512
 
+#define PIOS_COM_RFM22B_RF_RX_BUF_LEN 512
+#define PIOS_COM_RFM22B_RF_TX_BUF_LEN 512
+
 uint32_t pios_com_aux_id       = 0;
 uint32_t pios_com_gps_id       = 0;
 uint32_t pios_com_telem_usb_id = 0;
 uint32_t pios_com_telem_rf_id  = 0;
 uint32_t pios_com_bridge_id    = 0;
 
+#if defined(PIOS_INCLUDE_RFM22B)
+uint32_t pios_rfm22b_id = 0;
+uint32_t pios_spi_rfm22b_sim_id = 0;
+#endif
+
 uintptr_t pios_uavo_settings_fs_id;
 
 /*
@@ -128,6 +138,10 @@ void PIOS_Board_Init(void)
     UAVObjInitialize();
 
     HwSettingsInitialize();
+#if defined(PIOS_INCLUDE_RFM22B)
+    OPLinkSettingsInitialize();
+    OPLinkStatusInitialize();
+#endif /* PIOS_INCLUDE_RFM22B */
 
     UAVObjectsInitializeAll();
 
@@ -191,6 +205,83 @@ void PIOS_Board_Init(void)
         break;
         break;
     } /* hwsettings_rv_auxport */
+
+    /* Initialize the simulated RFM22B radio COM device. */
+#if defined(PIOS_INCLUDE_RFM22B)
+
+    /* Fetch the OPLinkSettings object. */
+    OPLinkSettingsData oplinkSettings;
+    OPLinkSettingsGet(&oplinkSettings);
+
+    OPLinkStatusData oplinkStatus;
+    OPLinkStatusGet(&oplinkStatus);
+    PIOS_SYS_SerialNumberGetBinary(oplinkStatus.CPUSerial);
+
+    /* Is the radio turned on? */
+    bool is_coordinator = (oplinkSettings.Coordinator == OPLINKSETTINGS_COORDINATOR_TRUE);
+    bool is_oneway = (oplinkSettings.OneWay == OPLINKSETTINGS_ONEWAY_TRUE);
+    bool ppm_mode  = (oplinkSettings.PPM == OPLINKSETTINGS_PPM_TRUE);
+    bool ppm_only  = (oplinkSettings.PPMOnly == OPLINKSETTINGS_PPMONLY_TRUE);
+    if (oplinkSettings.MaxRFPower != OPLINKSETTINGS_MAXRFPOWER_0) {
+        /* The radio at the other end of the link is another simposix on localhost */
+        const struct pios_rfm22b_sim_cfg *sim_cfg = is_coordinator ? &pios_rfm22b_sim_coordinator_cfg : &pios_rfm22b_sim_remote_cfg;
+        if (PIOS_RFM22B_SIM_Init(&pios_spi_rfm22b_sim_id, sim_cfg)) {
+            PIOS_Assert(0);
+        }
+
+        /* Configure the RFM22B device. */
+        if (PIOS_RFM22B_Init(&pios_rfm22b_id, PIOS_RFM22_SPI_PORT, pios_rfm22b_cfg.slave_num, &pios_rfm22b_cfg)) {
+            PIOS_Assert(0);
+        }
+
+        /* Configure the radio com interface */
+        uint8_t *rx_buffer = (uint8_t *)pvPortMalloc(PIOS_COM_RFM22B_RF_RX_BUF_LEN);
+        uint8_t *tx_buffer = (uint8_t *)pvPortMalloc(PIOS_COM_RFM22B_RF_TX_BUF_LEN);
+        PIOS_Assert(rx_buffer);
+        PIOS_Assert(tx_buffer);
+        if (PIOS_COM_Init(&pios_com_telem_rf_id, &pios_rfm22b_com_driver, pios_rfm22b_id,
+                          rx_buffer, PIOS_COM_RFM22B_RF_RX_BUF_LEN,
+                          tx_buffer, PIOS_COM_RFM22B_RF_TX_BUF_LEN)) {
+            PIOS_Assert(0);
+        }
+        oplinkStatus.LinkState = OPLINKSTATUS_LINKSTATE_ENABLED;
+
+        // Set the RF data rate on the modem to ~2X the selected baud rate because the modem is half duplex.
+        enum rfm22b_datarate datarate = RFM22_datarate_64000;
+        switch (oplinkSettings.ComSpeed) {
+        case OPLINKSETTINGS_COMSPEED_4800:
+            datarate = RFM22_datarate_9600;
+            break;
+        case OPLINKSETTINGS_COMSPEED_9600:
+            datarate = RFM22_datarate_19200;
+            break;
+        case OPLINKSETTINGS_COMSPEED_19200:
+            datarate = RFM22_datarate_32000;
+            break;
+        case OPLINKSETTINGS_COMSPEED_38400:
+            datarate = RFM22_datarate_64000;
+            break;
+        case OPLINKSETTINGS_COMSPEED_57600:
+            datarate = RFM22_datarate_100000;
+            break;
+        case OPLINKSETTINGS_COMSPEED_115200:
+            datarate = RFM22_datarate_192000;
+            break;
+        }
+
+        /* Set the radio configuration parameters, there is no PPM output on simposix. */
+        PIOS_RFM22B_SetChannelConfig(pios_rfm22b_id, datarate, oplinkSettings.MinChannel, oplinkSettings.MaxChannel, oplinkSettings.ChannelSet, is_coordinator, is_oneway, ppm_mode, ppm_only);
+        PIOS_RFM22B_SetCoordinatorID(pios_rfm22b_id, oplinkSettings.CoordID);
+        PIOS_RFM22B_SetTxPower(pios_rfm22b_id, RFM22_tx_pwr_txpow_7);
+
+        /* Reinitialize the modem. */
+        PIOS_RFM22B_Reinit(pios_rfm22b_id);
+    } else {
+        oplinkStatus.LinkState = OPLINKSTATUS_LINKSTATE_DISABLED;
+    }
+
+    OPLinkStatusSet(&oplinkStatus);
+#endif /* PIOS_INCLUDE_RFM22B */
 }
 
 /**
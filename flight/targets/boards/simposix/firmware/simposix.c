@@ -42,6 +42,8 @@
 
 /* Local Variables */
 #define INCLUDE_TEST_TASKS  0
+#define INCLUDE_UAVO_BENCHMARK 0
+#define INCLUDE_EVENT_TIMING 0
 #if INCLUDE_TEST_TASKS
 static uint8_t sdcard_available;
 #endif
@@ -72,6 +74,12 @@ static xTaskHandle initTaskHandle;
 
 /* Function Prototypes */
 static void initTask(void *parameters);
+#if INCLUDE_UAVO_BENCHMARK
+static void benchmarkGetByID(void);
+#endif
+#if INCLUDE_EVENT_TIMING
+static void reportEventTiming(void);
+#endif
 
 /* Prototype of generated InitModules() function */
 extern void InitModules(void);
@@ -129,10 +137,80 @@ void initTask(__attribute__((unused)) void *parameters)
     /* Initialize modules */
     MODULE_INITIALISE_ALL;
 
+#if INCLUDE_UAVO_BENCHMARK
+    benchmarkGetByID();
+#endif
+
+#if INCLUDE_EVENT_TIMING
+    reportEventTiming();
+#endif
+
     /* terminate this task */
     vTaskDelete(NULL);
 }
 
+#if INCLUDE_UAVO_BENCHMARK
+#define BENCHMARK_ROUNDS 10000
+static uint32_t benchmarkIds[512];
+static uint16_t benchmarkNumIds;
+
+static void benchmarkCollectId(UAVObjHandle obj)
+{
+    if (benchmarkNumIds < NELEMENTS(benchmarkIds)) {
+        benchmarkIds[benchmarkNumIds++] = UAVObjGetID(obj);
+    }
+}
+
+/**
+ * Time UAVObjGetByID() over every registered data and meta object,
+ * the way UAVTalk looks up each received packet.
+ */
+static void benchmarkGetByID(void)
+{
+    uint32_t found = 0;
+
+    benchmarkNumIds = 0;
+    UAVObjIterate(&benchmarkCollectId);
+
+    uint32_t start = PIOS_DELAY_GetRaw();
+    for (uint32_t round = 0; round < BENCHMARK_ROUNDS; round++) {
+        for (uint16_t n = 0; n < benchmarkNumIds; n++) {
+            found += UAVObjGetByID(benchmarkIds[n]) != NULL;
+        }
+    }
+    uint32_t elapsed = PIOS_DELAY_DiffuS(start);
+    uint32_t lookups = BENCHMARK_ROUNDS * benchmarkNumIds;
+
+    printf("UAVObjGetByID: %u objects, %u lookups (%u found) in %u us, %u ns/lookup\n",
+           benchmarkNumIds, lookups, found, elapsed, lookups ? (uint32_t)((uint64_t)elapsed * 1000 / lookups) : 0);
+}
+#endif /* INCLUDE_UAVO_BENCHMARK */
+
+#if INCLUDE_EVENT_TIMING
+#define EVENT_TIMING_PERIOD_MS 10000
+
+static void printEventTiming(const UAVObjEvent *ev, uint16_t periodMs, uint16_t maxLatenessMs, uint16_t maxDispatchUs)
+{
+    printf("  %08x/%u every %u ms: late %u ms, dispatch %u us\n",
+           ev->obj ? UAVObjGetID(ev->obj) : 0, ev->instId, periodMs, maxLatenessMs, maxDispatchUs);
+}
+
+/**
+ * Print the worst case timing of each periodic event since boot every
+ * EVENT_TIMING_PERIOD_MS, never returns. The overall worst case is left
+ * to the system module, which clears it every second.
+ */
+static void reportEventTiming(void)
+{
+    vTaskPrioritySet(NULL, tskIDLE_PRIORITY + 1);
+    while (1) {
+        vTaskDelay(EVENT_TIMING_PERIOD_MS / portTICK_RATE_MS);
+        printf("Periodic events, worst since boot:\n");
+        EventPeriodicIterateStats(&printEventTiming);
+    }
+}
+#endif /* INCLUDE_EVENT_TIMING */
+
 /**
  * @}
  * @}
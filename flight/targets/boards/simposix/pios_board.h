@@ -140,6 +140,17 @@ extern uint32_t pios_com_vcp_id;
 #define PIOS_COM_VCP            (pios_com_vcp_id)
 #define PIOS_COM_DEBUG          PIOS_COM_AUX
 
+#if defined(PIOS_INCLUDE_RFM22B)
+extern uint32_t pios_rfm22b_id;
+extern uint32_t pios_spi_rfm22b_sim_id;
+#define PIOS_RFM22_SPI_PORT     (pios_spi_rfm22b_sim_id)
+#endif /* PIOS_INCLUDE_RFM22B */
+
+// -------------------------
+// Packet Handler
+// -------------------------
+#define RS_ECC_NPARITY          4
+
 // ------------------------
 // TELEMETRY
 // ------------------------
@@ -0,0 +1,44 @@
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#define pvPortMalloc(xSize) (malloc(xSize))
+#define vPortFree(pv)       (free(pv))
+
+/* Single threaded: the tick count is advanced by the test, the event task is never started */
+typedef uint32_t portTickType;
+typedef void *xSemaphoreHandle;
+typedef void *xQueueHandle;
+typedef void *xTaskHandle;
+typedef long portBASE_TYPE;
+
+#define pdTRUE           1
+#define pdFALSE          0
+#define portMAX_DELAY    ((portTickType)0xffffffff)
+#define portTICK_RATE_MS ((portTickType)1)
+#define tskIDLE_PRIORITY 0
+#define configMINIMAL_STACK_SIZE 128
+
+extern portTickType xTaskGetTickCount(void);
+extern xQueueHandle xQueueCreate(portBASE_TYPE uxQueueLength, portBASE_TYPE uxItemSize);
+extern portBASE_TYPE xQueueSend(xQueueHandle xQueue, const void *pvItemToQueue, portTickType xTicksToWait);
+extern portBASE_TYPE xQueueReceive(xQueueHandle xQueue, void *pvBuffer, portTickType xTicksToWait);
+
+typedef void (*pdTASK_CODE)(void *);
+extern portBASE_TYPE xTaskCreate(pdTASK_CODE pvTaskCode, const signed char *pcName, uint16_t usStackDepth,
+                                 void *pvParameters, unsigned long uxPriority, xTaskHandle *pxCreatedTask);
+
+#define xSemaphoreCreateRecursiveMutex() ((xSemaphoreHandle)1)
+
+static inline long xSemaphoreTakeRecursive(__attribute__((unused)) xSemaphoreHandle xMutex, __attribute__((unused)) portTickType xBlockTime)
+{
+    return pdTRUE;
+}
+static inline long xSemaphoreGiveRecursive(__attribute__((unused)) xSemaphoreHandle xMutex)
+{
+    return pdTRUE;
+}
+
+#endif /* FREERTOS_H */
@@ -0,0 +1,78 @@
+/*
+ * FreeRTOS stubs for the dispatcher. Its event task is not started, the
+ * test runs it until a given time, the clock jumps to each wake up time.
+ */
+
+#include <setjmp.h>
+
+#include "openpilot.h"
+#include "eventdispatcher_ut_priv.h"
+
+portTickType ut_tick_count;
+bool ut_queue_full;
+uint32_t ut_queue_sends;
+
+static pdTASK_CODE event_task;
+static portTickType run_end;
+static jmp_buf run_done;
+
+portTickType xTaskGetTickCount(void)
+{
+    return ut_tick_count;
+}
+
+portBASE_TYPE xTaskCreate(pdTASK_CODE pvTaskCode, __attribute__((unused)) const signed char *pcName,
+                          __attribute__((unused)) uint16_t usStackDepth, __attribute__((unused)) void *pvParameters,
+                          __attribute__((unused)) unsigned long uxPriority, xTaskHandle *pxCreatedTask)
+{
+    event_task     = pvTaskCode;
+    *pxCreatedTask = NULL;
+    return pdTRUE;
+}
+
+xQueueHandle xQueueCreate(__attribute__((unused)) portBASE_TYPE uxQueueLength, __attribute__((unused)) portBASE_TYPE uxItemSize)
+{
+    return (xQueueHandle)1;
+}
+
+portBASE_TYPE xQueueSend(__attribute__((unused)) xQueueHandle xQueue, __attribute__((unused)) const void *pvItemToQueue,
+                         __attribute__((unused)) portTickType xTicksToWait)
+{
+    ut_queue_sends++;
+    return ut_queue_full ? pdFALSE : pdTRUE;
+}
+
+/* Only the event task waits on a queue, nothing is ever sent to it */
+portBASE_TYPE xQueueReceive(__attribute__((unused)) xQueueHandle xQueue, __attribute__((unused)) void *pvBuffer,
+                            portTickType xTicksToWait)
+{
+    if (xTicksToWait > run_end - ut_tick_count) {
+        ut_tick_count = run_end;
+        longjmp(run_done, 1);
+    }
+    ut_tick_count += xTicksToWait;
+    return pdFALSE;
+}
+
+uint32_t PIOS_DELAY_GetRaw(void)
+{
+    return 0;
+}
+
+uint32_t PIOS_DELAY_DiffuS(__attribute__((unused)) uint32_t raw)
+{
+    return 0;
+}
+
+uint32_t UAVObjGetID(UAVObjHandle obj)
+{
+    return (uint32_t)(uintptr_t)obj;
+}
+
+void ut_run_event_task(portTickType end)
+{
+    run_end = end;
+    if (setjmp(run_done) == 0) {
+        event_task(NULL);
+    }
+}
@@ -0,0 +1,14 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+
+/* Current time as returned by xTaskGetTickCount */
+extern portTickType ut_tick_count;
+
+/* Run the event task from the current time until the given one, it starts with a pass over the periodic updates */
+void ut_run_event_task(portTickType end);
+
+/* The event queue refuses every event while full, sends counts the attempts */
+extern bool ut_queue_full;
+extern uint32_t ut_queue_sends;
@@ -0,0 +1,20 @@
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "uavobjectmanager.h"
+#include "eventdispatcher.h"
+#include "utlist.h"
+
+#define PIOS_Assert(x) \
+    if (!(x)) { while (1) {; } \
+    }
+
+uint32_t PIOS_DELAY_GetRaw(void);
+uint32_t PIOS_DELAY_DiffuS(uint32_t raw);
+
+#endif /* OPENPILOT_H */
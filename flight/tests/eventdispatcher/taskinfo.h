@@ -0,0 +1,7 @@
+#ifndef TASKINFO_H
+#define TASKINFO_H
+
+#define TASKINFO_RUNNING_EVENTDISPATCHER 0
+#define PIOS_TASK_MONITOR_RegisterTask(task_id, handle)
+
+#endif /* TASKINFO_H */
@@ -0,0 +1,29 @@
+#ifndef UAVOBJECTMANAGER_H
+#define UAVOBJECTMANAGER_H
+
+#include <stdint.h>
+
+/* The parts of the object manager used by the event dispatcher */
+typedef void *UAVObjHandle;
+
+typedef enum {
+    EV_NONE             = 0x00,
+    EV_UNPACKED         = 0x01,
+    EV_UPDATED          = 0x02,
+    EV_UPDATED_MANUAL   = 0x04,
+    EV_UPDATED_PERIODIC = 0x08,
+    EV_UPDATE_REQ       = 0x10
+} UAVObjEventType;
+
+typedef struct {
+    UAVObjHandle    obj;
+    uint16_t        instId;
+    uint16_t        seq;
+    UAVObjEventType event;
+} UAVObjEvent;
+
+typedef void (*UAVObjEventCallback)(UAVObjEvent *ev);
+
+uint32_t UAVObjGetID(UAVObjHandle obj);
+
+#endif /* UAVOBJECTMANAGER_H */
@@ -0,0 +1,201 @@
+#include "gtest/gtest.h"
+
+#include <string.h> /* memset */
+
+extern "C" {
+#include "openpilot.h"
+#include "eventdispatcher_ut_priv.h"
+}
+
+/* Long enough after boot that a relative due time would stand out */
+#define UPTIME_MS 100000
+
+#define MAX_EVENTS 4
+
+static uint32_t dispatched[MAX_EVENTS];
+static portTickType last_dispatch[MAX_EVENTS];
+
+static void count_event(UAVObjEvent *ev)
+{
+    uint32_t n = (uint32_t)(uintptr_t)ev->obj;
+
+    dispatched[n]++;
+    last_dispatch[n] = ut_tick_count;
+}
+
+static uint16_t worst_lateness;
+
+static void collect_lateness(__attribute__((unused)) const UAVObjEvent *ev, __attribute__((unused)) uint16_t periodMs,
+                             uint16_t maxLatenessMs, __attribute__((unused)) uint16_t maxDispatchUs)
+{
+    if (maxLatenessMs > worst_lateness) {
+        worst_lateness = maxLatenessMs;
+    }
+}
+
+class EventDispatcherTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        memset(dispatched, 0, sizeof(dispatched));
+        memset(last_dispatch, 0, sizeof(last_dispatch));
+        ut_tick_count  = UPTIME_MS;
+        ut_queue_full  = false;
+        ut_queue_sends = 0;
+        ASSERT_EQ(0, EventDispatcherInitialize());
+    }
+
+    void event(uint32_t n, UAVObjEvent *ev)
+    {
+        memset(ev, 0, sizeof(*ev));
+        ev->obj   = (UAVObjHandle)(uintptr_t)n;
+        ev->event = EV_UPDATED_PERIODIC;
+    }
+
+    /* Run the event task until the given time */
+    void run_until(portTickType time)
+    {
+        ut_run_event_task(time);
+    }
+
+    uint16_t lateness()
+    {
+        worst_lateness = 0;
+        EventPeriodicIterateStats(&collect_lateness);
+        return worst_lateness;
+    }
+};
+
+TEST_F(EventDispatcherTest, CreatedEventFiresRightAway) {
+    UAVObjEvent ev;
+
+    event(0, &ev);
+    ASSERT_EQ(0, EventPeriodicCallbackCreate(&ev, count_event, 100));
+
+    /* Sent on the first pass of the event task */
+    run_until(UPTIME_MS);
+    EXPECT_EQ(1U, dispatched[0]);
+    EXPECT_EQ((portTickType)UPTIME_MS, last_dispatch[0]);
+
+    /* The next one somewhere within the first period */
+    run_until(UPTIME_MS + 100);
+    EXPECT_EQ(2U, dispatched[0]);
+    EXPECT_GT(last_dispatch[0], (portTickType)UPTIME_MS);
+    EXPECT_EQ(0, lateness());
+
+    EventStats stats;
+    EventGetStats(&stats);
+    EXPECT_EQ(0U, stats.maxLatenessMs);
+    EXPECT_EQ(0U, stats.eventErrors);
+}
+
+TEST_F(EventDispatcherTest, UpdatedPeriodWaitsForItsPeriod) {
+    UAVObjEvent ev;
+
+    event(0, &ev);
+    ASSERT_EQ(0, EventPeriodicCallbackCreate(&ev, count_event, 1000));
+    run_until(UPTIME_MS + 1000);
+    ASSERT_EQ(2U, dispatched[0]);
+
+    ASSERT_EQ(0, EventPeriodicCallbackUpdate(&ev, count_event, 50));
+    portTickType updated = ut_tick_count;
+    dispatched[0] = 0;
+    run_until(updated + 50);
+    EXPECT_EQ(1U, dispatched[0]);
+    EXPECT_EQ(0, lateness());
+
+    /* A zero period stops the updates */
+    ASSERT_EQ(0, EventPeriodicCallbackUpdate(&ev, count_event, 0));
+    dispatched[0] = 0;
+    run_until(ut_tick_count + 500);
+    EXPECT_EQ(0U, dispatched[0]);
+
+    /* Enabled again, it fires right away like a new event */
+    ASSERT_EQ(0, EventPeriodicCallbackUpdate(&ev, count_event, 50));
+    run_until(ut_tick_count);
+    EXPECT_EQ(1U, dispatched[0]);
+}
+
+TEST_F(EventDispatcherTest, PeriodsKept) {
+    static const uint16_t periods[MAX_EVENTS] = { 10, 40, 100, 250 };
+    UAVObjEvent ev;
+
+    for (uint32_t n = 0; n < MAX_EVENTS; n++) {
+        event(n, &ev);
+        ASSERT_EQ(0, EventPeriodicCallbackCreate(&ev, count_event, periods[n]));
+    }
+    run_until(UPTIME_MS + 10000);
+
+    /* One right away, then one per period whatever the phase */
+    for (uint32_t n = 0; n < MAX_EVENTS; n++) {
+        EXPECT_EQ(10000U / periods[n] + 1, dispatched[n]) << "period " << periods[n];
+        EXPECT_GT(last_dispatch[n] + periods[n], (portTickType)UPTIME_MS + 10000) << "period " << periods[n];
+    }
+    EXPECT_EQ(0, lateness());
+}
+
+TEST_F(EventDispatcherTest, UpdatedPeriodKeepsPhase) {
+    UAVObjEvent ev;
+    portTickType before[MAX_EVENTS];
+
+    for (uint32_t n = 0; n < MAX_EVENTS; n++) {
+        event(n, &ev);
+        ASSERT_EQ(0, EventPeriodicCallbackCreate(&ev, count_event, 100));
+    }
+    run_until(UPTIME_MS + 1000);
+    memcpy(before, last_dispatch, sizeof(before));
+
+    /* Slowing all of them down at once moves each next update out by the difference */
+    for (uint32_t n = 0; n < MAX_EVENTS; n++) {
+        event(n, &ev);
+        ASSERT_EQ(0, EventPeriodicCallbackUpdate(&ev, count_event, 133));
+    }
+    memset(dispatched, 0, sizeof(dispatched));
+    run_until(UPTIME_MS + 1000 + 133);
+    for (uint32_t n = 0; n < MAX_EVENTS; n++) {
+        EXPECT_EQ(1U, dispatched[n]);
+        EXPECT_EQ(before[n] + 133, last_dispatch[n]);
+    }
+
+    /* Speeding them up again keeps them on the grid of their last update */
+    memcpy(before, last_dispatch, sizeof(before));
+    for (uint32_t n = 0; n < MAX_EVENTS; n++) {
+        event(n, &ev);
+        ASSERT_EQ(0, EventPeriodicCallbackUpdate(&ev, count_event, 50));
+    }
+    portTickType updated = ut_tick_count;
+    memset(dispatched, 0, sizeof(dispatched));
+    run_until(updated + 50);
+    for (uint32_t n = 0; n < MAX_EVENTS; n++) {
+        EXPECT_EQ(1U, dispatched[n]);
+        EXPECT_EQ(0U, (last_dispatch[n] - before[n]) % 50);
+    }
+    EXPECT_EQ(0, lateness());
+}
+
+TEST_F(EventDispatcherTest, UpdatedPeriodWithFullQueue) {
+    UAVObjEvent ev;
+
+    ut_queue_full = true;
+    for (uint32_t n = 0; n < MAX_EVENTS; n++) {
+        event(n, &ev);
+        ASSERT_EQ(0, EventPeriodicQueueCreate(&ev, (xQueueHandle)1, 100));
+    }
+    run_until(UPTIME_MS + 1000);
+
+    EventStats stats;
+    EventGetStats(&stats);
+    EXPECT_EQ(MAX_EVENTS * 11U, stats.eventErrors);
+
+    /* The events the queue refused are not made up for after a rate change */
+    for (uint32_t step = 0; step < 4; step++) {
+        for (uint32_t n = 0; n < MAX_EVENTS; n++) {
+            event(n, &ev);
+            ASSERT_EQ(0, EventPeriodicQueueUpdate(&ev, (xQueueHandle)1, 100 + 25 * (step + 1)));
+        }
+        ut_queue_sends = 0;
+        run_until(ut_tick_count + 100 + 25 * (step + 1));
+        EXPECT_EQ((uint32_t)MAX_EVENTS, ut_queue_sends) << "step " << step;
+    }
+    EXPECT_EQ(0, lateness());
+}
@@ -0,0 +1,313 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <string.h> /* memset */
+#include <time.h> /* clock */
+#include <pthread.h>
+
+extern "C" {
+#include "fifo_buffer.h"
+}
+
+/* Odd size so the indexes wrap at every offset */
+#define FIFO_SIZE       67
+
+#define STREAM_BYTES    (4 * 1024 * 1024)
+#define BENCH_FIFO_SIZE 1024
+#define BENCH_BYTES     (64 * 1024 * 1024)
+#define BENCH_CHUNK     64
+
+class FifoBufferTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        memset(mem, 0, sizeof(mem));
+        fifoBuf_init(&fifo, mem, sizeof(mem));
+    }
+
+    uint8_t mem[FIFO_SIZE];
+    t_fifo_buffer fifo;
+};
+
+TEST_F(FifoBufferTest, Empty) {
+    uint8_t buf[FIFO_SIZE];
+    uint16_t len;
+
+    EXPECT_EQ(FIFO_SIZE - 1, fifoBuf_getSize(&fifo));
+    EXPECT_EQ(0, fifoBuf_getUsed(&fifo));
+    EXPECT_EQ(FIFO_SIZE - 1, fifoBuf_getFree(&fifo));
+    EXPECT_EQ(-1, fifoBuf_getByte(&fifo));
+    EXPECT_EQ(-1, fifoBuf_getBytePeek(&fifo));
+    EXPECT_EQ(0, fifoBuf_getData(&fifo, buf, sizeof(buf)));
+
+    fifoBuf_getBlockPeek(&fifo, &len);
+    EXPECT_EQ(0, len);
+}
+
+TEST_F(FifoBufferTest, Full) {
+    uint8_t buf[FIFO_SIZE];
+    uint16_t len;
+
+    memset(buf, 0xAA, sizeof(buf));
+    EXPECT_EQ(FIFO_SIZE - 1, fifoBuf_putData(&fifo, buf, sizeof(buf)));
+    EXPECT_EQ(FIFO_SIZE - 1, fifoBuf_getUsed(&fifo));
+    EXPECT_EQ(0, fifoBuf_getFree(&fifo));
+    EXPECT_EQ(0, fifoBuf_putByte(&fifo, 0x55));
+    EXPECT_EQ(0, fifoBuf_putData(&fifo, buf, 1));
+
+    fifoBuf_putBlockReserve(&fifo, &len);
+    EXPECT_EQ(0, len);
+}
+
+TEST_F(FifoBufferTest, BulkWraps) {
+    uint8_t in[FIFO_SIZE];
+    uint8_t out[FIFO_SIZE];
+    uint8_t next = 0;
+
+    /* Move the indexes through every offset with every length */
+    for (uint16_t shift = 0; shift < FIFO_SIZE; shift++) {
+        for (uint16_t len = 1; len < FIFO_SIZE; len++) {
+            for (uint16_t i = 0; i < len; i++) {
+                in[i] = next + i;
+            }
+            ASSERT_EQ(len, fifoBuf_putData(&fifo, in, len));
+            ASSERT_EQ(len, fifoBuf_getUsed(&fifo));
+            ASSERT_EQ(len, fifoBuf_getDataPeek(&fifo, out, sizeof(out)));
+            ASSERT_EQ(0, memcmp(in, out, len));
+            memset(out, 0, sizeof(out));
+            ASSERT_EQ(len, fifoBuf_getData(&fifo, out, sizeof(out)));
+            ASSERT_EQ(0, memcmp(in, out, len));
+            ASSERT_EQ(0, fifoBuf_getUsed(&fifo));
+            next += len;
+        }
+        fifoBuf_putByte(&fifo, 0);
+        fifoBuf_getByte(&fifo);
+    }
+}
+
+TEST_F(FifoBufferTest, ReserveCommit) {
+    uint8_t out[FIFO_SIZE];
+    uint16_t len;
+
+    /* Leave the write index 10 bytes short of the end */
+    uint8_t skip[FIFO_SIZE - 10] = { 0 };
+    fifoBuf_putData(&fifo, skip, sizeof(skip));
+    fifoBuf_removeData(&fifo, 20);
+
+    /* Contiguous up to the end of the memory */
+    uint8_t *p = fifoBuf_putBlockReserve(&fifo, &len);
+    EXPECT_EQ(mem + FIFO_SIZE - 10, p);
+    EXPECT_EQ(10, len);
+    memset(p, 0x11, len);
+    fifoBuf_putBlockCommit(&fifo, len);
+
+    /* Then from the start, one byte short of the read index */
+    p = fifoBuf_putBlockReserve(&fifo, &len);
+    EXPECT_EQ(mem, p);
+    EXPECT_EQ(19, len);
+    memset(p, 0x22, 5);
+    fifoBuf_putBlockCommit(&fifo, 5);
+
+    EXPECT_EQ(FIFO_SIZE - 10 - 20 + 15, fifoBuf_getUsed(&fifo));
+    fifoBuf_removeData(&fifo, FIFO_SIZE - 10 - 20);
+    EXPECT_EQ(15, fifoBuf_getData(&fifo, out, sizeof(out)));
+    for (int i = 0; i < 15; i++) {
+        EXPECT_EQ(i < 10 ? 0x11 : 0x22, out[i]);
+    }
+}
+
+TEST_F(FifoBufferTest, ReserveFromStart) {
+    uint16_t len;
+
+    /* With the read index at the start one byte tells full from empty */
+    uint8_t *p = fifoBuf_putBlockReserve(&fifo, &len);
+    EXPECT_EQ(mem, p);
+    EXPECT_EQ(FIFO_SIZE - 1, len);
+    fifoBuf_putBlockCommit(&fifo, len);
+    EXPECT_EQ(0, fifoBuf_getFree(&fifo));
+}
+
+TEST_F(FifoBufferTest, PeekRemove) {
+    uint8_t in[FIFO_SIZE];
+    uint16_t len;
+
+    for (int i = 0; i < FIFO_SIZE; i++) {
+        in[i] = i;
+    }
+
+    /* Wrap the data around the end of the memory */
+    fifoBuf_putData(&fifo, in, FIFO_SIZE - 7);
+    fifoBuf_removeData(&fifo, FIFO_SIZE - 7);
+    ASSERT_EQ(20, fifoBuf_putData(&fifo, in, 20));
+
+    const uint8_t *p = fifoBuf_getBlockPeek(&fifo, &len);
+    EXPECT_EQ(mem + FIFO_SIZE - 7, p);
+    EXPECT_EQ(7, len);
+    EXPECT_EQ(0, memcmp(in, p, len));
+
+    /* Peeking leaves the data in place */
+    EXPECT_EQ(20, fifoBuf_getUsed(&fifo));
+    fifoBuf_removeData(&fifo, len);
+
+    p = fifoBuf_getBlockPeek(&fifo, &len);
+    EXPECT_EQ(mem, p);
+    EXPECT_EQ(13, len);
+    EXPECT_EQ(0, memcmp(in + 7, p, len));
+    fifoBuf_removeData(&fifo, len);
+    EXPECT_EQ(0, fifoBuf_getUsed(&fifo));
+}
+
+/*
+ * A producer and a consumer thread with no locking in between, as an
+ * interrupt handler and a task would use the buffer.  Both sides mix the
+ * copying and the zero copy calls and check a counting pattern.
+ */
+struct stream {
+    t_fifo_buffer *fifo;
+    uint32_t bytes;
+    uint32_t errors;
+};
+
+static void *stream_producer(void *arg)
+{
+    struct stream *s = (struct stream *)arg;
+    uint8_t buf[FIFO_SIZE];
+    uint8_t next = 0;
+    uint32_t sent = 0;
+    uint32_t n = 0;
+
+    while (sent < s->bytes) {
+        uint16_t len = 1 + (n++ % (FIFO_SIZE - 1));
+        if (len > s->bytes - sent) {
+            len = s->bytes - sent;
+        }
+        if (n & 1) {
+            for (uint16_t i = 0; i < len; i++) {
+                buf[i] = next + i;
+            }
+            len = fifoBuf_putData(s->fifo, buf, len);
+        } else {
+            uint16_t room;
+            uint8_t *p = fifoBuf_putBlockReserve(s->fifo, &room);
+            if (len > room) {
+                len = room;
+            }
+            for (uint16_t i = 0; i < len; i++) {
+                p[i] = next + i;
+            }
+            fifoBuf_putBlockCommit(s->fifo, len);
+        }
+        next += len;
+        sent += len;
+        if (len == 0) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *stream_consumer(void *arg)
+{
+    struct stream *s = (struct stream *)arg;
+    uint8_t buf[FIFO_SIZE];
+    uint8_t expected = 0;
+    uint32_t received = 0;
+    uint32_t n = 0;
+
+    while (received < s->bytes) {
+        uint16_t len = 0;
+        const uint8_t *p = buf;
+        switch (n++ % 3) {
+        case 0:
+            len = fifoBuf_getData(s->fifo, buf, 1 + (n % (FIFO_SIZE - 1)));
+            break;
+        case 1:
+            p = fifoBuf_getBlockPeek(s->fifo, &len);
+            break;
+        case 2:
+        {
+            int16_t b = fifoBuf_getByte(s->fifo);
+            if (b >= 0) {
+                buf[0] = b;
+                len    = 1;
+            }
+            break;
+        }
+        }
+        for (uint16_t i = 0; i < len; i++) {
+            s->errors += (p[i] != (uint8_t)(expected + i));
+        }
+        if (p != buf) {
+            fifoBuf_removeData(s->fifo, len);
+        }
+        expected += len;
+        received += len;
+        if (len == 0) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+TEST_F(FifoBufferTest, ProducerConsumerThreads) {
+    struct stream s = { &fifo, STREAM_BYTES, 0 };
+    pthread_t producer, consumer;
+
+    ASSERT_EQ(0, pthread_create(&consumer, NULL, stream_consumer, &s));
+    ASSERT_EQ(0, pthread_create(&producer, NULL, stream_producer, &s));
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+
+    EXPECT_EQ(0u, s.errors);
+    EXPECT_EQ(0, fifoBuf_getUsed(&fifo));
+}
+
+/* Throughput through a serial port sized buffer, byte at a time against bulk and zero copy */
+TEST(FifoBufferBenchmark, Throughput) {
+    static uint8_t mem[BENCH_FIFO_SIZE];
+    uint8_t chunk[BENCH_CHUNK];
+    t_fifo_buffer fifo;
+    double seconds[3];
+    clock_t start;
+
+    memset(chunk, 0x5A, sizeof(chunk));
+    fifoBuf_init(&fifo, mem, sizeof(mem));
+
+    start = clock();
+    for (uint32_t n = 0; n < BENCH_BYTES; n += BENCH_CHUNK) {
+        for (uint16_t i = 0; i < BENCH_CHUNK; i++) {
+            fifoBuf_putByte(&fifo, chunk[i]);
+        }
+        for (uint16_t i = 0; i < BENCH_CHUNK; i++) {
+            fifoBuf_getByte(&fifo);
+        }
+    }
+    seconds[0] = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (uint32_t n = 0; n < BENCH_BYTES; n += BENCH_CHUNK) {
+        fifoBuf_putData(&fifo, chunk, BENCH_CHUNK);
+        fifoBuf_getData(&fifo, chunk, BENCH_CHUNK);
+    }
+    seconds[1] = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (uint32_t n = 0; n < BENCH_BYTES; n += BENCH_CHUNK) {
+        uint16_t len;
+        uint8_t *p = fifoBuf_putBlockReserve(&fifo, &len);
+        if (len > BENCH_CHUNK) {
+            len = BENCH_CHUNK;
+        }
+        memset(p, 0x5A, len);
+        fifoBuf_putBlockCommit(&fifo, len);
+
+        fifoBuf_getBlockPeek(&fifo, &len);
+        fifoBuf_removeData(&fifo, len);
+    }
+    seconds[2] = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    EXPECT_EQ(0, fifoBuf_getUsed(&fifo));
+    printf("%u byte chunks: bytes %.1f MB/s, bulk %.1f MB/s, zero copy %.1f MB/s\n",
+           BENCH_CHUNK, BENCH_BYTES / seconds[0] / 1e6, BENCH_BYTES / seconds[1] / 1e6,
+           BENCH_BYTES / seconds[2] / 1e6);
+}
@@ -297,6 +297,245 @@ TEST_F(LogfsTestCooked, WriteManyVerify) {
     EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
 }
 
+#define BOOT_NUM_OBJS 40U
+
+TEST_F(LogfsTestCooked, BootLoadManyVerify) {
+    /* Write a settings-like collection of objects, each saved twice to leave obsolete slots behind */
+    for (uint32_t pass = 0; pass < 2; pass++) {
+        for (uint32_t i = 0; i < BOOT_NUM_OBJS; i++) {
+            obj1[0] = i;
+            EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID + i, 0, obj1, sizeof(obj1)));
+        }
+    }
+
+    /* Remount the filesystem as done at boot */
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Destroy(fs_id));
+    uint32_t reads = PIOS_Flash_UT_GetReadCount(flash_id);
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_a, &pios_ut_flash_driver, flash_id));
+    uint32_t mount_reads = PIOS_Flash_UT_GetReadCount(flash_id) - reads;
+
+    /* Load everything back, each object costs a slot header and a data read */
+    reads = PIOS_Flash_UT_GetReadCount(flash_id);
+    unsigned char obj1_check[OBJ1_SIZE];
+    for (uint32_t i = 0; i < BOOT_NUM_OBJS; i++) {
+        obj1[0] = i;
+        memset(obj1_check, 0, sizeof(obj1_check));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID + i, 0, obj1_check, sizeof(obj1_check)));
+        EXPECT_EQ(0, memcmp(obj1, obj1_check, sizeof(obj1)));
+    }
+    uint32_t load_reads = PIOS_Flash_UT_GetReadCount(flash_id) - reads;
+
+    RecordProperty("MountFlashReads", mount_reads);
+    RecordProperty("LoadFlashReads", load_reads);
+    EXPECT_GE(flashfs_config_partition_a.total_fs_size / flashfs_config_partition_a.arena_size
+              + flashfs_config_partition_a.arena_size / flashfs_config_partition_a.slot_size, mount_reads);
+    EXPECT_EQ(2 * BOOT_NUM_OBJS, load_reads);
+
+    /* Objects that were never saved are not looked for in flash */
+    reads = PIOS_Flash_UT_GetReadCount(flash_id);
+    EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ2_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(reads, PIOS_Flash_UT_GetReadCount(flash_id));
+}
+
+TEST_F(LogfsTestCooked, IndexOverflowVerify) {
+    /* Write more objects than the RAM index can hold */
+    uint32_t num_objs = (flashfs_config_partition_a.arena_size / flashfs_config_partition_a.slot_size) - 2;
+
+    for (uint32_t i = 0; i < num_objs; i++) {
+        obj1[0] = i;
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i, obj1, sizeof(obj1)));
+    }
+
+    /* Remount, then delete and rewrite objects on both sides of the index limit */
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Destroy(fs_id));
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_a, &pios_ut_flash_driver, flash_id));
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ1_ID, 0));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ1_ID, num_objs - 1));
+    EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, num_objs - 1, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, num_objs - 1, obj1_alt, sizeof(obj1_alt)));
+
+    for (uint32_t i = 1; i < num_objs - 1; i++) {
+        obj1[0] = i;
+        memset(obj1_check, 0, sizeof(obj1_check));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, i, obj1_check, sizeof(obj1_check)));
+        EXPECT_EQ(0, memcmp(obj1, obj1_check, sizeof(obj1)));
+    }
+
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, num_objs - 1, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+}
+
+TEST_F(LogfsTestCooked, NoIndexVerify) {
+    /* A board without RAM for an index finds every object by scanning the log */
+    static struct flashfs_logfs_cfg no_index_cfg;
+
+    no_index_cfg = flashfs_config_partition_a;
+    no_index_cfg.index_size = 0;
+
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ2_ID, 0, obj2, sizeof(obj2)));
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Destroy(fs_id));
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &no_index_cfg, &pios_ut_flash_driver, flash_id));
+
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1_alt, sizeof(obj1_alt)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ2_ID, 0));
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+
+    unsigned char obj2_check[OBJ2_SIZE];
+    EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ2_ID, 0, obj2_check, sizeof(obj2_check)));
+}
+
+TEST_F(LogfsTestCooked, BackgroundGarbageCollect) {
+    struct PIOS_FLASHFS_Stats stats;
+    uint32_t num_slots = flashfs_config_partition_a.arena_size / flashfs_config_partition_a.slot_size;
+    uint32_t saves     = 0;
+
+    /* Write objects for gc to copy, obj3 gets deleted after it has been copied */
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ3_ID, 0, obj3, sizeof(obj3)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ2_ID, 0, obj2, sizeof(obj2)));
+    saves += 2;
+
+    /* Rewrite obj1 until the log runs low on free slots and gc starts in the background */
+    while (PIOS_FLASHFS_Idle(fs_id) == 0) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+        saves++;
+        ASSERT_GT(num_slots, saves);
+    }
+
+    /* The saves left gc to the background and the log is not full */
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(0, stats.num_gc_runs);
+    EXPECT_LT(0, stats.num_free_slots);
+
+    /* Run gc to completion, saving and deleting along the way */
+    uint32_t steps = 1;
+    int32_t rc;
+    do {
+        uint32_t reads = PIOS_Flash_UT_GetReadCount(flash_id);
+        rc = PIOS_FLASHFS_Idle(fs_id);
+        EXPECT_LE(0, rc);
+        steps++;
+        if (rc == 1) {
+            /* Steps are bounded, only the final one remounts the log */
+            EXPECT_GT(num_slots, PIOS_Flash_UT_GetReadCount(flash_id) - reads);
+        }
+        if (steps == 10) {
+            EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ3_ID, 0));
+            EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1_alt, sizeof(obj1_alt)));
+            saves++;
+        }
+    } while (rc == 1);
+    EXPECT_LT(10U, steps);
+
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(1, stats.num_gc_runs);
+    EXPECT_EQ(steps, stats.gc_last_steps);
+    EXPECT_EQ(saves, stats.num_slots_written);
+    EXPECT_LE(2U, stats.num_slots_copied);
+    EXPECT_GE(4U, stats.num_slots_copied);
+    EXPECT_LE(num_slots - 6, stats.num_free_slots);
+
+    /* Check the contents, also after remounting */
+    for (uint32_t mount = 0; mount < 2; mount++) {
+        unsigned char obj1_check[OBJ1_SIZE];
+        memset(obj1_check, 0, sizeof(obj1_check));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+        EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+
+        unsigned char obj2_check[OBJ2_SIZE];
+        memset(obj2_check, 0, sizeof(obj2_check));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ2_ID, 0, obj2_check, sizeof(obj2_check)));
+        EXPECT_EQ(0, memcmp(obj2, obj2_check, sizeof(obj2)));
+
+        unsigned char obj3_check[OBJ3_SIZE];
+        EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ3_ID, 0, obj3_check, sizeof(obj3_check)));
+
+        EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Destroy(fs_id));
+        EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_a, &pios_ut_flash_driver, flash_id));
+    }
+}
+
+struct batch_entry {
+    uint32_t obj_id;
+    uint8_t  *obj_data;
+    uint16_t obj_size;
+};
+
+struct batch {
+    struct batch_entry *entries;
+    uint32_t num_entries;
+    uint32_t next;
+};
+
+static bool batch_next(void *context, uint32_t *obj_id, uint16_t *obj_inst_id, uint8_t **obj_data, uint16_t *obj_size)
+{
+    struct batch *b = (struct batch *)context;
+
+    if (b->next >= b->num_entries) {
+        return false;
+    }
+    *obj_id      = b->entries[b->next].obj_id;
+    *obj_inst_id = 0;
+    *obj_data    = b->entries[b->next].obj_data;
+    *obj_size    = b->entries[b->next].obj_size;
+    b->next++;
+    return true;
+}
+
+TEST_F(LogfsTestCooked, SaveBatchVerify) {
+    struct PIOS_FLASHFS_Stats stats;
+
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+
+    /* An empty batch writes nothing */
+    struct batch empty = { NULL, 0, 0 };
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSaveBatch(fs_id, batch_next, &empty));
+    EXPECT_EQ(-1, PIOS_FLASHFS_ObjSaveBatch(fs_id + 1, batch_next, &empty));
+
+    /* Replace obj1 and add obj2 and obj3 in one batch */
+    struct batch_entry entries[] = {
+        { OBJ1_ID, obj1_alt, sizeof(obj1_alt) },
+        { OBJ2_ID, obj2,     sizeof(obj2)     },
+        { OBJ3_ID, obj3,     sizeof(obj3)     },
+    };
+    struct batch b = { entries, 3, 0 };
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSaveBatch(fs_id, batch_next, &b));
+    EXPECT_EQ(3U, b.next);
+
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(4U, stats.num_slots_written);
+    EXPECT_EQ(3, stats.num_active_slots);
+
+    /* Check the contents, also after remounting */
+    for (uint32_t mount = 0; mount < 2; mount++) {
+        unsigned char obj1_check[OBJ1_SIZE];
+        memset(obj1_check, 0, sizeof(obj1_check));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+        EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+
+        unsigned char obj2_check[OBJ2_SIZE];
+        memset(obj2_check, 0, sizeof(obj2_check));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ2_ID, 0, obj2_check, sizeof(obj2_check)));
+        EXPECT_EQ(0, memcmp(obj2, obj2_check, sizeof(obj2)));
+
+        unsigned char obj3_check[OBJ3_SIZE];
+        memset(obj3_check, 0, sizeof(obj3_check));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ3_ID, 0, obj3_check, sizeof(obj3_check)));
+        EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
+
+        EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Destroy(fs_id));
+        EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_a, &pios_ut_flash_driver, flash_id));
+    }
+}
+
 class LogfsTestCookedMultiPart : public LogfsTestRaw {
 protected:
     virtual void SetUp()
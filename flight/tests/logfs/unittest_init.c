@@ -22,6 +22,8 @@ const struct flashfs_logfs_cfg flashfs_config_partition_a = {
     .start_offset  = 0,          /* start at the beginning of the chip */
     .sector_size   = 0x00010000, /* 64K bytes */
     .page_size     = 0x00000100, /* 256 bytes */
+
+    .index_size    = 64,         /* 512 bytes of RAM */
 };
 
 const struct flashfs_logfs_cfg flashfs_config_partition_b = {
@@ -33,4 +35,6 @@ const struct flashfs_logfs_cfg flashfs_config_partition_b = {
     .start_offset  = 0x00200000, /* start after partition a */
     .sector_size   = 0x00010000, /* 64K bytes */
     .page_size     = 0x00000100, /* 256 bytes */
+
+    .index_size    = 64,         /* 512 bytes of RAM */
 };
@@ -0,0 +1,21 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#define PIOS_INCLUDE_COM
+#define PIOS_INCLUDE_FREERTOS
+
+#include "FreeRTOS.h"
+
+#define PIOS_Assert(x) \
+    if (!(x)) { while (1) {; } \
+    }
+
+#include "pios_com.h"
+
+#endif /* PIOS_H */
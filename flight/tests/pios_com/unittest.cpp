@@ -0,0 +1,106 @@
+#include "gtest/gtest.h"
+
+#include <string.h> /* memset */
+
+extern "C" {
+#include "pios.h"
+#include "pios_com_priv.h"
+}
+
+#define TX_BUFFER_SIZE 64
+
+/* Fake driver, the test drains the tx buffer through the bound callback */
+static pios_com_callback tx_out_cb;
+static uint32_t tx_out_context;
+
+static void fake_bind_tx_cb(__attribute__((unused)) uint32_t id, pios_com_callback tx_out, uint32_t context)
+{
+    tx_out_cb      = tx_out;
+    tx_out_context = context;
+}
+
+static void fake_bind_rx_cb(__attribute__((unused)) uint32_t id, __attribute__((unused)) pios_com_callback rx_in, __attribute__((unused)) uint32_t context)
+{}
+
+static const struct pios_com_driver fake_driver = {
+    .init            = NULL,
+    .set_baud        = NULL,
+    .tx_start        = NULL,
+    .rx_start        = NULL,
+    .bind_rx_cb      = fake_bind_rx_cb,
+    .bind_tx_cb      = fake_bind_tx_cb,
+    .available       = NULL,
+    .bind_tx_span_cb = NULL,
+};
+
+class PiosComTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        memset(tx_buffer, 0, sizeof(tx_buffer));
+        ASSERT_EQ(0, PIOS_COM_Init(&com_id, &fake_driver, 0, NULL, 0, tx_buffer, sizeof(tx_buffer)));
+    }
+
+    /* Everything the driver would put on the wire */
+    uint16_t drain(uint8_t *buf, uint16_t buf_len)
+    {
+        uint16_t headroom;
+        bool need_yield;
+
+        return tx_out_cb(tx_out_context, buf, buf_len, &headroom, &need_yield);
+    }
+
+    uint8_t tx_buffer[TX_BUFFER_SIZE];
+    uint32_t com_id;
+};
+
+TEST_F(PiosComTest, SecondWriterWaitsForCommit) {
+    const uint8_t frame[8] = { 0x3c, 0x20, 0x08, 0x00, 0x11, 0x22, 0x33, 0x44 };
+    const uint8_t other[4] = { 0xaa, 0xbb, 0xcc, 0xdd };
+    uint8_t wire[TX_BUFFER_SIZE];
+
+    uint8_t *room = PIOS_COM_SendBufferReserve(com_id, sizeof(frame));
+    ASSERT_TRUE(room != NULL);
+    memcpy(room, frame, 4);
+
+    /* Another task sends on the port while the frame is half built */
+    EXPECT_EQ(-2, PIOS_COM_SendBufferNonBlocking(com_id, other, sizeof(other)));
+    EXPECT_EQ(-3, PIOS_COM_SendBuffer(com_id, other, sizeof(other)));
+    EXPECT_TRUE(PIOS_COM_SendBufferReserve(com_id, sizeof(other)) == NULL);
+
+    memcpy(&room[4], &frame[4], 4);
+    EXPECT_EQ((int32_t)sizeof(frame), PIOS_COM_SendBufferCommit(com_id, sizeof(frame)));
+
+    ASSERT_EQ(sizeof(frame), drain(wire, sizeof(wire)));
+    EXPECT_EQ(0, memcmp(wire, frame, sizeof(frame)));
+
+    /* The port takes data again once the frame is committed */
+    EXPECT_EQ((int32_t)sizeof(other), PIOS_COM_SendBufferNonBlocking(com_id, other, sizeof(other)));
+    ASSERT_EQ(sizeof(other), drain(wire, sizeof(wire)));
+    EXPECT_EQ(0, memcmp(wire, other, sizeof(other)));
+}
+
+TEST_F(PiosComTest, AbandonedReservationReleasesPort) {
+    const uint8_t other[4] = { 0xaa, 0xbb, 0xcc, 0xdd };
+    uint8_t wire[TX_BUFFER_SIZE];
+
+    uint8_t *room = PIOS_COM_SendBufferReserve(com_id, 8);
+    ASSERT_TRUE(room != NULL);
+    memset(room, 0x55, 8);
+
+    EXPECT_EQ(0, PIOS_COM_SendBufferCommit(com_id, 0));
+    EXPECT_EQ(0, drain(wire, sizeof(wire)));
+
+    EXPECT_EQ((int32_t)sizeof(other), PIOS_COM_SendBuffer(com_id, other, sizeof(other)));
+    ASSERT_EQ(sizeof(other), drain(wire, sizeof(wire)));
+    EXPECT_EQ(0, memcmp(wire, other, sizeof(other)));
+}
+
+TEST_F(PiosComTest, ReservationTooLongLeavesPortFree) {
+    const uint8_t other[4] = { 0xaa, 0xbb, 0xcc, 0xdd };
+
+    EXPECT_TRUE(PIOS_COM_SendBufferReserve(com_id, TX_BUFFER_SIZE) == NULL);
+    EXPECT_TRUE(PIOS_COM_SendBufferReserve(com_id, 0) == NULL);
+
+    EXPECT_EQ((int32_t)sizeof(other), PIOS_COM_SendBufferNonBlocking(com_id, other, sizeof(other)));
+}
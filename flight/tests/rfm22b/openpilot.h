@@ -0,0 +1,6 @@
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+#include "pios.h"
+
+#endif /* OPENPILOT_H */
@@ -0,0 +1,4 @@
+#ifndef OPLINKSETTINGS_H
+#define OPLINKSETTINGS_H
+
+#endif /* OPLINKSETTINGS_H */
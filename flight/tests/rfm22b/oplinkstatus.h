@@ -0,0 +1,15 @@
+#ifndef OPLINKSTATUS_H
+#define OPLINKSTATUS_H
+
+/* The parts of the generated object the radio driver uses */
+typedef enum {
+    OPLINKSTATUS_LINKSTATE_DISABLED     = 0,
+    OPLINKSTATUS_LINKSTATE_ENABLED      = 1,
+    OPLINKSTATUS_LINKSTATE_DISCONNECTED = 2,
+    OPLINKSTATUS_LINKSTATE_CONNECTING   = 3,
+    OPLINKSTATUS_LINKSTATE_CONNECTED    = 4
+} OPLinkStatusLinkStateOptions;
+
+#define OPLINKSTATUS_PAIRIDS_NUMELEM 4
+
+#endif /* OPLINKSTATUS_H */
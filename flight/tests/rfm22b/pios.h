@@ -0,0 +1,45 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "pios_config.h"
+#include "pios_board.h"
+
+#ifdef PIOS_INCLUDE_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#endif
+
+#define PIOS_Assert(x) \
+    if (!(x)) { while (1) {; } \
+    }
+#define PIOS_DEBUG_Assert(x) PIOS_Assert(x)
+#define DEBUG_PRINTF(level, ...)
+
+#include <pios_delay.h>
+#include <pios_sys.h>
+#include <pios_rcvr.h>
+#include <pios_com.h>
+#include <pios_spi.h>
+
+#ifdef PIOS_INCLUDE_CRC
+#include <pios_crc.h>
+#endif
+
+#ifdef PIOS_INCLUDE_RFM22B
+#include <pios_rfm22b_sim.h>
+#include <pios_rfm22b.h>
+#endif
+
+#ifdef PIOS_INCLUDE_RFM22B_COM
+#include <pios_rfm22b_com.h>
+#endif
+
+#endif /* PIOS_H */
@@ -0,0 +1,10 @@
+#ifndef PIOS_BOARD_H
+#define PIOS_BOARD_H
+
+// -------------------------
+// Reed-Solomon ECC
+// -------------------------
+
+#define RS_ECC_NPARITY 4
+
+#endif /* PIOS_BOARD_H */
@@ -0,0 +1,9 @@
+#ifndef PIOS_CONFIG_H
+#define PIOS_CONFIG_H
+
+#define PIOS_INCLUDE_CRC
+#define PIOS_INCLUDE_FREERTOS
+#define PIOS_INCLUDE_RFM22B
+#define PIOS_INCLUDE_RFM22B_COM
+
+#endif /* PIOS_CONFIG_H */
@@ -0,0 +1,303 @@
+/*
+ * One end of a simulated OPLink: the real radio driver on top of the
+ * simulated RFM22B, running the posix FreeRTOS port in its own process.
+ * The remote echoes everything it receives, the coordinator measures the
+ * link and reports back to the test over a pipe.
+ */
+
+#include "rfm22b_ut_priv.h"
+
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <fifo_buffer.h>
+#include <pios_rfm22b_priv.h>
+
+#define UT_FIFO_SIZE          1024
+#define UT_PROBE_LEN          8
+#define UT_LINK_UP_TIMEOUT_MS 10000
+#define UT_STREAM_MS          2000
+#define UT_DRAIN_MS           500
+#define UT_OUTAGE_MS          1000
+
+static struct ut_radio_cfg ut_cfg;
+static uint32_t ut_spi_id;
+static char ut_serial[PIOS_SYS_SERIAL_NUM_ASCII_LEN + 1];
+
+static t_fifo_buffer ut_tx_fifo;
+static t_fifo_buffer ut_rx_fifo;
+static uint8_t ut_tx_mem[UT_FIFO_SIZE];
+static uint8_t ut_rx_mem[UT_FIFO_SIZE];
+
+static const struct pios_exti_cfg ut_exti_cfg = {
+    .vector = PIOS_RFM22_EXT_Int,
+};
+
+static const struct pios_rfm22b_cfg ut_rfm22b_cfg = {
+    .exti_cfg  = &ut_exti_cfg,
+    .RFXtalCap = 0x7F,
+    .slave_num = 0,
+    .gpio_direction = GPIO0_TX_GPIO1_RX,
+};
+
+int32_t PIOS_SYS_SerialNumberGet(char str[PIOS_SYS_SERIAL_NUM_ASCII_LEN + 1])
+{
+    strcpy(str, ut_serial);
+    return 0;
+}
+
+int32_t PIOS_DELAY_WaituS(uint32_t uS)
+{
+    struct timespec ts = { .tv_sec = uS / 1000000, .tv_nsec = (uS % 1000000) * 1000 };
+
+    nanosleep(&ts, NULL);
+    return 0;
+}
+
+int32_t PIOS_DELAY_WaitmS(uint32_t mS)
+{
+    return PIOS_DELAY_WaituS(mS * 1000);
+}
+
+/* Give the CPU to the other end of the link while there is nothing to do */
+void vApplicationIdleHook(void)
+{
+    PIOS_DELAY_WaituS(1000);
+}
+
+static uint32_t ut_now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* COM callbacks, called from the radio driver task */
+
+static uint16_t ut_tx_out(__attribute__((unused)) uint32_t context, uint8_t *buf, uint16_t buf_len,
+                          __attribute__((unused)) uint16_t *headroom, __attribute__((unused)) bool *task_woken)
+{
+    portENTER_CRITICAL();
+    uint16_t len = fifoBuf_getData(&ut_tx_fifo, buf, buf_len);
+    portEXIT_CRITICAL();
+    return len;
+}
+
+static uint16_t ut_rx_in(__attribute__((unused)) uint32_t context, uint8_t *buf, uint16_t buf_len,
+                         __attribute__((unused)) uint16_t *headroom, __attribute__((unused)) bool *task_woken)
+{
+    /* The remote sends straight back what it receives */
+    t_fifo_buffer *fifo = ut_cfg.coordinator ? &ut_rx_fifo : &ut_tx_fifo;
+
+    portENTER_CRITICAL();
+    uint16_t len = fifoBuf_putData(fifo, buf, buf_len);
+    portEXIT_CRITICAL();
+    return len;
+}
+
+static void ut_fifo_clear(t_fifo_buffer *fifo)
+{
+    portENTER_CRITICAL();
+    fifoBuf_clearData(fifo);
+    portEXIT_CRITICAL();
+}
+
+static uint16_t ut_fifo_put(t_fifo_buffer *fifo, const uint8_t *buf, uint16_t len)
+{
+    portENTER_CRITICAL();
+    len = fifoBuf_putData(fifo, buf, len);
+    portEXIT_CRITICAL();
+    return len;
+}
+
+static uint16_t ut_fifo_get(t_fifo_buffer *fifo, uint8_t *buf, uint16_t len)
+{
+    portENTER_CRITICAL();
+    len = fifoBuf_getData(fifo, buf, len);
+    portEXIT_CRITICAL();
+    return len;
+}
+
+/**
+ * Send a probe and wait for its echo.
+ */
+static bool ut_probe(uint32_t seq, uint32_t timeout_ms, uint32_t *rtt_ms)
+{
+    uint8_t probe[UT_PROBE_LEN];
+    uint8_t echo[UT_PROBE_LEN];
+    uint16_t received = 0;
+
+    for (uint8_t i = 0; i < UT_PROBE_LEN; ++i) {
+        probe[i] = (uint8_t)(seq >> (8 * (i % 4))) ^ (0xA5 + i);
+    }
+    ut_fifo_clear(&ut_tx_fifo);
+    ut_fifo_clear(&ut_rx_fifo);
+
+    uint32_t start = ut_now_ms();
+    ut_fifo_put(&ut_tx_fifo, probe, sizeof(probe));
+    while (ut_now_ms() - start < timeout_ms) {
+        vTaskDelay(1);
+        received += ut_fifo_get(&ut_rx_fifo, echo + received, sizeof(echo) - received);
+        if (received == sizeof(echo)) {
+            *rtt_ms = ut_now_ms() - start;
+            return memcmp(probe, echo, sizeof(probe)) == 0;
+        }
+    }
+    return false;
+}
+
+/**
+ * Probe until the first echo comes back.
+ */
+static bool ut_wait_echo(uint32_t start, uint32_t *elapsed_ms)
+{
+    uint32_t rtt;
+
+    for (uint32_t seq = 0; ut_now_ms() - start < UT_LINK_UP_TIMEOUT_MS; ++seq) {
+        if (ut_probe(seq, UT_PROBE_TIMEOUT_MS / 2, &rtt)) {
+            *elapsed_ms = ut_now_ms() - start;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int ut_compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void ut_measure_rtt(struct ut_bench_result *result)
+{
+    uint32_t rtts[UT_RTT_PROBES];
+    uint32_t num = 0;
+
+    for (uint32_t seq = 0; seq < UT_RTT_PROBES; ++seq) {
+        uint32_t rtt;
+        result->probes++;
+        if (ut_probe(0x10000 + seq, UT_PROBE_TIMEOUT_MS, &rtt)) {
+            rtts[num++] = rtt;
+        } else {
+            result->probes_lost++;
+        }
+    }
+    if (num) {
+        qsort(rtts, num, sizeof(rtts[0]), ut_compare_u32);
+        result->rtt_min_ms    = rtts[0];
+        result->rtt_median_ms = rtts[num / 2];
+        result->rtt_max_ms    = rtts[num - 1];
+    }
+}
+
+/**
+ * Keep the link full with a counting pattern and count what comes back.
+ * There is no retransmission on the link, so a lost packet shows up as a
+ * gap in the pattern.
+ */
+static void ut_measure_stream(struct ut_bench_result *result)
+{
+    uint8_t buf[64];
+    uint8_t next_tx  = 0;
+    uint8_t expected = 0;
+    uint32_t last_rx = 0;
+
+    ut_fifo_clear(&ut_tx_fifo);
+    ut_fifo_clear(&ut_rx_fifo);
+
+    uint32_t start = ut_now_ms();
+    uint32_t now;
+    while ((now = ut_now_ms()) - start < UT_STREAM_MS + UT_DRAIN_MS) {
+        if (now - start < UT_STREAM_MS) {
+            uint16_t len;
+            for (len = 0; len < sizeof(buf); ++len) {
+                buf[len] = next_tx + len;
+            }
+            next_tx += ut_fifo_put(&ut_tx_fifo, buf, sizeof(buf));
+        }
+        vTaskDelay(1);
+
+        uint16_t len = ut_fifo_get(&ut_rx_fifo, buf, sizeof(buf));
+        for (uint16_t i = 0; i < len; ++i) {
+            if (buf[i] != expected) {
+                result->stream_errors++;
+            }
+            expected = buf[i] + 1;
+        }
+        if (len) {
+            result->stream_bytes += len;
+            last_rx = ut_now_ms();
+        }
+    }
+    if (last_rx > start) {
+        result->goodput_bps = (uint64_t)result->stream_bytes * 8 * 1000 / (last_rx - start);
+    }
+}
+
+static void ut_bench_task(__attribute__((unused)) void *parameters)
+{
+    struct ut_bench_result result;
+    uint32_t start = ut_now_ms();
+
+    memset(&result, 0, sizeof(result));
+    if (ut_wait_echo(start, &result.link_up_ms)) {
+        ut_measure_rtt(&result);
+        ut_measure_stream(&result);
+
+        /* Take the link down and time how long it takes to come back */
+        PIOS_RFM22B_SIM_SetLoss(ut_spi_id, 100);
+        vTaskDelay(UT_OUTAGE_MS / portTICK_RATE_MS);
+        PIOS_RFM22B_SIM_SetLoss(ut_spi_id, ut_cfg.loss);
+        result.complete = ut_wait_echo(ut_now_ms(), &result.reconnect_ms);
+    }
+    PIOS_RFM22B_SIM_GetStats(ut_spi_id, &result.sim);
+
+    if (write(ut_cfg.report_fd, &result, sizeof(result)) != sizeof(result)) {
+        _exit(1);
+    }
+    _exit(0);
+}
+
+void ut_radio_run(const struct ut_radio_cfg *cfg)
+{
+    const struct pios_rfm22b_sim_cfg sim_cfg = {
+        .port       = cfg->port,
+        .peer_port  = cfg->peer_port,
+        .loss       = cfg->loss,
+        .latency_us = cfg->latency_us,
+        .seed       = cfg->port,
+    };
+    uint32_t rfm22b_id;
+
+    ut_cfg = *cfg;
+    snprintf(ut_serial, sizeof(ut_serial), "%s%u", cfg->coordinator ? "coordinator" : "remote", cfg->port);
+    fifoBuf_init(&ut_tx_fifo, ut_tx_mem, sizeof(ut_tx_mem));
+    fifoBuf_init(&ut_rx_fifo, ut_rx_mem, sizeof(ut_rx_mem));
+
+    /* Initialise from the main thread so the device lands in the low heap */
+    if (PIOS_RFM22B_SIM_Init(&ut_spi_id, &sim_cfg) < 0 ||
+        PIOS_RFM22B_Init(&rfm22b_id, ut_spi_id, 0, &ut_rfm22b_cfg) < 0) {
+        _exit(2);
+    }
+    PIOS_RFM22B_SetTxPower(rfm22b_id, RFM22_tx_pwr_txpow_7);
+    PIOS_RFM22B_SetChannelConfig(rfm22b_id, cfg->datarate, 0, 250, 24, cfg->coordinator, false, false, false);
+    if (!cfg->coordinator) {
+        PIOS_RFM22B_SetCoordinatorID(rfm22b_id, cfg->coordinator_id);
+    }
+    pios_rfm22b_com_driver.bind_tx_cb(rfm22b_id, ut_tx_out, 0);
+    pios_rfm22b_com_driver.bind_rx_cb(rfm22b_id, ut_rx_in, 0);
+
+    if (cfg->coordinator) {
+        uint32_t device_id = PIOS_RFM22B_DeviceID(rfm22b_id);
+        if (write(cfg->report_fd, &device_id, sizeof(device_id)) != sizeof(device_id)) {
+            _exit(1);
+        }
+        xTaskCreate(ut_bench_task, (const signed char *)"Bench", 1024, NULL, tskIDLE_PRIORITY + 1, NULL);
+    }
+
+    vTaskStartScheduler();
+    _exit(3);
+}
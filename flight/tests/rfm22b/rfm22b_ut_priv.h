@@ -0,0 +1,41 @@
+#ifndef RFM22B_UT_PRIV_H
+#define RFM22B_UT_PRIV_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pios.h"
+
+/* One end of the link, run in a process of its own */
+struct ut_radio_cfg {
+    bool     coordinator;
+    uint32_t coordinator_id; /* the remote binds to this coordinator */
+    uint16_t port;
+    uint16_t peer_port;
+    uint8_t  loss;
+    uint32_t latency_us;
+    enum rfm22b_datarate datarate;
+    int      report_fd; /* the coordinator writes its device id and the results here */
+};
+
+/* What the coordinator measured over the link to the echoing remote */
+struct ut_bench_result {
+    bool     complete;
+    uint32_t link_up_ms; /* from power up until the first echo */
+    uint32_t probes;
+    uint32_t probes_lost;
+    uint32_t rtt_min_ms;
+    uint32_t rtt_median_ms;
+    uint32_t rtt_max_ms;
+    uint32_t stream_bytes; /* bytes echoed back while streaming */
+    uint32_t stream_errors; /* gaps in the echoed byte pattern */
+    uint32_t goodput_bps; /* echoed payload rate */
+    uint32_t reconnect_ms; /* from the end of an outage until the first echo */
+    struct pios_rfm22b_sim_stats sim;
+};
+
+#define UT_RTT_PROBES       20
+#define UT_PROBE_TIMEOUT_MS 1000u
+
+extern void ut_radio_run(const struct ut_radio_cfg *cfg) __attribute__((noreturn));
+
+#endif /* RFM22B_UT_PRIV_H */
@@ -0,0 +1,6 @@
+#ifndef UAVOBJECTMANAGER_H
+#define UAVOBJECTMANAGER_H
+
+/* The radio driver only needs the generated OPLink object headers */
+
+#endif /* UAVOBJECTMANAGER_H */
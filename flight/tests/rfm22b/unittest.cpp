@@ -0,0 +1,178 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+#include <string.h> /* memset */
+#include <signal.h> /* kill */
+#include <unistd.h> /* fork, pipe */
+#include <sys/wait.h> /* waitpid */
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+extern "C" {
+#include "rfm22b_ut_priv.h"
+}
+
+/*
+ * OPLink benchmark on two simulated radios.  Each end runs the unmodified
+ * radio driver and FreeRTOS in a forked process, with the radios talking
+ * over UDP on localhost.
+ */
+class RFM22BLink : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        memset(&result, 0, sizeof(result));
+        coordinator_pid = remote_pid = -1;
+    }
+
+    virtual void TearDown()
+    {
+        stop(coordinator_pid);
+        stop(remote_pid);
+    }
+
+    /* Let the kernel pick a free UDP port on localhost */
+    static uint16_t free_port(void)
+    {
+        struct sockaddr_in addr;
+        socklen_t len = sizeof(addr);
+        int fd = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+        getsockname(fd, (struct sockaddr *)&addr, &len);
+        close(fd);
+        return ntohs(addr.sin_port);
+    }
+
+    static pid_t start(const struct ut_radio_cfg *cfg)
+    {
+        pid_t pid = fork();
+
+        if (pid == 0) {
+            ut_radio_run(cfg);
+        }
+        return pid;
+    }
+
+    static void stop(pid_t pid)
+    {
+        if (pid > 0) {
+            kill(pid, SIGKILL);
+            waitpid(pid, NULL, 0);
+        }
+    }
+
+    static bool read_all(int fd, void *buf, size_t len)
+    {
+        uint8_t *p = (uint8_t *)buf;
+
+        while (len) {
+            ssize_t n = read(fd, p, len);
+            if (n <= 0) {
+                return false;
+            }
+            p   += n;
+            len -= n;
+        }
+        return true;
+    }
+
+    /* Run the benchmark over a link and collect the results of the coordinator */
+    bool run(enum rfm22b_datarate datarate, uint8_t loss, uint32_t latency_us)
+    {
+        int fds[2];
+        struct ut_radio_cfg cfg;
+        uint32_t coordinator_id;
+
+        if (pipe(fds) < 0) {
+            return false;
+        }
+
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.port       = free_port();
+        cfg.peer_port  = free_port();
+        cfg.loss       = loss;
+        cfg.latency_us = latency_us;
+        cfg.datarate   = datarate;
+        cfg.report_fd  = fds[1];
+
+        cfg.coordinator = true;
+        coordinator_pid = start(&cfg);
+        bool ok = read_all(fds[0], &coordinator_id, sizeof(coordinator_id));
+
+        if (ok) {
+            uint16_t port = cfg.port;
+            cfg.coordinator    = false;
+            cfg.coordinator_id = coordinator_id;
+            cfg.port      = cfg.peer_port;
+            cfg.peer_port = port;
+            remote_pid     = start(&cfg);
+            ok = read_all(fds[0], &result, sizeof(result));
+        }
+        close(fds[0]);
+        close(fds[1]);
+
+        printf("link up %u ms, rtt %u/%u/%u ms (min/median/max), %u/%u probes lost\n",
+               result.link_up_ms, result.rtt_min_ms, result.rtt_median_ms, result.rtt_max_ms,
+               result.probes_lost, result.probes);
+        printf("echo goodput %u bps, %u bytes with %u gaps, reconnect %u ms\n",
+               result.goodput_bps, result.stream_bytes, result.stream_errors, result.reconnect_ms);
+        printf("air: %u sent, %u received, %u lost, %u missed, %u rejected, %u aborted\n",
+               result.sim.tx_packets, result.sim.rx_packets, result.sim.lost,
+               result.sim.missed, result.sim.rejected, result.sim.aborted);
+        return ok;
+    }
+
+    struct ut_bench_result result;
+    pid_t coordinator_pid;
+    pid_t remote_pid;
+};
+
+/*
+ * The posix port runs on the wall clock and drops ticks when the host is
+ * busy, and the two ends of the link lose them at different rates.  The hop
+ * timing of the remote drifts against the coordinator then and packets go
+ * astray, so the goodput says more about the host than about the link.  This
+ * is a benchmark, run with make ut_rfm22b and left out of all_ut: the
+ * figures are the report, the checks only catch a link that is broken.
+ */
+
+/* Gaps in the echoed pattern over the UT_STREAM_MS of streaming */
+#define MAX_CLEAN_STREAM_GAPS 16u
+TEST_F(RFM22BLink, Clean64k) {
+    ASSERT_TRUE(run(RFM22_datarate_64000, 0, 0));
+    ASSERT_TRUE(result.complete);
+
+    EXPECT_LT(result.link_up_ms, 10000u);
+    EXPECT_LT(result.probes_lost, result.probes);
+    EXPECT_GT(result.rtt_min_ms, 0u);
+    EXPECT_LE(result.rtt_min_ms, result.rtt_median_ms);
+    EXPECT_LE(result.rtt_median_ms, result.rtt_max_ms);
+    EXPECT_LT(result.rtt_max_ms, UT_PROBE_TIMEOUT_MS);
+
+    /* Nothing but the radio at the other end is on the air */
+    EXPECT_EQ(0u, result.sim.rejected);
+    EXPECT_GT(result.goodput_bps, 0u);
+    EXPECT_LT(result.goodput_bps, 64000u);
+    EXPECT_LE(result.stream_errors, MAX_CLEAN_STREAM_GAPS);
+
+    EXPECT_LT(result.reconnect_ms, 10000u);
+}
+
+TEST_F(RFM22BLink, Lossy64k) {
+    ASSERT_TRUE(run(RFM22_datarate_64000, 10, 2000));
+    ASSERT_TRUE(result.complete);
+
+    /* The link comes up and back through the losses.  Lost packets are not
+     * resent, they show up as gaps in the stream */
+    EXPECT_LT(result.link_up_ms, 10000u);
+    EXPECT_GT(result.sim.lost, 0u);
+    EXPECT_LE(result.probes_lost, result.probes);
+    EXPECT_LT(result.goodput_bps, 64000u);
+
+    EXPECT_LT(result.reconnect_ms, 10000u);
+}
@@ -0,0 +1,9 @@
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+#include <stdint.h>
+
+/* Parity bytes used on the OPLink */
+#define RS_ECC_NPARITY 4
+
+#endif /* OPENPILOT_H */
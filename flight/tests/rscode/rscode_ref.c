@@ -0,0 +1,38 @@
+/*
+ * The rscode library as imported, built under a ref_ prefix so it links
+ * next to the optimised library.  The sources in ref/ are unmodified
+ * copies and pick up their own ecc.h.
+ */
+
+#define pBytes                    ref_pBytes
+#define synBytes                  ref_synBytes
+#define genPoly                   ref_genPoly
+#define DEBUG                     ref_DEBUG
+#define gexp                      ref_gexp
+#define glog                      ref_glog
+#define initialize_ecc            ref_initialize_ecc
+#define check_syndrome            ref_check_syndrome
+#define decode_data               ref_decode_data
+#define encode_data               ref_encode_data
+#define crc_ccitt                 ref_crc_ccitt
+#define init_galois_tables        ref_init_galois_tables
+#define ginv                      ref_ginv
+#define gmult                     ref_gmult
+#define correct_errors_erasures   ref_correct_errors_erasures
+#define add_polys                 ref_add_polys
+#define scale_poly                ref_scale_poly
+#define mult_polys                ref_mult_polys
+#define copy_poly                 ref_copy_poly
+#define zero_poly                 ref_zero_poly
+#define zero_fill_from            ref_zero_fill_from
+#define print_parity              ref_print_parity
+#define print_syndrome            ref_print_syndrome
+#define build_codeword            ref_build_codeword
+#define debug_check_syndrome      ref_debug_check_syndrome
+#define Modified_Berlekamp_Massey ref_Modified_Berlekamp_Massey
+#define compute_next_omega        ref_compute_next_omega
+#define Find_Roots                ref_Find_Roots
+
+#include "ref/galois.c"
+#include "ref/rs.c"
+#include "ref/berlekamp.c"
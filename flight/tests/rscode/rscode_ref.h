@@ -0,0 +1,13 @@
+#ifndef RSCODE_REF_H
+#define RSCODE_REF_H
+
+/* The rscode library as imported, kept to check the optimised one against */
+extern void ref_initialize_ecc(void);
+extern void ref_encode_data(unsigned char msg[], int nbytes, unsigned char dst[]);
+extern void ref_decode_data(unsigned char data[], int nbytes);
+extern int ref_check_syndrome(void);
+extern int ref_correct_errors_erasures(unsigned char codeword[], int csize, int nerasures, int erasures[]);
+
+extern int ref_synBytes[];
+
+#endif /* RSCODE_REF_H */
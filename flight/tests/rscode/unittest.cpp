@@ -0,0 +1,232 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <string.h> /* memcpy */
+#include <time.h> /* clock */
+#include <algorithm>
+
+extern "C" {
+#include "ecc.h"
+#include "rscode_ref.h"
+}
+
+/* Largest message that fits a codeword */
+#define MAX_MSG_LEN  (255 - RS_ECC_NPARITY)
+
+/* Packet size on the OPLink, including the parity */
+#define PACKET_LEN   255
+
+#define FUZZ_ROUNDS  20000
+#define BENCH_ROUNDS 2000
+
+class RSCodeTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        initialize_ecc();
+        ref_initialize_ecc();
+        seed = 0x12345678;
+    }
+
+    /* Reproducible xorshift generator, a failing round can be replayed */
+    uint32_t rand32(void)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+    uint32_t rand_below(uint32_t n)
+    {
+        return rand32() % n;
+    }
+
+    void random_message(uint8_t *msg, int len)
+    {
+        for (int i = 0; i < len; i++) {
+            msg[i] = rand32();
+        }
+    }
+
+    /* Flip bytes at distinct positions, returns the positions counted from the end as the decoder does */
+    int corrupt(uint8_t *codeword, int csize, int nerrors, int locs[])
+    {
+        int n = 0;
+
+        while (n < nerrors) {
+            int pos = rand_below(csize);
+            bool dup = false;
+            for (int i = 0; i < n; i++) {
+                dup |= (locs[i] == csize - pos - 1);
+            }
+            if (dup) {
+                continue;
+            }
+            codeword[pos] ^= 1 + rand_below(255);
+            locs[n++] = csize - pos - 1;
+        }
+        return n;
+    }
+
+    uint32_t seed;
+};
+
+TEST_F(RSCodeTest, EncodeMatchesReference) {
+    uint8_t msg[255];
+    uint8_t codeword[255];
+    uint8_t ref_codeword[255];
+
+    for (int round = 0; round < FUZZ_ROUNDS; round++) {
+        int len = 1 + rand_below(MAX_MSG_LEN);
+        random_message(msg, len);
+
+        encode_data(msg, len, codeword);
+        ref_encode_data(msg, len, ref_codeword);
+        ASSERT_EQ(0, memcmp(codeword, ref_codeword, len + RS_ECC_NPARITY)) << "round " << round;
+    }
+}
+
+TEST_F(RSCodeTest, EncodeInPlace) {
+    uint8_t msg[255];
+    uint8_t codeword[255];
+
+    random_message(msg, MAX_MSG_LEN);
+    encode_data(msg, MAX_MSG_LEN, codeword);
+
+    /* The radio driver encodes its packet buffer in place */
+    encode_data(msg, MAX_MSG_LEN, msg);
+    EXPECT_EQ(0, memcmp(codeword, msg, sizeof(codeword)));
+}
+
+TEST_F(RSCodeTest, ErrorFreePacket) {
+    uint8_t msg[255];
+    uint8_t codeword[255];
+
+    random_message(msg, MAX_MSG_LEN);
+    encode_data(msg, MAX_MSG_LEN, codeword);
+
+    decode_data(codeword, PACKET_LEN);
+    EXPECT_EQ(0, check_syndrome());
+    for (int i = 0; i < RS_ECC_NPARITY; i++) {
+        EXPECT_EQ(0, synBytes[i]);
+    }
+
+    /* Nothing to correct, and nothing touched */
+    EXPECT_EQ(0, correct_errors_erasures(codeword, PACKET_LEN, 0, NULL));
+    EXPECT_EQ(0, memcmp(codeword, msg, MAX_MSG_LEN));
+}
+
+TEST_F(RSCodeTest, CorrectsHalfParityErrors) {
+    uint8_t msg[255];
+    uint8_t codeword[255];
+    int locs[RS_ECC_NPARITY];
+
+    for (int round = 0; round < FUZZ_ROUNDS; round++) {
+        int len = 1 + rand_below(MAX_MSG_LEN);
+        int csize = len + RS_ECC_NPARITY;
+        random_message(msg, len);
+        encode_data(msg, len, codeword);
+
+        corrupt(codeword, csize, 1 + rand_below(RS_ECC_NPARITY / 2), locs);
+        decode_data(codeword, csize);
+        ASSERT_NE(0, check_syndrome()) << "round " << round;
+        ASSERT_EQ(1, correct_errors_erasures(codeword, csize, 0, NULL)) << "round " << round;
+        ASSERT_EQ(0, memcmp(codeword, msg, len)) << "round " << round;
+    }
+}
+
+TEST_F(RSCodeTest, CorrectsParityErasures) {
+    uint8_t msg[255];
+    uint8_t codeword[255];
+    int locs[RS_ECC_NPARITY];
+
+    for (int round = 0; round < FUZZ_ROUNDS; round++) {
+        int len = 1 + rand_below(MAX_MSG_LEN);
+        int csize = len + RS_ECC_NPARITY;
+        random_message(msg, len);
+        encode_data(msg, len, codeword);
+
+        int nerasures = corrupt(codeword, csize, 1 + rand_below(RS_ECC_NPARITY), locs);
+        decode_data(codeword, csize);
+        ASSERT_EQ(1, correct_errors_erasures(codeword, csize, nerasures, locs)) << "round " << round;
+        ASSERT_EQ(0, memcmp(codeword, msg, len)) << "round " << round;
+    }
+}
+
+/* Any damage, including more than can be corrected, gives the same result as the reference */
+TEST_F(RSCodeTest, FuzzMatchesReference) {
+    uint8_t msg[255];
+    uint8_t codeword[255];
+    uint8_t ref_codeword[255];
+    int locs[RS_ECC_NPARITY + 3];
+
+    for (int round = 0; round < FUZZ_ROUNDS; round++) {
+        int len = 1 + rand_below(MAX_MSG_LEN);
+        int csize = len + RS_ECC_NPARITY;
+        random_message(msg, len);
+        encode_data(msg, len, codeword);
+
+        int nerrors = corrupt(codeword, csize, std::min(csize, (int)rand_below(RS_ECC_NPARITY + 3)), locs);
+        /* Mark some of the damage as erasures */
+        int nerasures = rand_below(4) ? 0 : rand_below(std::min(nerrors, RS_ECC_NPARITY) + 1);
+        memcpy(ref_codeword, codeword, csize);
+
+        decode_data(codeword, csize);
+        ref_decode_data(ref_codeword, csize);
+        ASSERT_EQ(0, memcmp(synBytes, ref_synBytes, RS_ECC_NPARITY * sizeof(int))) << "round " << round;
+        ASSERT_EQ(ref_check_syndrome(), check_syndrome()) << "round " << round;
+
+        int ref_ret = ref_correct_errors_erasures(ref_codeword, csize, nerasures, locs);
+        ASSERT_EQ(ref_ret, correct_errors_erasures(codeword, csize, nerasures, locs)) << "round " << round;
+        ASSERT_EQ(0, memcmp(codeword, ref_codeword, csize)) << "round " << round;
+    }
+}
+
+/* Cost per full size packet against the reference, as on the OPLink receive path */
+TEST_F(RSCodeTest, Benchmark) {
+    static uint8_t packets[BENCH_ROUNDS][255];
+    uint8_t msg[255];
+    int locs[RS_ECC_NPARITY / 2];
+    double us[2][3];
+    clock_t start;
+
+    for (int impl = 0; impl < 2; impl++) {
+        void (*encode)(unsigned char *, int, unsigned char *) = impl ? ref_encode_data : encode_data;
+        void (*decode)(unsigned char *, int) = impl ? ref_decode_data : decode_data;
+        int (*check)(void) = impl ? ref_check_syndrome : check_syndrome;
+        int (*correct)(unsigned char *, int, int, int *) = impl ? ref_correct_errors_erasures : correct_errors_erasures;
+
+        seed = 0x12345678;
+        start = clock();
+        for (int n = 0; n < BENCH_ROUNDS; n++) {
+            random_message(msg, MAX_MSG_LEN);
+            encode(msg, MAX_MSG_LEN, packets[n]);
+        }
+        us[impl][0] = 1e6 * (clock() - start) / CLOCKS_PER_SEC / BENCH_ROUNDS;
+
+        /* Error free packets */
+        start = clock();
+        for (int n = 0; n < BENCH_ROUNDS; n++) {
+            decode(packets[n], PACKET_LEN);
+            EXPECT_EQ(0, check());
+        }
+        us[impl][1] = 1e6 * (clock() - start) / CLOCKS_PER_SEC / BENCH_ROUNDS;
+
+        /* Packets with as many errors as can be corrected */
+        for (int n = 0; n < BENCH_ROUNDS; n++) {
+            corrupt(packets[n], PACKET_LEN, RS_ECC_NPARITY / 2, locs);
+        }
+        start = clock();
+        for (int n = 0; n < BENCH_ROUNDS; n++) {
+            decode(packets[n], PACKET_LEN);
+            EXPECT_NE(0, check());
+            EXPECT_EQ(1, correct(packets[n], PACKET_LEN, 0, NULL));
+        }
+        us[impl][2] = 1e6 * (clock() - start) / CLOCKS_PER_SEC / BENCH_ROUNDS;
+    }
+
+    printf("%d byte packet, us per packet (table driven / reference):\n", PACKET_LEN);
+    printf("encode %.1f / %.1f, check clean %.1f / %.1f, correct %d errors %.1f / %.1f\n",
+           us[0][0], us[1][0], us[0][1], us[1][1], RS_ECC_NPARITY / 2, us[0][2], us[1][2]);
+}
@@ -0,0 +1,46 @@
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#define pvPortMalloc(xSize) (malloc(xSize))
+#define vPortFree(pv)       (free(pv))
+
+/* Single threaded: the tick count is advanced by the test and semaphores never block,
+ * a take that fails returns as if it waited out its whole block time */
+typedef uint32_t portTickType;
+typedef void *xSemaphoreHandle;
+
+#define pdTRUE           1
+#define pdFALSE          0
+#define portMAX_DELAY    ((portTickType)0xffffffff)
+#define portTICK_RATE_MS ((portTickType)1)
+
+extern portTickType xTaskGetTickCount(void);
+extern portTickType ut_tick_count;
+
+#define xSemaphoreCreateRecursiveMutex() ((xSemaphoreHandle)1)
+#define vSemaphoreCreateBinary(xSemaphore) ((xSemaphore) = (xSemaphoreHandle)1)
+
+static inline long xSemaphoreTake(__attribute__((unused)) xSemaphoreHandle xSemaphore, portTickType xBlockTime)
+{
+    if (xBlockTime != portMAX_DELAY) {
+        ut_tick_count += xBlockTime;
+    }
+    return pdFALSE;
+}
+static inline long xSemaphoreGive(__attribute__((unused)) xSemaphoreHandle xSemaphore)
+{
+    return pdTRUE;
+}
+static inline long xSemaphoreTakeRecursive(__attribute__((unused)) xSemaphoreHandle xMutex, __attribute__((unused)) portTickType xBlockTime)
+{
+    return pdTRUE;
+}
+static inline long xSemaphoreGiveRecursive(__attribute__((unused)) xSemaphoreHandle xMutex)
+{
+    return pdTRUE;
+}
+
+#endif /* FREERTOS_H */
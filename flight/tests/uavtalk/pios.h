@@ -0,0 +1,18 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pios_config.h"
+
+#ifdef PIOS_INCLUDE_FREERTOS
+#include "FreeRTOS.h"
+#endif
+
+#ifdef PIOS_INCLUDE_CRC
+#include <pios_crc.h>
+#endif
+
+#endif /* PIOS_H */
@@ -0,0 +1,7 @@
+#ifndef PIOS_CONFIG_H
+#define PIOS_CONFIG_H
+
+#define PIOS_INCLUDE_CRC
+#define PIOS_INCLUDE_FREERTOS
+
+#endif /* PIOS_CONFIG_H */
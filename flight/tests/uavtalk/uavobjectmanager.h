@@ -0,0 +1,21 @@
+#ifndef UAVOBJECTMANAGER_H
+#define UAVOBJECTMANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* The parts of the object manager used by UAVTalk, backed by a table of fake objects */
+#define UAVOBJ_ALL_INSTANCES 0xFFFF
+
+typedef void *UAVObjHandle;
+
+UAVObjHandle UAVObjGetByID(uint32_t id);
+uint32_t UAVObjGetID(UAVObjHandle obj);
+uint32_t UAVObjGetNumBytes(UAVObjHandle obj);
+uint16_t UAVObjGetNumInstances(UAVObjHandle obj);
+bool UAVObjIsSingleInstance(UAVObjHandle obj);
+int32_t UAVObjPack(UAVObjHandle obj_handle, uint16_t instId, uint8_t *dataOut);
+int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId, const uint8_t *dataIn);
+uint8_t UAVObjGetFieldSizes(UAVObjHandle obj_handle, const uint16_t * *fieldSizes);
+
+#endif /* UAVOBJECTMANAGER_H */
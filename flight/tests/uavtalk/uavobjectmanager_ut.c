@@ -0,0 +1,134 @@
+/*
+ * These need to be defined in a .c file so that we can use
+ * designated initializer syntax which c++ doesn't support (yet).
+ */
+
+#include "uavobjectmanager.h"
+#include "uavobjectmanager_ut_priv.h"
+
+#include <string.h>
+
+static const uint16_t systemstats_fields[] = { 4, 4, 4, 4, 4, 2, 2, 2, 2, 2, 2, 1, 1 };
+static const uint16_t flighttelemetrystats_fields[] = { 4, 4, 4, 4, 4, 4, 4, 4, 1, 2 };
+static const uint16_t gpsposition_fields[] = { 4, 4, 4, 4, 4, 4, 4, 4, 4, 1, 1 };
+static const uint16_t actuatorcommand_fields[] = { 24, 2, 2, 1 };
+
+#define UT_FIELDS(fields) .field_sizes = fields, .num_fields = sizeof(fields) / sizeof(fields[0])
+
+struct ut_object ut_objects[UT_OBJ_COUNT] = {
+    [UT_OBJ_ATTITUDEACTUAL] = {
+        .id        = 0x33DAD5E6,
+        .num_bytes = 28,
+    },
+    [UT_OBJ_GYROS] = {
+        .id        = 0x4228AF6,
+        .num_bytes = 16,
+    },
+    [UT_OBJ_FLIGHTSTATUS] = {
+        .id        = 0x9B6A127E,
+        .num_bytes = 2,
+    },
+    [UT_OBJ_MANUALCONTROLCOMMAND] = {
+        .id        = 0x161A2C98,
+        .num_bytes = 39,
+    },
+    [UT_OBJ_WAYPOINT] = {
+        .id            = 0xD23852DC,
+        .num_bytes     = 21,
+        .num_instances = 3,
+    },
+    [UT_OBJ_LARGEST] = {
+        .id        = 0x12345678,
+        .num_bytes = UAVOBJECTS_LARGEST,
+    },
+    [UT_OBJ_SYSTEMSTATS] = {
+        .id        = 0x40BFFEFC,
+        .num_bytes = 34,
+        UT_FIELDS(systemstats_fields),
+    },
+    [UT_OBJ_FLIGHTTELEMETRYSTATS] = {
+        .id        = 0x6737BB5A,
+        .num_bytes = 35,
+        UT_FIELDS(flighttelemetrystats_fields),
+    },
+    [UT_OBJ_GPSPOSITION] = {
+        .id        = 0x9DF1F67A,
+        .num_bytes = 38,
+        UT_FIELDS(gpsposition_fields),
+    },
+    [UT_OBJ_ACTUATORCOMMAND] = {
+        .id        = 0x5324CB8,
+        .num_bytes = 29,
+        UT_FIELDS(actuatorcommand_fields),
+    },
+};
+
+portTickType ut_tick_count;
+
+portTickType xTaskGetTickCount(void)
+{
+    return ut_tick_count;
+}
+
+UAVObjHandle UAVObjGetByID(uint32_t id)
+{
+    for (uint32_t i = 0; i < UT_OBJ_COUNT; i++) {
+        if (ut_objects[i].id == id) {
+            return &ut_objects[i];
+        }
+    }
+    return 0;
+}
+
+uint32_t UAVObjGetID(UAVObjHandle obj)
+{
+    return ((struct ut_object *)obj)->id;
+}
+
+uint32_t UAVObjGetNumBytes(UAVObjHandle obj)
+{
+    return ((struct ut_object *)obj)->num_bytes;
+}
+
+uint16_t UAVObjGetNumInstances(UAVObjHandle obj)
+{
+    struct ut_object *ut_obj = (struct ut_object *)obj;
+
+    return ut_obj->num_instances ? ut_obj->num_instances : 1;
+}
+
+bool UAVObjIsSingleInstance(UAVObjHandle obj)
+{
+    return ((struct ut_object *)obj)->num_instances == 0;
+}
+
+int32_t UAVObjPack(UAVObjHandle obj_handle, uint16_t instId, uint8_t *dataOut)
+{
+    struct ut_object *ut_obj = (struct ut_object *)obj_handle;
+
+    if (instId >= UAVObjGetNumInstances(obj_handle)) {
+        return -1;
+    }
+    memcpy(dataOut, ut_obj->data[instId], ut_obj->num_bytes);
+    return 0;
+}
+
+uint8_t UAVObjGetFieldSizes(UAVObjHandle obj_handle, const uint16_t * *fieldSizes)
+{
+    struct ut_object *ut_obj = (struct ut_object *)obj_handle;
+
+    *fieldSizes = ut_obj->field_sizes;
+    return ut_obj->num_fields;
+}
+
+int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId, const uint8_t *dataIn)
+{
+    struct ut_object *ut_obj = (struct ut_object *)obj_handle;
+
+    if (instId >= UAVObjGetNumInstances(obj_handle)) {
+        return -1;
+    }
+    memcpy(ut_obj->data[instId], dataIn, ut_obj->num_bytes);
+    ut_obj->num_unpacked++;
+    return 0;
+}
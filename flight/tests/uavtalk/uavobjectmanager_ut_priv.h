@@ -0,0 +1,37 @@
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "uavobjectsinit.h"
+
+#define UT_OBJ_MAX_INSTANCES 4
+
+struct ut_object {
+    uint32_t id;
+    uint16_t num_bytes;
+    uint16_t num_instances; /* 0 for single instance objects */
+    uint8_t  data[UT_OBJ_MAX_INSTANCES][UAVOBJECTS_LARGEST];
+    uint32_t num_unpacked; /* number of UAVObjUnpack calls, to see which updates were received */
+    const uint16_t *field_sizes; /* packed field sizes of delta encoded objects */
+    uint8_t  num_fields;
+};
+
+/* Fake objects with the sizes of objects sent at high rates */
+enum {
+    UT_OBJ_ATTITUDEACTUAL = 0,
+    UT_OBJ_GYROS,
+    UT_OBJ_FLIGHTSTATUS,
+    UT_OBJ_MANUALCONTROLCOMMAND,
+    UT_OBJ_WAYPOINT,
+    UT_OBJ_LARGEST,
+    /* Delta encoded objects, fields in packing order */
+    UT_OBJ_SYSTEMSTATS,
+    UT_OBJ_FLIGHTTELEMETRYSTATS,
+    UT_OBJ_GPSPOSITION,
+    UT_OBJ_ACTUATORCOMMAND,
+    UT_OBJ_COUNT
+};
+
+extern struct ut_object ut_objects[UT_OBJ_COUNT];
+
+/* Current time as returned by xTaskGetTickCount */
+extern portTickType ut_tick_count;
@@ -0,0 +1,7 @@
+#ifndef UAVOBJECTSINIT_H
+#define UAVOBJECTSINIT_H
+
+/* Size of the largest object in the fake object table, see uavobjectmanager_ut.c */
+#define UAVOBJECTS_LARGEST 255
+
+#endif /* UAVOBJECTSINIT_H */
@@ -0,0 +1,1237 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <string.h> /* memset */
+#include <time.h> /* clock */
+#include <algorithm>
+#include <vector>
+
+extern "C" {
+#include "openpilot.h"
+#include "uavtalk_priv.h"
+
+#include "uavobjectmanager_ut_priv.h"
+}
+
+/* Serial link used for the throughput comparison, 10 bits per byte on the wire */
+#define LINK_BAUD_RATE    57600
+#define LINK_BYTES_PER_S  (LINK_BAUD_RATE / 10)
+
+#define MULTI_DELAY_MS    10
+
+/* Bytes read from a port at once by a modem */
+#define RELAY_BLOCK_SIZE  64
+
+static std::vector<uint8_t> tx_link;
+static std::vector<uint8_t> relay_link;
+static uint32_t tx_frames;
+
+static int32_t tx_stream(uint8_t *data, int32_t length)
+{
+    tx_link.insert(tx_link.end(), data, data + length);
+    tx_frames++;
+    return length;
+}
+
+static int32_t relay_stream(uint8_t *data, int32_t length)
+{
+    relay_link.insert(relay_link.end(), data, data + length);
+    return length;
+}
+
+static int32_t rx_stream(__attribute__((unused)) uint8_t *data, int32_t length)
+{
+    return length;
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class UAVTalkTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        tx_link.clear();
+        relay_link.clear();
+        tx_frames     = 0;
+        ut_tick_count = 0;
+        for (uint32_t i = 0; i < UT_OBJ_COUNT; i++) {
+            fill(i, 0x10 * (i + 1));
+            ut_objects[i].num_unpacked = 0;
+        }
+
+        tx = UAVTalkInitialize(tx_stream);
+        rx = UAVTalkInitialize(rx_stream);
+        ASSERT_NE((UAVTalkConnection)0, tx);
+        ASSERT_NE((UAVTalkConnection)0, rx);
+    }
+
+    virtual void TearDown()
+    {
+        /* Connections are never destroyed on the flight side either */
+    }
+
+    void fill(uint32_t obj, uint8_t value)
+    {
+        for (uint32_t inst = 0; inst < UT_OBJ_MAX_INSTANCES; inst++) {
+            memset(ut_objects[obj].data[inst], value + inst, sizeof(ut_objects[obj].data[inst]));
+        }
+    }
+
+    void send(uint32_t obj, uint16_t inst = 0)
+    {
+        EXPECT_EQ(0, UAVTalkSendObject(tx, &ut_objects[obj], inst, 0, 0));
+    }
+
+    /* Feed everything sent on the link into the receiving connection, returns the number of complete packets */
+    uint32_t receive()
+    {
+        uint32_t packets = 0;
+
+        for (size_t i = 0; i < tx_link.size(); i++) {
+            if (UAVTalkProcessInputStream(rx, tx_link[i]) == UAVTALK_STATE_COMPLETE) {
+                packets++;
+            }
+        }
+        return packets;
+    }
+
+    UAVTalkConnection tx;
+    UAVTalkConnection rx;
+};
+
+TEST_F(UAVTalkTest, SingleObjectFrames) {
+    send(UT_OBJ_ATTITUDEACTUAL);
+    send(UT_OBJ_FLIGHTSTATUS);
+
+    EXPECT_EQ(2U, tx_frames);
+    EXPECT_EQ(2U * (UAVTALK_MIN_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH) + 28U + 2U, tx_link.size());
+
+    fill(UT_OBJ_ATTITUDEACTUAL, 0);
+    fill(UT_OBJ_FLIGHTSTATUS, 0);
+    EXPECT_EQ(2U, receive());
+    EXPECT_EQ(1U, ut_objects[UT_OBJ_ATTITUDEACTUAL].num_unpacked);
+    EXPECT_EQ(1U, ut_objects[UT_OBJ_FLIGHTSTATUS].num_unpacked);
+    EXPECT_EQ(0x10, ut_objects[UT_OBJ_ATTITUDEACTUAL].data[0][27]);
+    EXPECT_EQ(0x30, ut_objects[UT_OBJ_FLIGHTSTATUS].data[0][1]);
+}
+
+TEST_F(UAVTalkTest, MultiObjectFrame) {
+    EXPECT_EQ(0, UAVTalkSetMultiObjectDelay(tx, MULTI_DELAY_MS));
+
+    send(UT_OBJ_ATTITUDEACTUAL);
+    send(UT_OBJ_FLIGHTSTATUS);
+    send(UT_OBJ_MANUALCONTROLCOMMAND);
+    send(UT_OBJ_WAYPOINT, 2);
+
+    /* Nothing goes out before the latency budget is used up */
+    EXPECT_EQ(0U, tx_frames);
+    EXPECT_EQ(MULTI_DELAY_MS, UAVTalkProcessMultiObject(tx));
+    ut_tick_count += MULTI_DELAY_MS - 1;
+    EXPECT_EQ(1, UAVTalkProcessMultiObject(tx));
+    EXPECT_EQ(0U, tx_frames);
+
+    ut_tick_count += 1;
+    EXPECT_EQ(UAVTALK_WAITFOREVER, UAVTalkProcessMultiObject(tx));
+    EXPECT_EQ(1U, tx_frames);
+
+    /* one header and checksum, one record header per object and the instance id of the waypoint */
+    EXPECT_EQ(UAVTALK_MIN_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH + 4U * UAVTALK_MULTI_RECORD_HEADER_LENGTH + 2U +
+              28U + 2U + 39U + 21U, tx_link.size());
+    EXPECT_EQ(UAVTALK_SYNC_VAL, tx_link[0]);
+    EXPECT_EQ(UAVTALK_TYPE_OBJ_MULTI, tx_link[1]);
+
+    UAVTalkStats stats;
+    UAVTalkGetStats(tx, &stats);
+    EXPECT_EQ(4U, stats.txObjects);
+    EXPECT_EQ(tx_link.size(), stats.txBytes);
+
+    fill(UT_OBJ_ATTITUDEACTUAL, 0);
+    fill(UT_OBJ_FLIGHTSTATUS, 0);
+    fill(UT_OBJ_MANUALCONTROLCOMMAND, 0);
+    fill(UT_OBJ_WAYPOINT, 0);
+    EXPECT_EQ(1U, receive());
+    EXPECT_EQ(1U, ut_objects[UT_OBJ_ATTITUDEACTUAL].num_unpacked);
+    EXPECT_EQ(1U, ut_objects[UT_OBJ_FLIGHTSTATUS].num_unpacked);
+    EXPECT_EQ(1U, ut_objects[UT_OBJ_MANUALCONTROLCOMMAND].num_unpacked);
+    EXPECT_EQ(1U, ut_objects[UT_OBJ_WAYPOINT].num_unpacked);
+    EXPECT_EQ(0x10, ut_objects[UT_OBJ_ATTITUDEACTUAL].data[0][27]);
+    EXPECT_EQ(0x30, ut_objects[UT_OBJ_FLIGHTSTATUS].data[0][1]);
+    EXPECT_EQ(0x40, ut_objects[UT_OBJ_MANUALCONTROLCOMMAND].data[0][38]);
+    EXPECT_EQ(0x52, ut_objects[UT_OBJ_WAYPOINT].data[2][20]);
+    EXPECT_EQ(0x01, ut_objects[UT_OBJ_WAYPOINT].data[1][20]); /* other instances untouched */
+
+    UAVTalkGetStats(rx, &stats);
+    EXPECT_EQ(4U, stats.rxObjects);
+    EXPECT_EQ(0U, stats.rxErrors);
+}
+
+TEST_F(UAVTalkTest, MultiObjectUpdateReplaced) {
+    EXPECT_EQ(0, UAVTalkSetMultiObjectDelay(tx, MULTI_DELAY_MS));
+
+    send(UT_OBJ_GYROS);
+    send(UT_OBJ_FLIGHTSTATUS);
+    fill(UT_OBJ_GYROS, 0x77);
+    send(UT_OBJ_GYROS);
+
+    /* Turning aggregation off sends what was collected */
+    EXPECT_EQ(0, UAVTalkSetMultiObjectDelay(tx, 0));
+    EXPECT_EQ(1U, tx_frames);
+    EXPECT_EQ(UAVTALK_MIN_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH + 2U * UAVTALK_MULTI_RECORD_HEADER_LENGTH + 16U + 2U,
+              tx_link.size());
+
+    fill(UT_OBJ_GYROS, 0);
+    EXPECT_EQ(1U, receive());
+    EXPECT_EQ(1U, ut_objects[UT_OBJ_GYROS].num_unpacked);
+    EXPECT_EQ(0x77, ut_objects[UT_OBJ_GYROS].data[0][15]);
+}
+
+TEST_F(UAVTalkTest, MultiObjectKeptWithoutStream) {
+    EXPECT_EQ(0, UAVTalkSetMultiObjectDelay(tx, MULTI_DELAY_MS));
+
+    send(UT_OBJ_GYROS);
+    send(UT_OBJ_FLIGHTSTATUS);
+
+    /* The collected updates wait for a stream to go out on */
+    EXPECT_EQ(0, UAVTalkSetOutputStream(tx, NULL));
+    ut_tick_count += MULTI_DELAY_MS;
+    EXPECT_EQ(UAVTALK_WAITFOREVER, UAVTalkProcessMultiObject(tx));
+    EXPECT_EQ(0U, tx_frames);
+
+    EXPECT_EQ(0, UAVTalkSetOutputStream(tx, tx_stream));
+    EXPECT_EQ(UAVTALK_WAITFOREVER, UAVTalkProcessMultiObject(tx));
+    EXPECT_EQ(1U, tx_frames);
+
+    fill(UT_OBJ_GYROS, 0);
+    fill(UT_OBJ_FLIGHTSTATUS, 0);
+    EXPECT_EQ(1U, receive());
+    EXPECT_EQ(1U, ut_objects[UT_OBJ_GYROS].num_unpacked);
+    EXPECT_EQ(1U, ut_objects[UT_OBJ_FLIGHTSTATUS].num_unpacked);
+}
+
+TEST_F(UAVTalkTest, MultiObjectOrdering) {
+    EXPECT_EQ(0, UAVTalkSetMultiObjectDelay(tx, MULTI_DELAY_MS));
+
+    /* Objects that do not fit in a record go out on their own, after what was collected before them */
+    send(UT_OBJ_FLIGHTSTATUS);
+    send(UT_OBJ_LARGEST);
+    EXPECT_EQ(2U, tx_frames);
+    EXPECT_EQ(UAVTALK_TYPE_OBJ_MULTI, tx_link[1]);
+    EXPECT_EQ(UAVTALK_TYPE_OBJ, tx_link[UAVTALK_MIN_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH + UAVTALK_MULTI_RECORD_HEADER_LENGTH + 2U + 1U]);
+
+    /* A full frame is sent to make room for the next record */
+    uint32_t objId = ut_objects[UT_OBJ_ATTITUDEACTUAL].id;
+    uint32_t fit   = UAVTALK_MULTI_MAX_PAYLOAD_LENGTH / (UAVTALK_MULTI_RECORD_HEADER_LENGTH + 28U);
+    for (uint32_t i = 0; i < fit; i++) {
+        ut_objects[UT_OBJ_ATTITUDEACTUAL].id = objId + i;
+        send(UT_OBJ_ATTITUDEACTUAL);
+    }
+    EXPECT_EQ(2U, tx_frames);
+    ut_objects[UT_OBJ_ATTITUDEACTUAL].id = objId + fit;
+    send(UT_OBJ_ATTITUDEACTUAL);
+    EXPECT_EQ(3U, tx_frames);
+    EXPECT_EQ(UAVTALK_MIN_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH + fit * (UAVTALK_MULTI_RECORD_HEADER_LENGTH + 28U),
+              tx_link.size() - (UAVTALK_MIN_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH + UAVTALK_MULTI_RECORD_HEADER_LENGTH + 2U) -
+              (UAVTALK_MIN_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH + UAVOBJECTS_LARGEST));
+    ut_objects[UT_OBJ_ATTITUDEACTUAL].id = objId;
+}
+
+TEST_F(UAVTalkTest, MultiObjectUnknownRecordSkipped) {
+    uint8_t frame[UAVTALK_MIN_HEADER_LENGTH + 2U * UAVTALK_MULTI_RECORD_HEADER_LENGTH + 3U + 2U + UAVTALK_CHECKSUM_LENGTH];
+    uint32_t objId = ut_objects[UT_OBJ_FLIGHTSTATUS].id;
+    uint8_t *record;
+
+    frame[0] = UAVTALK_SYNC_VAL;
+    frame[1] = UAVTALK_TYPE_OBJ_MULTI;
+    frame[2] = sizeof(frame) - UAVTALK_CHECKSUM_LENGTH;
+    frame[3] = 0;
+    memset(&frame[4], 0xFF, 4);
+
+    /* record of an object the receiver does not know */
+    record    = &frame[UAVTALK_MIN_HEADER_LENGTH];
+    memset(record, 0xEE, UAVTALK_MULTI_RECORD_HEADER_LENGTH + 3U);
+    record[4] = 3;
+
+    record    = &record[UAVTALK_MULTI_RECORD_HEADER_LENGTH + 3U];
+    record[0] = objId & 0xFF;
+    record[1] = (objId >> 8) & 0xFF;
+    record[2] = (objId >> 16) & 0xFF;
+    record[3] = (objId >> 24) & 0xFF;
+    record[4] = 2;
+    record[5] = 0x5A;
+    record[6] = 0xA5;
+    frame[sizeof(frame) - 1] = PIOS_CRC_updateCRC(0, frame, sizeof(frame) - 1);
+
+    tx_link.assign(frame, frame + sizeof(frame));
+    EXPECT_EQ(1U, receive());
+    EXPECT_EQ(1U, ut_objects[UT_OBJ_FLIGHTSTATUS].num_unpacked);
+    EXPECT_EQ(0x5A, ut_objects[UT_OBJ_FLIGHTSTATUS].data[0][0]);
+    EXPECT_EQ(0xA5, ut_objects[UT_OBJ_FLIGHTSTATUS].data[0][1]);
+}
+
+TEST_F(UAVTalkTest, MultiObjectShortRecordsRejected) {
+    uint8_t frame[UAVTALK_MIN_HEADER_LENGTH + 3U * UAVTALK_MULTI_RECORD_HEADER_LENGTH + 2U + 1U + UAVTALK_CHECKSUM_LENGTH];
+    uint32_t objIds[] = { ut_objects[UT_OBJ_FLIGHTSTATUS].id, ut_objects[UT_OBJ_WAYPOINT].id, ut_objects[UT_OBJ_WAYPOINT].id };
+    uint8_t lengths[] = { 2, 1, 0 };
+    uint8_t *record;
+
+    frame[0] = UAVTALK_SYNC_VAL;
+    frame[1] = UAVTALK_TYPE_OBJ_MULTI;
+    frame[2] = sizeof(frame) - UAVTALK_CHECKSUM_LENGTH;
+    frame[3] = 0;
+    memset(&frame[4], 0xFF, 4);
+
+    /* A good record, one of a multi instance object too short for its instance id, one with only a header */
+    record = &frame[UAVTALK_MIN_HEADER_LENGTH];
+    for (uint32_t i = 0; i < 3; i++) {
+        record[0] = objIds[i] & 0xFF;
+        record[1] = (objIds[i] >> 8) & 0xFF;
+        record[2] = (objIds[i] >> 16) & 0xFF;
+        record[3] = (objIds[i] >> 24) & 0xFF;
+        record[4] = lengths[i];
+        memset(&record[UAVTALK_MULTI_RECORD_HEADER_LENGTH], 0x5A, lengths[i]);
+        record    = &record[UAVTALK_MULTI_RECORD_HEADER_LENGTH + lengths[i]];
+    }
+    frame[sizeof(frame) - 1] = PIOS_CRC_updateCRC(0, frame, sizeof(frame) - 1);
+
+    tx_link.assign(frame, frame + sizeof(frame));
+    EXPECT_EQ(1U, receive());
+    EXPECT_EQ(1U, ut_objects[UT_OBJ_FLIGHTSTATUS].num_unpacked);
+    EXPECT_EQ(0U, ut_objects[UT_OBJ_WAYPOINT].num_unpacked);
+
+    UAVTalkStats stats;
+    UAVTalkGetStats(rx, &stats);
+    EXPECT_EQ(2U, stats.rxErrors);
+
+    /* A record running past the end of the frame ends it */
+    record = &frame[UAVTALK_MIN_HEADER_LENGTH + UAVTALK_MULTI_RECORD_HEADER_LENGTH + 2U];
+    record[4] = 200;
+    frame[sizeof(frame) - 1] = PIOS_CRC_updateCRC(0, frame, sizeof(frame) - 1);
+
+    tx_link.assign(frame, frame + sizeof(frame));
+    EXPECT_EQ(1U, receive());
+    EXPECT_EQ(2U, ut_objects[UT_OBJ_FLIGHTSTATUS].num_unpacked);
+    EXPECT_EQ(0U, ut_objects[UT_OBJ_WAYPOINT].num_unpacked);
+    UAVTalkGetStats(rx, &stats);
+    EXPECT_EQ(3U, stats.rxErrors);
+}
+
+TEST_F(UAVTalkTest, MultiObjectRelay) {
+    UAVTalkConnection relay = UAVTalkInitialize(relay_stream);
+
+    ASSERT_NE((UAVTalkConnection)0, relay);
+    EXPECT_EQ(0, UAVTalkSetMultiObjectDelay(tx, MULTI_DELAY_MS));
+    send(UT_OBJ_ATTITUDEACTUAL);
+    send(UT_OBJ_WAYPOINT, 1);
+    EXPECT_EQ(0, UAVTalkSetMultiObjectDelay(tx, 0));
+    send(UT_OBJ_GYROS);
+    EXPECT_EQ(2U, tx_frames);
+
+    /* The relay forwards the frames as they are, without knowing their content */
+    for (size_t i = 0; i < tx_link.size(); i++) {
+        if (UAVTalkProcessInputStreamQuiet(rx, tx_link[i]) == UAVTALK_STATE_COMPLETE) {
+            UAVTalkRelayPacket(rx, relay);
+        }
+    }
+    EXPECT_EQ(tx_link, relay_link);
+}
+
+TEST_F(UAVTalkTest, MultiObjectThroughput) {
+    /* Telemetry of a copter at typical update periods (ms) over one second */
+    static const struct {
+        uint32_t obj;
+        uint32_t period;
+    } telemetry[] = {
+        { UT_OBJ_ATTITUDEACTUAL,       20  },
+        { UT_OBJ_GYROS,                20  },
+        { UT_OBJ_MANUALCONTROLCOMMAND, 50  },
+        { UT_OBJ_FLIGHTSTATUS,         100 },
+    };
+    uint32_t objects[2], bytes[2], frames[2];
+
+    for (uint32_t multi = 0; multi < 2; multi++) {
+        tx_link.clear();
+        tx_frames = 0;
+        EXPECT_EQ(0, UAVTalkSetMultiObjectDelay(tx, multi ? MULTI_DELAY_MS : 0));
+        objects[multi] = 0;
+        for (ut_tick_count = 0; ut_tick_count < 1000; ut_tick_count++) {
+            for (uint32_t i = 0; i < sizeof(telemetry) / sizeof(telemetry[0]); i++) {
+                if (ut_tick_count % telemetry[i].period == 0) {
+                    send(telemetry[i].obj);
+                    objects[multi]++;
+                }
+            }
+            UAVTalkProcessMultiObject(tx);
+        }
+        EXPECT_EQ(0, UAVTalkSetMultiObjectDelay(tx, 0));
+        bytes[multi]  = tx_link.size();
+        frames[multi] = tx_frames;
+
+        /* Everything arrives */
+        for (uint32_t i = 0; i < UT_OBJ_COUNT; i++) {
+            ut_objects[i].num_unpacked = 0;
+        }
+        EXPECT_EQ(frames[multi], receive());
+        uint32_t received = 0;
+        for (uint32_t i = 0; i < UT_OBJ_COUNT; i++) {
+            received += ut_objects[i].num_unpacked;
+        }
+        EXPECT_EQ(objects[multi], received);
+    }
+
+    printf("%u updates/s at %u baud: single object frames %u frames %u bytes/s (%u%% of the link), "
+           "multi-object frames %u frames %u bytes/s (%u%% of the link)\n",
+           objects[0], LINK_BAUD_RATE,
+           frames[0], bytes[0], bytes[0] * 100 / LINK_BYTES_PER_S,
+           frames[1], bytes[1], bytes[1] * 100 / LINK_BYTES_PER_S);
+    RecordProperty("SingleObjectBytes", bytes[0]);
+    RecordProperty("MultiObjectBytes", bytes[1]);
+
+    EXPECT_LT(bytes[1], bytes[0]);
+    EXPECT_LT(frames[1], frames[0]);
+}
+
+/* Fields of the delta encoded objects, as offsets in their packed data */
+#define SYSTEMSTATS_FLIGHTTIME              0
+#define SYSTEMSTATS_HEAPREMAINING           20
+#define SYSTEMSTATS_CPULOAD                 32
+#define FLIGHTTELEMETRYSTATS_TXDATARATE     0
+#define FLIGHTTELEMETRYSTATS_RXDATARATE     4
+#define GPSPOSITION_LATITUDE                0
+#define GPSPOSITION_LONGITUDE               4
+#define GPSPOSITION_ALTITUDE                8
+#define GPSPOSITION_HEADING                 16
+#define GPSPOSITION_GROUNDSPEED             20
+#define GPSPOSITION_SATELLITES              37
+#define ACTUATORCOMMAND_CHANNEL             0
+
+#define DELTA_KEYFRAME_INTERVAL             10
+
+class UAVTalkDeltaTest : public UAVTalkTest {
+protected:
+    virtual void SetUp()
+    {
+        UAVTalkTest::SetUp();
+        EXPECT_EQ(0, UAVTalkSetDeltaKeyframeInterval(tx, DELTA_KEYFRAME_INTERVAL));
+    }
+
+    void set(uint32_t obj, uint32_t offset, uint32_t size, uint32_t value)
+    {
+        memcpy(&ut_objects[obj].data[0][offset], &value, size);
+    }
+
+    /* Keyframe bytes of the delta frames on the link */
+    std::vector<uint8_t> keyframe_bytes()
+    {
+        std::vector<uint8_t> bytes;
+
+        for (size_t i = 0; i + UAVTALK_MIN_HEADER_LENGTH < tx_link.size();
+             i += (tx_link[i + 2] | (tx_link[i + 3] << 8)) + UAVTALK_CHECKSUM_LENGTH) {
+            if (tx_link[i + 1] == UAVTALK_TYPE_OBJ_DELTA) {
+                bytes.push_back(tx_link[i + UAVTALK_MIN_HEADER_LENGTH]);
+            }
+        }
+        return bytes;
+    }
+};
+
+TEST_F(UAVTalkDeltaTest, DeltaFrames) {
+    send(UT_OBJ_SYSTEMSTATS);
+    set(UT_OBJ_SYSTEMSTATS, SYSTEMSTATS_FLIGHTTIME, 4, 0x01020304);
+    set(UT_OBJ_SYSTEMSTATS, SYSTEMSTATS_CPULOAD, 1, 55);
+    send(UT_OBJ_SYSTEMSTATS);
+
+    /* A keyframe with the whole object, then the two fields that changed after a two byte bitmap */
+    EXPECT_EQ(2U, tx_frames);
+    EXPECT_EQ(2U * (UAVTALK_MIN_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH + 1U) + 34U + 2U + 4U + 1U, tx_link.size());
+    std::vector<uint8_t> keyframes = keyframe_bytes();
+    ASSERT_EQ(2U, keyframes.size());
+    EXPECT_EQ(UAVTALK_DELTA_KEYFRAME, keyframes[0] & UAVTALK_DELTA_KEYFRAME);
+    EXPECT_EQ(keyframes[0] & UAVTALK_DELTA_ID_MASK, keyframes[1]);
+
+    fill(UT_OBJ_SYSTEMSTATS, 0);
+    EXPECT_EQ(2U, receive());
+    EXPECT_EQ(2U, ut_objects[UT_OBJ_SYSTEMSTATS].num_unpacked);
+    EXPECT_EQ(0x04, ut_objects[UT_OBJ_SYSTEMSTATS].data[0][SYSTEMSTATS_FLIGHTTIME]);
+    EXPECT_EQ(0x01, ut_objects[UT_OBJ_SYSTEMSTATS].data[0][SYSTEMSTATS_FLIGHTTIME + 3]);
+    EXPECT_EQ(55, ut_objects[UT_OBJ_SYSTEMSTATS].data[0][SYSTEMSTATS_CPULOAD]);
+    EXPECT_EQ(0x70, ut_objects[UT_OBJ_SYSTEMSTATS].data[0][SYSTEMSTATS_HEAPREMAINING]); /* taken from the keyframe */
+
+    UAVTalkStats stats;
+    UAVTalkGetStats(rx, &stats);
+    EXPECT_EQ(0U, stats.rxErrors);
+
+    /* Objects without field sizes are sent in full */
+    tx_link.clear();
+    send(UT_OBJ_GYROS);
+    EXPECT_EQ(UAVTALK_TYPE_OBJ, tx_link[1]);
+}
+
+TEST_F(UAVTalkDeltaTest, DeltaKeyframeInterval) {
+    for (uint32_t i = 0; i < 2 * DELTA_KEYFRAME_INTERVAL + 1; i++) {
+        set(UT_OBJ_SYSTEMSTATS, SYSTEMSTATS_FLIGHTTIME, 4, i);
+        send(UT_OBJ_SYSTEMSTATS);
+    }
+
+    /* Every DELTA_KEYFRAME_INTERVAL deltas a new keyframe follows, with the next keyframe id */
+    std::vector<uint8_t> keyframes = keyframe_bytes();
+    ASSERT_EQ(2U * DELTA_KEYFRAME_INTERVAL + 1U, keyframes.size());
+    for (uint32_t i = 0; i < keyframes.size(); i++) {
+        uint8_t id = (keyframes[0] + i / (DELTA_KEYFRAME_INTERVAL + 1)) & UAVTALK_DELTA_ID_MASK;
+        if (i % (DELTA_KEYFRAME_INTERVAL + 1) == 0) {
+            EXPECT_EQ(UAVTALK_DELTA_KEYFRAME | id, keyframes[i]);
+        } else {
+            EXPECT_EQ(id, keyframes[i]);
+        }
+    }
+
+    /* Changing the interval starts over with a keyframe */
+    tx_link.clear();
+    EXPECT_EQ(0, UAVTalkSetDeltaKeyframeInterval(tx, DELTA_KEYFRAME_INTERVAL + 1));
+    send(UT_OBJ_SYSTEMSTATS);
+    keyframes = keyframe_bytes();
+    ASSERT_EQ(1U, keyframes.size());
+    EXPECT_EQ(UAVTALK_DELTA_KEYFRAME, keyframes[0] & UAVTALK_DELTA_KEYFRAME);
+
+    /* A delta that would not be smaller than the object is sent as a keyframe */
+    tx_link.clear();
+    fill(UT_OBJ_SYSTEMSTATS, 0x99);
+    send(UT_OBJ_SYSTEMSTATS);
+    keyframes = keyframe_bytes();
+    ASSERT_EQ(1U, keyframes.size());
+    EXPECT_EQ(UAVTALK_DELTA_KEYFRAME, keyframes[0] & UAVTALK_DELTA_KEYFRAME);
+
+    /* Turning delta frames off sends full objects again */
+    tx_link.clear();
+    EXPECT_EQ(0, UAVTalkSetDeltaKeyframeInterval(tx, 0));
+    send(UT_OBJ_SYSTEMSTATS);
+    EXPECT_EQ(UAVTALK_TYPE_OBJ, tx_link[1]);
+}
+
+TEST_F(UAVTalkDeltaTest, DeltaMissedKeyframe) {
+    /* The keyframe is lost on the link */
+    send(UT_OBJ_GPSPOSITION);
+    tx_link.clear();
+    set(UT_OBJ_GPSPOSITION, GPSPOSITION_LATITUDE, 4, 0x11223344);
+    send(UT_OBJ_GPSPOSITION);
+    receive();
+    EXPECT_EQ(0U, ut_objects[UT_OBJ_GPSPOSITION].num_unpacked);
+
+    /* Deltas of an older keyframe are dropped too */
+    tx_link.clear();
+    for (uint32_t i = 1; i < DELTA_KEYFRAME_INTERVAL; i++) {
+        send(UT_OBJ_GPSPOSITION);
+    }
+    std::vector<uint8_t> link = tx_link;
+    tx_link.clear();
+    send(UT_OBJ_GPSPOSITION);
+    set(UT_OBJ_GPSPOSITION, GPSPOSITION_SATELLITES, 1, 9);
+    send(UT_OBJ_GPSPOSITION);
+    receive();
+    EXPECT_EQ(2U, ut_objects[UT_OBJ_GPSPOSITION].num_unpacked);
+    EXPECT_EQ(9, ut_objects[UT_OBJ_GPSPOSITION].data[0][GPSPOSITION_SATELLITES]);
+
+    tx_link = link;
+    receive();
+    EXPECT_EQ(2U, ut_objects[UT_OBJ_GPSPOSITION].num_unpacked);
+    EXPECT_EQ(9, ut_objects[UT_OBJ_GPSPOSITION].data[0][GPSPOSITION_SATELLITES]);
+}
+
+TEST_F(UAVTalkDeltaTest, DeltaRelay) {
+    UAVTalkConnection relay = UAVTalkInitialize(relay_stream);
+
+    ASSERT_NE((UAVTalkConnection)0, relay);
+    send(UT_OBJ_ACTUATORCOMMAND);
+    set(UT_OBJ_ACTUATORCOMMAND, ACTUATORCOMMAND_CHANNEL, 2, 1500);
+    send(UT_OBJ_ACTUATORCOMMAND);
+    send(UT_OBJ_GYROS);
+    EXPECT_EQ(3U, tx_frames);
+
+    /* The relay forwards delta frames as they are, without keeping keyframes */
+    for (size_t i = 0; i < tx_link.size(); i++) {
+        if (UAVTalkProcessInputStreamQuiet(rx, tx_link[i]) == UAVTALK_STATE_COMPLETE) {
+            UAVTalkRelayPacket(rx, relay);
+        }
+    }
+    EXPECT_EQ(tx_link, relay_link);
+}
+
+TEST_F(UAVTalkDeltaTest, DeltaThroughput) {
+    /*
+     * Synthetic replay of the slow status telemetry of a flight, there are no recorded
+     * logs to replay. Periods are the telemetry update periods of the objects (ms).
+     */
+    static const struct {
+        uint32_t obj;
+        uint32_t period;
+    } telemetry[] = {
+        { UT_OBJ_SYSTEMSTATS,          1000 },
+        { UT_OBJ_FLIGHTTELEMETRYSTATS, 5000 },
+        { UT_OBJ_GPSPOSITION,          1000 },
+        { UT_OBJ_ACTUATORCOMMAND,      1000 },
+    };
+    uint32_t objects[2], bytes[2];
+    uint8_t sent[UT_OBJ_COUNT][UAVOBJECTS_LARGEST];
+
+    for (uint32_t delta = 0; delta < 2; delta++) {
+        tx_link.clear();
+        EXPECT_EQ(0, UAVTalkSetDeltaKeyframeInterval(tx, delta ? DELTA_KEYFRAME_INTERVAL : 0));
+        for (uint32_t i = 0; i < UT_OBJ_COUNT; i++) {
+            fill(i, 0);
+        }
+        objects[delta] = 0;
+        for (uint32_t t = 0; t < 300000; t += 1000) {
+            uint32_t s = t / 1000;
+            set(UT_OBJ_SYSTEMSTATS, SYSTEMSTATS_FLIGHTTIME, 4, t);
+            set(UT_OBJ_SYSTEMSTATS, SYSTEMSTATS_HEAPREMAINING, 2, 2048 - s / 60);
+            set(UT_OBJ_SYSTEMSTATS, SYSTEMSTATS_CPULOAD, 1, 40 + s % 7);
+            set(UT_OBJ_FLIGHTTELEMETRYSTATS, FLIGHTTELEMETRYSTATS_TXDATARATE, 4, 1200 + s % 13);
+            set(UT_OBJ_FLIGHTTELEMETRYSTATS, FLIGHTTELEMETRYSTATS_RXDATARATE, 4, 300 + s % 5);
+            set(UT_OBJ_GPSPOSITION, GPSPOSITION_LATITUDE, 4, 523456789 + s * 37);
+            set(UT_OBJ_GPSPOSITION, GPSPOSITION_LONGITUDE, 4, 45678901 + s * 53);
+            set(UT_OBJ_GPSPOSITION, GPSPOSITION_ALTITUDE, 4, 1000 + s % 20);
+            set(UT_OBJ_GPSPOSITION, GPSPOSITION_HEADING, 4, (s * 3) % 360);
+            set(UT_OBJ_GPSPOSITION, GPSPOSITION_GROUNDSPEED, 4, 5 + s % 3);
+            set(UT_OBJ_GPSPOSITION, GPSPOSITION_SATELLITES, 1, 9 + (s / 45) % 2);
+            for (uint32_t c = 0; c < 4; c++) {
+                set(UT_OBJ_ACTUATORCOMMAND, ACTUATORCOMMAND_CHANNEL + 2 * c, 2, 1400 + (s * (c + 1)) % 50);
+            }
+            for (uint32_t i = 0; i < sizeof(telemetry) / sizeof(telemetry[0]); i++) {
+                if (t % telemetry[i].period == 0) {
+                    send(telemetry[i].obj);
+                    memcpy(sent[telemetry[i].obj], ut_objects[telemetry[i].obj].data[0], ut_objects[telemetry[i].obj].num_bytes);
+                    objects[delta]++;
+                }
+            }
+        }
+        bytes[delta] = tx_link.size();
+
+        /* Everything arrives, with the data of the last update */
+        for (uint32_t i = 0; i < UT_OBJ_COUNT; i++) {
+            fill(i, 0xEE);
+            ut_objects[i].num_unpacked = 0;
+        }
+        receive();
+        uint32_t received = 0;
+        for (uint32_t i = 0; i < UT_OBJ_COUNT; i++) {
+            received += ut_objects[i].num_unpacked;
+            if (ut_objects[i].num_unpacked) {
+                EXPECT_EQ(0, memcmp(sent[i], ut_objects[i].data[0], ut_objects[i].num_bytes));
+            }
+        }
+        EXPECT_EQ(objects[delta], received);
+    }
+
+    printf("%u status updates in 5 minutes: full objects %u bytes, delta frames %u bytes (%u%% saved)\n",
+           objects[0], bytes[0], bytes[1], 100 - bytes[1] * 100 / bytes[0]);
+    RecordProperty("FullObjectBytes", bytes[0]);
+    RecordProperty("DeltaFrameBytes", bytes[1]);
+
+    EXPECT_LT(bytes[1], bytes[0]);
+}
+
+class UAVTalkRelayTest : public UAVTalkTest {
+protected:
+    virtual void SetUp()
+    {
+        UAVTalkTest::SetUp();
+        relay = UAVTalkInitialize(relay_stream);
+        ASSERT_NE((UAVTalkConnection)0, relay);
+
+        /* Telemetry as it goes through a modem */
+        send(UT_OBJ_ATTITUDEACTUAL);
+        ends.push_back(tx_link.size());
+        send(UT_OBJ_WAYPOINT, 2);
+        ends.push_back(tx_link.size());
+        send(UT_OBJ_FLIGHTSTATUS);
+        ends.push_back(tx_link.size());
+        /* Nobody answers, the request times out once it is sent */
+        EXPECT_EQ(-1, UAVTalkSendObjectRequest(tx, &ut_objects[UT_OBJ_GYROS], 0, 0));
+        ends.push_back(tx_link.size());
+        send(UT_OBJ_LARGEST);
+        ends.push_back(tx_link.size());
+        send(UT_OBJ_MANUALCONTROLCOMMAND);
+        ends.push_back(tx_link.size());
+        EXPECT_EQ(6U, tx_frames);
+    }
+
+    /* Relay the link in blocks of at most block_size bytes, returns the number of frames that were complete in their block */
+    uint32_t relay_blocks(size_t block_size)
+    {
+        uint32_t in_place = 0;
+
+        for (size_t start = 0; start < tx_link.size(); start += block_size) {
+            uint8_t *buf    = &tx_link[start];
+            uint16_t length = std::min(block_size, tx_link.size() - start);
+
+            while (length > 0) {
+                UAVTalkFrame frame;
+                uint16_t used = UAVTalkScanFrame(rx, buf, length, 0, &frame);
+                if (frame.data) {
+                    if (frame.data >= buf && frame.data < buf + length) {
+                        in_place++;
+                    }
+                    EXPECT_EQ(0, UAVTalkRelayFrame(rx, relay, &frame));
+                }
+                buf    += used;
+                length -= used;
+            }
+        }
+        return in_place;
+    }
+
+    UAVTalkConnection relay;
+    std::vector<size_t> ends;
+};
+
+TEST_F(UAVTalkRelayTest, RelayInPlace) {
+    /* Frames that are complete in the block are relayed from it */
+    EXPECT_EQ(6U, relay_blocks(tx_link.size()));
+    EXPECT_EQ(tx_link, relay_link);
+
+    UAVTalkRelayStats stats;
+    UAVTalkGetRelayStats(rx, &stats, false);
+    EXPECT_EQ(6U, stats.frames);
+    EXPECT_EQ(tx_link.size(), stats.bytes);
+    EXPECT_EQ(0U, stats.dropped);
+
+    /* The frames are not decoded */
+    for (uint32_t i = 0; i < UT_OBJ_COUNT; i++) {
+        EXPECT_EQ(0U, ut_objects[i].num_unpacked);
+    }
+}
+
+TEST_F(UAVTalkRelayTest, RelaySplitFrames) {
+    /* Frames that arrive in pieces are collected, whatever the size of the pieces */
+    for (size_t block_size = 1; block_size < 40; block_size++) {
+        relay_link.clear();
+        relay_blocks(block_size);
+        EXPECT_EQ(tx_link, relay_link) << "block size " << block_size;
+    }
+    EXPECT_EQ(0U, relay_blocks(1));
+}
+
+TEST_F(UAVTalkRelayTest, RelayDropsBadFrames) {
+    std::vector<uint8_t> expected;
+
+    /* Garbage with sync bytes in it in front, a bad checksum in the second frame */
+    static const uint8_t garbage[] = { 0x00, UAVTALK_SYNC_VAL, 0x55, UAVTALK_SYNC_VAL, UAVTALK_TYPE_OBJ, 0xFF, 0xFF, 0x01 };
+    expected.insert(expected.end(), tx_link.begin(), tx_link.begin() + ends[0]);
+    expected.insert(expected.end(), tx_link.begin() + ends[1], tx_link.end());
+    tx_link[ends[1] - 1] ^= 0xFF;
+    tx_link.insert(tx_link.begin(), garbage, garbage + sizeof(garbage));
+
+    for (size_t block_size = 1; block_size <= tx_link.size(); block_size *= 2) {
+        relay_link.clear();
+        UAVTalkResetRelayStats(rx);
+        relay_blocks(block_size);
+        EXPECT_EQ(expected, relay_link) << "block size " << block_size;
+
+        UAVTalkRelayStats stats;
+        UAVTalkGetRelayStats(rx, &stats, false);
+        EXPECT_EQ(5U, stats.frames);
+        EXPECT_EQ(3U, stats.dropped);
+    }
+}
+
+TEST_F(UAVTalkRelayTest, RelayReceiveFrame) {
+    uint8_t *buf    = &tx_link[0];
+    uint16_t length = tx_link.size();
+
+    fill(UT_OBJ_WAYPOINT, 0);
+    while (length > 0) {
+        UAVTalkFrame frame;
+        uint16_t used = UAVTalkScanFrame(rx, buf, length, 0, &frame);
+        if (frame.data && frame.objId == ut_objects[UT_OBJ_WAYPOINT].id) {
+            EXPECT_EQ(UAVTALK_TYPE_OBJ, frame.type);
+            EXPECT_EQ(0, UAVTalkReceiveFrame(rx, &frame));
+        }
+        buf    += used;
+        length -= used;
+    }
+    EXPECT_EQ(1U, ut_objects[UT_OBJ_WAYPOINT].num_unpacked);
+    EXPECT_EQ(0x52, ut_objects[UT_OBJ_WAYPOINT].data[2][20]);
+    EXPECT_EQ(0x01, ut_objects[UT_OBJ_WAYPOINT].data[1][20]);
+}
+
+TEST_F(UAVTalkRelayTest, RelayLatencyFromReception) {
+    /* The first frame arrives in two blocks, it is timed from the block holding its sync byte */
+    uint16_t split = ends[0] / 2;
+    UAVTalkFrame frame;
+
+    ut_tick_count = 1000;
+    EXPECT_EQ(split, UAVTalkScanFrame(rx, &tx_link[0], split, 1000, &frame));
+    EXPECT_TRUE(frame.data == NULL);
+    EXPECT_EQ(ends[0] - split, UAVTalkScanFrame(rx, &tx_link[split], ends[0] - split, 1020, &frame));
+    ASSERT_TRUE(frame.data != NULL);
+    ut_tick_count = 1025;
+    EXPECT_EQ(0, UAVTalkRelayFrame(rx, relay, &frame));
+
+    /* The second one waited in the receive buffer */
+    EXPECT_EQ(ends[1] - ends[0], UAVTalkScanFrame(rx, &tx_link[ends[0]], ends[1] - ends[0], 1015, &frame));
+    ASSERT_TRUE(frame.data != NULL);
+    EXPECT_EQ(0, UAVTalkRelayFrame(rx, relay, &frame));
+
+    UAVTalkRelayStats stats;
+    UAVTalkGetRelayStats(rx, &stats, true);
+    EXPECT_EQ(2U, stats.frames);
+    EXPECT_EQ(35U, stats.latencySumMs);
+    EXPECT_EQ(25U, stats.latencyMaxMs);
+
+    /* Reading with reset starts the counting again */
+    UAVTalkGetRelayStats(rx, &stats, false);
+    EXPECT_EQ(0U, stats.frames);
+    EXPECT_EQ(0U, stats.latencySumMs);
+    EXPECT_EQ(0U, stats.latencyMaxMs);
+}
+
+TEST_F(UAVTalkRelayTest, RelayThroughput) {
+    std::vector<uint8_t> frames = tx_link;
+    uint32_t repeat = 4000;
+    clock_t start;
+    double seconds[2];
+
+    /* Byte by byte through the receive state machine, then rebuilt on the output */
+    start = clock();
+    for (uint32_t n = 0; n < repeat; n++) {
+        for (size_t i = 0; i < frames.size(); i++) {
+            if (UAVTalkProcessInputStreamQuiet(rx, frames[i]) == UAVTALK_STATE_COMPLETE) {
+                UAVTalkRelayPacket(rx, relay);
+            }
+        }
+    }
+    seconds[0] = (double)(clock() - start) / CLOCKS_PER_SEC;
+    size_t relayed = relay_link.size();
+    relay_link.clear();
+
+    /* The frame scanner on the blocks of a modem */
+    start = clock();
+    for (uint32_t n = 0; n < repeat; n++) {
+        tx_link = frames;
+        relay_blocks(RELAY_BLOCK_SIZE);
+    }
+    seconds[1] = (double)(clock() - start) / CLOCKS_PER_SEC;
+    EXPECT_EQ(relayed, relay_link.size());
+
+    printf("relayed %u bytes: receive state machine %.1f MB/s, frame scanner %.1f MB/s\n",
+           (unsigned)relayed, relayed / seconds[0] / 1e6, relayed / seconds[1] / 1e6);
+}
+
+class UAVTalkBufferTest : public UAVTalkTest {
+protected:
+    struct result {
+        UAVTalkStats   stats;
+        UAVTalkRxState state;
+        uint32_t num_unpacked[UT_OBJ_COUNT];
+        uint8_t  data[UT_OBJ_COUNT][UT_OBJ_MAX_INSTANCES][UAVOBJECTS_LARGEST];
+    };
+
+    virtual void SetUp()
+    {
+        UAVTalkTest::SetUp();
+
+        /* A bit of everything the receiver has to cope with */
+        static const uint8_t garbage[] = { 0x00, UAVTALK_SYNC_VAL, 0x55, UAVTALK_SYNC_VAL, UAVTALK_TYPE_OBJ, 0xFF, 0xFF, 0x01 };
+        tx_link.insert(tx_link.end(), garbage, garbage + sizeof(garbage));
+        send(UT_OBJ_ATTITUDEACTUAL);
+        send(UT_OBJ_WAYPOINT, 2);
+        EXPECT_EQ(0, UAVTalkSendObjectTimestamped(tx, &ut_objects[UT_OBJ_FLIGHTSTATUS], 0, 0, 0));
+        EXPECT_EQ(0, UAVTalkSendObjectTimestamped(tx, &ut_objects[UT_OBJ_WAYPOINT], 1, 0, 0));
+        EXPECT_EQ(-1, UAVTalkSendObjectRequest(tx, &ut_objects[UT_OBJ_GYROS], 0, 0));
+        EXPECT_EQ(0, UAVTalkSendAck(tx, &ut_objects[UT_OBJ_MANUALCONTROLCOMMAND], 0));
+        EXPECT_EQ(0, UAVTalkSendNack(tx, 0x12345678));
+        send(UT_OBJ_LARGEST);
+
+        /* Keyframe and field delta */
+        EXPECT_EQ(0, UAVTalkSetDeltaKeyframeInterval(tx, 4));
+        send(UT_OBJ_SYSTEMSTATS);
+        ut_objects[UT_OBJ_SYSTEMSTATS].data[0][0]++;
+        send(UT_OBJ_SYSTEMSTATS);
+        send(UT_OBJ_FLIGHTSTATUS);
+
+        /* A frame with a bad checksum and one cut short */
+        size_t start = tx_link.size();
+        send(UT_OBJ_GYROS);
+        tx_link.back() ^= 0xFF;
+        start = tx_link.size();
+        send(UT_OBJ_ACTUATORCOMMAND);
+        tx_link.resize(start + UAVTALK_MIN_HEADER_LENGTH + 3);
+        tx_link.resize(tx_link.size() + UAVTALK_MAX_PACKET_LENGTH, 0x00);
+
+
+        /* End with the checksum missing */
+        send(UT_OBJ_GPSPOSITION);
+        tx_link.pop_back();
+    }
+
+    void clear()
+    {
+        for (uint32_t i = 0; i < UT_OBJ_COUNT; i++) {
+            fill(i, 0);
+            ut_objects[i].num_unpacked = 0;
+        }
+    }
+
+    void collect(UAVTalkConnection connection, UAVTalkRxState state, struct result *res)
+    {
+        memset(res, 0, sizeof(*res));
+        UAVTalkGetStats(connection, &res->stats);
+        res->state = state;
+        for (uint32_t i = 0; i < UT_OBJ_COUNT; i++) {
+            res->num_unpacked[i] = ut_objects[i].num_unpacked;
+            memcpy(res->data[i], ut_objects[i].data, sizeof(res->data[i]));
+        }
+    }
+
+    /* Receive the link byte by byte */
+    void receive_bytes(struct result *res)
+    {
+        UAVTalkConnection connection = UAVTalkInitialize(rx_stream);
+        UAVTalkRxState state = UAVTALK_STATE_SYNC;
+
+        clear();
+        for (size_t i = 0; i < tx_link.size(); i++) {
+            state = UAVTalkProcessInputStream(connection, tx_link[i]);
+        }
+        collect(connection, state, res);
+    }
+
+    /* Receive the link in blocks of at most block_size bytes */
+    void receive_blocks(size_t block_size, struct result *res)
+    {
+        UAVTalkConnection connection = UAVTalkInitialize(rx_stream);
+        UAVTalkRxState state = UAVTALK_STATE_SYNC;
+
+        clear();
+        for (size_t start = 0; start < tx_link.size(); start += block_size) {
+            state = UAVTalkProcessInputBuffer(connection, &tx_link[start], std::min(block_size, tx_link.size() - start));
+        }
+        collect(connection, state, res);
+    }
+};
+
+TEST_F(UAVTalkBufferTest, SameAsBytes) {
+    struct result bytes;
+    struct result blocks;
+
+    receive_bytes(&bytes);
+    EXPECT_EQ(11U, bytes.stats.rxObjects);
+    EXPECT_EQ(2U, bytes.stats.rxErrors);
+    EXPECT_EQ(tx_link.size(), bytes.stats.rxBytes);
+    EXPECT_EQ(UAVTALK_STATE_CS, bytes.state);
+    EXPECT_EQ(2U, bytes.num_unpacked[UT_OBJ_WAYPOINT]);
+    EXPECT_EQ(2U, bytes.num_unpacked[UT_OBJ_SYSTEMSTATS]);
+
+    for (size_t block_size = 1; block_size <= tx_link.size(); block_size++) {
+        receive_blocks(block_size, &blocks);
+        EXPECT_EQ(0, memcmp(&bytes.stats, &blocks.stats, sizeof(bytes.stats))) << "block size " << block_size;
+        EXPECT_EQ(bytes.state, blocks.state) << "block size " << block_size;
+        EXPECT_EQ(0, memcmp(bytes.num_unpacked, blocks.num_unpacked, sizeof(bytes.num_unpacked))) << "block size " << block_size;
+        EXPECT_EQ(0, memcmp(bytes.data, blocks.data, sizeof(bytes.data))) << "block size " << block_size;
+    }
+}
+
+TEST_F(UAVTalkBufferTest, Throughput) {
+    std::vector<uint8_t> stream;
+    UAVTalkConnection connection = UAVTalkInitialize(rx_stream);
+    uint32_t repeat = 4000;
+    clock_t start;
+    double seconds[2];
+
+    for (uint32_t n = 0; n < repeat; n++) {
+        stream.insert(stream.end(), tx_link.begin(), tx_link.end());
+    }
+
+    start = clock();
+    for (size_t i = 0; i < stream.size(); i++) {
+        UAVTalkProcessInputStream(connection, stream[i]);
+    }
+    seconds[0] = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (size_t i = 0; i < stream.size(); i += RELAY_BLOCK_SIZE) {
+        UAVTalkProcessInputBuffer(connection, &stream[i], std::min((size_t)RELAY_BLOCK_SIZE, stream.size() - i));
+    }
+    seconds[1] = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    /* Share of the cpu taken by a 1 Mbit/s link */
+    printf("received %u bytes: bytes %.1f MB/s (%.2f%% at 1 Mbit/s), blocks %.1f MB/s (%.2f%% at 1 Mbit/s)\n",
+           (unsigned)stream.size(),
+           stream.size() / seconds[0] / 1e6, 100.0 * 125000 * seconds[0] / stream.size(),
+           stream.size() / seconds[1] / 1e6, 100.0 * 125000 * seconds[1] / stream.size());
+}
+
+/* Room lent by the output, as the tx buffer of a port would */
+static uint8_t lent_room[UAVTALK_MAX_PACKET_LENGTH];
+static bool lend_room;
+static uint16_t reserved_length;
+static uint16_t last_reserved_length;
+static uint32_t committed_frames;
+
+static uint8_t *reserve_room(uint16_t length)
+{
+    if (!lend_room || length > sizeof(lent_room)) {
+        return NULL;
+    }
+    /* Stale bytes left in the room must not end up on the link */
+    memset(lent_room, 0xEE, sizeof(lent_room));
+    reserved_length = last_reserved_length = length;
+    return lent_room;
+}
+
+static int32_t commit_room(uint16_t length)
+{
+    EXPECT_LE(length, reserved_length);
+    tx_link.insert(tx_link.end(), lent_room, lent_room + length);
+    committed_frames++;
+    reserved_length = 0;
+    return length;
+}
+
+class UAVTalkOutputBufferTest : public UAVTalkTest {
+protected:
+    virtual void SetUp()
+    {
+        UAVTalkTest::SetUp();
+        lend_room        = true;
+        reserved_length  = 0;
+        committed_frames = 0;
+    }
+
+    /* Every kind of frame, the delta frames on a connection of their own */
+    void send_all(UAVTalkConnection connection, UAVTalkConnection delta)
+    {
+        ut_tick_count = 1234;
+        EXPECT_EQ(0, UAVTalkSendObject(connection, &ut_objects[UT_OBJ_ATTITUDEACTUAL], 0, 0, 0));
+        EXPECT_EQ(0, UAVTalkSendObject(connection, &ut_objects[UT_OBJ_WAYPOINT], 2, 0, 0));
+        EXPECT_EQ(0, UAVTalkSendObjectTimestamped(connection, &ut_objects[UT_OBJ_FLIGHTSTATUS], 0, 0, 0));
+        EXPECT_EQ(0, UAVTalkSendObjectTimestamped(connection, &ut_objects[UT_OBJ_WAYPOINT], 1, 0, 0));
+        EXPECT_EQ(0, UAVTalkSendAck(connection, &ut_objects[UT_OBJ_MANUALCONTROLCOMMAND], 0));
+        EXPECT_EQ(0, UAVTalkSendNack(connection, 0x12345678));
+        EXPECT_EQ(0, UAVTalkSendObject(connection, &ut_objects[UT_OBJ_LARGEST], 0, 0, 0));
+
+        EXPECT_EQ(0, UAVTalkSetDeltaKeyframeInterval(delta, 4));
+        EXPECT_EQ(0, UAVTalkSendObject(delta, &ut_objects[UT_OBJ_SYSTEMSTATS], 0, 0, 0));
+        ut_objects[UT_OBJ_SYSTEMSTATS].data[0][0]++;
+        EXPECT_EQ(0, UAVTalkSendObject(delta, &ut_objects[UT_OBJ_SYSTEMSTATS], 0, 0, 0));
+        ut_objects[UT_OBJ_SYSTEMSTATS].data[0][0]--;
+    }
+};
+
+TEST_F(UAVTalkOutputBufferTest, SameFramesAsStream) {
+    send_all(tx, UAVTalkInitialize(tx_stream));
+    std::vector<uint8_t> copied = tx_link;
+    uint32_t copied_frames = tx_frames;
+
+    UAVTalkConnection connection = UAVTalkInitialize(tx_stream);
+    UAVTalkConnection delta = UAVTalkInitialize(tx_stream);
+    ASSERT_EQ(0, UAVTalkSetOutputBuffer(connection, reserve_room, commit_room));
+    ASSERT_EQ(0, UAVTalkSetOutputBuffer(delta, reserve_room, commit_room));
+    tx_link.clear();
+    tx_frames = 0;
+    send_all(connection, delta);
+
+    /* All but the NACK is built in place */
+    EXPECT_EQ(copied_frames - 1, committed_frames);
+    EXPECT_EQ(1U, tx_frames);
+    ASSERT_EQ(copied.size(), tx_link.size());
+    EXPECT_TRUE(copied == tx_link);
+
+    UAVTalkStats stats;
+    UAVTalkGetStats(connection, &stats);
+    EXPECT_EQ(6U, stats.txObjects);
+
+    fill(UT_OBJ_ATTITUDEACTUAL, 0);
+    fill(UT_OBJ_SYSTEMSTATS, 0);
+    EXPECT_EQ(copied_frames, receive());
+    EXPECT_EQ(0x10, ut_objects[UT_OBJ_ATTITUDEACTUAL].data[0][27]);
+    EXPECT_EQ(0x71, ut_objects[UT_OBJ_SYSTEMSTATS].data[0][0]);
+}
+
+TEST_F(UAVTalkOutputBufferTest, DeltaReservesKeyframe) {
+    ASSERT_EQ(0, UAVTalkSetOutputBuffer(tx, reserve_room, commit_room));
+    EXPECT_EQ(0, UAVTalkSetDeltaKeyframeInterval(tx, 4));
+
+    /* The room is reserved for a keyframe and only the delta, a two byte bitmap and the field, is committed */
+    send(UT_OBJ_SYSTEMSTATS);
+    EXPECT_EQ(tx_link.size(), UAVTALK_MIN_HEADER_LENGTH + 1U + 34U + UAVTALK_CHECKSUM_LENGTH);
+    ut_objects[UT_OBJ_SYSTEMSTATS].data[0][SYSTEMSTATS_CPULOAD] = 99;
+    send(UT_OBJ_SYSTEMSTATS);
+    EXPECT_EQ(2U, committed_frames);
+    EXPECT_EQ(UAVTALK_MIN_HEADER_LENGTH + 1U + 34U + UAVTALK_CHECKSUM_LENGTH, last_reserved_length);
+    EXPECT_EQ(2U * (UAVTALK_MIN_HEADER_LENGTH + 1U + UAVTALK_CHECKSUM_LENGTH) + 34U + 2U + 1U, tx_link.size());
+
+    fill(UT_OBJ_SYSTEMSTATS, 0);
+    EXPECT_EQ(2U, receive());
+    EXPECT_EQ(99, ut_objects[UT_OBJ_SYSTEMSTATS].data[0][SYSTEMSTATS_CPULOAD]);
+}
+
+TEST_F(UAVTalkOutputBufferTest, FallsBackWithoutRoom) {
+    ASSERT_EQ(0, UAVTalkSetOutputBuffer(tx, reserve_room, commit_room));
+    lend_room = false;
+
+    send(UT_OBJ_ATTITUDEACTUAL);
+    send(UT_OBJ_FLIGHTSTATUS);
+    EXPECT_EQ(0U, committed_frames);
+    EXPECT_EQ(2U, tx_frames);
+    EXPECT_EQ(2U, receive());
+
+    UAVTalkStats stats;
+    UAVTalkGetStats(tx, &stats);
+    EXPECT_EQ(2U, stats.txObjects);
+    EXPECT_EQ(tx_link.size(), stats.txBytes);
+}
+
+TEST_F(UAVTalkOutputBufferTest, BothCallbacksOrNone) {
+    EXPECT_EQ(-1, UAVTalkSetOutputBuffer(tx, reserve_room, NULL));
+    EXPECT_EQ(-1, UAVTalkSetOutputBuffer(tx, NULL, commit_room));
+    EXPECT_EQ(0, UAVTalkSetOutputBuffer(tx, reserve_room, commit_room));
+    EXPECT_EQ(0, UAVTalkSetOutputBuffer(tx, NULL, NULL));
+
+    send(UT_OBJ_ATTITUDEACTUAL);
+    EXPECT_EQ(0U, committed_frames);
+    EXPECT_EQ(1U, tx_frames);
+}
+
+/* Acks sent back by the receiving side */
+static std::vector<uint8_t> ack_link;
+
+static int32_t ack_stream(uint8_t *data, int32_t length)
+{
+    ack_link.insert(ack_link.end(), data, data + length);
+    return length;
+}
+
+#define ACK_TIMEOUT_MS 100
+#define ACK_RETRIES    2
+
+class UAVTalkAsyncTest : public UAVTalkTest {
+protected:
+    virtual void SetUp()
+    {
+        UAVTalkTest::SetUp();
+        ack_link.clear();
+        ASSERT_EQ(0, UAVTalkSetOutputStream(rx, ack_stream));
+    }
+
+    void send_acked(uint32_t obj, uint16_t inst = 0)
+    {
+        EXPECT_EQ(0, UAVTalkSendObjectAsync(tx, &ut_objects[obj], inst, 1, ACK_TIMEOUT_MS, ACK_RETRIES));
+    }
+
+    /* Let the other side receive everything sent so far and deliver its acks */
+    void deliver()
+    {
+        receive();
+        tx_link.clear();
+        for (size_t i = 0; i < ack_link.size(); i++) {
+            UAVTalkProcessInputStream(tx, ack_link[i]);
+        }
+        ack_link.clear();
+    }
+
+    UAVTalkStats stats()
+    {
+        UAVTalkStats stats;
+
+        UAVTalkGetStats(tx, &stats);
+        return stats;
+    }
+};
+
+TEST_F(UAVTalkAsyncTest, AckCompletesTransaction) {
+    send_acked(UT_OBJ_ATTITUDEACTUAL);
+    EXPECT_EQ(1U, tx_frames);
+    EXPECT_EQ(ACK_TIMEOUT_MS, UAVTalkProcessTransactions(tx));
+
+    ut_tick_count += 20;
+    deliver();
+    EXPECT_EQ(1U, ut_objects[UT_OBJ_ATTITUDEACTUAL].num_unpacked);
+    EXPECT_EQ(UAVTALK_WAITFOREVER, UAVTalkProcessTransactions(tx));
+
+    UAVTalkStats s = stats();
+    EXPECT_EQ(1U, s.rttSamples);
+    EXPECT_EQ(20U, s.rttSumMs);
+    EXPECT_EQ(0U, s.txRetries);
+    EXPECT_EQ(0U, s.txErrors);
+}
+
+TEST_F(UAVTalkAsyncTest, TimeoutRetriesThenFails) {
+    send_acked(UT_OBJ_ATTITUDEACTUAL);
+
+    for (uint32_t retry = 1; retry <= ACK_RETRIES; retry++) {
+        ut_tick_count += ACK_TIMEOUT_MS - 1;
+        EXPECT_EQ(1, UAVTalkProcessTransactions(tx));
+        EXPECT_EQ(retry, tx_frames);
+        ut_tick_count += 1;
+        EXPECT_EQ(ACK_TIMEOUT_MS, UAVTalkProcessTransactions(tx));
+        EXPECT_EQ(retry + 1, tx_frames);
+        EXPECT_EQ(retry, stats().txRetries);
+    }
+
+    ut_tick_count += ACK_TIMEOUT_MS;
+    EXPECT_EQ(UAVTALK_WAITFOREVER, UAVTalkProcessTransactions(tx));
+    EXPECT_EQ(ACK_RETRIES + 1U, tx_frames);
+    EXPECT_EQ(1U, stats().txErrors);
+}
+
+TEST_F(UAVTalkAsyncTest, AckAfterRetryHasNoRoundTrip) {
+    send_acked(UT_OBJ_ATTITUDEACTUAL);
+    ut_tick_count += ACK_TIMEOUT_MS;
+    EXPECT_EQ(ACK_TIMEOUT_MS, UAVTalkProcessTransactions(tx));
+
+    /* The ack can't be told apart from one for the first send */
+    deliver();
+    EXPECT_EQ(UAVTALK_WAITFOREVER, UAVTalkProcessTransactions(tx));
+
+    UAVTalkStats s = stats();
+    EXPECT_EQ(1U, s.txRetries);
+    EXPECT_EQ(0U, s.rttSamples);
+    EXPECT_EQ(0U, s.txErrors);
+}
+
+TEST_F(UAVTalkAsyncTest, WindowFullWaitsForFreeSlot) {
+    /* Fill the window with transactions that are never acked */
+    send_acked(UT_OBJ_GYROS);
+    send_acked(UT_OBJ_FLIGHTSTATUS);
+    send_acked(UT_OBJ_WAYPOINT, 0);
+    send_acked(UT_OBJ_WAYPOINT, 2);
+    ASSERT_EQ(4, UAVTALK_MAX_TRANSACTIONS);
+    EXPECT_EQ(0U, ut_tick_count);
+
+    /* Blocks until the first of them gave up */
+    send_acked(UT_OBJ_ATTITUDEACTUAL);
+    EXPECT_EQ((ACK_RETRIES + 1U) * ACK_TIMEOUT_MS, ut_tick_count);
+
+    UAVTalkStats s = stats();
+    EXPECT_EQ(UAVTALK_MAX_TRANSACTIONS * (uint32_t)ACK_RETRIES, s.txRetries);
+    EXPECT_EQ((uint32_t)UAVTALK_MAX_TRANSACTIONS, s.txErrors);
+    EXPECT_EQ(UAVTALK_MAX_TRANSACTIONS * (ACK_RETRIES + 1U) + 1U, tx_frames);
+
+    /* The new one is acked as usual */
+    deliver();
+    EXPECT_EQ(UAVTALK_WAITFOREVER, UAVTalkProcessTransactions(tx));
+    EXPECT_EQ(1U, stats().rttSamples);
+}
+
+TEST_F(UAVTalkAsyncTest, TakeoverKeepsRetries) {
+    send_acked(UT_OBJ_ATTITUDEACTUAL);
+    ut_tick_count += ACK_TIMEOUT_MS;
+    UAVTalkProcessTransactions(tx);
+
+    /* A newer update sent before the ack must not restart the retries */
+    send_acked(UT_OBJ_ATTITUDEACTUAL);
+    for (uint32_t i = 0; i < ACK_RETRIES; i++) {
+        ut_tick_count += ACK_TIMEOUT_MS;
+        UAVTalkProcessTransactions(tx);
+    }
+    EXPECT_EQ(1U, stats().txErrors);
+    EXPECT_EQ(UAVTALK_WAITFOREVER, UAVTalkProcessTransactions(tx));
+}
+
+TEST_F(UAVTalkAsyncTest, WaitTicksCoverTheTimeout) {
+    /* The tx task and a full window wait the same, never less than the time left */
+    send_acked(UT_OBJ_ATTITUDEACTUAL);
+    ut_tick_count += ACK_TIMEOUT_MS - 1;
+    EXPECT_EQ(1U, UAVTalkWaitTicks(UAVTalkProcessTransactions(tx)));
+    EXPECT_EQ(0U, UAVTalkWaitTicks(0));
+    EXPECT_EQ(portMAX_DELAY, UAVTalkWaitTicks(UAVTALK_WAITFOREVER));
+}
@@ -38,7 +38,15 @@
  */
 struct DelayedCallbackTaskStruct {
     DelayedCallbackInfo *callbackQueue[CALLBACK_PRIORITY_LOW + 1];
-    DelayedCallbackInfo *queueCursor[CALLBACK_PRIORITY_LOW + 1];
+    /*
+     * Callbacks waiting for execution, per priority in the order they were
+     * dispatched. Also modified from ISRs, so only touched in critical sections.
+     */
+    DelayedCallbackInfo *readyHead[CALLBACK_PRIORITY_LOW + 1];
+    DelayedCallbackInfo *readyTail[CALLBACK_PRIORITY_LOW + 1];
+    uint16_t readyCount[CALLBACK_PRIORITY_LOW + 1];
+    uint16_t roundLeft[CALLBACK_PRIORITY_LOW + 1]; // runs left before the next lower priority gets a turn
+    DelayedCallbackInfo *timerQueue; // scheduled callbacks sorted by deadline, protected by the mutex
     xTaskHandle callbackSchedulerTaskHandle;
     signed char name[3];
     uint32_t    stackSize;
@@ -54,8 +62,14 @@ struct DelayedCallbackInfoStruct {
     DelayedCallback   cb;
     bool volatile     waiting;
     uint32_t volatile scheduletime;
+    DelayedCallbackPriority priority;
+    uint32_t readyTime; // PIOS_DELAY raw time it was made ready
+    uint32_t readyLateUs; // how late past its deadline it was made ready
+    DelayedCallbackStats stats;
     struct DelayedCallbackTaskStruct *task;
     struct DelayedCallbackInfoStruct *next;
+    struct DelayedCallbackInfoStruct *nextReady;
+    struct DelayedCallbackInfoStruct *nextTimer;
 };
 
 
@@ -66,7 +80,12 @@ static bool schedulerStarted;
 
 // Private functions
 static void CallbackSchedulerTask(void *task);
-static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority);
+static void makeReady(DelayedCallbackInfo *cbinfo, uint32_t lateUs);
+static DelayedCallbackInfo *nextReady(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority);
+static void timerInsert(DelayedCallbackInfo *cbinfo);
+static void timerRemove(DelayedCallbackInfo *cbinfo);
+static uint32_t processTimers(struct DelayedCallbackTaskStruct *task);
+static void runCallback(DelayedCallbackInfo *cbinfo);
 
 /**
  * Initialize the scheduler
@@ -173,8 +192,10 @@ int32_t DelayedCallbackSchedule(
             result = 1;
         } else {
             result = 2;
+            timerRemove(cbinfo);
         }
         cbinfo->scheduletime = new;
+        timerInsert(cbinfo);
 
         // scheduler needs to be notified to adapt sleep times
         xSemaphoreGive(cbinfo->task->signal);
@@ -195,8 +216,10 @@ int32_t DelayedCallbackDispatch(DelayedCallbackInfo *cbinfo)
 {
     PIOS_Assert(cbinfo);
 
-    // no semaphore needed for the callback
-    cbinfo->waiting = true;
+    // no semaphore needed for the callback, the ready list is shared with ISRs
+    portENTER_CRITICAL();
+    makeReady(cbinfo, 0);
+    portEXIT_CRITICAL();
     // but the scheduler as a whole needs to be notified
     return xSemaphoreGive(cbinfo->task->signal);
 }
@@ -219,8 +242,10 @@ int32_t DelayedCallbackDispatchFromISR(DelayedCallbackInfo *cbinfo, long *pxHigh
 {
     PIOS_Assert(cbinfo);
 
-    // no semaphore needed for the callback
-    cbinfo->waiting = true;
+    // no semaphore needed for the callback, just keep other ISRs out of the ready list
+    unsigned portBASE_TYPE savedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+    makeReady(cbinfo, 0);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(savedInterruptStatus);
     // but the scheduler as a whole needs to be notified
     return xSemaphoreGiveFromISR(cbinfo->task->signal, pxHigherPriorityTaskWoken);
 }
@@ -266,8 +291,12 @@ DelayedCallbackInfo *DelayedCallbackCreate(
         // initialize structure
         for (DelayedCallbackPriority p = 0; p <= CALLBACK_PRIORITY_LOW; p++) {
             task->callbackQueue[p] = NULL;
-            task->queueCursor[p]   = NULL;
+            task->readyHead[p]     = NULL;
+            task->readyTail[p]     = NULL;
+            task->readyCount[p]    = 0;
+            task->roundLeft[p]     = 0;
         }
+        task->timerQueue   = NULL;
         task->name[0]      = 'C';
         task->name[1]      = 'a' + t;
         task->name[2]      = 0;
@@ -319,10 +348,18 @@ DelayedCallbackInfo *DelayedCallbackCreate(
         return NULL; // error - not enough memory
     }
     info->next    = NULL;
+    info->nextReady    = NULL;
+    info->nextTimer    = NULL;
     info->waiting = false;
     info->scheduletime = 0;
+    info->priority     = priority;
+    info->readyTime    = 0;
+    info->readyLateUs  = 0;
     info->task    = task;
     info->cb = cb;
+    memset(&info->stats, 0, sizeof(DelayedCallbackStats));
+    info->stats.priority     = priority;
+    info->stats.priorityTask = priorityTask;
 
     // add to scheduling queue
     LL_APPEND(task->callbackQueue[priority], info);
@@ -333,68 +370,197 @@ DelayedCallbackInfo *DelayedCallbackCreate(
 }
 
 /**
- * Scheduler subtask
+ * Report the statistics of every registered callback. Ids follow the order
+ * of the scheduler tasks and priorities, they are stable as long as no new
+ * callbacks are created.
+ * \param[in] callback Called for each registered callback
+ * \param[in] context Passed on to the callback
+ */
+void CallbackSchedulerForEachCallback(DelayedCallbackStatsCallback callback, void *context)
+{
+    struct DelayedCallbackTaskStruct *task = NULL;
+    DelayedCallbackInfo *info;
+    int16_t callback_id = 0;
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    LL_FOREACH(schedulerTasks, task) {
+        for (DelayedCallbackPriority p = 0; p <= CALLBACK_PRIORITY_LOW; p++) {
+            LL_FOREACH(task->callbackQueue[p], info) {
+                callback(callback_id++, &info->stats, context);
+            }
+        }
+    }
+    xSemaphoreGiveRecursive(mutex);
+}
+
+/**
+ * Append a callback to the ready list of its priority, unless it is
+ * already waiting. Must be called in a critical section.
+ * \param[in] cbinfo the callback handle
+ * \param[in] lateUs how late the callback is already, 0 if dispatched right now
+ */
+static void makeReady(DelayedCallbackInfo *cbinfo, uint32_t lateUs)
+{
+    if (cbinfo->waiting) {
+        return;
+    }
+
+    struct DelayedCallbackTaskStruct *task = cbinfo->task;
+    DelayedCallbackPriority priority = cbinfo->priority;
+
+    cbinfo->waiting     = true;
+    cbinfo->readyTime   = PIOS_DELAY_GetRaw();
+    cbinfo->readyLateUs = lateUs;
+    cbinfo->nextReady   = NULL;
+    if (task->readyTail[priority]) {
+        task->readyTail[priority]->nextReady = cbinfo;
+    } else {
+        task->readyHead[priority] = cbinfo;
+    }
+    task->readyTail[priority] = cbinfo;
+    task->readyCount[priority]++;
+}
+
+/**
+ * Take the next callback to run off the ready lists. Each priority runs its
+ * ready callbacks in dispatch order, once per round, and then leaves one
+ * slot to the next lower priority.
  * \param[in] task The scheduler task in question
- * \param[in] priority The scheduling priority of the callback to search for
- * \return wait time until next scheduled callback is due - 0 if a callback has just been executed
+ * \param[in] priority The highest priority to look at
+ * \return the callback to run or NULL if none is ready
  */
-static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority)
+static DelayedCallbackInfo *nextReady(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority)
 {
-    int32_t result = MAX_SLEEP;
-    int32_t diff   = 0;
+    DelayedCallbackInfo *cbinfo;
 
     // no such queue
     if (priority > CALLBACK_PRIORITY_LOW) {
-        return result;
+        return NULL;
     }
 
-    // queue is empty, search a lower priority queue
-    if (task->callbackQueue[priority] == NULL) {
-        return runNextCallback(task, priority + 1);
+    // round is over, a lower priority callback gets a turn
+    if (task->roundLeft[priority] == 0) {
+        cbinfo = nextReady(task, priority + 1);
+        task->roundLeft[priority] = task->readyCount[priority];
+        if (cbinfo) {
+            return cbinfo;
+        }
     }
 
-    DelayedCallbackInfo *current = task->queueCursor[priority];
-    DelayedCallbackInfo *next;
-    do {
-        if (current == NULL) {
-            next = task->callbackQueue[priority]; // loop around the end of the list
-            // also attempt to run a callback that has lower priority
-            // every time the queue is completely traversed
-            diff = runNextCallback(task, priority + 1);
-            if (!diff) {
-                task->queueCursor[priority] = next; // the recursive call has executed a callback
-                return 0;
-            }
-            if (diff < result) {
+    portENTER_CRITICAL();
+    cbinfo = task->readyHead[priority];
+    if (cbinfo) {
+        task->readyHead[priority] = cbinfo->nextReady;
+        if (!cbinfo->nextReady) {
+            task->readyTail[priority] = NULL;
+        }
+        task->readyCount[priority]--;
+        cbinfo->waiting = false; // the flag is reset just before execution.
+    }
+    portEXIT_CRITICAL();
+
+    if (!cbinfo) {
+        // queue is empty, search a lower priority queue
+        return nextReady(task, priority + 1);
+    }
+    if (task->roundLeft[priority] > 0) {
+        task->roundLeft[priority]--;
+    }
+    return cbinfo;
+}
+
+/**
+ * Insert a callback into the deadline ordered timer queue of its task.
+ * Must be called with the mutex held.
+ */
+static void timerInsert(DelayedCallbackInfo *cbinfo)
+{
+    DelayedCallbackInfo **cursor = &cbinfo->task->timerQueue;
+
+    // deadlines are compared as differences to survive the tick counter wrapping around
+    while (*cursor && (int32_t)((*cursor)->scheduletime - cbinfo->scheduletime) <= 0) {
+        cursor = &(*cursor)->nextTimer;
+    }
+    cbinfo->nextTimer = *cursor;
+    *cursor = cbinfo;
+}
+
+/**
+ * Remove a callback from the timer queue of its task, if it is in there.
+ * Must be called with the mutex held.
+ */
+static void timerRemove(DelayedCallbackInfo *cbinfo)
+{
+    DelayedCallbackInfo **cursor = &cbinfo->task->timerQueue;
+
+    while (*cursor && *cursor != cbinfo) {
+        cursor = &(*cursor)->nextTimer;
+    }
+    if (*cursor) {
+        *cursor = cbinfo->nextTimer;
+        cbinfo->nextTimer = NULL;
+    }
+}
+
+/**
+ * Make all callbacks whose deadline passed ready, earliest first
+ * \param[in] task The scheduler task in question
+ * \return ticks until the next deadline, at most MAX_SLEEP
+ */
+static uint32_t processTimers(struct DelayedCallbackTaskStruct *task)
+{
+    uint32_t result = MAX_SLEEP;
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY); // access to scheduletime should be mutex protected
+    uint32_t now = xTaskGetTickCount();
+    while (task->timerQueue) {
+        DelayedCallbackInfo *cbinfo = task->timerQueue;
+        int32_t diff = cbinfo->scheduletime - now;
+        if (diff > 0) {
+            if ((uint32_t)diff < result) {
                 result = diff; // adjust sleep time
             }
-        } else {
-            next = current->next;
-            xSemaphoreTakeRecursive(mutex, portMAX_DELAY); // access to scheduletime should be mutex protected
-            if (current->scheduletime) {
-                diff = current->scheduletime - xTaskGetTickCount();
-                if (diff <= 0) {
-                    current->waiting = true;
-                } else if (diff < result) {
-                    result = diff; // adjust sleep time
-                }
-            }
-            if (current->waiting) {
-                task->queueCursor[priority] = next;
-                current->scheduletime = 0; // any schedules are reset
-                current->waiting = false; // the flag is reset just before execution.
-                xSemaphoreGiveRecursive(mutex);
-                current->cb(); // call the callback
-                return 0;
-            }
-            xSemaphoreGiveRecursive(mutex);
+            break;
         }
-        current = next;
-    } while (current != task->queueCursor[priority]);
-    // once the list has been traversed entirely without finding any to be executed task, abort (nothing to do)
+        task->timerQueue     = cbinfo->nextTimer;
+        cbinfo->nextTimer    = NULL;
+        cbinfo->scheduletime = 0;
+        portENTER_CRITICAL();
+        makeReady(cbinfo, (uint32_t)(-diff) * portTICK_RATE_MS * 1000);
+        portEXIT_CRITICAL();
+    }
+    xSemaphoreGiveRecursive(mutex);
+
     return result;
 }
 
+/**
+ * Run a callback taken off the ready list and account for it
+ */
+static void runCallback(DelayedCallbackInfo *cbinfo)
+{
+    // any schedules are reset
+    if (cbinfo->scheduletime) {
+        xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+        timerRemove(cbinfo);
+        cbinfo->scheduletime = 0;
+        xSemaphoreGiveRecursive(mutex);
+    }
+
+    uint32_t latencyUs = PIOS_DELAY_DiffuS(cbinfo->readyTime) + cbinfo->readyLateUs;
+    uint32_t start     = PIOS_DELAY_GetRaw();
+    cbinfo->cb(); // call the callback
+    uint32_t executionUs = PIOS_DELAY_DiffuS(start);
+
+    cbinfo->stats.runCount++;
+    if (latencyUs > cbinfo->stats.maxLatencyUs) {
+        cbinfo->stats.maxLatencyUs = latencyUs;
+    }
+    if (executionUs > cbinfo->stats.maxExecutionUs) {
+        cbinfo->stats.maxExecutionUs = executionUs;
+    }
+}
+
 /**
  * Scheduler task, responsible of invoking callbacks.
  * \param[in] task The scheduling task being run
@@ -404,8 +570,11 @@ static void CallbackSchedulerTask(void *task)
     uint32_t delay = 0;
 
     while (1) {
-        delay = runNextCallback((struct DelayedCallbackTaskStruct *)task, CALLBACK_PRIORITY_CRITICAL);
-        if (delay) {
+        delay = processTimers((struct DelayedCallbackTaskStruct *)task);
+        DelayedCallbackInfo *cbinfo = nextReady((struct DelayedCallbackTaskStruct *)task, CALLBACK_PRIORITY_CRITICAL);
+        if (cbinfo) {
+            runCallback(cbinfo);
+        } else {
             // nothing to do but sleep
             xSemaphoreTake(((struct DelayedCallbackTaskStruct *)task)->signal, delay);
         }
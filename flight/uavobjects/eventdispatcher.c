@@ -43,6 +43,8 @@
 
 #define TASK_PRIORITY        (tskIDLE_PRIORITY + 3)
 #define MAX_UPDATE_PERIOD_MS 1000
+#define HEAP_INITIAL_SIZE    16
+#define HEAP_NONE            0xFFFF
 
 // Private types
 
@@ -62,13 +64,24 @@ typedef struct {
 struct PeriodicObjectListStruct {
     EventCallbackInfo evInfo; /** Event callback information */
     uint16_t updatePeriodMs; /** Update period in ms or 0 if no periodic updates are needed */
-    int32_t  timeToNextUpdateMs; /** Time delay to the next update */
+    uint16_t heapIndex; /** Position in the timer heap or HEAP_NONE if not scheduled */
+    int32_t  timeToNextUpdateMs; /** System time of the next update */
+    bool     firstUpdate; /** The next update is the one sent right away once enabled, it is never late */
+    uint16_t maxLatenessMs; /** Worst delay between the due time and the dispatch */
+    uint16_t maxDispatchUs; /** Worst time spent in the callback or queue send */
     struct PeriodicObjectListStruct *next; /** Needed by linked list library (utlist.h) */
 };
 typedef struct PeriodicObjectListStruct PeriodicObjectList;
 
 // Private variables
 static PeriodicObjectList *mObjList;
+/*
+ * Scheduled entries of mObjList as a binary min-heap on timeToNextUpdateMs,
+ * the next update to dispatch is always mHeap[0]
+ */
+static PeriodicObjectList * *mHeap;
+static uint16_t mHeapCount;
+static uint16_t mHeapSize;
 static xQueueHandle mQueue;
 static xTaskHandle mEventTaskHandle;
 static xSemaphoreHandle mMutex;
@@ -80,6 +93,11 @@ static void eventTask();
 static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQueueHandle queue, uint16_t periodMs);
 static int32_t eventPeriodicUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, xQueueHandle queue, uint16_t periodMs);
 static uint16_t randomizePeriod(uint16_t periodMs);
+static void scheduleFirstUpdate(PeriodicObjectList *objEntry, uint16_t periodMs);
+static void heapSchedule(PeriodicObjectList *objEntry);
+static void heapRemove(PeriodicObjectList *objEntry);
+static void heapSiftUp(uint16_t index);
+static void heapSiftDown(uint16_t index);
 
 
 /**
@@ -89,7 +107,10 @@ static uint16_t randomizePeriod(uint16_t periodMs);
 int32_t EventDispatcherInitialize()
 {
     // Initialize variables
-    mObjList = NULL;
+    mObjList   = NULL;
+    mHeap      = NULL;
+    mHeapCount = 0;
+    mHeapSize  = 0;
     memset(&mStats, 0, sizeof(EventStats));
 
     // Create mMutex
@@ -129,6 +150,21 @@ void EventClearStats()
     xSemaphoreGiveRecursive(mMutex);
 }
 
+/**
+ * Report the timing of every periodic event, worst cases since it was registered
+ * @param[in] iterator Called for each periodic event, from the caller's task
+ */
+void EventPeriodicIterateStats(void (*iterator)(const UAVObjEvent *ev, uint16_t periodMs, uint16_t maxLatenessMs, uint16_t maxDispatchUs))
+{
+    PeriodicObjectList *objEntry;
+
+    xSemaphoreTakeRecursive(mMutex, portMAX_DELAY);
+    LL_FOREACH(mObjList, objEntry) {
+        iterator(&objEntry->evInfo.ev, objEntry->updatePeriodMs, objEntry->maxLatenessMs, objEntry->maxDispatchUs);
+    }
+    xSemaphoreGiveRecursive(mMutex);
+}
+
 /**
  * Dispatch an event by invoking the supplied callback. The function
  * returns imidiatelly, the callback is invoked from the event task.
@@ -225,17 +261,23 @@ static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
     // Create handle
     objEntry = (PeriodicObjectList *)pvPortMalloc(sizeof(PeriodicObjectList));
     if (objEntry == NULL) {
+        xSemaphoreGiveRecursive(mMutex);
         return -1;
     }
     objEntry->evInfo.ev.obj      = ev->obj;
     objEntry->evInfo.ev.instId   = ev->instId;
+    objEntry->evInfo.ev.seq      = ev->seq;
     objEntry->evInfo.ev.event    = ev->event;
     objEntry->evInfo.cb = cb;
     objEntry->evInfo.queue       = queue;
     objEntry->updatePeriodMs     = periodMs;
-    objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
+    objEntry->heapIndex          = HEAP_NONE;
+    scheduleFirstUpdate(objEntry, periodMs);
+    objEntry->maxLatenessMs      = 0;
+    objEntry->maxDispatchUs      = 0;
     // Add to list
     LL_APPEND(mObjList, objEntry);
+    heapSchedule(objEntry);
     // Release lock
     xSemaphoreGiveRecursive(mMutex);
     return 0;
@@ -263,8 +305,21 @@ static int32_t eventPeriodicUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
             objEntry->evInfo.ev.instId == ev->instId &&
             objEntry->evInfo.ev.event == ev->event) {
             // Object found, update period
-            objEntry->updatePeriodMs     = periodMs;
-            objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
+            if (objEntry->updatePeriodMs != 0 && periodMs != 0 && !objEntry->firstUpdate) {
+                // Keep the phase of a running event, the next update is due one new period
+                // after the last one, or at the first point after now on that grid. Updating
+                // many periods at once then neither bunches nor bursts them.
+                int32_t timeNow     = xTaskGetTickCount() * portTICK_RATE_MS;
+                int32_t sinceLastMs = timeNow - (objEntry->timeToNextUpdateMs - objEntry->updatePeriodMs);
+                if (sinceLastMs < 0) {
+                    sinceLastMs = 0;
+                }
+                objEntry->timeToNextUpdateMs = timeNow + periodMs - sinceLastMs % periodMs;
+            } else {
+                scheduleFirstUpdate(objEntry, periodMs);
+            }
+            objEntry->updatePeriodMs = periodMs;
+            heapSchedule(objEntry);
             // Release lock
             xSemaphoreGiveRecursive(mMutex);
             return 0;
@@ -319,49 +374,179 @@ static int32_t processPeriodicUpdates()
     PeriodicObjectList *objEntry;
     int32_t timeNow;
     int32_t timeToNextUpdate;
-    int32_t offset;
+    int32_t lateness;
 
     // Get lock
     xSemaphoreTakeRecursive(mMutex, portMAX_DELAY);
 
-    // Iterate through each object and update its timer, if zero then transmit object.
-    // Also calculate smallest delay to next update.
-    timeToNextUpdate = xTaskGetTickCount() * portTICK_RATE_MS + MAX_UPDATE_PERIOD_MS;
-    LL_FOREACH(mObjList, objEntry) {
-        // If object is configured for periodic updates
-        if (objEntry->updatePeriodMs > 0) {
-            // Check if time for the next update
-            timeNow = xTaskGetTickCount() * portTICK_RATE_MS;
-            if (objEntry->timeToNextUpdateMs <= timeNow) {
-                // Reset timer
-                offset = (timeNow - objEntry->timeToNextUpdateMs) % objEntry->updatePeriodMs;
-                objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - offset;
-                // Invoke callback, if one
-                if (objEntry->evInfo.cb != 0) {
-                    objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
-                }
-                // Push event to queue, if one
-                if (objEntry->evInfo.queue != 0) {
-                    if (xQueueSend(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != pdTRUE) { // do not block if queue is full
-                        if (objEntry->evInfo.ev.obj != NULL) {
-                            mStats.lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
-                        }
-                        ++mStats.eventErrors;
-                    }
+    // Dispatch every update that is due, earliest first. Each one is
+    // rescheduled before its callback runs so the callback may change it.
+    timeNow = xTaskGetTickCount() * portTICK_RATE_MS;
+    while (mHeapCount > 0 && mHeap[0]->timeToNextUpdateMs <= timeNow) {
+        objEntry = mHeap[0];
+
+        // Reset timer
+        lateness = timeNow - objEntry->timeToNextUpdateMs;
+        objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - lateness % objEntry->updatePeriodMs;
+        heapSiftDown(0);
+        if (objEntry->firstUpdate) {
+            objEntry->firstUpdate = false;
+            lateness = 0;
+        }
+
+        uint32_t dispatchStart = PIOS_DELAY_GetRaw();
+        // Invoke callback, if one
+        if (objEntry->evInfo.cb != 0) {
+            objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
+        }
+        // Push event to queue, if one
+        if (objEntry->evInfo.queue != 0) {
+            if (xQueueSend(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != pdTRUE) { // do not block if queue is full
+                if (objEntry->evInfo.ev.obj != NULL) {
+                    mStats.lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
                 }
+                ++mStats.eventErrors;
             }
-            // Update minimum delay
-            if (objEntry->timeToNextUpdateMs < timeToNextUpdate) {
-                timeToNextUpdate = objEntry->timeToNextUpdateMs;
-            }
+        }
+        uint32_t dispatchUs = PIOS_DELAY_DiffuS(dispatchStart);
+
+        // Timing statistics, per object and worst overall
+        uint32_t objId = (objEntry->evInfo.ev.obj != NULL) ? UAVObjGetID(objEntry->evInfo.ev.obj) : 0;
+        if (lateness > objEntry->maxLatenessMs) {
+            objEntry->maxLatenessMs = (lateness > 0xFFFF) ? 0xFFFF : lateness;
+        }
+        if (dispatchUs > objEntry->maxDispatchUs) {
+            objEntry->maxDispatchUs = (dispatchUs > 0xFFFF) ? 0xFFFF : dispatchUs;
+        }
+        if ((uint32_t)lateness > mStats.maxLatenessMs) {
+            mStats.maxLatenessMs = lateness;
+            mStats.maxLatenessID = objId;
+        }
+        if (dispatchUs > mStats.maxDispatchUs) {
+            mStats.maxDispatchUs = dispatchUs;
+            mStats.maxDispatchID = objId;
         }
     }
 
+    // Wake up for the next update, or at least every MAX_UPDATE_PERIOD_MS
+    timeToNextUpdate = timeNow + MAX_UPDATE_PERIOD_MS;
+    if (mHeapCount > 0 && mHeap[0]->timeToNextUpdateMs < timeToNextUpdate) {
+        timeToNextUpdate = mHeap[0]->timeToNextUpdateMs;
+    }
+
     // Done
     xSemaphoreGiveRecursive(mMutex);
     return timeToNextUpdate;
 }
 
+/**
+ * Put an entry in the timer heap at its timeToNextUpdateMs, or take it out
+ * if periodic updates are disabled. Must be called with mMutex held.
+ */
+static void heapSchedule(PeriodicObjectList *objEntry)
+{
+    if (objEntry->updatePeriodMs == 0) {
+        heapRemove(objEntry);
+        return;
+    }
+
+    if (objEntry->heapIndex == HEAP_NONE) {
+        // Grow the heap geometrically, entries are never freed so neither is it
+        if (mHeapCount == mHeapSize) {
+            uint16_t size = mHeapSize ? mHeapSize * 2 : HEAP_INITIAL_SIZE;
+            PeriodicObjectList * *heap = (PeriodicObjectList * *)pvPortMalloc(size * sizeof(PeriodicObjectList *));
+            if (heap == NULL) {
+                // Stays registered but unscheduled, as if its period was 0
+                ++mStats.eventErrors;
+                return;
+            }
+            if (mHeap) {
+                memcpy(heap, mHeap, mHeapCount * sizeof(PeriodicObjectList *));
+                vPortFree(mHeap);
+            }
+            mHeap     = heap;
+            mHeapSize = size;
+        }
+        objEntry->heapIndex = mHeapCount;
+        mHeap[mHeapCount++] = objEntry;
+    }
+
+    // The due time may have moved either way
+    heapSiftUp(objEntry->heapIndex);
+    heapSiftDown(objEntry->heapIndex);
+}
+
+/**
+ * Take an entry out of the timer heap, if it is in there
+ */
+static void heapRemove(PeriodicObjectList *objEntry)
+{
+    uint16_t index = objEntry->heapIndex;
+
+    if (index == HEAP_NONE) {
+        return;
+    }
+    objEntry->heapIndex = HEAP_NONE;
+
+    // Move the last entry into the hole and restore the heap order
+    if (index != --mHeapCount) {
+        mHeap[index] = mHeap[mHeapCount];
+        mHeap[index]->heapIndex = index;
+        heapSiftUp(index);
+        heapSiftDown(index);
+    }
+}
+
+static void heapSiftUp(uint16_t index)
+{
+    PeriodicObjectList *objEntry = mHeap[index];
+
+    while (index > 0) {
+        uint16_t parent = (index - 1) / 2;
+        if (mHeap[parent]->timeToNextUpdateMs <= objEntry->timeToNextUpdateMs) {
+            break;
+        }
+        mHeap[index] = mHeap[parent];
+        mHeap[index]->heapIndex = index;
+        index = parent;
+    }
+    mHeap[index] = objEntry;
+    objEntry->heapIndex = index;
+}
+
+static void heapSiftDown(uint16_t index)
+{
+    PeriodicObjectList *objEntry = mHeap[index];
+
+    while (1) {
+        uint16_t child = 2 * index + 1;
+        if (child >= mHeapCount) {
+            break;
+        }
+        if (child + 1 < mHeapCount && mHeap[child + 1]->timeToNextUpdateMs < mHeap[child]->timeToNextUpdateMs) {
+            child++;
+        }
+        if (objEntry->timeToNextUpdateMs <= mHeap[child]->timeToNextUpdateMs) {
+            break;
+        }
+        mHeap[index] = mHeap[child];
+        mHeap[index]->heapIndex = index;
+        index = child;
+    }
+    mHeap[index] = objEntry;
+    objEntry->heapIndex = index;
+}
+
+/**
+ * Make a newly enabled event due right away. Its due time is set back by part of a
+ * period, so the updates after the first one are spread out to avoid bunching.
+ */
+static void scheduleFirstUpdate(PeriodicObjectList *objEntry, uint16_t periodMs)
+{
+    objEntry->timeToNextUpdateMs = xTaskGetTickCount() * portTICK_RATE_MS - periodMs + randomizePeriod(periodMs);
+    objEntry->firstUpdate = true;
+}
+
 /**
  * Return a psedorandom integer from 0 to periodMs
  * Based on the Park-Miller-Carta Pseudo-Random Number Generator
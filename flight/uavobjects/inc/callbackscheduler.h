@@ -51,6 +51,8 @@ typedef enum {
 // And if onlz A and y need execution it will be:
 // ...AyAyAyAyAyAyAyAyAyAyAyAyAyAyAyAyAyAy...
 // despite their different priority they would get treated equally in this case.
+// Within a priority, callbacks run in the order they were dispatched. Scheduled
+// callbacks join that order when their deadline passes, earliest deadline first.
 //
 // WARNING: Callbacks ALWAYS should return as quickly as possible.  Otherwise
 // a low priority callback can block a critical one from being executed.
@@ -105,6 +107,18 @@ typedef struct DelayedCallbackInfoStruct DelayedCallbackInfo;
 // Be aware that using different priorityTasks for the same callback function
 // might cause your callback to be executed recursively in different task contexts!
 
+typedef struct {
+    uint32_t runCount; // number of times the callback ran
+    uint32_t maxLatencyUs; // worst time from dispatch or deadline to the start of the callback
+    uint32_t maxExecutionUs; // worst time spent in the callback
+    DelayedCallbackPriority     priority;
+    DelayedCallbackPriorityTask priorityTask;
+} DelayedCallbackStats;
+// Execution statistics of a callback, see CallbackSchedulerForEachCallback()
+
+typedef void (*DelayedCallbackStatsCallback)(int16_t callback_id, const DelayedCallbackStats *stats, void *context);
+// Iterator called for each registered callback.
+
 // Public functions
 //
 
@@ -184,4 +198,13 @@ int32_t DelayedCallbackDispatch(DelayedCallbackInfo *cbinfo);
  */
 int32_t DelayedCallbackDispatchFromISR(DelayedCallbackInfo *cbinfo, long *pxHigherPriorityTaskWoken);
 
+/**
+ * Report the statistics of every registered callback. Ids follow the order
+ * of the scheduler tasks and priorities, they are stable as long as no new
+ * callbacks are created.
+ * \param[in] callback Called for each registered callback
+ * \param[in] context Passed on to the callback
+ */
+void CallbackSchedulerForEachCallback(DelayedCallbackStatsCallback callback, void *context);
+
 #endif // CALLBACKSCHEDULER_H
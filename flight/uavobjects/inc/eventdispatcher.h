@@ -33,12 +33,17 @@
 typedef struct {
     uint32_t lastErrorID;
     uint32_t eventErrors;
+    uint32_t maxLatenessMs; /* worst delay of a periodic event past its due time */
+    uint32_t maxLatenessID; /* object of that event */
+    uint32_t maxDispatchUs; /* worst time spent dispatching a periodic event */
+    uint32_t maxDispatchID; /* object of that event */
 } EventStats;
 
 // Public functions
 int32_t EventDispatcherInitialize();
 void EventGetStats(EventStats *statsOut);
 void EventClearStats();
+void EventPeriodicIterateStats(void (*iterator)(const UAVObjEvent *ev, uint16_t periodMs, uint16_t maxLatenessMs, uint16_t maxDispatchUs));
 int32_t EventCallbackDispatch(UAVObjEvent *ev, UAVObjEventCallback cb);
 int32_t EventPeriodicCallbackCreate(UAVObjEvent *ev, UAVObjEventCallback cb, uint16_t periodMs);
 int32_t EventPeriodicCallbackUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, uint16_t periodMs);
@@ -113,6 +113,7 @@ typedef enum {
 typedef struct {
     UAVObjHandle    obj;
     uint16_t        instId;
+    uint16_t        seq; /** Object update sequence when the event was sent, see UAVObjEventIsStale() */
     UAVObjEventType event;
 } UAVObjEvent;
 
@@ -136,13 +137,15 @@ typedef struct {
     uint32_t eventCallbackErrors;
     uint32_t lastCallbackErrorID;
     uint32_t lastQueueErrorID;
+    uint32_t lockContention; /* mutex takes that had to wait plus lock free reads that were retried */
+    uint32_t eventsCoalesced; /* events folded into a pending one on coalesced queues, dropped ones count as eventQueueErrors */
 } UAVObjStats;
 
 int32_t UAVObjInitialize();
 void UAVObjGetStats(UAVObjStats *statsOut);
 void UAVObjClearStats();
 UAVObjHandle UAVObjRegister(uint32_t id,
-                            int32_t isSingleInstance, int32_t isSettings, uint32_t numBytes, UAVObjInitializeCallback initCb);
+                            int32_t isSingleInstance, int32_t isSettings, uint32_t numBytes, uint16_t numInstances, UAVObjInitializeCallback initCb);
 UAVObjHandle UAVObjGetByID(uint32_t id);
 uint32_t UAVObjGetID(UAVObjHandle obj);
 uint32_t UAVObjGetNumBytes(UAVObjHandle obj);
@@ -152,6 +155,8 @@ uint16_t UAVObjCreateInstance(UAVObjHandle obj_handle, UAVObjInitializeCallback
 bool UAVObjIsSingleInstance(UAVObjHandle obj);
 bool UAVObjIsMetaobject(UAVObjHandle obj);
 bool UAVObjIsSettings(UAVObjHandle obj);
+int32_t UAVObjSetFieldSizes(UAVObjHandle obj_handle, const uint16_t *fieldSizes, uint8_t numFields);
+uint8_t UAVObjGetFieldSizes(UAVObjHandle obj_handle, const uint16_t * *fieldSizes);
 int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId, const uint8_t *dataIn);
 int32_t UAVObjPack(UAVObjHandle obj_handle, uint16_t instId, uint8_t *dataOut);
 int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId);
@@ -164,6 +169,9 @@ int32_t UAVObjLoadFromFile(UAVObjHandle obj_handle, FILEINFO *file);
 int32_t UAVObjSaveSettings();
 int32_t UAVObjLoadSettings();
 int32_t UAVObjDeleteSettings();
+void UAVObjMarkSettingsDirty();
+void UAVObjCollectSettings();
+int32_t UAVObjSaveCollectedSettings();
 int32_t UAVObjSaveMetaobjects();
 int32_t UAVObjLoadMetaobjects();
 int32_t UAVObjDeleteMetaobjects();
@@ -175,6 +183,10 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId, const vo
 int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, const void *dataIn, uint32_t offset, uint32_t size);
 int32_t UAVObjGetInstanceData(UAVObjHandle obj_handle, uint16_t instId, void *dataOut);
 int32_t UAVObjGetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, void *dataOut, uint32_t offset, uint32_t size);
+void *UAVObjBorrowInstanceData(UAVObjHandle obj_handle, uint16_t instId);
+const void *UAVObjBorrowInstanceDataConst(UAVObjHandle obj_handle, uint16_t instId);
+int32_t UAVObjCommitInstanceData(UAVObjHandle obj_handle, uint16_t instId);
+void UAVObjReturnInstanceData(UAVObjHandle obj_handle, uint16_t instId);
 int32_t UAVObjSetMetadata(UAVObjHandle obj_handle, const UAVObjMetadata *dataIn);
 int32_t UAVObjGetMetadata(UAVObjHandle obj_handle, UAVObjMetadata *dataOut);
 uint8_t UAVObjGetMetadataAccess(const UAVObjMetadata *dataOut);
@@ -192,6 +204,9 @@ UAVObjUpdateMode UAVObjGetGcsTelemetryUpdateMode(const UAVObjMetadata *dataOut);
 void UAVObjSetTelemetryGcsUpdateMode(UAVObjMetadata *dataOut, UAVObjUpdateMode val);
 int8_t UAVObjReadOnly(UAVObjHandle obj);
 int32_t UAVObjConnectQueue(UAVObjHandle obj_handle, xQueueHandle queue, uint8_t eventMask);
+int32_t UAVObjConnectQueueCoalesced(UAVObjHandle obj_handle, xQueueHandle queue, uint8_t eventMask);
+int32_t UAVObjReceiveEvent(xQueueHandle queue, UAVObjEvent *ev, portTickType timeout);
+bool UAVObjEventIsStale(const UAVObjEvent *ev);
 int32_t UAVObjDisconnectQueue(UAVObjHandle obj_handle, xQueueHandle queue);
 int32_t UAVObjConnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb, uint8_t eventMask);
 int32_t UAVObjDisconnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb);
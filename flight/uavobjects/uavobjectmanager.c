@@ -63,6 +63,15 @@ extern struct UAVOData *__start__uavo_handles[] __attribute__((weak));
 extern struct UAVOData *__stop__uavo_handles[] __attribute__((weak));
 #endif
 
+/*
+ * Registered data UAVOs sorted by ID, meta objects are found through their
+ * data object. Sized from the handle table at init so it never grows, and
+ * kept sorted on every insert so lookups can binary search it without the lock.
+ */
+static struct UAVOData * *uavo_index;
+static volatile uint16_t uavo_index_count;
+static uint16_t uavo_index_size;
+
 #define UAVO_LIST_ITERATE(_item) \
     for (struct UAVOData * *_uavo_slot = __start__uavo_handles; \
          _uavo_slot && _uavo_slot < __stop__uavo_handles; \
@@ -82,16 +91,18 @@ struct ObjectEventEntry {
     xQueueHandle queue;
     UAVObjEventCallback     cb;
     uint8_t eventMask;
+    bool     coalesce; /** Queue at most one event of each type per instance */
+    uint8_t  pending; /** Event types queued for pendingInstId and not received yet, guarded by a critical section */
+    uint16_t pendingInstId;
 };
 
 /*
    MetaInstance   == [UAVOBase [UAVObjMetadata]]
    SingleInstance == [UAVOBase [UAVOData [InstanceData]]]
-   MultiInstance  == [UAVOBase [UAVOData [NumInstances [InstanceData0 [next]]]]
-                                                  ____________________/
-   \-->[InstanceData1 [next]]
-                                                  _________...________/
-   \-->[InstanceDataN [next]]
+   MultiInstance  == [UAVOBase [UAVOData [NumInstances [Chunks [InstanceData0..ChunkSize-1]]]]
+                                                            |
+                                                            \-->[Chunk1 [InstanceDataChunkSize..]]
+                                                            \-->[ChunkN [...]]
  */
 
 /*
@@ -103,12 +114,22 @@ struct UAVOBase {
     /* Let these objects be added to an event queue */
     struct ObjectEventEntry *next_event;
 
+    /*
+     * Sequence lock for the instance data, odd while a writer is
+     * copying into it. Kept on a 2 byte boundary (see reserved) so the
+     * embedded meta object gets an aligned one as well.
+     */
+    volatile uint16_t seq;
+
     /* Describe the type of object that follows this header */
     struct UAVOInfo {
         bool isMeta        : 1;
         bool isSingle      : 1;
         bool isSettings    : 1;
+        bool isDirty       : 1; /* written since last saved to or loaded from flash */
+        bool isCollected   : 1; /* unpacked since UAVObjCollectSettings() */
     } flags;
+    uint8_t reserved;
 } __attribute__((packed));
 
 /* Augmented type for Meta UAVO */
@@ -140,24 +161,25 @@ struct UAVOSingle {
      */
 } __attribute__((packed));
 
-/* Part of a linked list of instances chained off of a multi instance UAVO. */
-struct UAVOMultiInst {
-    struct UAVOMultiInst *next;
-    uint8_t instance[];
-    /*
-     * Additional space will be malloc'd here to hold the
-     * the data for this instance.
-     */
-} __attribute__((packed));
-
-/* Augmented type for Multi Instance Data UAVO */
+/*
+ * Augmented type for Multi Instance Data UAVO
+ *
+ * Instances are stored in chunks of chunk_size contiguous instances, the
+ * first chunk is allocated with the object and sized from the object
+ * definition. Further chunks are only allocated when the object outgrows
+ * it, so instance N is always one division away.
+ */
 struct UAVOMulti {
     struct UAVOData uavo;
     uint16_t num_instances;
-    struct UAVOMultiInst instance0 __attribute__((aligned(4)));
+    uint16_t chunk_size;
+    uint16_t num_chunks; /* chunks allocated past the first one */
+    uint16_t max_chunks; /* capacity of the chunks table */
+    uint8_t * *chunks; /* allocated behind a link word, see retiredChunkTables */
+    uint8_t instance0[] __attribute__((aligned(4)));
     /*
      * Additional space will be malloc'd here to hold the
-     * the data for instance 0.
+     * the data for the first chunk of instances.
      */
 } __attribute__((packed));
 
@@ -171,18 +193,44 @@ struct UAVOMulti {
 
 /** all information about instances are dependant on object type **/
 #define ObjSingleInstanceDataOffset(obj) ((void *)(&(((struct UAVOSingle *)obj)->instance0)))
-#define InstanceDataOffset(inst)         ((void *)&(((struct UAVOMultiInst *)inst)->instance))
+#define InstanceStride(obj)              (((obj)->instance_size + 3) & ~3)
 #define InstanceData(instance)           (void *)instance
 
+/** number of lock free attempts before a reader falls back to the mutex **/
+#define SEQ_READ_ATTEMPTS                2
+
 // Private functions
 static int32_t sendEvent(struct UAVOBase *obj, uint16_t instId,
                          UAVObjEventType event);
 static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId);
+static int32_t addChunk(struct UAVOMulti *obj);
+static void freeRetiredChunkTables(void);
 static InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId);
 static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
-                          UAVObjEventCallback cb, uint8_t eventMask);
+                          UAVObjEventCallback cb, uint8_t eventMask, bool coalesce);
 static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue,
                              UAVObjEventCallback cb);
+static uint16_t indexFind(uint32_t id);
+static UAVObjHandle indexLookup(uint32_t id);
+static int32_t indexInsert(struct UAVOData *obj);
+static void lockObjects(void);
+static void seqWriteBegin(struct UAVOBase *obj);
+static void seqWriteEnd(struct UAVOBase *obj);
+static void writeInstance(struct UAVOBase *obj, void *instData, const void *dataIn, uint32_t size);
+static int32_t saveSettings(bool collectedOnly);
+#if defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS)
+static void markSaved(struct UAVOBase *obj, uint16_t seq);
+#endif
+static int32_t readInstance(struct UAVOBase *obj, uint16_t instId, void *dataOut, uint32_t offset, uint32_t size);
+static int32_t copyInstance(struct UAVOBase *obj, uint16_t instId, void *dataOut, uint32_t offset, uint32_t size);
+
+#if defined(DEBUG)
+static void borrowCheckBegin(UAVObjHandle obj_handle, uint16_t instId, const void *data, bool writable);
+static void borrowCheckEnd(UAVObjHandle obj_handle, uint16_t instId, bool writable);
+#else
+#define borrowCheckBegin(obj_handle, instId, data, writable)
+#define borrowCheckEnd(obj_handle, instId, writable)
+#endif
 
 #if defined(PIOS_USE_SETTINGS_ON_SDCARD) && defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS)
 #error Both PIOS_USE_SETTINGS_ON_SDCARD and PIOS_INCLUDE_FLASH_LOGFS_SETTINGS. Only one settings storage allowed.
@@ -209,6 +257,45 @@ static const UAVObjMetadata defMetadata = {
 
 static UAVObjStats stats;
 
+/* Settings unpacked from telemetry are collected for UAVObjSaveCollectedSettings() */
+static bool collectingSettings;
+
+/*
+ * Chunk tables replaced by addChunk() while a lock free reader may still be
+ * walking them. They are freed once no lock free read of a multi instance
+ * object is in progress. Each table is allocated with a link word in front
+ * of it, readers never touch that word.
+ */
+static uint8_t * *retiredChunkTables;
+static volatile uint32_t multiInstanceReaders;
+
+/*
+ * Field boundaries of the objects that have them registered, only the
+ * objects sent as field deltas do, see UAVObjSetFieldSizes().
+ */
+static struct UAVOFieldSizes {
+    struct UAVOFieldSizes *next;
+    UAVObjHandle   obj;
+    const uint16_t *sizes;
+    uint8_t num_fields;
+} *fieldSizesList;
+
+#if defined(DEBUG)
+/*
+ * Outstanding borrows, checked on commit/return. Borrows hold the mutex
+ * so the list only ever belongs to a single task.
+ */
+#define UAVOBJ_MAX_BORROWS 4
+static struct UAVOBorrow {
+    UAVObjHandle obj;
+    const void   *data;
+    uint16_t     instId;
+    bool writable;
+    uint8_t crc;
+} borrows[UAVOBJ_MAX_BORROWS];
+static uint8_t numBorrows;
+#endif
+
 /**
  * Initialize the object manager
  * \return 0 Success
@@ -230,6 +317,16 @@ int32_t UAVObjInitialize()
     memset(__start__uavo_handles, 0,
            (uintptr_t)__stop__uavo_handles - (uintptr_t)__start__uavo_handles);
 
+    // Every object that can register owns a slot in the handle table
+    uavo_index_count = 0;
+    uavo_index_size  = __start__uavo_handles ? (__stop__uavo_handles - __start__uavo_handles) : 0;
+    if (uavo_index_size > 0) {
+        uavo_index = (struct UAVOData * *)pvPortMalloc(uavo_index_size * sizeof(struct UAVOData *));
+        if (uavo_index == NULL) {
+            return -1;
+        }
+    }
+
     // Create mutex
     mutex = xSemaphoreCreateRecursiveMutex();
     if (mutex == NULL) {
@@ -250,7 +347,7 @@ int32_t UAVObjInitialize()
  */
 void UAVObjGetStats(UAVObjStats *statsOut)
 {
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
     memcpy(statsOut, &stats, sizeof(UAVObjStats));
     xSemaphoreGiveRecursive(mutex);
 }
@@ -260,7 +357,7 @@ void UAVObjGetStats(UAVObjStats *statsOut)
  */
 void UAVObjClearStats()
 {
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
     memset(&stats, 0, sizeof(UAVObjStats));
     xSemaphoreGiveRecursive(mutex);
 }
@@ -308,10 +405,12 @@ static struct UAVOData *UAVObjAllocSingle(uint32_t num_bytes)
     return &(uavo_single->uavo);
 }
 
-static struct UAVOData *UAVObjAllocMulti(uint32_t num_bytes)
+static struct UAVOData *UAVObjAllocMulti(uint32_t num_bytes, uint16_t num_instances)
 {
-    /* Compute the complete size of the object, including the data for a single embedded instance */
-    uint32_t object_size = sizeof(struct UAVOMulti) + num_bytes;
+    /* Compute the complete size of the object, including the data for the embedded chunk of instances */
+    uint32_t stride      = (num_bytes + 3) & ~3;
+    uint16_t chunk_size  = num_instances > 0 ? num_instances : 1;
+    uint32_t object_size = sizeof(struct UAVOMulti) + stride * chunk_size;
 
     /* Allocate the object from the heap */
     struct UAVOMulti *uavo_multi = (struct UAVOMulti *)pvPortMalloc(object_size);
@@ -328,9 +427,13 @@ static struct UAVOData *UAVObjAllocMulti(uint32_t num_bytes)
 
     /* Set up the type-specific part of the UAVO */
     uavo_multi->num_instances = 1;
+    uavo_multi->chunk_size    = chunk_size;
+    uavo_multi->num_chunks    = 0;
+    uavo_multi->max_chunks    = 0;
+    uavo_multi->chunks        = NULL;
 
     /* Clear the multi instance data carried in the UAVO */
-    memset(&(uavo_multi->instance0), 0, sizeof(struct UAVOMultiInst) + num_bytes);
+    memset(uavo_multi->instance0, 0, stride * chunk_size);
 
     /* Give back the generic UAVO part */
     return &(uavo_multi->uavo);
@@ -346,29 +449,35 @@ static struct UAVOData *UAVObjAllocMulti(uint32_t num_bytes)
  * \param[in] isSingleInstance Is this a single instance or multi-instance object
  * \param[in] isSettings Is this a settings object
  * \param[in] numBytes Number of bytes of object data (for one instance)
+ * \param[in] numInstances Number of instances to allocate storage for up front (multi-instance objects only)
  * \param[in] initCb Default field and metadata initialization function
  * \return Object handle, or NULL if failure.
  * \return
  */
 UAVObjHandle UAVObjRegister(uint32_t id,
                             int32_t isSingleInstance, int32_t isSettings,
-                            uint32_t num_bytes,
+                            uint32_t num_bytes, uint16_t num_instances,
                             UAVObjInitializeCallback initCb)
 {
     struct UAVOData *uavo_data = NULL;
 
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     /* Don't allow duplicate registrations */
     if (UAVObjGetByID(id)) {
         goto unlock_exit;
     }
 
+    /* The lookup index is sized for the objects linked in */
+    if (uavo_index_count >= uavo_index_size) {
+        goto unlock_exit;
+    }
+
     /* Map the various flags to one of the UAVO types we understand */
     if (isSingleInstance) {
         uavo_data = UAVObjAllocSingle(num_bytes);
     } else {
-        uavo_data = UAVObjAllocMulti(num_bytes);
+        uavo_data = UAVObjAllocMulti(num_bytes, num_instances);
     }
 
     if (!uavo_data) {
@@ -380,7 +489,9 @@ UAVObjHandle UAVObjRegister(uint32_t id,
     uavo_data->instance_size = num_bytes;
     if (isSettings) {
         uavo_data->base.flags.isSettings = true;
+        uavo_data->base.flags.isDirty    = true;
     }
+    indexInsert(uavo_data);
 
     /* Initialize the embedded meta UAVO */
     UAVObjInitMetaData(&uavo_data->metaObj);
@@ -414,26 +525,18 @@ unlock_exit:
  */
 UAVObjHandle UAVObjGetByID(uint32_t id)
 {
-    UAVObjHandle *found_obj = (UAVObjHandle *)NULL;
-
-    // Get lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    UAVObjHandle found_obj = indexLookup(id);
 
-    // Look for object
-    UAVO_LIST_ITERATE(tmp_obj)
-    if (tmp_obj->id == id) {
-        found_obj = (UAVObjHandle *)tmp_obj;
-        goto unlock_exit;
+    if (found_obj) {
+        return found_obj;
     }
-    if (MetaObjectId(tmp_obj->id) == id) {
-        found_obj = (UAVObjHandle *)&(tmp_obj->metaObj);
-        goto unlock_exit;
-    }
-}
 
-unlock_exit:
-xSemaphoreGiveRecursive(mutex);
-return found_obj;
+    // A miss may have raced with a registration shifting the index, retry under the lock
+    lockObjects();
+    found_obj = indexLookup(id);
+    xSemaphoreGiveRecursive(mutex);
+
+    return found_obj;
 }
 
 /**
@@ -549,7 +652,7 @@ uint16_t UAVObjCreateInstance(UAVObjHandle obj_handle,
     }
 
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     InstanceHandle instEntry;
     uint16_t instId = 0;
@@ -617,6 +720,56 @@ bool UAVObjIsSettings(UAVObjHandle obj_handle)
     return uavo_base->flags.isSettings;
 }
 
+/**
+ * Register the sizes of the fields of an object in packing order. The
+ * table is generated by the UAVObjectGenerator for the objects that may
+ * be sent as field deltas and must stay valid.
+ * \param[in] obj The object handle
+ * \param[in] fieldSizes Size of each field in bytes
+ * \param[in] numFields Number of fields
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjSetFieldSizes(UAVObjHandle obj_handle, const uint16_t *fieldSizes, uint8_t numFields)
+{
+    PIOS_Assert(obj_handle);
+
+    struct UAVOFieldSizes *entry = (struct UAVOFieldSizes *)pvPortMalloc(sizeof(struct UAVOFieldSizes));
+    if (entry == NULL) {
+        return -1;
+    }
+    entry->obj        = obj_handle;
+    entry->sizes      = fieldSizes;
+    entry->num_fields = numFields;
+
+    // Lookups do not lock, the entry is complete before it is linked
+    lockObjects();
+    LL_PREPEND(fieldSizesList, entry);
+    xSemaphoreGiveRecursive(mutex);
+
+    return 0;
+}
+
+/**
+ * Get the field sizes registered with UAVObjSetFieldSizes()
+ * \param[in] obj The object handle
+ * \param[out] fieldSizes Size of each field in bytes
+ * \return Number of fields, 0 if the object has no field sizes registered
+ */
+uint8_t UAVObjGetFieldSizes(UAVObjHandle obj_handle, const uint16_t * *fieldSizes)
+{
+    struct UAVOFieldSizes *entry;
+
+    PIOS_Assert(obj_handle);
+
+    LL_FOREACH(fieldSizesList, entry) {
+        if (entry->obj == obj_handle) {
+            *fieldSizes = entry->sizes;
+            return entry->num_fields;
+        }
+    }
+    return 0;
+}
+
 /**
  * Unpack an object from a byte array
  * \param[in] obj The object handle
@@ -630,7 +783,7 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId,
     PIOS_Assert(obj_handle);
 
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     int32_t rc = -1;
 
@@ -638,7 +791,7 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId,
         if (instId != 0) {
             goto unlock_exit;
         }
-        memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle), dataIn, MetaNumBytes);
+        writeInstance((struct UAVOBase *)obj_handle, MetaDataPtr((struct UAVOMeta *)obj_handle), dataIn, MetaNumBytes);
     } else {
         struct UAVOData *obj;
         InstanceHandle instEntry;
@@ -657,7 +810,10 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId,
             }
         }
         // Set the data
-        memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
+        writeInstance(&obj->base, InstanceData(instEntry), dataIn, obj->instance_size);
+        if (collectingSettings && obj->base.flags.isSettings) {
+            obj->base.flags.isCollected = true;
+        }
     }
 
     // Fire event
@@ -680,37 +836,7 @@ int32_t UAVObjPack(UAVObjHandle obj_handle, uint16_t instId, uint8_t *dataOut)
 {
     PIOS_Assert(obj_handle);
 
-    // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
-    int32_t rc = -1;
-
-    if (UAVObjIsMetaobject(obj_handle)) {
-        if (instId != 0) {
-            goto unlock_exit;
-        }
-        memcpy(dataOut, MetaDataPtr((struct UAVOMeta *)obj_handle), MetaNumBytes);
-    } else {
-        struct UAVOData *obj;
-        InstanceHandle instEntry;
-
-        // Cast handle to object
-        obj = (struct UAVOData *)obj_handle;
-
-        // Get the instance
-        instEntry = getInstance(obj, instId);
-        if (instEntry == NULL) {
-            goto unlock_exit;
-        }
-        // Pack data
-        memcpy(dataOut, InstanceData(instEntry), obj->instance_size);
-    }
-
-    rc = 0;
-
-unlock_exit:
-    xSemaphoreGiveRecursive(mutex);
-    return rc;
+    return readInstance((struct UAVOBase *)obj_handle, instId, dataOut, 0, UAVObjGetNumBytes(obj_handle));
 }
 
 #if defined(PIOS_USE_SETTINGS_ON_SDCARD)
@@ -734,7 +860,7 @@ int32_t UAVObjSaveToFile(UAVObjHandle obj_handle, uint16_t instId,
         return -1;
     }
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     if (UAVObjIsMetaobject(obj_handle)) {
         // Get the instance information
@@ -805,6 +931,9 @@ int32_t UAVObjSave(UAVObjHandle obj_handle, __attribute__((unused)) uint16_t ins
     PIOS_Assert(obj_handle);
 
 #if defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS)
+    // Writes during the save leave the object dirty
+    uint16_t seq = ((struct UAVOBase *)obj_handle)->seq;
+
     if (UAVObjIsMetaobject(obj_handle)) {
         if (instId != 0) {
             return -1;
@@ -828,6 +957,8 @@ int32_t UAVObjSave(UAVObjHandle obj_handle, __attribute__((unused)) uint16_t ins
             return -1;
         }
     }
+
+    markSaved((struct UAVOBase *)obj_handle, seq);
 #endif /* if defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS) */
 #if defined(PIOS_USE_SETTINGS_ON_SDCARD)
     FILEINFO file;
@@ -838,7 +969,7 @@ int32_t UAVObjSave(UAVObjHandle obj_handle, __attribute__((unused)) uint16_t ins
         return -1;
     }
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     // Get filename
     objectFilename(obj_handle, filename);
@@ -887,7 +1018,7 @@ int32_t UAVObjLoadFromFile(UAVObjHandle obj_handle, FILEINFO *file)
     objEntry = (struct UAVOBase *)obj_handle;
 
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     // Read the object ID
     if (PIOS_FREAD(file, &objId, sizeof(objId), &bytesRead)) {
@@ -919,11 +1050,14 @@ int32_t UAVObjLoadFromFile(UAVObjHandle obj_handle, FILEINFO *file)
             return -1;
         }
         // Read the instance data
+        seqWriteBegin(objEntry);
         if (PIOS_FREAD
                 (file, MetaDataPtr((struct UAVOMeta *)obj_handle), MetaNumBytes, &bytesRead)) {
+            seqWriteEnd(objEntry);
             xSemaphoreGiveRecursive(mutex);
             return -1;
         }
+        seqWriteEnd(objEntry);
     } else {
         // Get the instance information
         instEntry = getInstance((struct UAVOData *)objEntry, instId);
@@ -938,11 +1072,14 @@ int32_t UAVObjLoadFromFile(UAVObjHandle obj_handle, FILEINFO *file)
             }
         }
         // Read the instance data
+        seqWriteBegin(objEntry);
         if (PIOS_FREAD
                 (file, InstanceData(instEntry), ((struct UAVOData *)objEntry)->instance_size, &bytesRead)) {
+            seqWriteEnd(objEntry);
             xSemaphoreGiveRecursive(mutex);
             return -1;
         }
+        seqWriteEnd(objEntry);
     }
 
     // Fire event
@@ -973,7 +1110,15 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, __attribute__((unused)) uint16_t ins
         }
 
         // Fire event on success
-        if (PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle), UAVObjGetNumBytes(obj_handle)) == 0) {
+        lockObjects();
+        seqWriteBegin((struct UAVOBase *)obj_handle);
+        int32_t rc = PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle), UAVObjGetNumBytes(obj_handle));
+        seqWriteEnd((struct UAVOBase *)obj_handle);
+        if (rc == 0) {
+            ((struct UAVOBase *)obj_handle)->flags.isDirty = false;
+        }
+        xSemaphoreGiveRecursive(mutex);
+        if (rc == 0) {
             sendEvent((struct UAVOBase *)obj_handle, instId, EV_UNPACKED);
         } else {
             return -1;
@@ -986,7 +1131,15 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, __attribute__((unused)) uint16_t ins
         }
 
         // Fire event on success
-        if (PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, InstanceData(instEntry), UAVObjGetNumBytes(obj_handle)) == 0) {
+        lockObjects();
+        seqWriteBegin((struct UAVOBase *)obj_handle);
+        int32_t rc = PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId, InstanceData(instEntry), UAVObjGetNumBytes(obj_handle));
+        seqWriteEnd((struct UAVOBase *)obj_handle);
+        if (rc == 0) {
+            ((struct UAVOBase *)obj_handle)->flags.isDirty = false;
+        }
+        xSemaphoreGiveRecursive(mutex);
+        if (rc == 0) {
             sendEvent((struct UAVOBase *)obj_handle, instId, EV_UNPACKED);
         } else {
             return -1;
@@ -1004,7 +1157,7 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, __attribute__((unused)) uint16_t ins
         return -1;
     }
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     // Get filename
     objectFilename(obj_handle, filename);
@@ -1037,6 +1190,11 @@ int32_t UAVObjDelete(UAVObjHandle obj_handle, __attribute__((unused)) uint16_t i
 {
     PIOS_Assert(obj_handle);
 #if defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS)
+    // The next UAVObjSaveSettings() has to write it again
+    lockObjects();
+    ((struct UAVOBase *)obj_handle)->flags.isDirty = true;
+    xSemaphoreGiveRecursive(mutex);
+
     PIOS_FLASHFS_ObjDelete(pios_uavo_settings_fs_id, UAVObjGetID(obj_handle), instId);
 #endif
 #if defined(PIOS_USE_SETTINGS_ON_SDCARD)
@@ -1047,7 +1205,7 @@ int32_t UAVObjDelete(UAVObjHandle obj_handle, __attribute__((unused)) uint16_t i
         return -1;
     }
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     // Get filename
     objectFilename(obj_handle, filename);
@@ -1061,21 +1219,144 @@ int32_t UAVObjDelete(UAVObjHandle obj_handle, __attribute__((unused)) uint16_t i
     return 0;
 }
 
+#if defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS) && !defined(PIOS_USE_SETTINGS_ON_SDCARD)
+struct settingsBatch {
+    struct UAVOData * *slot;
+    struct UAVOData *current;
+    bool collectedOnly;
+};
+
+/**
+ * Supply the settings objects written since they were last saved or loaded
+ * to PIOS_FLASHFS_ObjSaveBatch(), only the collected ones if asked to.
+ * Called with the object lock held.
+ */
+static bool nextDirtySettings(void *context, uint32_t *obj_id, uint16_t *obj_inst_id, uint8_t **obj_data, uint16_t *obj_size)
+{
+    struct settingsBatch *batch = (struct settingsBatch *)context;
+
+    // Being asked for the next one means the current one made it to flash
+    if (batch->current) {
+        batch->current->base.flags.isDirty = false;
+        batch->current = NULL;
+    }
+
+    for (; batch->slot && batch->slot < __stop__uavo_handles; batch->slot++) {
+        struct UAVOData *obj = *batch->slot;
+        if (obj == NULL || !obj->base.flags.isSettings || !obj->base.flags.isDirty) {
+            continue;
+        }
+        if (batch->collectedOnly && !obj->base.flags.isCollected) {
+            continue;
+        }
+
+        InstanceHandle instEntry = getInstance(obj, 0);
+        if (instEntry == NULL) {
+            continue;
+        }
+
+        batch->current = obj;
+        batch->slot++;
+        *obj_id      = obj->id;
+        *obj_inst_id = 0;
+        *obj_data    = InstanceData(instEntry);
+        *obj_size    = obj->instance_size;
+        return true;
+    }
+
+    return false;
+}
+#endif /* defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS) && !defined(PIOS_USE_SETTINGS_ON_SDCARD) */
+
 /**
  * Save all settings objects to the SD card.
+ * With the flash filesystem only the objects written since they were last
+ * saved or loaded are saved, all in one flash transaction.
  * @return 0 if success or -1 if failure
  */
 int32_t UAVObjSaveSettings()
+{
+    return saveSettings(false);
+}
+
+/**
+ * Start collecting the settings objects unpacked from telemetry, which
+ * UAVObjSaveCollectedSettings() then saves. Settings applied before this
+ * are left for a later save.
+ */
+void UAVObjCollectSettings()
+{
+    // Get lock
+    lockObjects();
+
+    UAVO_LIST_ITERATE(obj)
+    obj->base.flags.isCollected = false;
+}
+
+collectingSettings = true;
+
+xSemaphoreGiveRecursive(mutex);
+}
+
+/**
+ * Save the settings objects unpacked since UAVObjCollectSettings(), as
+ * UAVObjSaveSettings() does, and stop collecting. Every collected object is
+ * loaded back from flash to verify it was saved.
+ * @return 0 if success or -1 if failure
+ */
+int32_t UAVObjSaveCollectedSettings()
+{
+    // Get lock
+    lockObjects();
+
+    int32_t rc = saveSettings(true);
+
+    UAVO_LIST_ITERATE(obj)
+    if (obj->base.flags.isCollected) {
+        // Verify saving worked
+        if (rc == 0 && UAVObjLoad((UAVObjHandle)obj, 0) != 0) {
+            rc = -1;
+        }
+        obj->base.flags.isCollected = false;
+    }
+}
+
+collectingSettings = false;
+
+xSemaphoreGiveRecursive(mutex);
+return rc;
+}
+
+/**
+ * Save the settings objects, all of them or only the collected ones
+ * @return 0 if success or -1 if failure
+ */
+static int32_t saveSettings(bool collectedOnly)
 {
     // Get lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     int32_t rc = -1;
 
+#if defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS) && !defined(PIOS_USE_SETTINGS_ON_SDCARD)
+    struct settingsBatch batch = {
+        .slot          = __start__uavo_handles,
+        .current       = NULL,
+        .collectedOnly = collectedOnly,
+    };
+
+    // Objects saved before a failure are clean, the rest stays dirty
+    if (PIOS_FLASHFS_ObjSaveBatch(pios_uavo_settings_fs_id, nextDirtySettings, &batch) != 0) {
+        goto unlock_exit;
+    }
+    if (batch.current) {
+        batch.current->base.flags.isDirty = false;
+    }
+#else
     // Save all settings objects
     UAVO_LIST_ITERATE(obj)
     // Check if this is a settings object
-    if (UAVObjIsSettings(obj)) {
+    if (UAVObjIsSettings(obj) && (!collectedOnly || obj->base.flags.isCollected)) {
         // Save object
         if (UAVObjSave((UAVObjHandle)obj, 0) ==
             -1) {
@@ -1083,6 +1364,7 @@ int32_t UAVObjSaveSettings()
         }
     }
 }
+#endif /* defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS) && !defined(PIOS_USE_SETTINGS_ON_SDCARD) */
 
 rc = 0;
 
@@ -1098,7 +1380,7 @@ return rc;
 int32_t UAVObjLoadSettings()
 {
     // Get lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     int32_t rc = -1;
 
@@ -1128,7 +1410,7 @@ return rc;
 int32_t UAVObjDeleteSettings()
 {
     // Get lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     int32_t rc = -1;
 
@@ -1151,6 +1433,24 @@ xSemaphoreGiveRecursive(mutex);
 return rc;
 }
 
+/**
+ * Mark all settings objects as changed, so the next UAVObjSaveSettings()
+ * writes all of them. Used after the settings storage was erased.
+ */
+void UAVObjMarkSettingsDirty()
+{
+    // Get lock
+    lockObjects();
+
+    UAVO_LIST_ITERATE(obj)
+    if (UAVObjIsSettings(obj)) {
+        obj->base.flags.isDirty = true;
+    }
+}
+
+xSemaphoreGiveRecursive(mutex);
+}
+
 /**
  * Save all metaobjects to the SD card.
  * @return 0 if success or -1 if failure
@@ -1158,7 +1458,7 @@ return rc;
 int32_t UAVObjSaveMetaobjects()
 {
     // Get lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     int32_t rc = -1;
 
@@ -1185,7 +1485,7 @@ return rc;
 int32_t UAVObjLoadMetaobjects()
 {
     // Get lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     int32_t rc = -1;
 
@@ -1212,7 +1512,7 @@ return rc;
 int32_t UAVObjDeleteMetaobjects()
 {
     // Get lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     int32_t rc = -1;
 
@@ -1289,7 +1589,7 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
     PIOS_Assert(obj_handle);
 
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     int32_t rc = -1;
 
@@ -1297,7 +1597,7 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
         if (instId != 0) {
             goto unlock_exit;
         }
-        memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle), dataIn, MetaNumBytes);
+        writeInstance((struct UAVOBase *)obj_handle, MetaDataPtr((struct UAVOMeta *)obj_handle), dataIn, MetaNumBytes);
     } else {
         struct UAVOData *obj;
         InstanceHandle instEntry;
@@ -1315,7 +1615,7 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
             goto unlock_exit;
         }
         // Set data
-        memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
+        writeInstance(&obj->base, InstanceData(instEntry), dataIn, obj->instance_size);
     }
 
     // Fire event
@@ -1339,7 +1639,7 @@ int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, con
     PIOS_Assert(obj_handle);
 
     // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     int32_t rc = -1;
 
@@ -1355,7 +1655,7 @@ int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, con
         }
 
         // Set data
-        memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle) + offset, dataIn, size);
+        writeInstance((struct UAVOBase *)obj_handle, MetaDataPtr((struct UAVOMeta *)obj_handle) + offset, dataIn, size);
     } else {
         struct UAVOData *obj;
         InstanceHandle instEntry;
@@ -1380,7 +1680,7 @@ int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, con
         }
 
         // Set data
-        memcpy(InstanceData(instEntry) + offset, dataIn, size);
+        writeInstance(&obj->base, InstanceData(instEntry) + offset, dataIn, size);
     }
 
 
@@ -1405,97 +1705,134 @@ int32_t UAVObjGetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
 {
     PIOS_Assert(obj_handle);
 
-    // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    return readInstance((struct UAVOBase *)obj_handle, instId, dataOut, 0, UAVObjGetNumBytes(obj_handle));
+}
 
-    int32_t rc = -1;
+/**
+ * Get the data of a specific object instance
+ * \param[in] obj The object handle
+ * \param[in] instId The object instance ID
+ * \param[out] dataOut The object's data structure
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjGetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, void *dataOut, uint32_t offset, uint32_t size)
+{
+    PIOS_Assert(obj_handle);
 
+    return readInstance((struct UAVOBase *)obj_handle, instId, dataOut, offset, size);
+}
+
+/**
+ * Borrow the data of an object instance to read and update it in place.
+ * The global object manager lock is held until the borrow is ended with
+ * UAVObjCommitInstanceData() or UAVObjReturnInstanceData(), which stalls
+ * every other task touching any object, so keep it short and never block
+ * while holding it. Only use it for in place writers; readers should copy
+ * with UAVObjGetInstanceData(), which does not take the lock.
+ * \param[in] obj The object handle
+ * \param[in] instId The object instance ID
+ * \return Pointer to the instance data or NULL if the instance does not exist or is read only
+ */
+void *UAVObjBorrowInstanceData(UAVObjHandle obj_handle, uint16_t instId)
+{
+    PIOS_Assert(obj_handle);
+
+    // Metadata goes through UAVObjSetMetadata()
     if (UAVObjIsMetaobject(obj_handle)) {
-        // Get instance information
-        if (instId != 0) {
-            goto unlock_exit;
-        }
-        // Set data
-        memcpy(dataOut, MetaDataPtr((struct UAVOMeta *)obj_handle), MetaNumBytes);
-    } else {
-        struct UAVOData *obj;
-        InstanceHandle instEntry;
+        return NULL;
+    }
 
-        // Cast to object info
-        obj = (struct UAVOData *)obj_handle;
+    lockObjects();
 
-        // Get instance information
-        instEntry = getInstance(obj, instId);
-        if (instEntry == NULL) {
-            goto unlock_exit;
-        }
-        // Set data
-        memcpy(dataOut, InstanceData(instEntry), obj->instance_size);
+    InstanceHandle instEntry = getInstance((struct UAVOData *)obj_handle, instId);
+    if (instEntry == NULL || UAVObjReadOnly(obj_handle)) {
+        xSemaphoreGiveRecursive(mutex);
+        return NULL;
     }
 
-    rc = 0;
+    borrowCheckBegin(obj_handle, instId, instEntry, true);
+    seqWriteBegin((struct UAVOBase *)obj_handle);
+    return InstanceData(instEntry);
+}
 
-unlock_exit:
-    xSemaphoreGiveRecursive(mutex);
-    return rc;
+/**
+ * Borrow the data of an object instance to read it in place.
+ * End the borrow with UAVObjReturnInstanceData(). Like the writable borrow
+ * this holds the global object manager lock for its whole duration, so it
+ * only pays off for large objects that are read in many small pieces; for
+ * anything else UAVObjGetInstanceData() is cheaper and lock free.
+ * \param[in] obj The object handle
+ * \param[in] instId The object instance ID
+ * \return Pointer to the instance data or NULL if the instance does not exist
+ */
+const void *UAVObjBorrowInstanceDataConst(UAVObjHandle obj_handle, uint16_t instId)
+{
+    PIOS_Assert(obj_handle);
+
+    if (UAVObjIsMetaobject(obj_handle)) {
+        return NULL;
+    }
+
+    lockObjects();
+
+    InstanceHandle instEntry = getInstance((struct UAVOData *)obj_handle, instId);
+    if (instEntry == NULL) {
+        xSemaphoreGiveRecursive(mutex);
+        return NULL;
+    }
+
+    borrowCheckBegin(obj_handle, instId, instEntry, false);
+    return InstanceData(instEntry);
 }
 
 /**
- * Get the data of a specific object instance
+ * End a borrow from UAVObjBorrowInstanceData() and fire the update event.
+ * A borrowed settings object always counts as changed and is saved again.
  * \param[in] obj The object handle
  * \param[in] instId The object instance ID
- * \param[out] dataOut The object's data structure
- * \return 0 if success or -1 if failure
+ * \return 0 if success or -1 if the instance was not borrowed for writing
  */
-int32_t UAVObjGetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, void *dataOut, uint32_t offset, uint32_t size)
+int32_t UAVObjCommitInstanceData(UAVObjHandle obj_handle, uint16_t instId)
 {
     PIOS_Assert(obj_handle);
 
-    // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    struct UAVOBase *obj = (struct UAVOBase *)obj_handle;
 
-    int32_t rc = -1;
+    borrowCheckEnd(obj_handle, instId, true);
 
-    if (UAVObjIsMetaobject(obj_handle)) {
-        // Get instance information
-        if (instId != 0) {
-            goto unlock_exit;
-        }
+    // The sequence is only odd while borrowed for writing
+    if ((obj->seq & 1) == 0) {
+        xSemaphoreGiveRecursive(mutex);
+        return -1;
+    }
+    seqWriteEnd(obj);
 
-        // Check for overrun
-        if ((size + offset) > MetaNumBytes) {
-            goto unlock_exit;
-        }
+    // Fire event
+    sendEvent(obj, instId, EV_UPDATED);
 
-        // Set data
-        memcpy(dataOut, MetaDataPtr((struct UAVOMeta *)obj_handle) + offset, size);
-    } else {
-        struct UAVOData *obj;
-        InstanceHandle instEntry;
+    xSemaphoreGiveRecursive(mutex);
+    return 0;
+}
 
-        // Cast to object info
-        obj = (struct UAVOData *)obj_handle;
+/**
+ * End a borrow without firing an event, used for read only borrows and
+ * for writable borrows that turned out to have nothing to update.
+ * \param[in] obj The object handle
+ * \param[in] instId The object instance ID
+ */
+void UAVObjReturnInstanceData(UAVObjHandle obj_handle, uint16_t instId)
+{
+    PIOS_Assert(obj_handle);
 
-        // Get instance information
-        instEntry = getInstance(obj, instId);
-        if (instEntry == NULL) {
-            goto unlock_exit;
-        }
+    struct UAVOBase *obj = (struct UAVOBase *)obj_handle;
 
-        // Check for overrun
-        if ((size + offset) > obj->instance_size) {
-            goto unlock_exit;
-        }
+    borrowCheckEnd(obj_handle, instId, obj->seq & 1);
 
-        // Set data
-        memcpy(dataOut, InstanceData(instEntry) + offset, size);
+    if (obj->seq & 1) {
+        seqWriteEnd(obj);
     }
 
-    rc = 0;
-
-unlock_exit:
     xSemaphoreGiveRecursive(mutex);
-    return rc;
 }
 
 /**
@@ -1513,7 +1850,7 @@ int32_t UAVObjSetMetadata(UAVObjHandle obj_handle, const UAVObjMetadata *dataIn)
         return -1;
     }
 
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     UAVObjSetData((UAVObjHandle)MetaObjectPtr((struct UAVOData *)obj_handle), dataIn);
 
@@ -1531,9 +1868,6 @@ int32_t UAVObjGetMetadata(UAVObjHandle obj_handle, UAVObjMetadata *dataOut)
 {
     PIOS_Assert(obj_handle);
 
-    // Lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
     // Get metadata
     if (UAVObjIsMetaobject(obj_handle)) {
         memcpy(dataOut, &defMetadata, sizeof(UAVObjMetadata));
@@ -1542,8 +1876,6 @@ int32_t UAVObjGetMetadata(UAVObjHandle obj_handle, UAVObjMetadata *dataOut)
                       dataOut);
     }
 
-    // Unlock
-    xSemaphoreGiveRecursive(mutex);
     return 0;
 }
 
@@ -1715,12 +2047,89 @@ int32_t UAVObjConnectQueue(UAVObjHandle obj_handle, xQueueHandle queue,
     PIOS_Assert(obj_handle);
     PIOS_Assert(queue);
     int32_t res;
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = connectObj(obj_handle, queue, 0, eventMask);
+    lockObjects();
+    res = connectObj(obj_handle, queue, 0, eventMask, false);
+    xSemaphoreGiveRecursive(mutex);
+    return res;
+}
+
+/**
+ * Connect an event queue to the object like UAVObjConnectQueue(), but queue
+ * at most one event of each type for an instance until it is received with
+ * UAVObjReceiveEvent(). Later events are folded into the pending one, so a
+ * burst of updates can not overflow the queue. The consumer is expected to
+ * read the current data when it gets the event.
+ * \param[in] obj The object handle
+ * \param[in] queue The event queue
+ * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjConnectQueueCoalesced(UAVObjHandle obj_handle, xQueueHandle queue,
+                                    uint8_t eventMask)
+{
+    PIOS_Assert(obj_handle);
+    PIOS_Assert(queue);
+    int32_t res;
+    lockObjects();
+    res = connectObj(obj_handle, queue, 0, eventMask, true);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
 
+/**
+ * Receive an event from a queue, clearing its pending state when it came
+ * through a coalesced connection. Works on any event queue.
+ * \param[in] queue The event queue
+ * \param[out] ev The event received
+ * \param[in] timeout Ticks to wait for an event
+ * \return pdTRUE if an event was received, pdFALSE on timeout
+ */
+int32_t UAVObjReceiveEvent(xQueueHandle queue, UAVObjEvent *ev, portTickType timeout)
+{
+    PIOS_Assert(queue);
+
+    if (xQueueReceive(queue, ev, timeout) != pdTRUE) {
+        return pdFALSE;
+    }
+
+    // Events not generated by an object (e.g. periodic ones) are never coalesced
+    if (ev->obj == NULL) {
+        return pdTRUE;
+    }
+
+    // No need for the object lock, the connection list and the pending state
+    // are only changed in a critical section as well
+    struct ObjectEventEntry *event;
+    portENTER_CRITICAL();
+    LL_FOREACH(((struct UAVOBase *)ev->obj)->next_event, event) {
+        if (event->queue == queue && event->coalesce) {
+            if (event->pendingInstId == ev->instId) {
+                event->pending &= ~ev->event;
+            }
+            break;
+        }
+    }
+    portEXIT_CRITICAL();
+
+    return pdTRUE;
+}
+
+/**
+ * Has the object been updated again since the event was sent? A consumer
+ * of a (non coalesced) queue can skip such events, a newer one follows.
+ * The sequence is per object, an update of any instance counts.
+ * \param[in] ev The event received
+ * \return true if the event is stale
+ */
+bool UAVObjEventIsStale(const UAVObjEvent *ev)
+{
+    // Only events sent for a data change carry a meaningful sequence
+    if (ev->obj == NULL || (ev->event & (EV_UNPACKED | EV_UPDATED | EV_UPDATED_MANUAL)) == 0) {
+        return false;
+    }
+    return ((struct UAVOBase *)ev->obj)->seq != ev->seq;
+}
+
 /**
  * Disconnect an event queue from the object.
  * \param[in] obj The object handle
@@ -1732,7 +2141,7 @@ int32_t UAVObjDisconnectQueue(UAVObjHandle obj_handle, xQueueHandle queue)
     PIOS_Assert(obj_handle);
     PIOS_Assert(queue);
     int32_t res;
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
     res = disconnectObj(obj_handle, queue, 0);
     xSemaphoreGiveRecursive(mutex);
     return res;
@@ -1751,8 +2160,8 @@ int32_t UAVObjConnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb,
 {
     PIOS_Assert(obj_handle);
     int32_t res;
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = connectObj(obj_handle, 0, cb, eventMask);
+    lockObjects();
+    res = connectObj(obj_handle, 0, cb, eventMask, false);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
@@ -1767,7 +2176,7 @@ int32_t UAVObjDisconnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb
 {
     PIOS_Assert(obj_handle);
     int32_t res;
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
     res = disconnectObj(obj_handle, 0, cb);
     xSemaphoreGiveRecursive(mutex);
     return res;
@@ -1792,7 +2201,7 @@ void UAVObjRequestUpdate(UAVObjHandle obj_handle)
 void UAVObjRequestInstanceUpdate(UAVObjHandle obj_handle, uint16_t instId)
 {
     PIOS_Assert(obj_handle);
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
     sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATE_REQ);
     xSemaphoreGiveRecursive(mutex);
 }
@@ -1814,7 +2223,7 @@ void UAVObjUpdated(UAVObjHandle obj_handle)
 void UAVObjInstanceUpdated(UAVObjHandle obj_handle, uint16_t instId)
 {
     PIOS_Assert(obj_handle);
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
     sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED_MANUAL);
     xSemaphoreGiveRecursive(mutex);
 }
@@ -1829,7 +2238,7 @@ void UAVObjIterate(void (*iterator)(UAVObjHandle obj))
     PIOS_Assert(iterator);
 
     // Get lock
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    lockObjects();
 
     // Iterate through the list and invoke iterator for each object
     UAVO_LIST_ITERATE (obj)
@@ -1841,6 +2250,232 @@ void UAVObjIterate(void (*iterator)(UAVObjHandle obj))
 xSemaphoreGiveRecursive(mutex);
 }
 
+/**
+ * Binary search the object index for a data object ID
+ * \param[in] id The data object ID
+ * \return The slot holding the ID, or the slot it would be inserted at
+ */
+static uint16_t indexFind(uint32_t id)
+{
+    uint16_t low  = 0;
+    uint16_t high = uavo_index_count;
+
+    while (low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        if (uavo_index[mid]->id < id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * Look an object up in the index, meta objects are found through the data
+ * object whose ID precedes theirs.
+ * \param[in] id The object ID
+ * \return The object or NULL if not found.
+ */
+static UAVObjHandle indexLookup(uint32_t id)
+{
+    uint16_t slot = indexFind(id);
+
+    if (slot < uavo_index_count && uavo_index[slot]->id == id) {
+        return (UAVObjHandle)uavo_index[slot];
+    }
+    slot = indexFind(id - 1);
+    if (slot < uavo_index_count && MetaObjectId(uavo_index[slot]->id) == id) {
+        return (UAVObjHandle) & (uavo_index[slot]->metaObj);
+    }
+    return NULL;
+}
+
+/**
+ * Insert a newly registered object in the index, must hold the mutex.
+ * Entries are shifted up from the end so a concurrent lookup always finds
+ * the index sorted, at worst it misses and retries under the lock.
+ * \param[in] obj The object to insert
+ * \return 0 Success
+ * \return -1 The index is full
+ */
+static int32_t indexInsert(struct UAVOData *obj)
+{
+    if (uavo_index_count >= uavo_index_size) {
+        return -1;
+    }
+    uint16_t slot = indexFind(obj->id);
+    for (uint16_t n = uavo_index_count; n > slot; n--) {
+        uavo_index[n] = uavo_index[n - 1];
+    }
+    uavo_index[slot] = obj;
+    uavo_index_count++;
+    return 0;
+}
+
+/**
+ * Take the object manager mutex, counting the takes that had to wait for
+ * another task.
+ */
+static void lockObjects(void)
+{
+    if (xSemaphoreTakeRecursive(mutex, 0) != pdTRUE) {
+        xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+        stats.lockContention++;
+    }
+}
+
+/**
+ * Mark the instance data of an object as being written. Writers are
+ * serialised by the mutex, the sequence stays odd until seqWriteEnd().
+ */
+static void seqWriteBegin(struct UAVOBase *obj)
+{
+    // Odd means the caller is updating an object it still has borrowed
+    PIOS_DEBUG_Assert((obj->seq & 1) == 0);
+    obj->seq++;
+    __sync_synchronize();
+}
+
+/**
+ * Publish the instance data written since seqWriteBegin()
+ */
+static void seqWriteEnd(struct UAVOBase *obj)
+{
+    __sync_synchronize();
+    obj->seq++;
+    obj->flags.isDirty = true;
+}
+
+/**
+ * Copy new data into (part of) an instance. Settings that are written with
+ * the data they already hold are left alone, so they don't need a save.
+ */
+static void writeInstance(struct UAVOBase *obj, void *instData, const void *dataIn, uint32_t size)
+{
+    if (obj->flags.isSettings && memcmp(instData, dataIn, size) == 0) {
+        return;
+    }
+
+    seqWriteBegin(obj);
+    memcpy(instData, dataIn, size);
+    seqWriteEnd(obj);
+}
+
+#if defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS)
+/**
+ * Mark an object saved to flash unless it was written since seq was read
+ */
+static void markSaved(struct UAVOBase *obj, uint16_t seq)
+{
+    lockObjects();
+    if (obj->seq == seq) {
+        obj->flags.isDirty = false;
+    }
+    xSemaphoreGiveRecursive(mutex);
+}
+#endif
+
+/**
+ * Copy (part of) an instance out of the object without taking the mutex.
+ * The copy is retried when a writer got in while copying. A reader that
+ * finds a write in progress takes the mutex straight away, spinning would
+ * never let a lower priority writer finish on a single core.
+ * \return 0 if success or -1 if the instance does not exist or the range overruns it
+ */
+static int32_t readInstance(struct UAVOBase *obj, uint16_t instId, void *dataOut, uint32_t offset, uint32_t size)
+{
+    int32_t rc;
+    // Keeps the chunk table this read may use from being freed, see addChunk()
+    bool multi = !UAVObjIsMetaobject(obj) && !UAVObjIsSingleInstance(obj);
+
+    if (multi) {
+        __sync_fetch_and_add(&multiInstanceReaders, 1);
+    }
+    for (uint8_t attempt = 0; attempt < SEQ_READ_ATTEMPTS; ++attempt) {
+        uint16_t seq = obj->seq;
+        if (seq & 1) {
+            break;
+        }
+        __sync_synchronize();
+        rc = copyInstance(obj, instId, dataOut, offset, size);
+        __sync_synchronize();
+        if (obj->seq == seq) {
+            if (multi) {
+                __sync_fetch_and_sub(&multiInstanceReaders, 1);
+            }
+            return rc;
+        }
+        // Not atomic, a lost count now and then is fine for a statistic
+        stats.lockContention++;
+    }
+    if (multi) {
+        __sync_fetch_and_sub(&multiInstanceReaders, 1);
+    }
+
+    lockObjects();
+    rc = copyInstance(obj, instId, dataOut, offset, size);
+    xSemaphoreGiveRecursive(mutex);
+    return rc;
+}
+
+/**
+ * Copy (part of) an instance out of the object, the caller deals with locking
+ */
+static int32_t copyInstance(struct UAVOBase *obj, uint16_t instId, void *dataOut, uint32_t offset, uint32_t size)
+{
+    InstanceHandle instEntry = getInstance((struct UAVOData *)obj, instId);
+
+    if (instEntry == NULL) {
+        return -1;
+    }
+
+    // Check for overrun
+    if ((size + offset) > UAVObjGetNumBytes((UAVObjHandle)obj)) {
+        return -1;
+    }
+
+    memcpy(dataOut, (uint8_t *)InstanceData(instEntry) + offset, size);
+    return 0;
+}
+
+#if defined(DEBUG)
+/**
+ * Record a borrow, borrowing the same instance twice would break the
+ * write sequence.
+ */
+static void borrowCheckBegin(UAVObjHandle obj_handle, uint16_t instId, const void *data, bool writable)
+{
+    PIOS_DEBUG_Assert(numBorrows < UAVOBJ_MAX_BORROWS);
+    for (uint8_t n = 0; n < numBorrows; ++n) {
+        PIOS_DEBUG_Assert(borrows[n].obj != obj_handle || borrows[n].instId != instId);
+    }
+
+    struct UAVOBorrow *borrow = &borrows[numBorrows++];
+    borrow->obj      = obj_handle;
+    borrow->data     = data;
+    borrow->instId   = instId;
+    borrow->writable = writable;
+    borrow->crc      = PIOS_CRC_updateCRC(0, (const uint8_t *)data, UAVObjGetNumBytes(obj_handle));
+}
+
+/**
+ * Check a borrow is ended the way it was taken, in reverse order, and that
+ * read only borrows left the data alone.
+ */
+static void borrowCheckEnd(UAVObjHandle obj_handle, uint16_t instId, bool writable)
+{
+    PIOS_DEBUG_Assert(numBorrows > 0);
+
+    struct UAVOBorrow *borrow = &borrows[--numBorrows];
+    PIOS_DEBUG_Assert(borrow->obj == obj_handle && borrow->instId == instId);
+    PIOS_DEBUG_Assert(borrow->writable == writable);
+    if (!writable) {
+        PIOS_DEBUG_Assert(borrow->crc == PIOS_CRC_updateCRC(0, (const uint8_t *)borrow->data, UAVObjGetNumBytes(obj_handle)));
+    }
+}
+#endif /* DEBUG */
+
 /**
  * Send a triggered event to all event queues registered on the object.
  */
@@ -1852,6 +2487,7 @@ static int32_t sendEvent(struct UAVOBase *obj, uint16_t instId,
         .obj    = (UAVObjHandle)obj,
         .event  = triggered_event,
         .instId = instId,
+        .seq    = obj->seq,
     };
 
     // Go through each object and push the event message in the queue (if event is activated for the queue)
@@ -1862,10 +2498,34 @@ static int32_t sendEvent(struct UAVOBase *obj, uint16_t instId,
             || (event->eventMask & triggered_event) != 0) {
             // Send to queue if a valid queue is registered
             if (event->queue) {
+                bool tracked = false;
+                if (event->coalesce) {
+                    bool folded;
+                    // Mark the event pending before it is queued, the receiver clears it
+                    portENTER_CRITICAL();
+                    // Fold into the event already queued for this instance
+                    folded = event->pending && event->pendingInstId == instId && (event->pending & triggered_event);
+                    if (!folded && (event->pending == 0 || event->pendingInstId == instId)) {
+                        // Only one instance is tracked at a time, others are queued as usual
+                        event->pendingInstId = instId;
+                        event->pending |= triggered_event;
+                        tracked = true;
+                    }
+                    portEXIT_CRITICAL();
+                    if (folded) {
+                        ++stats.eventsCoalesced;
+                        continue;
+                    }
+                }
                 // will not block
                 if (xQueueSend(event->queue, &msg, 0) != pdTRUE) {
                     stats.lastQueueErrorID = UAVObjGetID(obj);
                     ++stats.eventQueueErrors;
+                    if (tracked) {
+                        portENTER_CRITICAL();
+                        event->pending &= ~triggered_event;
+                        portEXIT_CRITICAL();
+                    }
                 }
             }
 
@@ -1888,8 +2548,6 @@ static int32_t sendEvent(struct UAVOBase *obj, uint16_t instId,
  */
 static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId)
 {
-    struct UAVOMultiInst *instEntry;
-
     /* Don't allow more than one instance for single instance objects */
     if (UAVObjIsSingleInstance(&(obj->base))) {
         PIOS_Assert(0);
@@ -1913,22 +2571,90 @@ static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId)
         }
     }
 
-    /* Create the actual instance */
-    uint32_t size = sizeof(struct UAVOMultiInst) + obj->instance_size;
-    instEntry = (struct UAVOMultiInst *)pvPortMalloc(size);
-    if (!instEntry) {
-        return NULL;
+    /* Make room for the actual instance, chunks are allocated cleared */
+    struct UAVOMulti *uavo_multi = (struct UAVOMulti *)obj;
+    if ((uint32_t)instId >= (uint32_t)uavo_multi->chunk_size * (uavo_multi->num_chunks + 1)) {
+        if (addChunk(uavo_multi) != 0) {
+            return NULL;
+        }
     }
-    memset(instEntry, 0, size);
-    LL_APPEND(((struct UAVOMulti *)obj)->instance0.next, instEntry);
 
-    ((struct UAVOMulti *)obj)->num_instances++;
+    // Readers check num_instances without the lock, publish the chunk first
+    __sync_synchronize();
+    uavo_multi->num_instances++;
 
     // Fire event
     UAVObjInstanceUpdated((UAVObjHandle)obj, instId);
 
     // Done
-    return InstanceDataOffset(instEntry);
+    return getInstance(obj, instId);
+}
+
+/**
+ * Allocate one more chunk of instances for a multi instance object,
+ * growing the chunk table geometrically when it is full. Called with the
+ * object lock held.
+ * \return 0 Success
+ * \return -1 Out of memory
+ */
+static int32_t addChunk(struct UAVOMulti *obj)
+{
+    uint32_t size  = InstanceStride(&obj->uavo) * obj->chunk_size;
+    uint8_t *chunk = (uint8_t *)pvPortMalloc(size);
+
+    if (!chunk) {
+        return -1;
+    }
+    memset(chunk, 0, size);
+
+    if (obj->num_chunks == obj->max_chunks) {
+        uint16_t max_chunks = obj->max_chunks ? obj->max_chunks * 2 : 2;
+        uint8_t * *table    = (uint8_t * *)pvPortMalloc((1 + max_chunks) * sizeof(uint8_t *));
+        if (!table) {
+            vPortFree(chunk);
+            return -1;
+        }
+        uint8_t * *chunks = &table[1];
+        if (obj->chunks) {
+            memcpy(chunks, obj->chunks, obj->num_chunks * sizeof(uint8_t *));
+        }
+        chunks[obj->num_chunks] = chunk;
+        __sync_synchronize();
+        uint8_t * *old_chunks = obj->chunks;
+        obj->chunks     = chunks;
+        obj->max_chunks = max_chunks;
+
+        // A lock free reader may still be walking the old table, retire it
+        if (old_chunks) {
+            old_chunks[-1]     = (uint8_t *)retiredChunkTables;
+            retiredChunkTables = old_chunks;
+        }
+    } else {
+        obj->chunks[obj->num_chunks] = chunk;
+    }
+    obj->num_chunks++;
+
+    freeRetiredChunkTables();
+
+    return 0;
+}
+
+/**
+ * Free the retired chunk tables once no lock free reader can hold one.
+ * Readers that start later only see the current tables. Called with the
+ * object lock held.
+ */
+static void freeRetiredChunkTables(void)
+{
+    __sync_synchronize();
+    if (multiInstanceReaders != 0) {
+        return;
+    }
+    while (retiredChunkTables) {
+        uint8_t * *chunks  = retiredChunkTables;
+        retiredChunkTables = (uint8_t * *)chunks[-1];
+        vPortFree(&chunks[-1]);
+    }
 }
 
 /**
@@ -1963,18 +2689,14 @@ static InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId)
         if (instId >= uavo_multi->num_instances) {
             return NULL;
         }
-
-        // Look for specified instance ID
-        uint16_t instance = 0;
-        struct UAVOMultiInst *instEntry;
-        LL_FOREACH(&(uavo_multi->instance0), instEntry) {
-            if (instance++ == instId) {
-                /* Found it */
-                return &(instEntry->instance);
-            }
-        }
-        /* Instance was not found */
-        return NULL;
+        // Pairs with the barrier in createInstance for lock free readers
+        __sync_synchronize();
+
+        // Locate the chunk holding the instance, the first one is embedded in the object
+        uint16_t chunk  = instId / uavo_multi->chunk_size;
+        uint16_t offset = instId % uavo_multi->chunk_size;
+        uint8_t *base   = (chunk == 0) ? uavo_multi->instance0 : uavo_multi->chunks[chunk - 1];
+        return base + offset * InstanceStride(obj);
     }
 }
 
@@ -1987,7 +2709,7 @@ static InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId)
  * \return 0 if success or -1 if failure
  */
 static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
-                          UAVObjEventCallback cb, uint8_t eventMask)
+                          UAVObjEventCallback cb, uint8_t eventMask, bool coalesce)
 {
     struct ObjectEventEntry *event;
     struct UAVOBase *obj;
@@ -1998,6 +2720,7 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
         if (event->queue == queue && event->cb == cb) {
             // Already connected, update event mask and return
             event->eventMask = eventMask;
+            event->coalesce  = coalesce;
             return 0;
         }
     }
@@ -2010,7 +2733,13 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
     event->queue     = queue;
     event->cb        = cb;
     event->eventMask = eventMask;
+    event->coalesce  = coalesce;
+    event->pending   = 0;
+    event->pendingInstId = 0;
+    // UAVObjReceiveEvent() walks the list without the object lock
+    portENTER_CRITICAL();
     LL_APPEND(obj->next_event, event);
+    portEXIT_CRITICAL();
 
     // Done
     return 0;
@@ -2034,7 +2763,10 @@ static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue,
     LL_FOREACH(obj->next_event, event) {
         if ((event->queue == queue
              && event->cb == cb)) {
+            // UAVObjReceiveEvent() walks the list without the object lock
+            portENTER_CRITICAL();
             LL_DELETE(obj->next_event, event);
+            portEXIT_CRITICAL();
             vPortFree(event);
             return 0;
         }
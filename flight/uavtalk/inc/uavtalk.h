@@ -31,6 +31,8 @@
 
 // Public types
 typedef int32_t (*UAVTalkOutputStream)(uint8_t *data, int32_t length);
+typedef uint8_t *(*UAVTalkOutputReserve)(uint16_t length);
+typedef int32_t (*UAVTalkOutputCommit)(uint16_t length);
 
 typedef struct {
     uint32_t txBytes;
@@ -39,10 +41,30 @@ typedef struct {
     uint32_t rxObjectBytes;
     uint32_t rxObjects;
     uint32_t txObjects;
-    uint32_t txErrors;
+    uint32_t txErrors; // acked objects given up on after all retries
     uint32_t rxErrors;
+    uint32_t txRetries; // acked objects sent again after an ack timeout
+    uint32_t rttSamples; // acks that measured a round trip time
+    uint32_t rttSumMs;
+    uint32_t rttMaxMs;
 } UAVTalkStats;
 
+typedef struct {
+    uint32_t frames; // frames relayed
+    uint32_t bytes; // bytes relayed
+    uint32_t dropped; // frames with a bad header or checksum, or refused by the output
+    uint32_t latencySumMs; // from the block holding the sync byte of a frame being received to the frame being relayed
+    uint32_t latencyMaxMs;
+} UAVTalkRelayStats;
+
+typedef struct {
+    uint8_t  *data; // the whole frame, from the sync byte to the checksum
+    uint16_t length;
+    uint8_t  type;
+    uint32_t objId;
+    uint32_t startTime; // ms, when the block holding the sync byte of the frame was received
+} UAVTalkFrame;
+
 typedef void *UAVTalkConnection;
 
 typedef enum { UAVTALK_STATE_ERROR = 0, UAVTALK_STATE_SYNC, UAVTALK_STATE_TYPE, UAVTALK_STATE_SIZE, UAVTALK_STATE_OBJID, UAVTALK_STATE_INSTID, UAVTALK_STATE_TIMESTAMP, UAVTALK_STATE_DATA, UAVTALK_STATE_CS, UAVTALK_STATE_COMPLETE } UAVTalkRxState;
@@ -51,16 +73,29 @@ typedef enum { UAVTALK_STATE_ERROR = 0, UAVTALK_STATE_SYNC, UAVTALK_STATE_TYPE,
 UAVTalkConnection UAVTalkInitialize(UAVTalkOutputStream outputStream);
 int32_t UAVTalkSetOutputStream(UAVTalkConnection connection, UAVTalkOutputStream outputStream);
 UAVTalkOutputStream UAVTalkGetOutputStream(UAVTalkConnection connection);
+int32_t UAVTalkSetOutputBuffer(UAVTalkConnection connectionHandle, UAVTalkOutputReserve outputReserve, UAVTalkOutputCommit outputCommit);
 int32_t UAVTalkSendObject(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId, uint8_t acked, int32_t timeoutMs);
 int32_t UAVTalkSendObjectTimestamped(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId, uint8_t acked, int32_t timeoutMs);
+int32_t UAVTalkSendObjectAsync(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId, uint8_t acked, int32_t timeoutMs, uint8_t retries);
+int32_t UAVTalkProcessTransactions(UAVTalkConnection connectionHandle);
+int32_t UAVTalkSetMultiObjectDelay(UAVTalkConnection connectionHandle, int32_t delayMs);
+int32_t UAVTalkProcessMultiObject(UAVTalkConnection connectionHandle);
+portTickType UAVTalkWaitTicks(int32_t waitMs);
+int32_t UAVTalkSetDeltaKeyframeInterval(UAVTalkConnection connectionHandle, uint8_t interval);
 int32_t UAVTalkSendObjectRequest(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId, int32_t timeoutMs);
 int32_t UAVTalkSendAck(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId);
 int32_t UAVTalkSendNack(UAVTalkConnection connectionHandle, uint32_t objId);
 int32_t UAVTalkSendBuf(UAVTalkConnection connectionHandle, uint8_t *buf, uint16_t len);
 UAVTalkRxState UAVTalkProcessInputStream(UAVTalkConnection connection, uint8_t rxbyte);
 UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connection, uint8_t rxbyte);
+UAVTalkRxState UAVTalkProcessInputBuffer(UAVTalkConnection connection, uint8_t *buf, uint16_t length);
 UAVTalkRxState UAVTalkRelayPacket(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle);
 int32_t UAVTalkReceiveObject(UAVTalkConnection connectionHandle);
+uint16_t UAVTalkScanFrame(UAVTalkConnection connectionHandle, uint8_t *buf, uint16_t length, uint32_t rxTimeMs, UAVTalkFrame *frame);
+int32_t UAVTalkRelayFrame(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, UAVTalkFrame *frame);
+int32_t UAVTalkReceiveFrame(UAVTalkConnection connectionHandle, UAVTalkFrame *frame);
+void UAVTalkGetRelayStats(UAVTalkConnection connectionHandle, UAVTalkRelayStats *stats, bool reset);
+void UAVTalkResetRelayStats(UAVTalkConnection connectionHandle);
 void UAVTalkGetStats(UAVTalkConnection connection, UAVTalkStats *stats);
 void UAVTalkAddStats(UAVTalkConnection connection, UAVTalkStats *stats);
 void UAVTalkResetStats(UAVTalkConnection connection);
@@ -56,6 +56,29 @@ typedef uint8_t uavtalk_checksum;
 #define UAVTALK_MIN_PACKET_LENGTH  UAVTALK_MAX_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH
 #define UAVTALK_MAX_PACKET_LENGTH  UAVTALK_MIN_PACKET_LENGTH + UAVTALK_MAX_PAYLOAD_LENGTH
 
+// Multi-object frames carry UAVTALK_OBJID_MULTI in the object id field and a
+// payload of records: object id (4), record length (1), instance id (2, multi
+// instance objects only) and the object data. The record length counts the
+// bytes after it. The GCS takes payloads of up to 255 bytes.
+#define UAVTALK_OBJID_MULTI 0xFFFFFFFF
+#define UAVTALK_MULTI_RECORD_HEADER_LENGTH 5
+#define UAVTALK_MULTI_MAX_PAYLOAD_LENGTH \
+    (UAVTALK_MAX_PAYLOAD_LENGTH - 1 < 255 ? UAVTALK_MAX_PAYLOAD_LENGTH - 1 : 255)
+
+// Delta frames carry the usual object header and a payload that starts with a
+// keyframe byte. Keyframes set UAVTALK_DELTA_KEYFRAME in it and carry the whole
+// object, both sides keep it as reference. Deltas carry the id of the keyframe
+// they refer to, a bitmap with one bit per field (field 0 in bit 0 of the first
+// byte) and the fields that differ from the keyframe, in field order.
+#define UAVTALK_DELTA_KEYFRAME    0x80
+#define UAVTALK_DELTA_ID_MASK     0x7F
+#define UAVTALK_DELTA_NO_KEYFRAME 0xFF
+
+// Objects that can be sent (or received) as field deltas at the same time
+#ifndef UAVTALK_MAX_DELTA_OBJECTS
+#define UAVTALK_MAX_DELTA_OBJECTS 8
+#endif
+
 typedef struct {
     UAVObjHandle obj;
     uint8_t type;
@@ -72,12 +95,37 @@ typedef struct {
     uint16_t rxPacketLength;
 } UAVTalkInputProcessor;
 
+// Acked objects that can be waiting for their ack at the same time
+#ifndef UAVTALK_MAX_TRANSACTIONS
+#define UAVTALK_MAX_TRANSACTIONS 4
+#endif
+
+typedef struct {
+    UAVObjHandle obj; // 0 when the slot is free
+    uint16_t     instId;
+    uint16_t     timeoutMs;
+    uint32_t     sentTime; // ms, last time the object was sent
+    uint8_t      retries; // sends left before giving up
+    bool resent; // the ack can't be matched to a send, no round trip time
+} UAVTalkTransaction;
+
+typedef struct {
+    UAVObjHandle obj; // 0 when the slot is free
+    uint16_t     instId;
+    uint8_t      keyframeId; // id of the keyframe in data, UAVTALK_DELTA_NO_KEYFRAME until one was received
+    uint8_t      sinceKeyframe; // deltas sent since the keyframe, UAVTALK_DELTA_NO_KEYFRAME to send one next
+    uint8_t      *data; // the keyframe, followed by room for the object being encoded or decoded
+} UAVTalkDeltaRef;
+
 typedef struct {
     uint8_t canari;
     UAVTalkOutputStream outStream;
+    UAVTalkOutputReserve outReserve; // optional, room lent by the output to build frames in
+    UAVTalkOutputCommit outCommit;
     xSemaphoreHandle    lock;
     xSemaphoreHandle    transLock;
     xSemaphoreHandle    respSema;
+    xSemaphoreHandle    windowSema;
     UAVObjHandle respObj;
     uint16_t     respInstId;
     UAVTalkStats stats;
@@ -85,6 +133,18 @@ typedef struct {
     uint8_t      *rxBuffer;
     uint32_t     txSize;
     uint8_t      *txBuffer;
+    UAVTalkTransaction transactions[UAVTALK_MAX_TRANSACTIONS];
+    int32_t      multiDelayMs; // 0 sends every object in a frame of its own
+    uint32_t     multiTime; // ms, when the first record was collected
+    uint16_t     multiLength; // payload collected so far
+    uint8_t      *multiBuffer;
+    uint8_t      deltaKeyframeInterval; // 0 sends objects in full
+    UAVTalkDeltaRef *txDeltaRefs;
+    UAVTalkDeltaRef *rxDeltaRefs;
+    uint8_t      *relayBuffer; // frames that arrived in pieces, allocated on first use
+    uint16_t     relayLength; // bytes of the frame collected so far
+    uint32_t     relayTime; // ms, when the block holding the sync byte was received
+    UAVTalkRelayStats relayStats;
 } UAVTalkConnectionData;
 
 #define UAVTALK_CANARI          0xCA
@@ -99,6 +159,8 @@ typedef struct {
 #define UAVTALK_TYPE_OBJ_ACK    (UAVTALK_TYPE_VER | 0x02)
 #define UAVTALK_TYPE_ACK        (UAVTALK_TYPE_VER | 0x03)
 #define UAVTALK_TYPE_NACK       (UAVTALK_TYPE_VER | 0x04)
+#define UAVTALK_TYPE_OBJ_MULTI  (UAVTALK_TYPE_VER | 0x05)
+#define UAVTALK_TYPE_OBJ_DELTA  (UAVTALK_TYPE_VER | 0x06)
 #define UAVTALK_TYPE_OBJ_TS     (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ)
 #define UAVTALK_TYPE_OBJ_ACK_TS (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ_ACK)
 
@@ -37,9 +37,23 @@
 static int32_t objectTransaction(UAVTalkConnectionData *connection, UAVObjHandle objectId, uint16_t instId, uint8_t type, int32_t timeout);
 static int32_t sendObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type);
 static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type);
+static uint8_t *txFrameBuffer(UAVTalkConnectionData *connection, uint16_t length);
+static int32_t txFrameSend(UAVTalkConnectionData *connection, uint8_t *buf, uint16_t length);
 static int32_t sendNack(UAVTalkConnectionData *connection, uint32_t objId);
 static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, uint8_t *data, int32_t length);
 static void updateAck(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId);
+static void completeTransaction(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId);
+static UAVTalkTransaction *findTransaction(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId);
+static int32_t addMultiObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId);
+static int32_t sendMultiObject(UAVTalkConnectionData *connection);
+static void receiveMultiObject(UAVTalkConnectionData *connection, uint8_t *data, int32_t length);
+static UAVTalkDeltaRef *allocDeltaRefs(void);
+static UAVTalkDeltaRef *findDeltaRef(UAVTalkDeltaRef *refs, UAVObjHandle obj, uint16_t instId);
+static int32_t sendDeltaObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId);
+static int32_t receiveDeltaObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t *data, int32_t length);
+static bool isFrameHeader(uint8_t type, uint16_t packetSize);
+static void relayDropped(UAVTalkConnectionData *connection);
+static void receiveHeader(UAVTalkConnectionData *connection);
 
 /**
  * Initialize the UAVTalk library
@@ -60,6 +74,8 @@ UAVTalkConnection UAVTalkInitialize(UAVTalkOutputStream outputStream)
     connection->iproc.rxPacketLength = 0;
     connection->iproc.state = UAVTALK_STATE_SYNC;
     connection->outStream   = outputStream;
+    connection->outReserve  = NULL;
+    connection->outCommit   = NULL;
     connection->lock = xSemaphoreCreateRecursiveMutex();
     connection->transLock   = xSemaphoreCreateRecursiveMutex();
     // allocate buffers
@@ -73,6 +89,18 @@ UAVTalkConnection UAVTalkInitialize(UAVTalkOutputStream outputStream)
     }
     vSemaphoreCreateBinary(connection->respSema);
     xSemaphoreTake(connection->respSema, 0); // reset to zero
+    vSemaphoreCreateBinary(connection->windowSema);
+    xSemaphoreTake(connection->windowSema, 0); // reset to zero
+    memset(connection->transactions, 0, sizeof(connection->transactions));
+    connection->multiDelayMs = 0;
+    connection->multiLength  = 0;
+    connection->multiBuffer  = NULL;
+    connection->deltaKeyframeInterval = 0;
+    connection->txDeltaRefs  = NULL;
+    connection->rxDeltaRefs  = NULL;
+    connection->relayBuffer  = NULL;
+    connection->relayLength  = 0;
+    memset(&connection->relayStats, 0, sizeof(UAVTalkRelayStats));
     UAVTalkResetStats((UAVTalkConnection)connection);
     return (UAVTalkConnection)connection;
 }
@@ -102,6 +130,40 @@ int32_t UAVTalkSetOutputStream(UAVTalkConnection connectionHandle, UAVTalkOutput
     return 0;
 }
 
+/**
+ * Let the output lend the room to build frames in, so they do not have to be
+ * copied out of the tx buffer of the connection.  Frames go to the output
+ * stream as before whenever the output has no room to lend.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] outputReserve Function pointer that returns room for a frame of the given length, or NULL
+ * \param[in] outputCommit Function pointer that is called to send the frame built in that room,
+ *            with length 0 when the frame is dropped.  It is called once for every room lent.
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSetOutputBuffer(UAVTalkConnection connectionHandle, UAVTalkOutputReserve outputReserve, UAVTalkOutputCommit outputCommit)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    if (!outputReserve != !outputCommit) {
+        return -1;
+    }
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    // set output buffer
+    connection->outReserve = outputReserve;
+    connection->outCommit  = outputCommit;
+
+    // Release lock
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return 0;
+}
+
 /**
  * Get current output stream
  * \param[in] connection UAVTalkConnection to be used
@@ -158,7 +220,13 @@ void UAVTalkAddStats(UAVTalkConnection connectionHandle, UAVTalkStats *statsOut)
     statsOut->txObjects     += connection->stats.txObjects;
     statsOut->rxObjects     += connection->stats.rxObjects;
     statsOut->txErrors      += connection->stats.txErrors;
-    statsOut->txErrors      += connection->stats.txErrors;
+    statsOut->rxErrors      += connection->stats.rxErrors;
+    statsOut->txRetries     += connection->stats.txRetries;
+    statsOut->rttSamples    += connection->stats.rttSamples;
+    statsOut->rttSumMs      += connection->stats.rttSumMs;
+    if (connection->stats.rttMaxMs > statsOut->rttMaxMs) {
+        statsOut->rttMaxMs = connection->stats.rttMaxMs;
+    }
 
     // Release lock
     xSemaphoreGiveRecursive(connection->lock);
@@ -262,6 +330,216 @@ int32_t UAVTalkSendObjectTimestamped(UAVTalkConnection connectionHandle, UAVObjH
     }
 }
 
+/**
+ * Send the specified object through the telemetry link without waiting for the ack.
+ * Acked objects join a window of transactions waiting for their ack, they are sent
+ * again by UAVTalkProcessTransactions() when the ack does not arrive in time. Only
+ * when the window is full this waits for an ack or for a transaction to give up.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object to send
+ * \param[in] instId The instance ID or UAVOBJ_ALL_INSTANCES for all instances.
+ * \param[in] acked Selects if an ack is required (1:ack required, 0: ack not required)
+ * \param[in] timeoutMs Time to wait for each ack
+ * \param[in] retries Number of times the object is sent again before giving up
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSendObjectAsync(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId, uint8_t acked, int32_t timeoutMs, uint8_t retries)
+{
+    UAVTalkConnectionData *connection;
+    UAVTalkTransaction *trans;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+    if (acked != 1) {
+        return objectTransaction(connection, obj, instId, UAVTALK_TYPE_OBJ, UAVTALK_NOWAIT);
+    }
+
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+    // A newer version of an object still waiting for its ack takes over its transaction,
+    // and the retries it has left, so an object updated faster than it is acked still fails
+    trans = findTransaction(connection, obj, instId);
+    if (trans) {
+        trans->resent = true;
+    }
+    while (!trans && !(trans = findTransaction(connection, 0, 0))) {
+        xSemaphoreGiveRecursive(connection->lock);
+        // Window is full, wait for an ack or the next retry
+        int32_t waitMs = UAVTalkProcessTransactions(connectionHandle);
+        if (waitMs > 0) {
+            xSemaphoreTake(connection->windowSema, UAVTalkWaitTicks(waitMs));
+        }
+        xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+    }
+    if (trans->obj == 0) {
+        trans->resent  = false;
+        trans->retries = retries;
+    }
+    trans->obj       = obj;
+    trans->instId    = instId;
+    trans->timeoutMs = timeoutMs;
+    trans->sentTime  = xTaskGetTickCount() * portTICK_RATE_MS;
+    sendObject(connection, obj, instId, UAVTALK_TYPE_OBJ_ACK);
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return 0;
+}
+
+/**
+ * Send the objects of transactions that timed out waiting for their ack again, or give
+ * up on them when they are out of retries.
+ * \param[in] connection UAVTalkConnection to be used
+ * \return Time in ms until the next transaction times out, UAVTALK_WAITFOREVER if none is waiting
+ */
+int32_t UAVTalkProcessTransactions(UAVTalkConnection connectionHandle)
+{
+    UAVTalkConnectionData *connection;
+    int32_t nextMs = UAVTALK_WAITFOREVER;
+
+    CHECKCONHANDLE(connectionHandle, connection, return UAVTALK_WAITFOREVER);
+
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+    uint32_t now = xTaskGetTickCount() * portTICK_RATE_MS;
+    for (uint8_t n = 0; n < UAVTALK_MAX_TRANSACTIONS; ++n) {
+        UAVTalkTransaction *trans = &connection->transactions[n];
+        if (trans->obj == 0) {
+            continue;
+        }
+        int32_t leftMs = (int32_t)(trans->sentTime + trans->timeoutMs - now);
+        if (leftMs <= 0) {
+            if (trans->retries == 0) {
+                trans->obj = 0;
+                ++connection->stats.txErrors;
+                xSemaphoreGive(connection->windowSema);
+                continue;
+            }
+            --trans->retries;
+            ++connection->stats.txRetries;
+            trans->resent   = true;
+            trans->sentTime = now;
+            sendObject(connection, trans->obj, trans->instId, UAVTALK_TYPE_OBJ_ACK);
+            leftMs = trans->timeoutMs;
+        }
+        if (nextMs == UAVTALK_WAITFOREVER || leftMs < nextMs) {
+            nextMs = leftMs;
+        }
+    }
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return nextMs;
+}
+
+/**
+ * Collect object updates sent without an ack into multi-object frames, which
+ * save the framing overhead of one frame per object on slow links. Only use
+ * this when the other side is known to understand multi-object frames.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] delayMs Longest time an update waits for others to join it, 0 to send every object in a frame of its own
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSetMultiObjectDelay(UAVTalkConnection connectionHandle, int32_t delayMs)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+    if (delayMs > 0 && !connection->multiBuffer) {
+        connection->multiBuffer = pvPortMalloc(UAVTALK_MIN_HEADER_LENGTH + UAVTALK_MULTI_MAX_PAYLOAD_LENGTH + UAVTALK_CHECKSUM_LENGTH);
+        if (!connection->multiBuffer) {
+            xSemaphoreGiveRecursive(connection->lock);
+            return -1;
+        }
+    }
+    if (delayMs <= 0) {
+        sendMultiObject(connection);
+        delayMs = 0;
+    }
+    connection->multiDelayMs = delayMs;
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return 0;
+}
+
+/**
+ * Send the multi-object frame once its first update waited for the delay set
+ * by UAVTalkSetMultiObjectDelay().
+ * \param[in] connection UAVTalkConnection to be used
+ * \return Time in ms until the frame is due, UAVTALK_WAITFOREVER if nothing is collected
+ */
+int32_t UAVTalkProcessMultiObject(UAVTalkConnection connectionHandle)
+{
+    UAVTalkConnectionData *connection;
+    int32_t leftMs = UAVTALK_WAITFOREVER;
+
+    CHECKCONHANDLE(connectionHandle, connection, return UAVTALK_WAITFOREVER);
+
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+    if (connection->multiLength > 0) {
+        leftMs = (int32_t)(connection->multiTime + connection->multiDelayMs - xTaskGetTickCount() * portTICK_RATE_MS);
+        if (leftMs <= 0) {
+            sendMultiObject(connection);
+            leftMs = UAVTALK_WAITFOREVER;
+        }
+    }
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return leftMs;
+}
+
+/**
+ * Convert a time returned by UAVTalkProcessTransactions() or UAVTalkProcessMultiObject()
+ * to ticks to wait, rounded up so that waiting for less than a tick does not turn into polling.
+ * \param[in] waitMs Time in ms, UAVTALK_WAITFOREVER if nothing is waiting
+ * \return Ticks to wait
+ */
+portTickType UAVTalkWaitTicks(int32_t waitMs)
+{
+    if (waitMs < 0) {
+        return portMAX_DELAY;
+    }
+    return (waitMs + portTICK_RATE_MS - 1) / portTICK_RATE_MS;
+}
+
+/**
+ * Send the updates of objects that have their field sizes registered as field
+ * deltas against a keyframe, see UAVObjSetFieldSizes(). Only use this when the
+ * other side is known to understand delta frames.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] interval Updates sent as deltas between two keyframes, 0 to send objects in full
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSetDeltaKeyframeInterval(UAVTalkConnection connectionHandle, uint8_t interval)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    if (interval == UAVTALK_DELTA_NO_KEYFRAME) {
+        return -1;
+    }
+
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+    if (interval > 0 && !connection->txDeltaRefs) {
+        connection->txDeltaRefs = allocDeltaRefs();
+        if (!connection->txDeltaRefs) {
+            xSemaphoreGiveRecursive(connection->lock);
+            return -1;
+        }
+    }
+    // The other side may have lost its keyframes, start with new ones
+    if (interval != connection->deltaKeyframeInterval && connection->txDeltaRefs) {
+        for (uint8_t i = 0; i < UAVTALK_MAX_DELTA_OBJECTS; i++) {
+            connection->txDeltaRefs[i].sinceKeyframe = UAVTALK_DELTA_NO_KEYFRAME;
+        }
+    }
+    connection->deltaKeyframeInterval = interval;
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return 0;
+}
+
 /**
  * Execute the requested transaction on an object.
  * \param[in] connection UAVTalkConnection to be used
@@ -305,7 +583,11 @@ static int32_t objectTransaction(UAVTalkConnectionData *connection, UAVObjHandle
         }
     } else if (type == UAVTALK_TYPE_OBJ || type == UAVTALK_TYPE_OBJ_TS) {
         xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
-        sendObject(connection, obj, instId, type);
+        if (type == UAVTALK_TYPE_OBJ && connection->deltaKeyframeInterval > 0 && sendDeltaObject(connection, obj, instId) == 0) {
+            // Sent as a keyframe or field delta
+        } else if (type != UAVTALK_TYPE_OBJ || connection->multiDelayMs == 0 || addMultiObject(connection, obj, instId) != 0) {
+            sendObject(connection, obj, instId, type);
+        }
         xSemaphoreGiveRecursive(connection->lock);
         return 0;
     } else {
@@ -402,60 +684,7 @@ UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connectionHandle
             break;
         }
 
-        // Search for object.
-        iproc->obj = UAVObjGetByID(iproc->objId);
-
-        // Determine data length
-        if (iproc->type == UAVTALK_TYPE_OBJ_REQ || iproc->type == UAVTALK_TYPE_ACK || iproc->type == UAVTALK_TYPE_NACK) {
-            iproc->length = 0;
-            iproc->instanceLength = 0;
-        } else {
-            if (iproc->obj) {
-                iproc->length = UAVObjGetNumBytes(iproc->obj);
-                iproc->instanceLength = (UAVObjIsSingleInstance(iproc->obj) ? 0 : 2);
-            } else {
-                // We don't know if it's a multi-instance object, so just assume it's 0.
-                iproc->instanceLength = 0;
-                iproc->length = iproc->packet_size - iproc->rxPacketLength;
-            }
-            iproc->timestampLength = (iproc->type & UAVTALK_TIMESTAMPED) ? 2 : 0;
-        }
-
-        // Check length and determine next state
-        if (iproc->length >= UAVTALK_MAX_PAYLOAD_LENGTH) {
-            connection->stats.rxErrors++;
-            iproc->state = UAVTALK_STATE_ERROR;
-            break;
-        }
-
-        // Check the lengths match
-        if ((iproc->rxPacketLength + iproc->instanceLength + iproc->timestampLength + iproc->length) != iproc->packet_size) { // packet error - mismatched packet size
-            connection->stats.rxErrors++;
-            iproc->state = UAVTALK_STATE_ERROR;
-            break;
-        }
-
-        iproc->instId = 0;
-        if (iproc->type == UAVTALK_TYPE_NACK) {
-            // If this is a NACK, we skip to Checksum
-            iproc->state = UAVTALK_STATE_CS;
-        }
-        // Check if this is a single instance object (i.e. if the instance ID field is coming next)
-        else if ((iproc->obj != 0) && !UAVObjIsSingleInstance(iproc->obj)) {
-            iproc->state = UAVTALK_STATE_INSTID;
-        }
-        // Check if this is a single instance and has a timestamp in it
-        else if ((iproc->obj != 0) && (iproc->type & UAVTALK_TIMESTAMPED)) {
-            iproc->timestamp = 0;
-            iproc->state     = UAVTALK_STATE_TIMESTAMP;
-        } else {
-            // If there is a payload get it, otherwise receive checksum
-            if (iproc->length > 0) {
-                iproc->state = UAVTALK_STATE_DATA;
-            } else {
-                iproc->state = UAVTALK_STATE_CS;
-            }
-        }
+        receiveHeader(connection);
         iproc->rxCount = 0;
 
         break;
@@ -568,6 +797,79 @@ UAVTalkRxState UAVTalkProcessInputStream(UAVTalkConnection connectionHandle, uin
     return state;
 }
 
+/**
+ * Process a block of bytes from the telemetry stream, same as passing them one by one
+ * to UAVTalkProcessInputStream(). Bytes between packets are skipped, headers and
+ * payloads are taken in one go.
+ * \param[in] connectionHandle UAVTalkConnection to be used
+ * \param[in] buf Received bytes
+ * \param[in] length Number of received bytes
+ * \return UAVTalkRxState after the last byte
+ */
+UAVTalkRxState UAVTalkProcessInputBuffer(UAVTalkConnection connectionHandle, uint8_t *buf, uint16_t length)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    UAVTalkInputProcessor *iproc = &connection->iproc;
+    uint16_t used = 0;
+
+    while (used < length) {
+        uint8_t *data  = &buf[used];
+        uint16_t count = length - used;
+
+        if (iproc->state == UAVTALK_STATE_SYNC || iproc->state == UAVTALK_STATE_ERROR || iproc->state == UAVTALK_STATE_COMPLETE) {
+            // Skip to the next sync byte
+            uint8_t *sync = memchr(data, UAVTALK_SYNC_VAL, count);
+            if (sync != data) {
+                if (sync) {
+                    count = sync - data;
+                }
+                connection->stats.rxBytes += count;
+                iproc->rxPacketLength = (iproc->rxPacketLength + count < 0xffff) ? iproc->rxPacketLength + count : 0xffff;
+                iproc->state = UAVTALK_STATE_SYNC;
+                used += count;
+                continue;
+            }
+
+            // Take a valid header up to the object id at once
+            if (count >= UAVTALK_MIN_HEADER_LENGTH && isFrameHeader(data[1], data[2] | (data[3] << 8))) {
+                connection->stats.rxBytes += UAVTALK_MIN_HEADER_LENGTH;
+                iproc->cs    = PIOS_CRC_updateCRC(0, data, UAVTALK_MIN_HEADER_LENGTH);
+                iproc->type  = data[1];
+                iproc->packet_size    = data[2] | (data[3] << 8);
+                iproc->objId = data[4] | (data[5] << 8) | (data[6] << 16) | ((uint32_t)data[7] << 24);
+                iproc->rxPacketLength = UAVTALK_MIN_HEADER_LENGTH;
+                receiveHeader(connection);
+                iproc->rxCount = 0;
+                used += UAVTALK_MIN_HEADER_LENGTH;
+                continue;
+            }
+        } else if (iproc->state == UAVTALK_STATE_DATA) {
+            // Copy as much of the payload as there is
+            if (count > iproc->length - iproc->rxCount) {
+                count = iproc->length - iproc->rxCount;
+            }
+            memcpy(&connection->rxBuffer[iproc->rxCount], data, count);
+            connection->stats.rxBytes += count;
+            iproc->cs              = PIOS_CRC_updateCRC(iproc->cs, data, count);
+            iproc->rxCount        += count;
+            iproc->rxPacketLength += count;
+            if (iproc->rxCount == iproc->length) {
+                iproc->state   = UAVTALK_STATE_CS;
+                iproc->rxCount = 0;
+            }
+            used += count;
+            continue;
+        }
+
+        UAVTalkProcessInputStream(connectionHandle, buf[used++]);
+    }
+
+    return iproc->state;
+}
+
 /**
  * Send a parsed packet received on one connection handle out on a different connection handle.
  * The packet must be in a complete state, meaning it is completed parsing.
@@ -724,66 +1026,282 @@ int32_t UAVTalkSendNack(UAVTalkConnection connectionHandle, uint32_t objId)
 }
 
 /**
- * Get the object ID of the current packet.
- * \param[in] connectionHandle UAVTalkConnection to be used
- * \param[in] objId Object ID to send a NACK for
- * \return The object ID, or 0 on error.
+ * Find the next frame in a block of received bytes, for relaying it without decoding it.
+ * Only the frame boundary and the checksum are checked. A frame that is complete in the
+ * block is returned in place, one that arrives in pieces is collected in the connection.
+ * Frames with a bad header or checksum are dropped.
+ * \param[in] connectionHandle UAVTalkConnection the bytes were received on
+ * \param[in] buf Received bytes
+ * \param[in] length Number of received bytes
+ * \param[in] rxTimeMs Time the block was received, in ms. A frame is timed from the block holding its sync byte.
+ * \param[out] frame The frame found, data is NULL if there is none yet. It is valid until the next call.
+ * \return The number of bytes used, call again with the rest of the block
  */
-uint32_t UAVTalkGetPacketObjId(UAVTalkConnection connectionHandle)
+uint16_t UAVTalkScanFrame(UAVTalkConnection connectionHandle, uint8_t *buf, uint16_t length, uint32_t rxTimeMs, UAVTalkFrame *frame)
 {
     UAVTalkConnectionData *connection;
+    uint16_t used = 0;
 
-    CHECKCONHANDLE(connectionHandle, connection, return 0);
-    return connection->iproc.objId;
+    frame->data = NULL;
+    CHECKCONHANDLE(connectionHandle, connection, return length);
+
+    while (used < length) {
+        uint8_t *data = NULL;
+        uint16_t size;
+
+        if (connection->relayLength == 0) {
+            // Look for the start of a frame
+            uint8_t *sync = memchr(&buf[used], UAVTALK_SYNC_VAL, length - used);
+            if (!sync) {
+                return length;
+            }
+            used = sync - buf;
+            connection->relayTime = rxTimeMs;
+
+            if (length - used >= UAVTALK_MIN_HEADER_LENGTH) {
+                size = buf[used + 2] | (buf[used + 3] << 8);
+                if (!isFrameHeader(buf[used + 1], size)) {
+                    // Not a frame, look for the next sync byte
+                    relayDropped(connection);
+                    used++;
+                    continue;
+                }
+                if (length - used > size) {
+                    // The whole frame is in the block
+                    data  = &buf[used];
+                    used += size + UAVTALK_CHECKSUM_LENGTH;
+                }
+            }
+        }
+
+        if (!data) {
+            if (!connection->relayBuffer) {
+                connection->relayBuffer = pvPortMalloc(UAVTALK_MAX_PACKET_LENGTH);
+                if (!connection->relayBuffer) {
+                    return length;
+                }
+            }
+
+            // Collect the header, then the rest of the frame
+            uint16_t needed = UAVTALK_MIN_HEADER_LENGTH;
+            if (connection->relayLength >= UAVTALK_MIN_HEADER_LENGTH) {
+                needed = (connection->relayBuffer[2] | (connection->relayBuffer[3] << 8)) + UAVTALK_CHECKSUM_LENGTH;
+            }
+            uint16_t count = needed - connection->relayLength;
+            if (count > length - used) {
+                count = length - used;
+            }
+            memcpy(&connection->relayBuffer[connection->relayLength], &buf[used], count);
+            connection->relayLength += count;
+            used += count;
+            if (connection->relayLength < needed) {
+                return used;
+            }
+            size = connection->relayBuffer[2] | (connection->relayBuffer[3] << 8);
+            if (connection->relayLength == UAVTALK_MIN_HEADER_LENGTH) {
+                if (!isFrameHeader(connection->relayBuffer[1], size)) {
+                    // Not a frame, carry on from the next sync byte in what was collected
+                    uint8_t *sync = memchr(&connection->relayBuffer[1], UAVTALK_SYNC_VAL, UAVTALK_MIN_HEADER_LENGTH - 1);
+                    relayDropped(connection);
+                    connection->relayLength = 0;
+                    if (sync) {
+                        connection->relayLength = &connection->relayBuffer[UAVTALK_MIN_HEADER_LENGTH] - sync;
+                        memmove(connection->relayBuffer, sync, connection->relayLength);
+                    }
+                }
+                continue;
+            }
+            data = connection->relayBuffer;
+            connection->relayLength = 0;
+        }
+
+        if (PIOS_CRC_updateCRC(0, data, size) != data[size]) {
+            relayDropped(connection);
+            continue;
+        }
+        frame->data      = data;
+        frame->length    = size + UAVTALK_CHECKSUM_LENGTH;
+        frame->type      = data[1];
+        frame->objId     = data[4] | (data[5] << 8) | (data[6] << 16) | ((uint32_t)data[7] << 24);
+        frame->startTime = connection->relayTime;
+        return used;
+    }
+
+    return used;
 }
 
 /**
- * Receive an object. This function process objects received through the telemetry stream.
- * \param[in] connection UAVTalkConnection to be used
- * \param[in] type Type of received message (UAVTALK_TYPE_OBJ, UAVTALK_TYPE_OBJ_REQ, UAVTALK_TYPE_OBJ_ACK, UAVTALK_TYPE_ACK, UAVTALK_TYPE_NACK)
- * \param[in] objId ID of the object to work on
- * \param[in] instId The instance ID of UAVOBJ_ALL_INSTANCES for all instances.
- * \param[in] data Data buffer
- * \param[in] length Buffer length
+ * Send a frame found by UAVTalkScanFrame() out on a different connection as it is.
+ * \param[in] inConnectionHandle UAVTalkConnection the frame was received on
+ * \param[in] outConnectionHandle UAVTalkConnection to send the frame on
+ * \param[in] frame The frame
  * \return 0 Success
  * \return -1 Failure
  */
-static int32_t receiveObject(UAVTalkConnectionData *connection,
-                             uint8_t type,
-                             uint32_t objId,
-                             uint16_t instId,
-                             uint8_t *data,
-                             __attribute__((unused)) int32_t length)
+int32_t UAVTalkRelayFrame(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, UAVTalkFrame *frame)
 {
-    UAVObjHandle obj;
-    int32_t ret = 0;
+    UAVTalkConnectionData *inConnection;
+    UAVTalkConnectionData *outConnection;
+
+    CHECKCONHANDLE(inConnectionHandle, inConnection, return -1);
+    CHECKCONHANDLE(outConnectionHandle, outConnection, return -1);
+
+    if (!frame->data || !outConnection->outStream) {
+        return -1;
+    }
 
     // Lock
-    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+    xSemaphoreTakeRecursive(outConnection->lock, portMAX_DELAY);
 
-    // Get the handle to the Object. Will be zero
-    // if object does not exist.
-    obj = UAVObjGetByID(objId);
+    int32_t rc = (*outConnection->outStream)(frame->data, frame->length);
+    if (rc > 0) {
+        outConnection->stats.txBytes += rc;
+    }
 
-    // Process message type
-    switch (type) {
-    case UAVTALK_TYPE_OBJ:
-    case UAVTALK_TYPE_OBJ_TS:
-        // All instances, not allowed for OBJ messages
-        if (obj && (instId != UAVOBJ_ALL_INSTANCES)) {
-            // Unpack object, if the instance does not exist it will be created!
-            UAVObjUnpack(obj, instId, data);
-            // Check if an ack is pending
-            updateAck(connection, obj, instId);
-        } else {
-            ret = -1;
-        }
-        break;
+    // Release lock
+    xSemaphoreGiveRecursive(outConnection->lock);
 
-    case UAVTALK_TYPE_OBJ_ACK:
-    case UAVTALK_TYPE_OBJ_ACK_TS:
-        // All instances, not allowed for OBJ_ACK messages
-        if (obj && (instId != UAVOBJ_ALL_INSTANCES)) {
+    // Update stats
+    if (rc != frame->length) {
+        relayDropped(inConnection);
+        return -1;
+    }
+    uint32_t latencyMs = xTaskGetTickCount() * portTICK_RATE_MS - frame->startTime;
+    xSemaphoreTakeRecursive(inConnection->lock, portMAX_DELAY);
+    inConnection->relayStats.frames++;
+    inConnection->relayStats.bytes += frame->length;
+    inConnection->relayStats.latencySumMs += latencyMs;
+    if (latencyMs > inConnection->relayStats.latencyMaxMs) {
+        inConnection->relayStats.latencyMaxMs = latencyMs;
+    }
+    xSemaphoreGiveRecursive(inConnection->lock);
+
+    return 0;
+}
+
+/**
+ * Decode a frame found by UAVTalkScanFrame(), for frames that are meant for this end of the link.
+ * \param[in] connectionHandle UAVTalkConnection the frame was received on
+ * \param[in] frame The frame
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkReceiveFrame(UAVTalkConnection connectionHandle, UAVTalkFrame *frame)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    if (!frame->data) {
+        return -1;
+    }
+    return UAVTalkProcessInputBuffer(connectionHandle, frame->data, frame->length) == UAVTALK_STATE_COMPLETE ? 0 : -1;
+}
+
+/**
+ * Get the relay statistics of the frames received on a connection.
+ * \param[in] connectionHandle UAVTalkConnection the frames were received on
+ * \param[out] statsOut Statistics counters
+ * \param[in] reset Start counting again, no frame relayed in between is lost
+ */
+void UAVTalkGetRelayStats(UAVTalkConnection connectionHandle, UAVTalkRelayStats *statsOut, bool reset)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return );
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    memcpy(statsOut, &connection->relayStats, sizeof(UAVTalkRelayStats));
+    if (reset) {
+        memset(&connection->relayStats, 0, sizeof(UAVTalkRelayStats));
+    }
+
+    // Release lock
+    xSemaphoreGiveRecursive(connection->lock);
+}
+
+/**
+ * Reset the relay statistics counters.
+ * \param[in] connectionHandle UAVTalkConnection the frames were received on
+ */
+void UAVTalkResetRelayStats(UAVTalkConnection connectionHandle)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return );
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    memset(&connection->relayStats, 0, sizeof(UAVTalkRelayStats));
+
+    // Release lock
+    xSemaphoreGiveRecursive(connection->lock);
+}
+
+/**
+ * Get the object ID of the current packet.
+ * \param[in] connectionHandle UAVTalkConnection to be used
+ * \param[in] objId Object ID to send a NACK for
+ * \return The object ID, or 0 on error.
+ */
+uint32_t UAVTalkGetPacketObjId(UAVTalkConnection connectionHandle)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return 0);
+    return connection->iproc.objId;
+}
+
+/**
+ * Receive an object. This function process objects received through the telemetry stream.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] type Type of received message (UAVTALK_TYPE_OBJ, UAVTALK_TYPE_OBJ_REQ, UAVTALK_TYPE_OBJ_ACK, UAVTALK_TYPE_ACK, UAVTALK_TYPE_NACK)
+ * \param[in] objId ID of the object to work on
+ * \param[in] instId The instance ID of UAVOBJ_ALL_INSTANCES for all instances.
+ * \param[in] data Data buffer
+ * \param[in] length Buffer length
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t receiveObject(UAVTalkConnectionData *connection,
+                             uint8_t type,
+                             uint32_t objId,
+                             uint16_t instId,
+                             uint8_t *data,
+                             int32_t length)
+{
+    UAVObjHandle obj;
+    int32_t ret = 0;
+
+    // Lock
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    // Get the handle to the Object. Will be zero
+    // if object does not exist.
+    obj = UAVObjGetByID(objId);
+
+    // Process message type
+    switch (type) {
+    case UAVTALK_TYPE_OBJ:
+    case UAVTALK_TYPE_OBJ_TS:
+        // All instances, not allowed for OBJ messages
+        if (obj && (instId != UAVOBJ_ALL_INSTANCES)) {
+            // Unpack object, if the instance does not exist it will be created!
+            UAVObjUnpack(obj, instId, data);
+            // Check if an ack is pending
+            updateAck(connection, obj, instId);
+        } else {
+            ret = -1;
+        }
+        break;
+
+    case UAVTALK_TYPE_OBJ_ACK:
+    case UAVTALK_TYPE_OBJ_ACK_TS:
+        // All instances, not allowed for OBJ_ACK messages
+        if (obj && (instId != UAVOBJ_ALL_INSTANCES)) {
             // Unpack object, if the instance does not exist it will be created!
             if (UAVObjUnpack(obj, instId, data) == 0) {
                 // Transmit ACK
@@ -803,6 +1321,22 @@ static int32_t receiveObject(UAVTalkConnectionData *connection,
             sendObject(connection, obj, instId, UAVTALK_TYPE_OBJ);
         }
         break;
+    case UAVTALK_TYPE_OBJ_DELTA:
+        // All instances, not allowed for delta messages
+        if (obj && (instId != UAVOBJ_ALL_INSTANCES) && receiveDeltaObject(connection, obj, instId, data, length) == 0) {
+            // Check if an ack is pending
+            updateAck(connection, obj, instId);
+        } else {
+            ret = -1;
+        }
+        break;
+    case UAVTALK_TYPE_OBJ_MULTI:
+        if (objId == UAVTALK_OBJID_MULTI) {
+            receiveMultiObject(connection, data, length);
+        } else {
+            ret = -1;
+        }
+        break;
     case UAVTALK_TYPE_NACK:
         // Do nothing on flight side, let it time out.
         break;
@@ -811,6 +1345,7 @@ static int32_t receiveObject(UAVTalkConnectionData *connection,
         if (obj && (instId != UAVOBJ_ALL_INSTANCES)) {
             // Check if an ack is pending
             updateAck(connection, obj, instId);
+            completeTransaction(connection, obj, instId);
         } else {
             ret = -1;
         }
@@ -840,6 +1375,51 @@ static void updateAck(UAVTalkConnectionData *connection, UAVObjHandle obj, uint1
     }
 }
 
+/**
+ * Find the transaction of an object waiting for its ack
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object, 0 to find a free slot
+ * \param[in] instId The instance ID
+ * \return The transaction or NULL if there is none
+ */
+static UAVTalkTransaction *findTransaction(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId)
+{
+    for (uint8_t n = 0; n < UAVTALK_MAX_TRANSACTIONS; ++n) {
+        UAVTalkTransaction *trans = &connection->transactions[n];
+        if (trans->obj == obj && (obj == 0 || trans->instId == instId)) {
+            return trans;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Complete the transaction an ack was received for and measure the round trip time
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object
+ * \param[in] instId The instance ID
+ */
+static void completeTransaction(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId)
+{
+    for (uint8_t n = 0; n < UAVTALK_MAX_TRANSACTIONS; ++n) {
+        UAVTalkTransaction *trans = &connection->transactions[n];
+        if (trans->obj != obj || (trans->instId != instId && trans->instId != UAVOBJ_ALL_INSTANCES)) {
+            continue;
+        }
+        if (!trans->resent) {
+            uint32_t rttMs = xTaskGetTickCount() * portTICK_RATE_MS - trans->sentTime;
+            ++connection->stats.rttSamples;
+            connection->stats.rttSumMs += rttMs;
+            if (rttMs > connection->stats.rttMaxMs) {
+                connection->stats.rttMaxMs = rttMs;
+            }
+        }
+        trans->obj = 0;
+        xSemaphoreGive(connection->windowSema);
+        return;
+    }
+}
+
 /**
  * Send an object through the telemetry link.
  * \param[in] connection UAVTalkConnection to be used
@@ -854,6 +1434,9 @@ static int32_t sendObject(UAVTalkConnectionData *connection, UAVObjHandle obj, u
     uint32_t numInst;
     uint32_t n;
 
+    // Updates collected before this one go first
+    sendMultiObject(connection);
+
     // If all instances are requested and this is a single instance object, force instance ID to zero
     if (instId == UAVOBJ_ALL_INSTANCES && UAVObjIsSingleInstance(obj)) {
         instId = 0;
@@ -904,73 +1487,602 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle
         return -1;
     }
 
+    // Determine data length
+    if (type == UAVTALK_TYPE_OBJ_REQ || type == UAVTALK_TYPE_ACK) {
+        length = 0;
+    } else {
+        length = UAVObjGetNumBytes(obj);
+    }
+
+    // Check length
+    if (length >= UAVTALK_MAX_PAYLOAD_LENGTH) {
+        return -1;
+    }
+
+    // Header length, with the instance ID if one is required and the timestamp if appropriate
+    dataOffset = UAVObjIsSingleInstance(obj) ? 8 : 10;
+    if (type & UAVTALK_TIMESTAMPED) {
+        dataOffset += 2;
+    }
+
+    uint16_t tx_msg_len = dataOffset + length + UAVTALK_CHECKSUM_LENGTH;
+    uint8_t *buf = txFrameBuffer(connection, tx_msg_len);
+
     // Setup type and object id fields
-    objId = UAVObjGetID(obj);
-    connection->txBuffer[0] = UAVTALK_SYNC_VAL; // sync byte
-    connection->txBuffer[1] = type;
+    objId  = UAVObjGetID(obj);
+    buf[0] = UAVTALK_SYNC_VAL; // sync byte
+    buf[1] = type;
     // data length inserted here below
-    connection->txBuffer[4] = (uint8_t)(objId & 0xFF);
-    connection->txBuffer[5] = (uint8_t)((objId >> 8) & 0xFF);
-    connection->txBuffer[6] = (uint8_t)((objId >> 16) & 0xFF);
-    connection->txBuffer[7] = (uint8_t)((objId >> 24) & 0xFF);
+    buf[4] = (uint8_t)(objId & 0xFF);
+    buf[5] = (uint8_t)((objId >> 8) & 0xFF);
+    buf[6] = (uint8_t)((objId >> 16) & 0xFF);
+    buf[7] = (uint8_t)((objId >> 24) & 0xFF);
 
     // Setup instance ID if one is required
-    if (UAVObjIsSingleInstance(obj)) {
-        dataOffset = 8;
-    } else {
-        connection->txBuffer[8] = (uint8_t)(instId & 0xFF);
-        connection->txBuffer[9] = (uint8_t)((instId >> 8) & 0xFF);
-        dataOffset = 10;
+    if (!UAVObjIsSingleInstance(obj)) {
+        buf[8] = (uint8_t)(instId & 0xFF);
+        buf[9] = (uint8_t)((instId >> 8) & 0xFF);
     }
 
     // Add timestamp when the transaction type is appropriate
     if (type & UAVTALK_TIMESTAMPED) {
         portTickType time = xTaskGetTickCount();
-        connection->txBuffer[dataOffset]     = (uint8_t)(time & 0xFF);
-        connection->txBuffer[dataOffset + 1] = (uint8_t)((time >> 8) & 0xFF);
-        dataOffset += 2;
+        buf[dataOffset - 2] = (uint8_t)(time & 0xFF);
+        buf[dataOffset - 1] = (uint8_t)((time >> 8) & 0xFF);
     }
 
-    // Determine data length
-    if (type == UAVTALK_TYPE_OBJ_REQ || type == UAVTALK_TYPE_ACK) {
-        length = 0;
-    } else {
-        length = UAVObjGetNumBytes(obj);
+    // Copy data (if any), room lent by the output is handed back on failure
+    if (length > 0) {
+        if (UAVObjPack(obj, instId, &buf[dataOffset]) < 0) {
+            txFrameSend(connection, buf, 0);
+            return -1;
+        }
     }
 
-    // Check length
-    if (length >= UAVTALK_MAX_PAYLOAD_LENGTH) {
+    // Store the packet length
+    buf[2] = (uint8_t)((dataOffset + length) & 0xFF);
+    buf[3] = (uint8_t)(((dataOffset + length) >> 8) & 0xFF);
+
+    // Calculate checksum
+    buf[dataOffset + length] = PIOS_CRC_updateCRC(0, buf, dataOffset + length);
+
+    int32_t rc = txFrameSend(connection, buf, tx_msg_len);
+
+    if (rc == tx_msg_len) {
+        // Update stats
+        ++connection->stats.txObjects;
+        connection->stats.txBytes += tx_msg_len;
+        connection->stats.txObjectBytes += length;
+    }
+
+    // Done
+    return 0;
+}
+
+/**
+ * Get the buffer to build a frame in, room lent by the output when it has
+ * some or the tx buffer of the connection otherwise.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] length Longest frame that will be built
+ * \return the buffer
+ */
+static uint8_t *txFrameBuffer(UAVTalkConnectionData *connection, uint16_t length)
+{
+    uint8_t *buf = NULL;
+
+    if (connection->outReserve) {
+        buf = (*connection->outReserve)(length);
+    }
+
+    return buf ? buf : connection->txBuffer;
+}
+
+/**
+ * Send a frame built in the buffer from txFrameBuffer()
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] buf The buffer
+ * \param[in] length Frame length, 0 to drop the frame and hand lent room back
+ * \return number of bytes sent
+ */
+static int32_t txFrameSend(UAVTalkConnectionData *connection, uint8_t *buf, uint16_t length)
+{
+    if (buf != connection->txBuffer) {
+        return (*connection->outCommit)(length);
+    }
+
+    if (length == 0) {
+        return 0;
+    }
+
+    return (*connection->outStream)(buf, length);
+}
+
+/**
+ * Collect an object update for the next multi-object frame. An update of an
+ * object that is already collected replaces the older one.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object handle to send
+ * \param[in] instId The instance ID, UAVOBJ_ALL_INSTANCES only for single instance objects
+ * \return 0 Success
+ * \return -1 if the update has to be sent in a frame of its own
+ */
+static int32_t addMultiObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId)
+{
+    uint8_t *payload = &connection->multiBuffer[UAVTALK_MIN_HEADER_LENGTH];
+    uint8_t instanceLength;
+    uint32_t objId;
+    uint16_t length;
+    uint16_t offset;
+
+    if (UAVObjIsSingleInstance(obj)) {
+        instId = 0;
+        instanceLength = 0;
+    } else if (instId == UAVOBJ_ALL_INSTANCES) {
         return -1;
+    } else {
+        instanceLength = 2;
     }
+    length = UAVObjGetNumBytes(obj);
+    if (UAVTALK_MULTI_RECORD_HEADER_LENGTH + instanceLength + length > UAVTALK_MULTI_MAX_PAYLOAD_LENGTH) {
+        return -1;
+    }
+    objId = UAVObjGetID(obj);
 
-    // Copy data (if any)
-    if (length > 0) {
-        if (UAVObjPack(obj, instId, &connection->txBuffer[dataOffset]) < 0) {
+    // Replace an update collected earlier
+    for (offset = 0; offset < connection->multiLength; offset += UAVTALK_MULTI_RECORD_HEADER_LENGTH + payload[offset + 4]) {
+        uint8_t *record = &payload[offset];
+        if (record[0] == (uint8_t)(objId & 0xFF) && record[1] == (uint8_t)((objId >> 8) & 0xFF) &&
+            record[2] == (uint8_t)((objId >> 16) & 0xFF) && record[3] == (uint8_t)((objId >> 24) & 0xFF) &&
+            (instanceLength == 0 || (record[5] == (uint8_t)(instId & 0xFF) && record[6] == (uint8_t)((instId >> 8) & 0xFF)))) {
+            return UAVObjPack(obj, instId, &record[UAVTALK_MULTI_RECORD_HEADER_LENGTH + instanceLength]) < 0 ? -1 : 0;
+        }
+    }
+
+    // Make room
+    if (connection->multiLength + UAVTALK_MULTI_RECORD_HEADER_LENGTH + instanceLength + length > UAVTALK_MULTI_MAX_PAYLOAD_LENGTH) {
+        if (sendMultiObject(connection) < 0) {
             return -1;
         }
     }
 
+    uint8_t *record = &payload[connection->multiLength];
+    record[0] = (uint8_t)(objId & 0xFF);
+    record[1] = (uint8_t)((objId >> 8) & 0xFF);
+    record[2] = (uint8_t)((objId >> 16) & 0xFF);
+    record[3] = (uint8_t)((objId >> 24) & 0xFF);
+    record[4] = instanceLength + length;
+    if (instanceLength > 0) {
+        record[5] = (uint8_t)(instId & 0xFF);
+        record[6] = (uint8_t)((instId >> 8) & 0xFF);
+    }
+    if (UAVObjPack(obj, instId, &record[UAVTALK_MULTI_RECORD_HEADER_LENGTH + instanceLength]) < 0) {
+        return -1;
+    }
+
+    if (connection->multiLength == 0) {
+        connection->multiTime = xTaskGetTickCount() * portTICK_RATE_MS;
+    }
+    connection->multiLength += UAVTALK_MULTI_RECORD_HEADER_LENGTH + instanceLength + length;
+
+    // Update stats
+    ++connection->stats.txObjects;
+    connection->stats.txObjectBytes += length;
+
+    return 0;
+}
+
+/**
+ * Send the object updates collected by addMultiObject() in one frame
+ * \param[in] connection UAVTalkConnection to be used
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t sendMultiObject(UAVTalkConnectionData *connection)
+{
+    uint8_t *buf = connection->multiBuffer;
+    uint16_t length = UAVTALK_MIN_HEADER_LENGTH + connection->multiLength;
+
+    if (connection->multiLength == 0) {
+        return 0;
+    }
+    // Keep the collected updates until there is a stream to send them on
+    if (!connection->outStream) {
+        return -1;
+    }
+    connection->multiLength = 0;
+
+    buf[0] = UAVTALK_SYNC_VAL; // sync byte
+    buf[1] = UAVTALK_TYPE_OBJ_MULTI;
+    buf[2] = (uint8_t)(length & 0xFF);
+    buf[3] = (uint8_t)((length >> 8) & 0xFF);
+    buf[4] = (uint8_t)(UAVTALK_OBJID_MULTI & 0xFF);
+    buf[5] = (uint8_t)((UAVTALK_OBJID_MULTI >> 8) & 0xFF);
+    buf[6] = (uint8_t)((UAVTALK_OBJID_MULTI >> 16) & 0xFF);
+    buf[7] = (uint8_t)((UAVTALK_OBJID_MULTI >> 24) & 0xFF);
+
+    // Calculate checksum
+    buf[length] = PIOS_CRC_updateCRC(0, buf, length);
+
+    uint16_t tx_msg_len = length + UAVTALK_CHECKSUM_LENGTH;
+    int32_t rc = (*connection->outStream)(buf, tx_msg_len);
+
+    if (rc == tx_msg_len) {
+        // Update stats
+        connection->stats.txBytes += tx_msg_len;
+    }
+
+    return 0;
+}
+
+/**
+ * Unpack the records of a multi-object frame, records of unknown objects or
+ * with the wrong length are skipped
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] data Frame payload
+ * \param[in] length Payload length
+ */
+static void receiveMultiObject(UAVTalkConnectionData *connection, uint8_t *data, int32_t length)
+{
+    int32_t offset   = 0;
+    uint32_t records = 0;
+
+    while (offset + UAVTALK_MULTI_RECORD_HEADER_LENGTH <= length) {
+        uint8_t *record = &data[offset];
+        uint8_t recordLength = record[4];
+
+        // Nothing past the header is read before the whole record is known to be in the frame
+        if (offset + UAVTALK_MULTI_RECORD_HEADER_LENGTH + recordLength > length) {
+            connection->stats.rxErrors++;
+            break;
+        }
+        offset += UAVTALK_MULTI_RECORD_HEADER_LENGTH + recordLength;
+        ++records;
+
+        uint32_t objId   = record[0] | (record[1] << 8) | (record[2] << 16) | ((uint32_t)record[3] << 24);
+        UAVObjHandle obj = UAVObjGetByID(objId);
+        if (obj == 0) {
+            continue;
+        }
+        uint8_t instanceLength = UAVObjIsSingleInstance(obj) ? 0 : 2;
+        if (recordLength != instanceLength + UAVObjGetNumBytes(obj)) {
+            connection->stats.rxErrors++;
+            continue;
+        }
+        uint16_t instId = 0;
+        if (instanceLength) {
+            instId = record[5] | (record[6] << 8);
+            if (instId == UAVOBJ_ALL_INSTANCES) {
+                connection->stats.rxErrors++;
+                continue;
+            }
+        }
+
+        UAVObjUnpack(obj, instId, &record[UAVTALK_MULTI_RECORD_HEADER_LENGTH + instanceLength]);
+        // Check if an ack is pending
+        updateAck(connection, obj, instId);
+    }
+
+    // The parser counted the frame as one object
+    if (records > 1) {
+        connection->stats.rxObjects += records - 1;
+    }
+}
+
+/**
+ * Allocate the keyframe slots of one direction of a connection
+ * \return The slots, NULL on failure
+ */
+static UAVTalkDeltaRef *allocDeltaRefs(void)
+{
+    UAVTalkDeltaRef *refs = pvPortMalloc(UAVTALK_MAX_DELTA_OBJECTS * sizeof(UAVTalkDeltaRef));
+
+    if (refs) {
+        memset(refs, 0, UAVTALK_MAX_DELTA_OBJECTS * sizeof(UAVTalkDeltaRef));
+    }
+    return refs;
+}
+
+/**
+ * Find the keyframe slot of an object instance, taking a free one if there is none yet.
+ * Slots are never given back, objects are not deleted either.
+ * \param[in] refs Keyframe slots of one direction of a connection
+ * \param[in] obj Object handle
+ * \param[in] instId The instance ID
+ * \return The slot, NULL if all are taken
+ */
+static UAVTalkDeltaRef *findDeltaRef(UAVTalkDeltaRef *refs, UAVObjHandle obj, uint16_t instId)
+{
+    UAVTalkDeltaRef *freeRef = NULL;
+
+    for (uint8_t i = 0; i < UAVTALK_MAX_DELTA_OBJECTS; i++) {
+        if (refs[i].obj == obj && refs[i].instId == instId) {
+            return &refs[i];
+        } else if (!refs[i].obj && !freeRef) {
+            freeRef = &refs[i];
+        }
+    }
+    if (!freeRef) {
+        return NULL;
+    }
+
+    freeRef->data = pvPortMalloc(2 * UAVObjGetNumBytes(obj));
+    if (!freeRef->data) {
+        return NULL;
+    }
+    freeRef->obj    = obj;
+    freeRef->instId = instId;
+    freeRef->keyframeId    = UAVTALK_DELTA_NO_KEYFRAME;
+    freeRef->sinceKeyframe = UAVTALK_DELTA_NO_KEYFRAME;
+    return freeRef;
+}
+
+/**
+ * Send an object as a delta frame, a keyframe every deltaKeyframeInterval
+ * updates or whenever the delta would not be smaller than the object.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object handle to send
+ * \param[in] instId The instance ID
+ * \return 0 Success
+ * \return -1 Failure, the object has to be sent in full
+ */
+static int32_t sendDeltaObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId)
+{
+    const uint16_t *fieldSizes;
+    uint8_t numFields = UAVObjGetFieldSizes(obj, &fieldSizes);
+    uint16_t length   = UAVObjGetNumBytes(obj);
+    uint16_t payloadLength;
+    int32_t dataOffset;
+    uint32_t objId;
+
+    if (numFields == 0 || instId == UAVOBJ_ALL_INSTANCES || !connection->outStream || 1 + length >= UAVTALK_MAX_PAYLOAD_LENGTH) {
+        return -1;
+    }
+
+    UAVTalkDeltaRef *ref = findDeltaRef(connection->txDeltaRefs, obj, instId);
+    if (!ref) {
+        return -1;
+    }
+    uint8_t *current = &ref->data[length];
+    if (UAVObjPack(obj, instId, current) < 0) {
+        return -1;
+    }
+
+    // Send what was collected for a multi-object frame first, to keep the order of the updates
+    sendMultiObject(connection);
+
+    // Room for a keyframe, a delta is never longer
+    dataOffset = UAVObjIsSingleInstance(obj) ? 8 : 10;
+    uint8_t *buf = txFrameBuffer(connection, dataOffset + 1 + length + UAVTALK_CHECKSUM_LENGTH);
+
+    // Setup type and object id fields
+    objId  = UAVObjGetID(obj);
+    buf[0] = UAVTALK_SYNC_VAL; // sync byte
+    buf[1] = UAVTALK_TYPE_OBJ_DELTA;
+    // data length inserted here below
+    buf[4] = (uint8_t)(objId & 0xFF);
+    buf[5] = (uint8_t)((objId >> 8) & 0xFF);
+    buf[6] = (uint8_t)((objId >> 16) & 0xFF);
+    buf[7] = (uint8_t)((objId >> 24) & 0xFF);
+
+    // Setup instance ID if one is required
+    if (!UAVObjIsSingleInstance(obj)) {
+        buf[8] = (uint8_t)(instId & 0xFF);
+        buf[9] = (uint8_t)((instId >> 8) & 0xFF);
+    }
+
+    uint8_t *payload = &buf[dataOffset];
+    bool keyframe    = ref->sinceKeyframe >= connection->deltaKeyframeInterval;
+    if (!keyframe) {
+        uint8_t bitmapLength = (numFields + 7) / 8;
+        uint16_t offset = 0;
+
+        memset(&payload[1], 0, bitmapLength);
+        payloadLength = 1 + bitmapLength;
+        for (uint8_t n = 0; n < numFields; offset += fieldSizes[n++]) {
+            if (memcmp(&current[offset], &ref->data[offset], fieldSizes[n]) == 0) {
+                continue;
+            }
+            // A delta that is not smaller than a keyframe is sent as one
+            if (payloadLength + fieldSizes[n] > length) {
+                keyframe = true;
+                break;
+            }
+            payload[1 + n / 8] |= 1 << (n % 8);
+            memcpy(&payload[payloadLength], &current[offset], fieldSizes[n]);
+            payloadLength += fieldSizes[n];
+        }
+    }
+    if (keyframe) {
+        ref->keyframeId    = (ref->keyframeId + 1) & UAVTALK_DELTA_ID_MASK;
+        ref->sinceKeyframe = 0;
+        memcpy(ref->data, current, length);
+        payload[0]    = UAVTALK_DELTA_KEYFRAME | ref->keyframeId;
+        memcpy(&payload[1], current, length);
+        payloadLength = 1 + length;
+    } else {
+        payload[0] = ref->keyframeId;
+        ref->sinceKeyframe++;
+    }
+
     // Store the packet length
-    connection->txBuffer[2] = (uint8_t)((dataOffset + length) & 0xFF);
-    connection->txBuffer[3] = (uint8_t)(((dataOffset + length) >> 8) & 0xFF);
+    buf[2] = (uint8_t)((dataOffset + payloadLength) & 0xFF);
+    buf[3] = (uint8_t)(((dataOffset + payloadLength) >> 8) & 0xFF);
 
     // Calculate checksum
-    connection->txBuffer[dataOffset + length] = PIOS_CRC_updateCRC(0, connection->txBuffer, dataOffset + length);
+    buf[dataOffset + payloadLength] = PIOS_CRC_updateCRC(0, buf, dataOffset + payloadLength);
 
-    uint16_t tx_msg_len = dataOffset + length + UAVTALK_CHECKSUM_LENGTH;
-    int32_t rc = (*connection->outStream)(connection->txBuffer, tx_msg_len);
+    uint16_t tx_msg_len = dataOffset + payloadLength + UAVTALK_CHECKSUM_LENGTH;
+    int32_t rc = txFrameSend(connection, buf, tx_msg_len);
 
     if (rc == tx_msg_len) {
         // Update stats
         ++connection->stats.txObjects;
         connection->stats.txBytes += tx_msg_len;
-        connection->stats.txObjectBytes += length;
+        connection->stats.txObjectBytes += payloadLength;
     }
 
-    // Done
     return 0;
 }
 
+/**
+ * Receive a delta frame, keyframes are kept to decode the deltas that follow
+ * them. Deltas for a keyframe that was missed are dropped.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object handle
+ * \param[in] instId The instance ID
+ * \param[in] data Frame payload
+ * \param[in] length Payload length
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t receiveDeltaObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t *data, int32_t length)
+{
+    const uint16_t *fieldSizes;
+    uint8_t numFields = UAVObjGetFieldSizes(obj, &fieldSizes);
+    uint16_t numBytes = UAVObjGetNumBytes(obj);
+
+    if (numFields == 0 || length < 1) {
+        return -1;
+    }
+    if (!connection->rxDeltaRefs) {
+        connection->rxDeltaRefs = allocDeltaRefs();
+        if (!connection->rxDeltaRefs) {
+            return -1;
+        }
+    }
+    UAVTalkDeltaRef *ref = findDeltaRef(connection->rxDeltaRefs, obj, instId);
+    if (!ref) {
+        return -1;
+    }
+
+    if (data[0] & UAVTALK_DELTA_KEYFRAME) {
+        if (length != 1 + numBytes) {
+            return -1;
+        }
+        memcpy(ref->data, &data[1], numBytes);
+        ref->keyframeId = data[0] & UAVTALK_DELTA_ID_MASK;
+        return UAVObjUnpack(obj, instId, &data[1]);
+    }
+
+    uint8_t bitmapLength = (numFields + 7) / 8;
+    if (data[0] != ref->keyframeId || length < 1 + bitmapLength) {
+        return -1;
+    }
+
+    // Patch the changed fields into a copy of the keyframe
+    uint8_t *decoded = &ref->data[numBytes];
+    int32_t pos = 1 + bitmapLength;
+    uint16_t offset = 0;
+    memcpy(decoded, ref->data, numBytes);
+    for (uint8_t n = 0; n < numFields; offset += fieldSizes[n++]) {
+        if (data[1 + n / 8] & (1 << (n % 8))) {
+            if (pos + fieldSizes[n] > length || offset + fieldSizes[n] > numBytes) {
+                return -1;
+            }
+            memcpy(&decoded[offset], &data[pos], fieldSizes[n]);
+            pos += fieldSizes[n];
+        }
+    }
+    if (pos != length) {
+        return -1;
+    }
+    return UAVObjUnpack(obj, instId, decoded);
+}
+
+/**
+ * Check a frame header the way the receive state machine does
+ * \param[in] type Message type
+ * \param[in] packetSize Frame length without the checksum
+ * \return true if this can be the header of a frame
+ */
+static bool isFrameHeader(uint8_t type, uint16_t packetSize)
+{
+    return (type & UAVTALK_TYPE_MASK) == UAVTALK_TYPE_VER &&
+           packetSize >= UAVTALK_MIN_HEADER_LENGTH &&
+           packetSize <= UAVTALK_MAX_HEADER_LENGTH + UAVTALK_MAX_PAYLOAD_LENGTH;
+}
+
+/**
+ * Count a frame that was not relayed, the statistics are read by another task
+ * \param[in] connection UAVTalkConnection the frame was received on
+ */
+static void relayDropped(UAVTalkConnectionData *connection)
+{
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+    connection->relayStats.dropped++;
+    xSemaphoreGiveRecursive(connection->lock);
+}
+
+/**
+ * Set up the reception of the rest of a packet once its header up to the object id is in.
+ * \param[in] connection UAVTalkConnection to be used
+ */
+static void receiveHeader(UAVTalkConnectionData *connection)
+{
+    UAVTalkInputProcessor *iproc = &connection->iproc;
+
+    // Search for object.
+    iproc->obj = UAVObjGetByID(iproc->objId);
+
+    // Determine data length
+    if (iproc->type == UAVTALK_TYPE_OBJ_REQ || iproc->type == UAVTALK_TYPE_ACK || iproc->type == UAVTALK_TYPE_NACK) {
+        iproc->length = 0;
+        iproc->instanceLength  = 0;
+        iproc->timestampLength = 0;
+    } else {
+        if (iproc->obj) {
+            iproc->instanceLength = (UAVObjIsSingleInstance(iproc->obj) ? 0 : 2);
+            if (iproc->type == UAVTALK_TYPE_OBJ_DELTA) {
+                // Delta frames only carry the fields that changed
+                iproc->length = iproc->packet_size - iproc->rxPacketLength - iproc->instanceLength;
+            } else {
+                iproc->length = UAVObjGetNumBytes(iproc->obj);
+            }
+        } else {
+            // We don't know if it's a multi-instance object, so just assume it's 0.
+            iproc->instanceLength = 0;
+            iproc->length = iproc->packet_size - iproc->rxPacketLength;
+        }
+        iproc->timestampLength = (iproc->type & UAVTALK_TIMESTAMPED) ? 2 : 0;
+    }
+
+    // Check length and determine next state
+    if (iproc->length >= UAVTALK_MAX_PAYLOAD_LENGTH) {
+        connection->stats.rxErrors++;
+        iproc->state = UAVTALK_STATE_ERROR;
+        return;
+    }
+
+    // Check the lengths match
+    if ((iproc->rxPacketLength + iproc->instanceLength + iproc->timestampLength + iproc->length) != iproc->packet_size) { // packet error - mismatched packet size
+        connection->stats.rxErrors++;
+        iproc->state = UAVTALK_STATE_ERROR;
+        return;
+    }
+
+    iproc->instId = 0;
+    if (iproc->type == UAVTALK_TYPE_NACK) {
+        // If this is a NACK, we skip to Checksum
+        iproc->state = UAVTALK_STATE_CS;
+    }
+    // Check if this is a single instance object (i.e. if the instance ID field is coming next)
+    else if ((iproc->obj != 0) && !UAVObjIsSingleInstance(iproc->obj)) {
+        iproc->state = UAVTALK_STATE_INSTID;
+    }
+    // Check if this is a single instance and has a timestamp in it
+    else if ((iproc->obj != 0) && (iproc->type & UAVTALK_TIMESTAMPED)) {
+        iproc->timestamp = 0;
+        iproc->state     = UAVTALK_STATE_TIMESTAMP;
+    } else {
+        // If there is a payload get it, otherwise receive checksum
+        if (iproc->length > 0) {
+            iproc->state = UAVTALK_STATE_DATA;
+        } else {
+            iproc->state = UAVTALK_STATE_CS;
+        }
+    }
+}
+
 /**
  * Send a NACK through the telemetry link.
  * \param[in] connection UAVTalkConnection to be used
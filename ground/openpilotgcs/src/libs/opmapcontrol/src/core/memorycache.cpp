@@ -44,6 +44,11 @@ QByteArray MemoryCache::GetTileFromMemoryCache(const RawTile &tile)
 void MemoryCache::AddTileToMemoryCache(const RawTile &tile, const QByteArray &pic)
 {
     kiberCacheLock.lockForWrite();
+    // the prefetcher and the visible tile loader may both bring the same tile in
+    if (TilesInMemory.cachequeue.contains(tile)) {
+        kiberCacheLock.unlock();
+        return;
+    }
     // QPixmapCache::Key key=TilesInMemory.insert(pic);
     TilesInMemory.memoryCacheSize += pic.size();
 #ifdef DEBUG_MEMORY_CACHE
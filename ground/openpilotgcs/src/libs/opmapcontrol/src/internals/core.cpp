@@ -25,6 +25,7 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "core.h"
+#include <QSet>
 
 #ifdef DEBUG_CORE
 qlonglong internals::Core::debugcounter = 0;
@@ -44,11 +45,14 @@ Core::Core() : MouseWheelZooming(false), currentPosition(0, 0), currentPositionP
     dragPoint    = Point(0, 0);
     CanDragMap   = true;
     tilesToload  = 0;
+    prefetcher   = new TilePrefetcher(this);
     OPMaps::Instance();
 }
 Core::~Core()
 {
+    prefetcher->Cancel();
     ProcessLoadTaskCallback.waitForDone();
+    delete prefetcher;
 }
 
 void Core::run()
@@ -188,6 +192,8 @@ void Core::run()
 
 
                         emit OnNeedInvalidation();
+
+                        StartPrefetch();
                     }
                 }
             }
@@ -539,6 +545,7 @@ void Core::Drag(Point const & pt)
 void Core::CancelAsyncTasks()
 {
     if (started) {
+        prefetcher->Clear();
         ProcessLoadTaskCallback.waitForDone();
         MtileLoadQueue.lock();
         {
@@ -615,6 +622,82 @@ void Core::FindTilesAround(QList<Point> &list)
         }
     }
 }
+void Core::PrefetchAlong(QList<PointLatLng> const & track, QList<PointLatLng> const & path)
+{
+    const int maxTiles = 4096;
+
+    if (!started) {
+        return;
+    }
+    QList<LoadTask> tiles;
+    QSet<quint64> queued;
+
+    // the visible tiles are loaded by UpdateBounds
+    MtileDrawingList.lock();
+    foreach(Point p, tileDrawingList) {
+        queued.insert(TilePrefetcher::Key(LoadTask(p, Zoom())));
+    }
+    MtileDrawingList.unlock();
+
+    // the track is what the map will show next when following the UAV so it goes first
+    // with a viewport sized corridor, the path only needs the tiles it crosses
+    int levels[3] = { Zoom(), Zoom() - 1, Zoom() + 1 };
+    for (int pass = 0; pass < 2 && tiles.count() < maxTiles; ++pass) {
+        QList<PointLatLng> const & points = (pass == 0) ? track : path;
+        for (int l = 0; l < 3 && tiles.count() < maxTiles; ++l) {
+            int level = levels[l];
+            if (level < 0 || level > MaxZoom()) {
+                continue;
+            }
+            Size radius = (pass == 0) ? sizeOfMapArea : Size(1, 1);
+            if (level < Zoom()) {
+                radius = Size((radius.Width() + 1) / 2, (radius.Height() + 1) / 2);
+            }
+            Size min = Projection()->GetTileMatrixMinXY(level);
+            Size max = Projection()->GetTileMatrixMaxXY(level);
+            foreach(PointLatLng point, points) {
+                Point center = Projection()->FromPixelToTileXY(Projection()->FromLatLngToPixel(point, level));
+                for (int i = -radius.Width(); i <= radius.Width(); ++i) {
+                    for (int j = -radius.Height(); j <= radius.Height(); ++j) {
+                        Point p(center.X() + i, center.Y() + j);
+                        if (p.X() < min.Width() || p.Y() < min.Height() || p.X() > max.Width() || p.Y() > max.Height()) {
+                            continue;
+                        }
+                        LoadTask task(p, level);
+                        quint64 key = TilePrefetcher::Key(task);
+                        if (!queued.contains(key)) {
+                            queued.insert(key);
+                            tiles.append(task);
+                        }
+                    }
+                }
+                if (tiles.count() >= maxTiles) {
+                    break;
+                }
+            }
+        }
+    }
+    prefetcher->SetTiles(tiles);
+    StartPrefetch();
+}
+void Core::SetPrefetchBudget(int const & memoryMB, int const & diskMB)
+{
+    prefetcher->SetBudget(memoryMB, diskMB);
+}
+bool Core::IsLoadingTiles()
+{
+    MtileToload.lock();
+    bool loading = tilesToload > 0;
+    MtileToload.unlock();
+    return loading;
+}
+void Core::StartPrefetch()
+{
+    if (started && !IsLoadingTiles() && prefetcher->Schedule()) {
+        // lowest priority, visible tiles queued later still run first
+        ProcessLoadTaskCallback.start(prefetcher, -1);
+    }
+}
 void Core::UpdateGroundResolution()
 {
     double rez = Projection()->GetGroundResolution(Zoom(), CurrentPosition().Lat());
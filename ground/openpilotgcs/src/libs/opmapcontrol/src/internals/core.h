@@ -40,6 +40,7 @@
 #include "tilematrix.h"
 #include <QQueue>
 #include "loadtask.h"
+#include "tileprefetcher.h"
 #include "copyrightstrings.h"
 #include "rectlatlng.h"
 #include "../internals/projections/lks94projection.h"
@@ -294,6 +295,30 @@ public:
 
     void FindTilesAround(QList<core::Point> &list);
 
+    /**
+     * @brief Queues tiles around a predicted track and a planned path for loading
+     *        behind the visible tiles, at the current zoom and one level either side
+     *
+     * @param track predicted positions, nearest first
+     * @param path planned positions, in flight order
+     */
+    void PrefetchAlong(QList<PointLatLng> const & track, QList<PointLatLng> const & path);
+
+    /**
+     * @brief Sets how much the prefetcher may keep in memory and download
+     *
+     * @param memoryMB Mb of the tile memory cache, at most half of it is ever used
+     * @param diskMB Mb downloaded (and stored on disk) per session
+     */
+    void SetPrefetchBudget(int const & memoryMB, int const & diskMB);
+
+    int PrefetchTilesToLoad()
+    {
+        return prefetcher->TilesToLoad();
+    }
+
+    bool IsLoadingTiles();
+
     void UpdateGroundResolution();
 
     TileMatrix Matrix;
@@ -319,6 +344,7 @@ signals:
 private:
 
     void keepInBounds();
+    void StartPrefetch();
     PointLatLng currentPosition;
     core::Point currentPositionPixel;
     core::Point renderOffset;
@@ -370,6 +396,8 @@ private:
     QMutex MtileToload;
     int tilesToload;
 
+    TilePrefetcher *prefetcher;
+
     int maxzoom;
     QMutex MrunningThreads;
     int runningThreads;
@@ -83,6 +83,41 @@ internals::PointLatLng LKS94Projection::FromPixelToLatLng(int const & x, int con
     return ret;
 }
 
+void LKS94Projection::FromLatLngToPixelBatch(const double *lat, const double *lng, int *x, int *y, int count, int const & zoom)
+{
+    const double res = GetTileMatrixResolution(zoom);
+    QVector <double> lks(3);
+
+    for (int i = 0; i < count; ++i) {
+        lks.resize(3);
+        lks[0] = Clip(lng[i], MinLongitude, MaxLongitude);
+        lks[1] = Clip(lat[i], MinLatitude, MaxLatitude);
+        lks[2] = 0;
+        lks    = DTM10(lks);
+        lks    = MTD10(lks);
+        lks    = DTM00(lks);
+        x[i]   = (int)floor((lks[0] + orignX) / res);
+        y[i]   = (int)floor((orignY - lks[1]) / res);
+    }
+}
+
+void LKS94Projection::FromPixelToLatLngBatch(const int *x, const int *y, double *lat, double *lng, int count, int const & zoom)
+{
+    const double res = GetTileMatrixResolution(zoom);
+    QVector <double> lks(2);
+
+    for (int i = 0; i < count; ++i) {
+        lks.resize(2);
+        lks[0] = (x[i] * res) - orignX;
+        lks[1] = -(y[i] * res) + orignY;
+        lks    = MTD11(lks);
+        lks    = DTM10(lks);
+        lks    = MTD10(lks);
+        lat[i] = Clip(lks[1], MinLatitude, MaxLatitude);
+        lng[i] = Clip(lks[0], MinLongitude, MaxLongitude);
+    }
+}
+
 QVector <double> LKS94Projection::DTM10(const QVector <double> & lonlat)
 {
     double es; // Eccentricity squared : (a^2 - b^2)/a^2
@@ -45,6 +45,8 @@ public:
     virtual double Flattening() const;
     virtual core::Point FromLatLngToPixel(double lat, double lng, int const & zoom);
     virtual internals::PointLatLng FromPixelToLatLng(int const & x, int const &  y, int const &  zoom);
+    virtual void FromLatLngToPixelBatch(const double *lat, const double *lng, int *x, int *y, int count, int const & zoom);
+    virtual void FromPixelToLatLngBatch(const int *x, const int *y, double *lat, double *lng, int count, int const & zoom);
     virtual double GetGroundResolution(int const & zoom, double const & latitude);
     virtual Size GetTileMatrixMinXY(int const & zoom);
     virtual Size GetTileMatrixMaxXY(int const & zoom);
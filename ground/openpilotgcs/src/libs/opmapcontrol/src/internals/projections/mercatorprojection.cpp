@@ -67,6 +67,36 @@ internals::PointLatLng MercatorProjection::FromPixelToLatLng(const int &x, const
 
     return ret;
 }
+void MercatorProjection::FromLatLngToPixelBatch(const double *lat, const double *lng, int *x, int *y, int count, const int &zoom)
+{
+    Size s = GetTileMatrixSizePixel(zoom);
+    const double mapSizeX = s.Width();
+    const double mapSizeY = s.Height();
+
+    // Same arithmetic as FromLatLngToPixel() so both give identical pixels
+    for (int i = 0; i < count; ++i) {
+        double la = Clip(lat[i], MinLatitude, MaxLatitude);
+        double lo = Clip(lng[i], MinLongitude, MaxLongitude);
+        double xx = (lo + 180) / 360;
+        double sinLatitude = sin(la * M_PI / 180);
+        double yy = 0.5 - log((1 + sinLatitude) / (1 - sinLatitude)) / (4 * M_PI);
+        x[i] = (int)Clip(xx * mapSizeX + 0.5, 0, mapSizeX - 1);
+        y[i] = (int)Clip(yy * mapSizeY + 0.5, 0, mapSizeY - 1);
+    }
+}
+void MercatorProjection::FromPixelToLatLngBatch(const int *x, const int *y, double *lat, double *lng, int count, const int &zoom)
+{
+    Size s = GetTileMatrixSizePixel(zoom);
+    const double mapSizeX = s.Width();
+    const double mapSizeY = s.Height();
+
+    for (int i = 0; i < count; ++i) {
+        double xx = (Clip(x[i], 0, mapSizeX - 1) / mapSizeX) - 0.5;
+        double yy = 0.5 - (Clip(y[i], 0, mapSizeY - 1) / mapSizeY);
+        lat[i] = 90 - 360 * atan(exp(-yy * 2 * M_PI)) / M_PI;
+        lng[i] = 360 * xx;
+    }
+}
 double MercatorProjection::Clip(const double &n, const double &minValue, const double &maxValue) const
 {
     return qMin(qMax(n, minValue), maxValue);
@@ -65,6 +65,28 @@ internals::PointLatLng PlateCarreeProjectionPergo::FromPixelToLatLng(const int &
     return ret;
 }
 
+void PlateCarreeProjectionPergo::FromLatLngToPixelBatch(const double *lat, const double *lng, int *x, int *y, int count, const int &zoom)
+{
+    Size s = GetTileMatrixSizePixel(zoom);
+    const double scale = 360.0 / s.Width();
+
+    for (int i = 0; i < count; ++i) {
+        double la = Clip(lat[i], MinLatitude, MaxLatitude);
+        double lo = Clip(lng[i], MinLongitude, MaxLongitude);
+        y[i] = (int)((90.0 - la) / scale);
+        x[i] = (int)((lo + 180.0) / scale);
+    }
+}
+void PlateCarreeProjectionPergo::FromPixelToLatLngBatch(const int *x, const int *y, double *lat, double *lng, int count, const int &zoom)
+{
+    Size s = GetTileMatrixSizePixel(zoom);
+    const double scale = 360.0 / s.Width();
+
+    for (int i = 0; i < count; ++i) {
+        lat[i] = 90 - (y[i] * scale);
+        lng[i] = (x[i] * scale) - 180;
+    }
+}
 double PlateCarreeProjectionPergo::Clip(const double &n, const double &minValue, const double &maxValue) const
 {
     return qMin(qMax(n, minValue), maxValue);
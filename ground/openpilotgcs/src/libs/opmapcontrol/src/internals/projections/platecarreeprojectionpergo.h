@@ -43,6 +43,8 @@ public:
     virtual double Flattening() const;
     virtual core::Point FromLatLngToPixel(double lat, double lng, int const & zoom);
     virtual internals::PointLatLng FromPixelToLatLng(const int &x, const int &y, const int &zoom);
+    virtual void FromLatLngToPixelBatch(const double *lat, const double *lng, int *x, int *y, int count, int const & zoom);
+    virtual void FromPixelToLatLngBatch(const int *x, const int *y, double *lat, double *lng, int count, int const & zoom);
     virtual Size GetTileMatrixMinXY(const int &zoom);
     virtual Size GetTileMatrixMaxXY(const int &zoom);
 private:
@@ -49,6 +49,24 @@ PointLatLng PureProjection::FromPixelToLatLng(const Point &p, const int &zoom)
     return FromPixelToLatLng(p.X(), p.Y(), zoom);
 }
 
+void PureProjection::FromLatLngToPixelBatch(const double *lat, const double *lng, int *x, int *y, int count, const int &zoom)
+{
+    for (int i = 0; i < count; ++i) {
+        Point p = FromLatLngToPixel(lat[i], lng[i], zoom);
+        x[i] = p.X();
+        y[i] = p.Y();
+    }
+}
+
+void PureProjection::FromPixelToLatLngBatch(const int *x, const int *y, double *lat, double *lng, int count, const int &zoom)
+{
+    for (int i = 0; i < count; ++i) {
+        PointLatLng p = FromPixelToLatLng(x[i], y[i], zoom);
+        lat[i] = p.Lat();
+        lng[i] = p.Lng();
+    }
+}
+
 Point PureProjection::FromPixelToTileXY(const Point &p)
 {
     return Point((int)(p.X() / TileSize().Width()), (int)(p.Y() / TileSize().Height()));
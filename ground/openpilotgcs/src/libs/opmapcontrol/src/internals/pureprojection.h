@@ -56,6 +56,18 @@ public:
     core::Point FromLatLngToPixel(const PointLatLng &p, const int &zoom);
 
     PointLatLng FromPixelToLatLng(const Point &p, const int &zoom);
+
+    /**
+     * @brief Projects count points at once. Coordinates are passed as separate
+     *        arrays so projections can hoist the per zoom constants out of the
+     *        loop and keep it branch free. Results match FromLatLngToPixel().
+     *        The default implementation calls FromLatLngToPixel() per point.
+     */
+    virtual void FromLatLngToPixelBatch(const double *lat, const double *lng, int *x, int *y, int count, int const & zoom);
+    /**
+     * @brief Batch counterpart of FromPixelToLatLng(), see FromLatLngToPixelBatch()
+     */
+    virtual void FromPixelToLatLngBatch(const int *x, const int *y, double *lat, double *lng, int count, int const & zoom);
     virtual core::Point FromPixelToTileXY(const core::Point &p);
     virtual core::Point FromTileXYToPixel(const core::Point &p);
     virtual Size GetTileMatrixMinXY(const int &zoom) = 0;
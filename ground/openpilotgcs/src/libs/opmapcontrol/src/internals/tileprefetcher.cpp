@@ -0,0 +1,199 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tileprefetcher.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      Loads tiles the map is about to need into the tile caches
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "tileprefetcher.h"
+#include "core.h"
+#include <QSet>
+
+namespace internals {
+TilePrefetcher::TilePrefetcher(Core *core) : core(core), memoryUsed(0), memoryBudget(0), diskUsed(0), diskBudget(0), running(false), canceled(false)
+{
+    this->setAutoDelete(false);
+}
+
+quint64 TilePrefetcher::Key(LoadTask const & task)
+{
+    return ((quint64)task.Zoom << 56) | ((quint64)(task.Pos.X() & 0x0FFFFFFF) << 28) | (quint64)(task.Pos.Y() & 0x0FFFFFFF);
+}
+
+void TilePrefetcher::SetTiles(QList<LoadTask> const & tiles)
+{
+    QMutexLocker locker(&mutex);
+    QSet<quint64> wanted;
+
+    queue.clear();
+    foreach(LoadTask task, tiles) {
+        wanted.insert(Key(task));
+        queue.enqueue(task);
+    }
+    QMutableHashIterator<quint64, int> i(prefetched);
+    while (i.hasNext()) {
+        i.next();
+        if (!wanted.contains(i.key())) {
+            memoryUsed -= i.value();
+            i.remove();
+        }
+    }
+}
+
+void TilePrefetcher::SetBudget(int const & memoryMB, int const & diskMB)
+{
+    QMutexLocker locker(&mutex);
+
+    memoryBudget = (qint64)memoryMB * 1048576;
+    diskBudget   = (qint64)diskMB * 1048576;
+}
+
+void TilePrefetcher::Clear()
+{
+    QMutexLocker locker(&mutex);
+
+    queue.clear();
+    prefetched.clear();
+    memoryUsed = 0;
+}
+
+void TilePrefetcher::Cancel()
+{
+    QMutexLocker locker(&mutex);
+
+    canceled = true;
+    queue.clear();
+}
+
+bool TilePrefetcher::Schedule()
+{
+    QMutexLocker locker(&mutex);
+
+    if (running || canceled || queue.isEmpty()) {
+        return false;
+    }
+    running = true;
+    return true;
+}
+
+int TilePrefetcher::TilesToLoad()
+{
+    QMutexLocker locker(&mutex);
+
+    return queue.count();
+}
+
+qint64 TilePrefetcher::BytesDownloaded()
+{
+    QMutexLocker locker(&mutex);
+
+    return diskUsed;
+}
+
+bool TilePrefetcher::diskBudgetLeft()
+{
+    QMutexLocker locker(&mutex);
+
+    return diskUsed < diskBudget;
+}
+
+void TilePrefetcher::run()
+{
+    OPMaps *maps = OPMaps::Instance();
+
+    forever {
+        // visible tiles always go first, Core restarts us once they are done
+        bool busy = core->IsLoadingTiles();
+        qint64 memoryLimit = (qint64)maps->TilesInMemory.MemoryCacheCapacity() * 1048576 / 2;
+        LoadTask task;
+
+        mutex.lock();
+        if (busy || canceled || queue.isEmpty() || memoryUsed >= qMin(memoryBudget, memoryLimit)) {
+            mutex.unlock();
+            break;
+        }
+        task = queue.dequeue();
+        mutex.unlock();
+
+        int downloaded = 0;
+        int stored     = fetch(task, downloaded);
+
+        mutex.lock();
+        if (stored > 0) {
+            quint64 key = Key(task);
+            memoryUsed += stored - prefetched.value(key, 0);
+            prefetched.insert(key, stored);
+        }
+        diskUsed += downloaded;
+        mutex.unlock();
+    }
+
+    maps->kiberCacheLock.lockForWrite();
+    maps->TilesInMemory.RemoveMemoryOverload();
+    maps->kiberCacheLock.unlock();
+
+    mutex.lock();
+    running = false;
+    mutex.unlock();
+}
+
+int TilePrefetcher::fetch(LoadTask const & task, int & downloaded)
+{
+    OPMaps *maps = OPMaps::Instance();
+    int stored   = 0;
+
+    foreach(MapType::Types type, maps->GetAllLayersOfType(core->GetMapType())) {
+        core::Point pos = task.Pos;
+
+        // tile number inversion(BottomLeft -> TopLeft) for pergo maps
+        if (type == MapType::PergoTurkeyMap) {
+            pos = core::Point(task.Pos.X(), core->Projection()->GetTileMatrixMaxXY(task.Zoom).Height() - task.Pos.Y());
+        }
+        RawTile tile(type, pos, task.Zoom);
+        if (!maps->GetTileFromMemoryCache(tile).isEmpty()) {
+            continue;
+        }
+        QByteArray img;
+        if (maps->GetAccessMode() != AccessMode::ServerOnly) {
+            img = Cache::Instance()->ImageCache.GetImageFromCache(type, pos, task.Zoom);
+        }
+        if (!img.isEmpty()) {
+            if (!maps->UseMemoryCache()) {
+                continue;
+            }
+            maps->AddTileToMemoryCache(tile, img);
+        } else {
+            if (maps->GetAccessMode() == AccessMode::CacheOnly || !diskBudgetLeft()) {
+                continue;
+            }
+            // stores the tile in the memory and disk caches
+            img = maps->GetImageFrom(type, pos, task.Zoom);
+            downloaded += img.size();
+            if (!maps->UseMemoryCache()) {
+                continue;
+            }
+        }
+        stored += img.size();
+    }
+    return stored;
+}
+}
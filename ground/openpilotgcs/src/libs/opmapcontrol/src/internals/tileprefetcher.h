@@ -0,0 +1,110 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tileprefetcher.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      Loads tiles the map is about to need into the tile caches
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TILEPREFETCHER_H
+#define TILEPREFETCHER_H
+
+#include <QRunnable>
+#include <QMutex>
+#include <QQueue>
+#include <QHash>
+#include "loadtask.h"
+
+namespace internals {
+class Core;
+/**
+ * @brief Warms the memory and disk tile caches with tiles that are not visible yet
+ *
+ * The prefetcher runs on the core thread pool at the lowest priority and gives way
+ * as soon as visible tiles are waiting to be loaded. Tiles found in the disk cache
+ * are moved to the memory cache, tiles missing from both are downloaded (which also
+ * stores them on disk). Both paths are bounded by a budget so a long flight plan
+ * cannot flush the tiles the user is looking at or fill the disk.
+ *
+ * @class TilePrefetcher tileprefetcher.h "internals/tileprefetcher.h"
+ */
+class TilePrefetcher : public QRunnable {
+public:
+    TilePrefetcher(Core *core);
+    void run();
+
+    /**
+     * @brief Replaces the pending tiles, most wanted first
+     *
+     * Tiles prefetched earlier that are not in the new list stop counting
+     * against the memory budget, the memory cache ages them out.
+     *
+     * @param tiles tiles to load
+     */
+    void SetTiles(QList<LoadTask> const & tiles);
+    /**
+     * @brief Sets the prefetch budgets
+     *
+     * @param memoryMB Mb of the memory cache the prefetched tiles may hold
+     * @param diskMB Mb the prefetcher may download (and store on disk) per session
+     */
+    void SetBudget(int const & memoryMB, int const & diskMB);
+    /**
+     * @brief Drops the pending tiles and the memory accounting, used when the map type changes
+     */
+    void Clear();
+    /**
+     * @brief Stops the prefetcher for good, used on shutdown
+     */
+    void Cancel();
+    /**
+     * @brief Marks the prefetcher as running if it has work to do
+     *
+     * @return true if the caller must start it on the thread pool
+     */
+    bool Schedule();
+    /**
+     * @brief Returns the number of tiles waiting to be prefetched
+     */
+    int TilesToLoad();
+    /**
+     * @brief Returns the number of bytes downloaded by the prefetcher
+     */
+    qint64 BytesDownloaded();
+
+    static quint64 Key(LoadTask const & task);
+private:
+    int fetch(LoadTask const & task, int & downloaded);
+    bool diskBudgetLeft();
+
+    Core *core;
+    QMutex mutex;
+    QQueue<LoadTask> queue;
+    QHash<quint64, int> prefetched;
+    qint64 memoryUsed;
+    qint64 memoryBudget;
+    qint64 diskUsed;
+    qint64 diskBudget;
+    bool running;
+    bool canceled;
+};
+}
+#endif // TILEPREFETCHER_H
@@ -35,6 +35,10 @@ Configuration::Configuration()
     ScalePen = QPen(Qt::blue);
     SelectionPen     = QPen(Qt::blue);
     DragButton = Qt::LeftButton;
+    PrefetchTiles = true;
+    PrefetchMemoryBudget = 8;
+    PrefetchDiskBudget   = 50;
+    PrefetchHorizon = 60;
 }
 void Configuration::SetAccessMode(core::AccessMode::Types const & type)
 {
@@ -88,6 +88,31 @@ public:
      */
     Qt::MouseButton DragButton;
 
+    /**
+     * @brief Loads tiles ahead of the UAV and along the WayPoints in the background
+     *
+     * @var PrefetchTiles
+     */
+    bool PrefetchTiles;
+    /**
+     * @brief Mb of the tile memory cache the prefetched tiles may hold, never more than half of it
+     *
+     * @var PrefetchMemoryBudget
+     */
+    int PrefetchMemoryBudget;
+    /**
+     * @brief Mb of tiles the prefetcher may download (and store on disk) per session
+     *
+     * @var PrefetchDiskBudget
+     */
+    int PrefetchDiskBudget;
+    /**
+     * @brief Seconds of UAV flight at its current velocity to prefetch tiles for
+     *
+     * @var PrefetchHorizon
+     */
+    int PrefetchHorizon;
+
     /**
      * @brief Sets the access mode for the map (cache only, server and cache...)
      *
@@ -84,16 +84,21 @@ int HomeItem::type() const
 
 void HomeItem::RefreshPos()
 {
-    prepareGeometryChange();
     localposition = map->FromLatLngToLocal(coord);
     this->setPos(localposition.X(), localposition.Y());
+    int newsafearea = localsafearea;
     if (showsafearea) {
-        localsafearea = safearea / map->Projection()->GetGroundResolution(map->ZoomTotal(), coord.Lat());
+        newsafearea = safearea / map->Projection()->GetGroundResolution(map->ZoomTotal(), coord.Lat());
+    }
+    // setPos() already repaints the old and new area, the geometry only changes with the safe area or toggleRefresh
+    if (newsafearea != localsafearea || toggleRefresh) {
+        prepareGeometryChange();
+        localsafearea = newsafearea;
+        this->update();
     }
 
     RefreshToolTip();
 
-    this->update();
     toggleRefresh = false;
 }
 
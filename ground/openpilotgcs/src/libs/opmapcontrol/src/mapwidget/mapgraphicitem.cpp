@@ -30,7 +30,7 @@
 #include "mapgraphicitem.h"
 
 namespace mapcontrol {
-MapGraphicItem::MapGraphicItem(internals::Core *core, Configuration *configuration) : core(core), config(configuration), MapRenderTransform(1), maxZoom(17), minZoom(2), zoomReal(0), isSelected(false), rotation(0), zoomDigi(0)
+MapGraphicItem::MapGraphicItem(internals::Core *core, Configuration *configuration) : core(core), config(configuration), MapRenderTransform(1), maxZoom(17), minZoom(2), zoomReal(0), isSelected(false), rotation(0), zoomDigi(0), tileLayerValid(false)
 {
     dragons.load(QString::fromUtf8(":/markers/images/dragons1.jpg"));
     showTileGridLines = false;
@@ -43,7 +43,9 @@ MapGraphicItem::MapGraphicItem(internals::Core *core, Configuration *configurati
     connect(core, SIGNAL(OnNeedInvalidation()), this, SLOT(Core_OnNeedInvalidation()));
     connect(core, SIGNAL(OnMapDrag()), this, SLOT(childPosRefresh()));
     connect(core, SIGNAL(OnMapZoomChanged()), this, SLOT(childPosRefresh()));
-    setCacheMode(QGraphicsItem::ItemCoordinateCache);
+    // The tile layer below replaces the item cache, which any update() would throw away
+    setCacheMode(QGraphicsItem::NoCache);
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
 }
 
 void MapGraphicItem::start()
@@ -77,8 +79,14 @@ QRectF MapGraphicItem::boundingRect() const
 }
 void MapGraphicItem::Core_OnNeedInvalidation()
 {
+    // Pan and zoom also raise OnMapDrag/OnMapZoomChanged which reposition the children,
+    // tile arrival only needs the tile layer redrawn
+    InvalidateTileLayer();
+}
+void MapGraphicItem::InvalidateTileLayer()
+{
+    tileLayerValid = false;
     this->update();
-    emit childRefreshPosition();
 }
 void MapGraphicItem::childPosRefresh()
 {
@@ -123,25 +131,35 @@ void MapGraphicItem::paintImage(QPainter *painter)
 }
 void MapGraphicItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
-    Q_UNUSED(option);
     Q_UNUSED(widget);
 
-    if (MapRenderTransform != 1) {
-        QTransform transform;
-        transform.translate(-((boundingRect().width() * MapRenderTransform) - (boundingRect().width())) / 2, -((boundingRect().height() * MapRenderTransform) - (boundingRect().height())) / 2);
-        transform.scale(MapRenderTransform, MapRenderTransform);
+    QRectF rect = boundingRect();
+    QSize size  = rect.size().toSize();
 
-        painter->setWorldTransform(transform);
-        painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
-        painter->setRenderHint(QPainter::HighQualityAntialiasing, true);
+    if (!tileLayerValid || tileLayer.size() != size) {
+        if (tileLayer.size() != size) {
+            tileLayer = QPixmap(size);
+        }
+        tileLayer.fill(Qt::transparent);
+        QPainter layerPainter(&tileLayer);
+        layerPainter.translate(-rect.topLeft());
+        if (MapRenderTransform != 1) {
+            QTransform transform;
+            transform.translate(-((rect.width() * MapRenderTransform) - (rect.width())) / 2, -((rect.height() * MapRenderTransform) - (rect.height())) / 2);
+            transform.scale(MapRenderTransform, MapRenderTransform);
 
-        {
-            DrawMap2D(painter);
+            layerPainter.setWorldTransform(transform, true);
+            layerPainter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+            layerPainter.setRenderHint(QPainter::HighQualityAntialiasing, true);
         }
-        painter->resetTransform();
-    } else {
-        DrawMap2D(painter);
+        DrawMap2D(&layerPainter);
+        layerPainter.end();
+        tileLayerValid = true;
     }
+
+    // Only blit what the view asked for, usually the area uncovered by a moving overlay item
+    QRectF exposed = option->exposedRect.intersected(rect);
+    painter->drawPixmap(exposed, tileLayer, exposed.translated(-rect.topLeft()));
 }
 void MapGraphicItem::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
 {
@@ -294,7 +312,7 @@ void MapGraphicItem::wheelEvent(QGraphicsSceneWheelEvent *event)
 }
 void MapGraphicItem::DrawMap2D(QPainter *painter)
 {
-    painter->drawImage(this->boundingRect(), dragons.toImage());
+    painter->drawPixmap(this->boundingRect(), dragons, dragons.rect());
     if (!lastimage.isNull()) {
         painter->drawImage(core->GetrenderOffset().X() - lastimagepoint.X(), core->GetrenderOffset().Y() - lastimagepoint.Y(), lastimage);
     }
@@ -380,6 +398,18 @@ core::Point MapGraphicItem::FromLatLngToLocal(internals::PointLatLng const & poi
     }
     return ret;
 }
+QTransform MapGraphicItem::FromPixelToLocalTransform()
+{
+    QTransform transform;
+    core::Point offset = core->GetrenderOffset();
+
+    if (MapRenderTransform != 1) {
+        transform.translate(-((boundingRect().width() * MapRenderTransform) - (boundingRect().width())) / 2, -((boundingRect().height() * MapRenderTransform) - (boundingRect().height())) / 2);
+        transform.scale(MapRenderTransform, MapRenderTransform);
+    }
+    transform.translate(offset.X(), offset.Y());
+    return transform;
+}
 internals::PointLatLng MapGraphicItem::FromLocalToLatLng(int x, int y)
 {
     if (MapRenderTransform != 1) {
@@ -430,13 +460,13 @@ void MapGraphicItem::SetZoom(double const & value)
             }
             SetZoomStep((qint32)(integer));
             // core->GoToCurrentPositionOnZoom();
-            this->update();
+            InvalidateTileLayer();
         } else {
             MapRenderTransform = 1;
 
             SetZoomStep((qint32)(value));
             zoomReal = ZoomStep();
-            this->update();
+            InvalidateTileLayer();
         }
     }
 }
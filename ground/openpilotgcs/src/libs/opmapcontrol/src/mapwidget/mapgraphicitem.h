@@ -84,6 +84,23 @@ public:
      * @return internals::PointLatLng LatLng coordinate
      */
     internals::PointLatLng FromLocalToLatLng(int x, int y);
+    /**
+     * @brief Returns the transform from projection pixel coordinates (at ProjectionZoom())
+     *        to local item coordinates. Items caching projected pixels only need to
+     *        re-apply it on pan or digital zoom, instead of re-projecting every point.
+     *
+     * @return QTransform
+     */
+    QTransform FromPixelToLocalTransform();
+    /**
+     * @brief Returns the integer zoom level used by the projection
+     *
+     * @return int
+     */
+    int ProjectionZoom() const
+    {
+        return core->Zoom();
+    }
     /**
      * @brief Returns true if map is being dragged
      *
@@ -145,6 +162,17 @@ private:
     bool showTileGridLines;
     qreal MapRenderTransform;
     void DrawMap2D(QPainter *painter);
+    /**
+     * @brief Offscreen copy of the tiles as rendered by DrawMap2D(), so overlay
+     *        items moving over the map only cost a blit of their exposed area
+     */
+    QPixmap tileLayer;
+    bool tileLayerValid;
+    /**
+     * @brief Marks the tile layer for redraw on the next paint. Only pan, zoom,
+     *        tile arrival and changes to what DrawMap2D() draws need this.
+     */
+    void InvalidateTileLayer();
     /**
      * @brief Maximum possible zoom
      *
@@ -205,7 +233,7 @@ private:
     }
     void SetSelectedArea(internals::RectLatLng const & value)
     {
-        selectedArea = value; this->update();
+        selectedArea = value; InvalidateTileLayer();
     }
     internals::RectLatLng SelectedArea() const
     {
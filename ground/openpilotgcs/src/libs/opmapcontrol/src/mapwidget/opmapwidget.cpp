@@ -29,10 +29,11 @@
 #include <QtGui>
 #include <QMetaObject>
 #include "waypointitem.h"
+#include <math.h>
 
 namespace mapcontrol {
 OPMapWidget::OPMapWidget(QWidget *parent, Configuration *config) : QGraphicsView(parent), configuration(config), UAV(0), GPS(0), Home(0)
-    , followmouse(true), compass(0), showuav(false), showhome(false), diagTimer(0), diagGraphItem(0), showDiag(false), overlayOpacity(1)
+    , followmouse(true), compass(0), showuav(false), showhome(false), diagTimer(0), prefetchTimer(0), diagGraphItem(0), showDiag(false), overlayOpacity(1), wpBatchDepth(0), wpRenumberFirst(-1)
 {
     setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Preferred);
     core = new internals::Core;
@@ -59,6 +60,9 @@ OPMapWidget::OPMapWidget(QWidget *parent, Configuration *config) : QGraphicsView
     this->setMouseTracking(followmouse);
     SetShowCompass(true);
     QPixmapCache::setCacheLimit(64 * 1024);
+    prefetchTimer = new QTimer(this);
+    connect(prefetchTimer, SIGNAL(timeout()), this, SLOT(prefetchRefresh()));
+    prefetchTimer->start(1000);
 }
 void OPMapWidget::SetShowDiagnostics(bool const & value)
 {
@@ -180,6 +184,8 @@ void OPMapWidget::showEvent(QShowEvent *event)
 }
 OPMapWidget::~OPMapWidget()
 {
+    // the WayPoints die with the map, no need to keep renumbering them
+    wpList.clear();
     if (UAV) {
         delete UAV;
     }
@@ -234,10 +240,8 @@ WayPointItem *OPMapWidget::WPCreate()
 {
     WayPointItem *item = new WayPointItem(this->CurrentPosition(), 0, map);
 
-    ConnectWP(item);
-    item->setParentItem(map);
-    int position = item->Number();
-    emit WPCreated(position, item);
+    WPIndexInsert(item, wpList.size());
+    emit WPCreated(item->Number(), item);
     return item;
 }
 WayPointItem *OPMapWidget::magicWPCreate()
@@ -250,73 +254,52 @@ WayPointItem *OPMapWidget::magicWPCreate()
 }
 void OPMapWidget::WPCreate(WayPointItem *item)
 {
-    ConnectWP(item);
-    item->setParentItem(map);
-    int position = item->Number();
-    emit WPCreated(position, item);
-    setOverlayOpacity(overlayOpacity);
+    WPIndexInsert(item, wpList.size());
+    emit WPCreated(item->Number(), item);
 }
 WayPointItem *OPMapWidget::WPCreate(internals::PointLatLng const & coord, int const & altitude)
 {
     WayPointItem *item = new WayPointItem(coord, altitude, map);
 
-    ConnectWP(item);
-    item->setParentItem(map);
-    int position = item->Number();
-    emit WPCreated(position, item);
-    setOverlayOpacity(overlayOpacity);
+    WPIndexInsert(item, wpList.size());
+    emit WPCreated(item->Number(), item);
     return item;
 }
 WayPointItem *OPMapWidget::WPCreate(internals::PointLatLng const & coord, int const & altitude, QString const & description)
 {
     WayPointItem *item = new WayPointItem(coord, altitude, description, map);
 
-    ConnectWP(item);
-    item->setParentItem(map);
-    int position = item->Number();
-    emit WPCreated(position, item);
-    setOverlayOpacity(overlayOpacity);
+    WPIndexInsert(item, wpList.size());
+    emit WPCreated(item->Number(), item);
     return item;
 }
 WayPointItem *OPMapWidget::WPCreate(const distBearingAltitude &relativeCoord, const QString &description)
 {
     WayPointItem *item = new WayPointItem(relativeCoord, description, map);
 
-    ConnectWP(item);
-    item->setParentItem(map);
-    int position = item->Number();
-    emit WPCreated(position, item);
-    setOverlayOpacity(overlayOpacity);
+    WPIndexInsert(item, wpList.size());
+    emit WPCreated(item->Number(), item);
     return item;
 }
 WayPointItem *OPMapWidget::WPInsert(const int &position)
 {
     WayPointItem *item = new WayPointItem(this->CurrentPosition(), 0, map);
 
-    item->SetNumber(position);
-    ConnectWP(item);
-    item->setParentItem(map);
+    WPIndexInsert(item, position);
     emit WPInserted(position, item);
-    setOverlayOpacity(overlayOpacity);
     return item;
 }
 void OPMapWidget::WPInsert(WayPointItem *item, const int &position)
 {
-    item->SetNumber(position);
-    ConnectWP(item);
-    item->setParentItem(map);
+    WPIndexInsert(item, position);
     emit WPInserted(position, item);
-    setOverlayOpacity(overlayOpacity);
 }
 WayPointItem *OPMapWidget::WPInsert(internals::PointLatLng const & coord, int const & altitude, const int &position)
 {
     WayPointItem *item = new WayPointItem(coord, altitude, map);
 
-    item->SetNumber(position);
-    ConnectWP(item);
-    item->setParentItem(map);
+    WPIndexInsert(item, position);
     emit WPInserted(position, item);
-    setOverlayOpacity(overlayOpacity);
     return item;
 }
 WayPointItem *OPMapWidget::WPInsert(internals::PointLatLng const & coord, int const & altitude, QString const & description, const int &position)
@@ -331,97 +314,56 @@ WayPointItem *OPMapWidget::WPInsert(internals::PointLatLng const & coord, int co
         mcoord = coord;
     }
     WayPointItem *item = new WayPointItem(mcoord, altitude, description, map);
-    item->SetNumber(position);
-    ConnectWP(item);
-    item->setParentItem(map);
+    WPIndexInsert(item, position);
     emit WPInserted(position, item);
     if (reloc) {
         emit WPValuesChanged(item);
     }
-    setOverlayOpacity(overlayOpacity);
     return item;
 }
 WayPointItem *OPMapWidget::WPInsert(distBearingAltitude const & relative, QString const & description, const int &position)
 {
     WayPointItem *item = new WayPointItem(relative, description, map);
 
-    item->SetNumber(position);
-    ConnectWP(item);
-    item->setParentItem(map);
+    WPIndexInsert(item, position);
     emit WPInserted(position, item);
-    setOverlayOpacity(overlayOpacity);
     return item;
 }
 void OPMapWidget::WPDelete(WayPointItem *item)
 {
     emit WPDeleted(item->Number(), item);
 
+    WPIndexRemove(item);
     delete item;
 }
 void OPMapWidget::WPDelete(int number)
 {
-    foreach(QGraphicsItem * i, map->childItems()) {
-        WayPointItem *w = qgraphicsitem_cast<WayPointItem *>(i);
+    WayPointItem *w = WPFind(number);
 
-        if (w) {
-            if (w->Number() == number) {
-                emit WPDeleted(w->Number(), w);
-                delete w;
-                return;
-            }
-        }
+    if (w) {
+        WPDelete(w);
     }
 }
 WayPointItem *OPMapWidget::WPFind(int number)
 {
-    foreach(QGraphicsItem * i, map->childItems()) {
-        WayPointItem *w = qgraphicsitem_cast<WayPointItem *>(i);
-
-        if (w) {
-            if (w->Number() == number) {
-                return w;
-            }
-        }
-    }
-    return NULL;
+    return wpList.value(number, NULL);
 }
 void OPMapWidget::WPSetVisibleAll(bool value)
 {
-    foreach(QGraphicsItem * i, map->childItems()) {
-        WayPointItem *w = qgraphicsitem_cast<WayPointItem *>(i);
-
-        if (w) {
-            if (w->Number() != -1) {
-                w->setVisible(value);
-            }
-        }
+    foreach(WayPointItem * w, wpList) {
+        w->setVisible(value);
     }
 }
 void OPMapWidget::WPDeleteAll()
 {
-    foreach(QGraphicsItem * i, map->childItems()) {
-        WayPointItem *w = qgraphicsitem_cast<WayPointItem *>(i);
-
-        if (w) {
-            if (w->Number() != -1) {
-                emit WPDeleted(w->Number(), w);
-                delete w;
-            }
-        }
+    // from the back, so nothing is left to renumber
+    while (!wpList.isEmpty()) {
+        WPDelete(wpList.last());
     }
 }
 bool OPMapWidget::WPPresent()
 {
-    foreach(QGraphicsItem * i, map->childItems()) {
-        WayPointItem *w = qgraphicsitem_cast<WayPointItem *>(i);
-
-        if (w) {
-            if (w->Number() != -1) {
-                return true;
-            }
-        }
-    }
-    return false;
+    return !wpList.isEmpty();
 }
 
 void OPMapWidget::deleteAllOverlays()
@@ -455,16 +397,129 @@ void OPMapWidget::WPRenumber(WayPointItem *item, const int &newnumber)
 {
     item->SetNumber(newnumber);
 }
+void OPMapWidget::WPBeginBatch()
+{
+    ++wpBatchDepth;
+}
+void OPMapWidget::WPEndBatch()
+{
+    if (wpBatchDepth > 0 && --wpBatchDepth == 0 && wpRenumberFirst >= 0) {
+        int first = wpRenumberFirst;
+        wpRenumberFirst = -1;
+        WPRenumberFrom(first);
+    }
+}
 
 void OPMapWidget::ConnectWP(WayPointItem *item)
 {
-    connect(item, SIGNAL(WPNumberChanged(int, int, WayPointItem *)), this, SIGNAL(WPNumberChanged(int, int, WayPointItem *)), Qt::DirectConnection);
+    connect(item, SIGNAL(WPNumberChanged(int, int, WayPointItem *)), this, SLOT(onWPNumberChanged(int, int, WayPointItem *)), Qt::DirectConnection);
     connect(item, SIGNAL(WPValuesChanged(WayPointItem *)), this, SIGNAL(WPValuesChanged(WayPointItem *)), Qt::DirectConnection);
     connect(item, SIGNAL(localPositionChanged(QPointF, WayPointItem *)), this, SIGNAL(WPLocalPositionChanged(QPointF, WayPointItem *)), Qt::DirectConnection);
     connect(item, SIGNAL(manualCoordChange(WayPointItem *)), this, SIGNAL(WPManualCoordChange(WayPointItem *)), Qt::DirectConnection);
-    connect(this, SIGNAL(WPInserted(int, WayPointItem *)), item, SLOT(WPInserted(int, WayPointItem *)), Qt::DirectConnection);
-    connect(this, SIGNAL(WPNumberChanged(int, int, WayPointItem *)), item, SLOT(WPRenumbered(int, int, WayPointItem *)), Qt::DirectConnection);
-    connect(this, SIGNAL(WPDeleted(int, WayPointItem *)), item, SLOT(WPDeleted(int, WayPointItem *)), Qt::DirectConnection);
+    connect(item, SIGNAL(aboutToBeDeleted(WayPointItem *)), this, SLOT(onWPAboutToBeDeleted(WayPointItem *)), Qt::DirectConnection);
+}
+void OPMapWidget::WPIndexInsert(WayPointItem *item, int position)
+{
+    position = qBound(0, position, wpList.size());
+    wpList.insert(position, item);
+    ConnectWP(item);
+    item->setParentItem(map);
+    item->setOpacity(overlayOpacity);
+    if (item->Number() != position) {
+        item->SetNumber(position);
+    }
+    WPRenumberFrom(position + 1);
+}
+void OPMapWidget::WPIndexRemove(WayPointItem *item)
+{
+    int index = item->Number();
+
+    if (wpList.value(index) != item) {
+        // numbers are stale inside a batch
+        index = wpList.indexOf(item);
+        if (index < 0) {
+            return;
+        }
+    }
+    wpList.removeAt(index);
+    disconnect(item, 0, this, 0);
+    WPRenumberFrom(index);
+}
+void OPMapWidget::WPRenumberFrom(int first)
+{
+    if (wpBatchDepth > 0) {
+        if (wpRenumberFirst < 0 || first < wpRenumberFirst) {
+            wpRenumberFirst = first;
+        }
+        return;
+    }
+    for (int i = first; i < wpList.size(); ++i) {
+        WayPointItem *w = wpList.at(i);
+        if (w->Number() != i) {
+            w->SetNumber(i);
+        }
+    }
+}
+void OPMapWidget::onWPNumberChanged(int const & oldnumber, int const & newnumber, WayPointItem *waypoint)
+{
+    if (wpList.value(newnumber) == waypoint) {
+        // renumbered by the index itself
+        return;
+    }
+    int from = (wpList.value(oldnumber) == waypoint) ? oldnumber : wpList.indexOf(waypoint);
+    if (from < 0) {
+        return;
+    }
+    int to   = qBound(0, newnumber, wpList.size() - 1);
+    wpList.move(from, to);
+    WPRenumberFrom(qMin(from, to));
+    emit WPNumberChanged(oldnumber, newnumber, waypoint);
+}
+void OPMapWidget::onWPAboutToBeDeleted(WayPointItem *waypoint)
+{
+    // deleted behind our back (e.g. with the scene)
+    WPIndexRemove(waypoint);
+}
+void OPMapWidget::prefetchRefresh()
+{
+    if (!configuration->PrefetchTiles || !isVisible() || !core->isStarted()) {
+        return;
+    }
+    internals::PureProjection *projection = core->Projection();
+    // one sample per tile, the corridor Core puts around each sample covers the rest
+    double tileGround = projection->GetGroundResolution(core->Zoom(), core->CurrentPosition().Lat()) * projection->TileSize().Width();
+    QList<internals::PointLatLng> track;
+    QList<internals::PointLatLng> path;
+
+    if (tileGround <= 0) {
+        return;
+    }
+    if (UAV) {
+        double north;
+        double east;
+        UAV->GetVelocity(north, east);
+        double distance = sqrt(north * north + east * east) * configuration->PrefetchHorizon;
+        int samples     = qMin(64, (int)(distance / tileGround));
+        double bearing  = atan2(east, north);
+        track.append(UAV->UAVPos());
+        for (int i = 1; i <= samples; ++i) {
+            track.append(projection->translate(UAV->UAVPos(), i * tileGround, bearing));
+        }
+    }
+    for (int i = 0; i < wpList.count() && path.count() < 512; ++i) {
+        internals::PointLatLng to = wpList.at(i)->Coord();
+        if (i > 0) {
+            internals::PointLatLng from = wpList.at(i - 1)->Coord();
+            int steps = (int)(internals::PureProjection::DistanceBetweenLatLng(from, to) * 1000 / tileGround);
+            for (int j = 1; j < steps && path.count() < 512; ++j) {
+                double f = (double)j / steps;
+                path.append(internals::PointLatLng(from.Lat() + (to.Lat() - from.Lat()) * f, from.Lng() + (to.Lng() - from.Lng()) * f));
+            }
+        }
+        path.append(to);
+    }
+    core->SetPrefetchBudget(configuration->PrefetchMemoryBudget, configuration->PrefetchDiskBudget);
+    core->PrefetchAlong(track, path);
 }
 void OPMapWidget::diagRefresh()
 {
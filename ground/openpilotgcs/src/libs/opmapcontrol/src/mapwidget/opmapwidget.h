@@ -251,7 +251,7 @@ public:
      */
     void SetShowTileGridLines(bool const & value)
     {
-        map->showTileGridLines = value; map->update();
+        map->showTileGridLines = value; map->InvalidateTileLayer();
     }
 
     /**
@@ -300,7 +300,7 @@ public:
     }
     void SetSelectedArea(internals::RectLatLng const & value)
     {
-        map->selectedArea = value; this->update();
+        map->SetSelectedArea(value);
     }
 
     bool CanDragMap() const
@@ -490,6 +490,27 @@ public:
      * @param newnumber the WayPoint's new number
      */
     void WPRenumber(WayPointItem *item, int const & newnumber);
+    /**
+     * @brief Starts a batch of WayPoint inserts/deletes
+     *
+     * Until the matching WPEndBatch() the WayPoints following an insert or delete
+     * are not renumbered, WPEndBatch() renumbers them all in a single pass.
+     * WPFind() stays valid inside a batch. Batches can be nested.
+     */
+    void WPBeginBatch();
+    /**
+     * @brief Ends a batch started with WPBeginBatch()
+     */
+    void WPEndBatch();
+    /**
+     * @brief Returns the number of WayPoints (the magic WayPoint is not counted)
+     *
+     * @return int
+     */
+    int WPCount() const
+    {
+        return wpList.size();
+    }
 
     void SetShowCompass(bool const & value);
 
@@ -532,15 +553,26 @@ private:
     internals::PointLatLng currentmouseposition;
     bool followmouse;
     void ConnectWP(WayPointItem *item);
+    void WPIndexInsert(WayPointItem *item, int position);
+    void WPIndexRemove(WayPointItem *item);
+    void WPRenumberFrom(int first);
     QGraphicsSvgItem *compass;
     bool showuav;
     bool showhome;
     QTimer *diagTimer;
+    QTimer *prefetchTimer;
     QGraphicsTextItem *diagGraphItem;
     bool showDiag;
     qreal overlayOpacity;
+    // WayPoints ordered by number, so lookups and renumbering don't walk the scene
+    QList<WayPointItem *> wpList;
+    int wpBatchDepth;
+    int wpRenumberFirst;
 private slots:
     void diagRefresh();
+    void prefetchRefresh();
+    void onWPNumberChanged(int const & oldnumber, int const & newnumber, WayPointItem *waypoint);
+    void onWPAboutToBeDeleted(WayPointItem *waypoint);
     // WayPointItem* item;//apagar
 protected:
     void resizeEvent(QResizeEvent *event);
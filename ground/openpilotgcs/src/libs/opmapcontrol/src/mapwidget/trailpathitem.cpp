@@ -0,0 +1,411 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trailpathitem.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      A single graphicsItem holding a whole UAV/GPS trail
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "trailpathitem.h"
+#include "../internals/pureprojection.h"
+#include <QStyleOptionGraphicsItem>
+#include <QGraphicsSceneHoverEvent>
+#include <algorithm>
+#include <math.h>
+
+namespace mapcontrol {
+// Grid bucket size in projected pixels, one tile
+static const int CellSize = 256;
+// Segments covering more cells than this are kept in a flat overflow list
+static const int MaxCellsPerSegment = 16;
+// Douglas-Peucker tolerance in projected pixels
+static const qreal SimplifyTolerance = 1.0;
+// Minimum distance between two drawn dots in projected pixels
+static const qreal DotSpacing = 4.0;
+// Number of appended line vertices after which the tail is simplified again
+static const int TailSimplifyLength = 256;
+
+TrailPathItem::TrailPathItem(QColor const & pointColor, QColor const & lineColor, MapGraphicItem *map) : QGraphicsItem(map), m_map(map),
+    m_pointColor(pointColor), m_lineColor(lineColor), showPoints(true), showLine(true), projectedZoom(-1), lineAnchor(0)
+{
+    this->setFlag(QGraphicsItem::ItemIsMovable, false);
+    this->setFlag(QGraphicsItem::ItemIsSelectable, false);
+    this->setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+    // Only used for the point tooltips, mouse presses must reach the map
+    this->setAcceptedMouseButtons(Qt::NoButton);
+    this->setAcceptHoverEvents(true);
+    connect(map, SIGNAL(childRefreshPosition()), this, SLOT(RefreshPos()));
+    RefreshPos();
+}
+
+int TrailPathItem::type() const
+{
+    return Type;
+}
+
+QRectF TrailPathItem::boundingRect() const
+{
+    if (points.isEmpty()) {
+        return QRectF();
+    }
+    return bounds.adjusted(-DotSpacing, -DotSpacing, DotSpacing, DotSpacing);
+}
+
+void TrailPathItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+
+    QRectF exposed = option->exposedRect.adjusted(-DotSpacing, -DotSpacing, DotSpacing, DotSpacing);
+
+    if (showLine && line.size() > 1) {
+        QVector<int> segments = query(lineGrid, lineOverflow, exposed);
+        QVector<QLineF> lines;
+        lines.reserve(segments.size());
+        foreach(int k, segments) {
+            lines.append(QLineF(pixels.at(line.at(k)), pixels.at(line.at(k + 1))));
+        }
+        QPen pen(m_lineColor);
+        pen.setWidth(1);
+        pen.setCosmetic(true);
+        painter->setPen(pen);
+        painter->drawLines(lines);
+    }
+    if (showPoints && !dots.isEmpty()) {
+        QVector<int> visible = query(dotGrid, QVector<int>(), exposed);
+        QVector<QPointF> centers;
+        centers.reserve(visible.size());
+        foreach(int j, visible) {
+            centers.append(pixels.at(dots.at(j)));
+        }
+        // Cosmetic round pens keep the dots the same size at any digital zoom
+        QPen pen(Qt::black);
+        pen.setCosmetic(true);
+        pen.setCapStyle(Qt::RoundCap);
+        pen.setWidth(5);
+        painter->setPen(pen);
+        painter->drawPoints(centers.constData(), centers.size());
+        pen.setColor(m_pointColor);
+        pen.setWidth(3);
+        painter->setPen(pen);
+        painter->drawPoints(centers.constData(), centers.size());
+    }
+}
+
+void TrailPathItem::AddPoint(internals::PointLatLng const & coord, int const & altitude)
+{
+    QDateTime now = QDateTime::currentDateTime();
+
+    if (points.isEmpty()) {
+        startTime = now;
+    }
+    TrailPoint p;
+    p.lat      = qRound(coord.Lat() * 1e7);
+    p.lng      = qRound(coord.Lng() * 1e7);
+    p.altitude = altitude;
+    p.time     = startTime.secsTo(now);
+    points.append(p);
+
+    int i = points.size() - 1;
+    if (pixels.size() != i || projectedZoom < 0) {
+        reproject();
+        return;
+    }
+
+    core::Point pixel = m_map->Projection()->FromLatLngToPixel(coord, projectedZoom);
+    pixels.append(QPointF(pixel.X(), pixel.Y()));
+
+    QRectF dirty(pixels.at(i), QSizeF(0, 0));
+    if (i > 0) {
+        dirty = QRectF(pixels.at(i - 1), pixels.at(i)).normalized();
+    }
+    if (!bounds.contains(pixels.at(i))) {
+        prepareGeometryChange();
+        bounds = i == 0 ? dirty : bounds.united(dirty);
+    }
+
+    line.append(i);
+    if (line.size() > 1) {
+        indexSegment(line.size() - 2);
+    }
+    addDot(i);
+
+    if (line.size() - 1 - lineAnchor > TailSimplifyLength) {
+        // Replace the raw tail by its simplified version, keeping the anchor vertex
+        int first = line.at(lineAnchor);
+        line.resize(lineAnchor);
+        simplify(first, i);
+        lineAnchor = line.size() - 1;
+        rebuildIndex();
+    }
+    update(dirty.adjusted(-DotSpacing, -DotSpacing, DotSpacing, DotSpacing));
+}
+
+void TrailPathItem::Clear()
+{
+    prepareGeometryChange();
+    points.clear();
+    pixels.clear();
+    line.clear();
+    dots.clear();
+    lineGrid.clear();
+    lineOverflow.clear();
+    dotGrid.clear();
+    lineAnchor = 0;
+    bounds     = QRectF();
+    update();
+}
+
+void TrailPathItem::SetShowPoints(bool const & value)
+{
+    showPoints = value;
+    setAcceptHoverEvents(value);
+    update();
+}
+
+void TrailPathItem::SetShowLine(bool const & value)
+{
+    showLine = value;
+    update();
+}
+
+void TrailPathItem::RefreshPos()
+{
+    internals::PureProjection *projection = m_map->Projection();
+
+    if (m_map->ProjectionZoom() != projectedZoom || projection->Type() != projectedType) {
+        reproject();
+    }
+    setTransform(m_map->FromPixelToLocalTransform());
+}
+
+void TrailPathItem::reproject()
+{
+    internals::PureProjection *projection = m_map->Projection();
+
+    projectedZoom = m_map->ProjectionZoom();
+    projectedType = projection->Type();
+
+    prepareGeometryChange();
+    int count = points.size();
+    QVector<double> lat(count), lng(count);
+    QVector<int> x(count), y(count);
+    for (int i = 0; i < count; ++i) {
+        lat[i] = points.at(i).lat * 1e-7;
+        lng[i] = points.at(i).lng * 1e-7;
+    }
+    projection->FromLatLngToPixelBatch(lat.constData(), lng.constData(), x.data(), y.data(), count, projectedZoom);
+    pixels.resize(count);
+    for (int i = 0; i < count; ++i) {
+        pixels[i] = QPointF(x.at(i), y.at(i));
+    }
+    bounds = QRectF();
+    if (!pixels.isEmpty()) {
+        qreal minX = pixels.at(0).x(), maxX = minX;
+        qreal minY = pixels.at(0).y(), maxY = minY;
+        foreach(QPointF const & p, pixels) {
+            minX = qMin(minX, p.x());
+            maxX = qMax(maxX, p.x());
+            minY = qMin(minY, p.y());
+            maxY = qMax(maxY, p.y());
+        }
+        bounds = QRectF(QPointF(minX, minY), QPointF(maxX, maxY));
+    }
+
+    line.clear();
+    if (!points.isEmpty()) {
+        simplify(0, points.size() - 1);
+    }
+    lineAnchor = qMax(0, line.size() - 1);
+    rebuildIndex();
+
+    dots.clear();
+    dotGrid.clear();
+    for (int i = 0; i < points.size(); ++i) {
+        addDot(i);
+    }
+    update();
+}
+
+/**
+ * Douglas-Peucker simplification of points [first, last], appending the kept
+ * point indices to line. Uses an explicit stack so long straight legs don't recurse.
+ */
+void TrailPathItem::simplify(int first, int last)
+{
+    if (last <= first) {
+        line.append(first);
+        return;
+    }
+    QVector<bool> keep(last - first + 1, false);
+    keep[0] = true;
+    keep[last - first] = true;
+
+    QVector<QPair<int, int> > stack;
+    stack.append(qMakePair(first, last));
+    while (!stack.isEmpty()) {
+        QPair<int, int> range = stack.last();
+        stack.pop_back();
+
+        QPointF const & a = pixels.at(range.first);
+        QPointF const & b = pixels.at(range.second);
+        qreal dx    = b.x() - a.x();
+        qreal dy    = b.y() - a.y();
+        qreal len   = sqrt(dx * dx + dy * dy);
+        qreal worst = 0;
+        int index   = -1;
+        for (int i = range.first + 1; i < range.second; ++i) {
+            QPointF const & p = pixels.at(i);
+            qreal d;
+            if (len > 0) {
+                d = fabs(dy * (p.x() - a.x()) - dx * (p.y() - a.y())) / len;
+            } else {
+                d = sqrt((p.x() - a.x()) * (p.x() - a.x()) + (p.y() - a.y()) * (p.y() - a.y()));
+            }
+            if (d > worst) {
+                worst = d;
+                index = i;
+            }
+        }
+        if (index >= 0 && worst > SimplifyTolerance) {
+            keep[index - first] = true;
+            stack.append(qMakePair(range.first, index));
+            stack.append(qMakePair(index, range.second));
+        }
+    }
+    for (int i = first; i <= last; ++i) {
+        if (keep.at(i - first)) {
+            line.append(i);
+        }
+    }
+}
+
+void TrailPathItem::rebuildIndex()
+{
+    lineGrid.clear();
+    lineOverflow.clear();
+    for (int k = 0; k < line.size() - 1; ++k) {
+        indexSegment(k);
+    }
+}
+
+void TrailPathItem::indexSegment(int k)
+{
+    QPointF const & a = pixels.at(line.at(k));
+    QPointF const & b = pixels.at(line.at(k + 1));
+    int cx0 = (int)floor(qMin(a.x(), b.x()) / CellSize);
+    int cx1 = (int)floor(qMax(a.x(), b.x()) / CellSize);
+    int cy0 = (int)floor(qMin(a.y(), b.y()) / CellSize);
+    int cy1 = (int)floor(qMax(a.y(), b.y()) / CellSize);
+
+    if ((cx1 - cx0 + 1) * (cy1 - cy0 + 1) > MaxCellsPerSegment) {
+        lineOverflow.append(k);
+        return;
+    }
+    for (int cx = cx0; cx <= cx1; ++cx) {
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            lineGrid[cellKey(cx, cy)].append(k);
+        }
+    }
+}
+
+void TrailPathItem::indexDot(int j)
+{
+    QPointF const & p = pixels.at(dots.at(j));
+
+    dotGrid[cellKey((int)floor(p.x() / CellSize), (int)floor(p.y() / CellSize))].append(j);
+}
+
+void TrailPathItem::addDot(int i)
+{
+    if (!dots.isEmpty()) {
+        QPointF d = pixels.at(i) - pixels.at(dots.last());
+        if (d.x() * d.x() + d.y() * d.y() < DotSpacing * DotSpacing) {
+            return;
+        }
+    }
+    dots.append(i);
+    indexDot(dots.size() - 1);
+}
+
+QVector<int> TrailPathItem::query(GridIndex const & grid, QVector<int> const & overflow, QRectF const & rect) const
+{
+    QVector<int> result = overflow;
+
+    if (grid.isEmpty() || rect.isEmpty()) {
+        return result;
+    }
+    int cx0 = (int)floor(rect.left() / CellSize);
+    int cx1 = (int)floor(rect.right() / CellSize);
+    int cy0 = (int)floor(rect.top() / CellSize);
+    int cy1 = (int)floor(rect.bottom() / CellSize);
+
+    if ((qint64)(cx1 - cx0 + 1) * (cy1 - cy0 + 1) > grid.size()) {
+        // Exposed area larger than the trail, walk the occupied cells instead
+        for (GridIndex::const_iterator it = grid.constBegin(); it != grid.constEnd(); ++it) {
+            int cx = (int)(it.key() >> 32);
+            int cy = (qint32)(it.key() & 0xFFFFFFFF);
+            if (cx >= cx0 && cx <= cx1 && cy >= cy0 && cy <= cy1) {
+                result += it.value();
+            }
+        }
+    } else {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            for (int cy = cy0; cy <= cy1; ++cy) {
+                GridIndex::const_iterator it = grid.constFind(cellKey(cx, cy));
+                if (it != grid.constEnd()) {
+                    result += it.value();
+                }
+            }
+        }
+    }
+    // Segments spanning several cells are reported once per cell
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+void TrailPathItem::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
+{
+    qreal scale     = transform().m11() > 0 ? transform().m11() : 1;
+    qreal tolerance = DotSpacing / scale;
+    QPointF pos     = event->pos();
+    QVector<int> candidates = query(dotGrid, QVector<int>(), QRectF(pos.x() - tolerance, pos.y() - tolerance, 2 * tolerance, 2 * tolerance));
+    int nearest     = -1;
+    qreal best      = tolerance * tolerance;
+
+    foreach(int j, candidates) {
+        QPointF d = pixels.at(dots.at(j)) - pos;
+        qreal dist = d.x() * d.x() + d.y() * d.y();
+        if (dist <= best) {
+            best    = dist;
+            nearest = dots.at(j);
+        }
+    }
+    if (nearest < 0) {
+        setToolTip(QString());
+        return;
+    }
+    internals::PointLatLng coord = coordOf(nearest);
+    QDateTime time    = startTime.addSecs(points.at(nearest).time);
+    QString coord_str = " " + QString::number(coord.Lat(), 'f', 6) + "   " + QString::number(coord.Lng(), 'f', 6);
+    setToolTip(QString(tr("Position:") + "%1\n" + tr("Altitude:") + "%2\n" + tr("Time:") + "%3").arg(coord_str).arg(QString::number(points.at(nearest).altitude)).arg(time.toString()));
+}
+}
@@ -0,0 +1,141 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trailpathitem.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      A single graphicsItem holding a whole UAV/GPS trail
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TRAILPATHITEM_H
+#define TRAILPATHITEM_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QVector>
+#include <QHash>
+#include <QDateTime>
+#include "../internals/pointlatlng.h"
+#include <QObject>
+#include "mapgraphicitem.h"
+
+namespace mapcontrol {
+/**
+ * @brief A QGraphicsItem drawing a complete trail (dots and connecting line)
+ *
+ * Points are kept in a compact geographic array and projected once per zoom level.
+ * Pan and digital zoom only change the item transform. The line is simplified with
+ * Douglas-Peucker at one pixel tolerance, dots are decimated to their own size, and
+ * both are bucketed in a grid so paint() only touches what is exposed.
+ *
+ * @class TrailPathItem trailpathitem.h "mapwidget/trailpathitem.h"
+ */
+class TrailPathItem : public QObject, public QGraphicsItem {
+    Q_OBJECT Q_INTERFACES(QGraphicsItem)
+public:
+    enum { Type = UserType + 10 };
+    TrailPathItem(QColor const & pointColor, QColor const & lineColor, MapGraphicItem *map);
+    /**
+     * @brief Appends a point to the end of the trail
+     *
+     * @param coord LatLng point
+     * @param altitude altitude in meters
+     */
+    void AddPoint(internals::PointLatLng const & coord, int const & altitude);
+    /**
+     * @brief Deletes all the trail points
+     */
+    void Clear();
+    /**
+     * @brief Returns the number of points stored in the trail
+     *
+     * @return int
+     */
+    int Count() const
+    {
+        return points.size();
+    }
+    void SetShowPoints(bool const & value);
+    void SetShowLine(bool const & value);
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+               QWidget *widget);
+    QRectF boundingRect() const;
+    int type() const;
+protected:
+    void hoverMoveEvent(QGraphicsSceneHoverEvent *event);
+private:
+    /**
+     * @brief Trail sample, latitude/longitude in 1e-7 degrees and time in seconds since the trail start
+     */
+    struct TrailPoint {
+        qint32  lat;
+        qint32  lng;
+        qint32  altitude;
+        quint32 time;
+    };
+    typedef QHash<qint64, QVector<int> > GridIndex;
+
+    void reproject();
+    void simplify(int first, int last);
+    void rebuildIndex();
+    void indexSegment(int k);
+    void indexDot(int i);
+    void addDot(int i);
+    QVector<int> query(GridIndex const & grid, QVector<int> const & overflow, QRectF const & rect) const;
+    static qint64 cellKey(int cx, int cy)
+    {
+        return ((qint64)cx << 32) | (quint32)cy;
+    }
+    internals::PointLatLng coordOf(int i) const
+    {
+        return internals::PointLatLng(points.at(i).lat * 1e-7, points.at(i).lng * 1e-7);
+    }
+
+    MapGraphicItem *m_map;
+    QColor m_pointColor;
+    QColor m_lineColor;
+    bool showPoints;
+    bool showLine;
+
+    QVector<TrailPoint> points;
+    QDateTime startTime;
+
+    // Projection cache, valid for projectedZoom/projectedType only
+    QVector<QPointF> pixels;
+    int projectedZoom;
+    QString projectedType;
+    QRectF bounds;
+
+    // Indices into points of the simplified line vertices and of the decimated dots
+    QVector<int> line;
+    QVector<int> dots;
+    // First line vertex not yet covered by a simplification pass
+    int lineAnchor;
+
+    // Grid buckets (cell -> index into line/dots); segments spanning too many cells go to lineOverflow
+    GridIndex lineGrid;
+    QVector<int> lineOverflow;
+    GridIndex dotGrid;
+public slots:
+    void RefreshPos();
+};
+}
+#endif // TRAILPATHITEM_H
@@ -40,14 +40,13 @@ UAVItem::UAVItem(MapGraphicItem *map, OPMapWidget *parent, QString uavPic) : map
     localposition = map->FromLatLngToLocal(mapwidget->CurrentPosition());
     this->setPos(localposition.X(), localposition.Y());
     this->setZValue(4);
-    trail     = new QGraphicsItemGroup(this);
-    trail->setParentItem(map);
-    trailLine = new QGraphicsItemGroup(this);
-    trailLine->setParentItem(map);
+    trail = new TrailPathItem(Qt::green, Qt::red, map);
     this->setFlag(QGraphicsItem::ItemIgnoresTransformations, true);
     setCacheMode(QGraphicsItem::ItemCoordinateCache);
     mapfollowtype = UAVMapFollowType::None;
     trailtype     = UAVTrailType::ByDistance;
+    boundingRectSize = 0;
+    vNED[0] = vNED[1] = vNED[2] = 0;
     timer.start();
     generateArrowhead();
     double pixels2meters = map->Projection()->GetGroundResolution(map->ZoomTotal(), coord.Lat());
@@ -58,7 +57,9 @@ UAVItem::UAVItem(MapGraphicItem *map, OPMapWidget *parent, QString uavPic) : map
     connect(map, SIGNAL(zoomChanged(double, double, double)), this, SLOT(zoomChangedSlot()));
 }
 UAVItem::~UAVItem()
-{}
+{
+    delete trail;
+}
 
 void UAVItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
@@ -234,10 +235,18 @@ void UAVItem::SetGroundspeed(double vNED[3], int m_maxUpdateRate_ms)
         double alpha    = m_maxUpdateRate_ms / (double)(m_maxUpdateRate_ms + riseTime_ms);
         groundspeed_mps_filt = alpha * groundspeed_mps_filt + (1 - alpha) * (groundspeed_kph / 3.6);
     }
-    ringTime         = 10 * pow(2, 17 - map->ZoomTotal()); // Basic ring is 10 seconds wide at zoom level 17
-    precalcRings     = groundspeed_mps_filt * ringTime * meters2pixels;
-    boundingRectSize = groundspeed_mps_filt * ringTime * 4 * meters2pixels + 20;
-    prepareGeometryChange();
+    ringTime     = 10 * pow(2, 17 - map->ZoomTotal()); // Basic ring is 10 seconds wide at zoom level 17
+    precalcRings = groundspeed_mps_filt * ringTime * meters2pixels;
+    SetBoundingRectSize(groundspeed_mps_filt * ringTime * 4 * meters2pixels + 20);
+}
+
+void UAVItem::SetBoundingRectSize(float size)
+{
+    // Only a real geometry change needs the scene index updated and the old area repainted
+    if (size != boundingRectSize) {
+        prepareGeometryChange();
+        boundingRectSize = size;
+    }
 }
 
 
@@ -249,29 +258,13 @@ void UAVItem::SetUAVPos(const internals::PointLatLng &position, const int &altit
     if (coord != position) {
         if (trailtype == UAVTrailType::ByTimeElapsed) {
             if (timer.elapsed() > trailtime * 1000) {
-                TrailItem *ob = new TrailItem(position, altitude, Qt::green, map);
-                trail->addToGroup(ob);
-                connect(this, SIGNAL(setChildPosition()), ob, SLOT(setPosSLOT()));
-                if (!lasttrailline.IsEmpty()) {
-                    TrailLineItem *obj = new TrailLineItem(lasttrailline, position, Qt::red, map);
-                    trailLine->addToGroup(obj);
-                    connect(this, SIGNAL(setChildLine()), obj, SLOT(setLineSlot()));
-                }
-                lasttrailline = position;
+                trail->AddPoint(position, altitude);
                 timer.restart();
             }
         } else if (trailtype == UAVTrailType::ByDistance) {
             if (qAbs(internals::PureProjection::DistanceBetweenLatLng(lastcoord, position) * 1000) > traildistance) {
-                TrailItem *ob = new TrailItem(position, altitude, Qt::green, map);
-                trail->addToGroup(ob);
-                connect(this, SIGNAL(setChildPosition()), ob, SLOT(setPosSLOT()));
-                if (!lasttrailline.IsEmpty()) {
-                    TrailLineItem *obj = new TrailLineItem(lasttrailline, position, Qt::red, map);
-                    trailLine->addToGroup(obj);
-                    connect(this, SIGNAL(setChildLine()), obj, SLOT(setLineSlot()));
-                }
-                lasttrailline = position;
-                lastcoord     = position;
+                trail->AddPoint(position, altitude);
+                lastcoord = position;
             }
         }
         coord = position;
@@ -336,8 +329,6 @@ void UAVItem::RefreshPos()
 {
     localposition = map->FromLatLngToLocal(coord);
     this->setPos(localposition.X(), localposition.Y());
-    emit setChildPosition();
-    emit setChildLine();
     updateTextOverlay();
 }
 
@@ -350,9 +341,8 @@ void UAVItem::zoomChangedSlot()
 {
     double pixels2meters = map->Projection()->GetGroundResolution(map->ZoomTotal(), coord.Lat());
 
-    meters2pixels    = 1.0 / pixels2meters;
-    boundingRectSize = groundspeed_mps_filt * ringTime * 4 * meters2pixels + 20;
-    prepareGeometryChange();
+    meters2pixels = 1.0 / pixels2meters;
+    SetBoundingRectSize(groundspeed_mps_filt * ringTime * 4 * meters2pixels + 20);
     updateTextOverlay();
     update();
 }
@@ -366,20 +356,17 @@ void UAVItem::SetTrailType(const UAVTrailType::Types &value)
 void UAVItem::SetShowTrail(const bool &value)
 {
     showtrail = value;
-    trail->setVisible(value);
+    trail->SetShowPoints(value);
 }
 void UAVItem::SetShowTrailLine(const bool &value)
 {
     showtrailline = value;
-    trailLine->setVisible(value);
+    trail->SetShowLine(value);
 }
 
 void UAVItem::DeleteTrail() const
 {
-    foreach(QGraphicsItem * i, trail->childItems())
-    delete i;
-    foreach(QGraphicsItem * i, trailLine->childItems())
-    delete i;
+    trail->Clear();
 }
 double UAVItem::Distance3D(const internals::PointLatLng &coord, const int &altitude)
 {
@@ -393,6 +380,8 @@ void UAVItem::SetUavPic(QString UAVPic)
 
 void UAVItem::SetShowUAVInfo(bool const & value)
 {
+    // boundingRect() depends on showUAVInfo
+    prepareGeometryChange();
     showUAVInfo     = value;
     showJustChanged = true;
     update();
@@ -38,8 +38,7 @@
 #include "uavtrailtype.h"
 #include <QtSvg/QSvgRenderer>
 #include "opmapwidget.h"
-#include "trailitem.h"
-#include "traillineitem.h"
+#include "trailpathitem.h"
 namespace mapcontrol {
 class WayPointItem;
 class OPMapWidget;
@@ -67,6 +66,17 @@ public:
      * @param NED
      */
     void SetGroundspeed(double vNED[3], int m_maxUpdateRate);
+    /**
+     * @brief Returns the UAV horizontal velocity last set by SetGroundspeed
+     *
+     * @param north north velocity in m/s
+     * @param east east velocity in m/s
+     */
+    void GetVelocity(double & north, double & east) const
+    {
+        north = vNED[0];
+        east  = vNED[1];
+    }
     /**
      * @brief Sets the UAV Calibrated Airspeed
      *
@@ -260,6 +270,7 @@ public:
     void updateTextOverlay();
 private:
     void generateArrowhead();
+    void SetBoundingRectSize(float size);
     MapGraphicItem *map;
     OPMapWidget *mapwidget;
     QPolygonF arrowHead;
@@ -282,9 +293,7 @@ private:
     double ringTime;
     QPixmap pic;
     core::Point localposition;
-    QGraphicsItemGroup *trail;
-    QGraphicsItemGroup *trailLine;
-    internals::PointLatLng lasttrailline;
+    TrailPathItem *trail;
     QTime timer;
     bool showtrail;
     bool showtrailline;
@@ -309,8 +318,6 @@ public slots:
 signals:
     void UAVReachedWayPoint(int const & waypointnumber, WayPointItem *waypoint);
     void UAVLeftSafetyBouble(internals::PointLatLng const & position);
-    void setChildPosition();
-    void setChildLine();
 };
 }
 #endif // UAVITEM_H
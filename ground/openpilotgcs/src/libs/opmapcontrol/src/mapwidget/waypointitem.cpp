@@ -49,6 +49,7 @@ WayPointItem::WayPointItem(const internals::PointLatLng &coord, int const & alti
 
         if (h) {
             myHome = h;
+            break;
         }
     }
 
@@ -93,6 +94,7 @@ WayPointItem::WayPointItem(MapGraphicItem *map, bool magicwaypoint) : reached(fa
 
         if (h) {
             myHome = h;
+            break;
         }
     }
 
@@ -127,6 +129,7 @@ WayPointItem::WayPointItem(const internals::PointLatLng &coord, int const & alti
 
         if (h) {
             myHome = h;
+            break;
         }
     }
     if (myHome) {
@@ -149,6 +152,7 @@ WayPointItem::WayPointItem(const distBearingAltitude &relativeCoordenate, const
 
         if (h) {
             myHome = h;
+            break;
         }
     }
     if (myHome) {
@@ -291,26 +295,21 @@ void WayPointItem::setRelativeCoord(distBearingAltitude value)
 
 void WayPointItem::SetCoord(const internals::PointLatLng &value)
 {
-    qDebug() << "1 SetCoord(" << value.Lat() << "," << value.Lng() << ")" << "OLD:" << Coord().Lat() << "," << Coord().Lng();
     if (qAbs(Coord().Lat() - value.Lat()) < 0.0001 && qAbs(Coord().Lng() - value.Lng()) < 0.0001) {
-        qDebug() << "2 SetCoord nothing changed returning";
         return;
     }
-    qDebug() << "3 setCoord there were changes";
     coord = value;
     distBearingAltitude back = relativeCoord;
     if (myHome) {
         map->Projection()->offSetFromLatLngs(myHome->Coord(), Coord(), back.distance, back.bearing);
     }
     if (qAbs(back.bearing - relativeCoord.bearing) > 0.01 || qAbs(back.distance - relativeCoord.distance) > 0.1) {
-        qDebug() << "4 setCoord-relative coordinates where also updated";
         relativeCoord = back;
     }
     emit WPValuesChanged(this);
     RefreshPos();
     RefreshToolTip();
     this->update();
-    qDebug() << "5 setCoord EXIT";
 }
 void WayPointItem::SetDescription(const QString &value)
 {
@@ -372,27 +371,6 @@ void WayPointItem::SetShowNumber(const bool &value)
     }
     this->update();
 }
-void WayPointItem::WPDeleted(const int &onumber, WayPointItem *waypoint)
-{
-    Q_UNUSED(waypoint);
-    int n = number;
-    if (number > onumber) {
-        SetNumber(--n);
-    }
-}
-void WayPointItem::WPInserted(const int &onumber, WayPointItem *waypoint)
-{
-    if (Number() == -1) {
-        return;
-    }
-
-    if (waypoint != this) {
-        if (onumber <= number) {
-            SetNumber(++number);
-        }
-    }
-}
-
 void WayPointItem::onHomePositionChanged(internals::PointLatLng homepos, float homeAltitude)
 {
     if (myType == relative) {
@@ -411,18 +389,6 @@ void WayPointItem::onHomePositionChanged(internals::PointLatLng homepos, float h
     }
 }
 
-void WayPointItem::WPRenumbered(const int &oldnumber, const int &newnumber, WayPointItem *waypoint)
-{
-    if (waypoint != this) {
-        if (((oldnumber > number) && (newnumber <= number))) {
-            SetNumber(++number);
-        } else if (((oldnumber < number) && (newnumber > number))) {
-            SetNumber(--number);
-        } else if (newnumber == number) {
-            SetNumber(++number);
-        }
-    }
-}
 int WayPointItem::type() const
 {
     // Enable the use of qgraphicsitem_cast with this item.
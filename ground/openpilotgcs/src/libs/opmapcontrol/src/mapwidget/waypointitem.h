@@ -228,28 +228,6 @@ private:
     QString myCustomString;
 
 public slots:
-    /**
-     * @brief Called when a WayPoint is deleted
-     *
-     * @param number number of the WayPoint that was deleted
-     */
-    void WPDeleted(int const & number, WayPointItem *waypoint);
-    /**
-     * @brief Called when a WayPoint is renumbered
-     *
-     * @param oldnumber the old  WayPoint number
-     * @param newnumber the new WayPoint number
-     * @param waypoint a pointer to the WayPoint renumbered
-     */
-    void WPRenumbered(int const & oldnumber, int const & newnumber, WayPointItem *waypoint);
-    /**
-     * @brief Called when a  WayPoint is inserted
-     *
-     * @param number the number of the  WayPoint
-     * @param waypoint  a pointer to the WayPoint inserted
-     */
-    void WPInserted(int const & number, WayPointItem *waypoint);
-
     void onHomePositionChanged(internals::PointLatLng, float altitude);
     void RefreshPos();
     void setOpacitySlot(qreal opacity);
@@ -0,0 +1,14 @@
+CONFIG += qtestlib
+TEMPLATE = app
+CONFIG -= app_bundle
+QT += network
+QT += sql
+
+# Links against the static opmapcontrol libraries, build libs/opmapcontrol first
+
+INCLUDEPATH *= $$PWD/../../../..
+LIBS += -L$$PWD/../../../src/build \
+    -linternals \
+    -lcore
+
+SOURCES += tst_projection.cpp
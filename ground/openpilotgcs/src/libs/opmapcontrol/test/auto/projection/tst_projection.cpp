@@ -0,0 +1,170 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_projection.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2013.
+ * @brief      Batch projection correctness and benchmark
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <opmapcontrol/src/internals/projections/mercatorprojection.h>
+#include <opmapcontrol/src/internals/projections/lks94projection.h>
+#include <opmapcontrol/src/internals/projections/platecarreeprojection.h>
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+
+using namespace internals;
+using namespace projections;
+
+Q_DECLARE_METATYPE(internals::PureProjection *)
+
+class tst_Projection : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void batchMatchesSingle_data();
+    void batchMatchesSingle();
+    void benchmarkSingle_data();
+    void benchmarkSingle();
+    void benchmarkBatch_data();
+    void benchmarkBatch();
+
+private:
+    void addProjectionRows(bool allZooms);
+
+    QList<PureProjection *> m_projections;
+    QVector<double> m_lat;
+    QVector<double> m_lng;
+};
+
+static const int BenchmarkPoints = 100000;
+
+void tst_Projection::initTestCase()
+{
+    m_projections << new MercatorProjection() << new LKS94Projection() << new PlateCarreeProjection();
+
+    // Points scattered over Lithuania so every projection, LKS94 included, is inside its valid area
+    qsrand(1);
+    m_lat.resize(BenchmarkPoints);
+    m_lng.resize(BenchmarkPoints);
+    for (int i = 0; i < BenchmarkPoints; ++i) {
+        m_lat[i] = 53.5 + 2.9 * qrand() / RAND_MAX;
+        m_lng[i] = 20.5 + 6.5 * qrand() / RAND_MAX;
+    }
+}
+
+void tst_Projection::cleanupTestCase()
+{
+    qDeleteAll(m_projections);
+    m_projections.clear();
+}
+
+void tst_Projection::addProjectionRows(bool allZooms)
+{
+    QTest::addColumn<PureProjection *>("projection");
+    QTest::addColumn<int>("zoom");
+
+    foreach(PureProjection * projection, m_projections) {
+        // Highest zoom each projection is used with by internals::Core::SetMapType()
+        int maxZoom = 17;
+        if (projection->Type() == "LKS94Projection") {
+            maxZoom = 11;
+        } else if (projection->Type() == "PlateCarreeProjection") {
+            maxZoom = 13;
+        }
+        for (int zoom = 2; zoom <= maxZoom; zoom += allZooms ? 1 : 5) {
+            QTest::newRow(QString("%1/%2").arg(projection->Type()).arg(zoom).toLatin1().constData()) << projection << zoom;
+        }
+    }
+}
+
+void tst_Projection::batchMatchesSingle_data()
+{
+    addProjectionRows(true);
+}
+
+void tst_Projection::batchMatchesSingle()
+{
+    QFETCH(PureProjection *, projection);
+    QFETCH(int, zoom);
+
+    const int count = 1000;
+    QVector<int> x(count), y(count);
+    projection->FromLatLngToPixelBatch(m_lat.constData(), m_lng.constData(), x.data(), y.data(), count, zoom);
+    for (int i = 0; i < count; ++i) {
+        core::Point p = projection->FromLatLngToPixel(m_lat.at(i), m_lng.at(i), zoom);
+        QCOMPARE(x.at(i), p.X());
+        QCOMPARE(y.at(i), p.Y());
+    }
+
+    QVector<double> lat(count), lng(count);
+    projection->FromPixelToLatLngBatch(x.constData(), y.constData(), lat.data(), lng.data(), count, zoom);
+    for (int i = 0; i < count; ++i) {
+        PointLatLng p = projection->FromPixelToLatLng(x.at(i), y.at(i), zoom);
+        QCOMPARE(lat.at(i), p.Lat());
+        QCOMPARE(lng.at(i), p.Lng());
+    }
+}
+
+void tst_Projection::benchmarkSingle_data()
+{
+    addProjectionRows(false);
+}
+
+void tst_Projection::benchmarkSingle()
+{
+    QFETCH(PureProjection *, projection);
+    QFETCH(int, zoom);
+
+    QVector<int> x(BenchmarkPoints), y(BenchmarkPoints);
+    QBENCHMARK {
+        for (int i = 0; i < BenchmarkPoints; ++i) {
+            core::Point p = projection->FromLatLngToPixel(m_lat.at(i), m_lng.at(i), zoom);
+            x[i] = p.X();
+            y[i] = p.Y();
+        }
+    }
+}
+
+void tst_Projection::benchmarkBatch_data()
+{
+    addProjectionRows(false);
+}
+
+void tst_Projection::benchmarkBatch()
+{
+    QFETCH(PureProjection *, projection);
+    QFETCH(int, zoom);
+
+    QVector<int> x(BenchmarkPoints), y(BenchmarkPoints);
+    QBENCHMARK {
+        projection->FromLatLngToPixelBatch(m_lat.constData(), m_lng.constData(), x.data(), y.data(), BenchmarkPoints, zoom);
+    }
+}
+
+QTEST_MAIN(tst_Projection)
+
+#include "tst_projection.moc"
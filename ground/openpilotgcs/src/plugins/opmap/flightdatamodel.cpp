@@ -52,7 +52,7 @@ QVariant flightDataModel::data(const QModelIndex &index, int role) const
         if (rowNumber > dataStorage.length() - 1 || rowNumber < 0) {
             return QVariant::Invalid;
         }
-        pathPlanData *myRow = dataStorage.at(rowNumber);
+        const pathPlanData *myRow = &dataStorage.at(rowNumber);
         QVariant ret = getColumnByIndex(myRow, columnNumber);
         return ret;
     }
@@ -403,7 +403,7 @@ bool flightDataModel::setData(const QModelIndex &index, const QVariant &value, i
         if (rowIndex > dataStorage.length() - 1) {
             return false;
         }
-        pathPlanData *myRow = dataStorage.at(rowIndex);
+        pathPlanData *myRow = &dataStorage[rowIndex];
         setColumnByIndex(myRow, columnIndex, value);
         emit dataChanged(index, index);
     }
@@ -415,69 +415,133 @@ Qt::ItemFlags flightDataModel::flags(const QModelIndex & /*index*/) const
     return Qt::ItemIsSelectable | Qt::ItemIsEditable | Qt::ItemIsEnabled;
 }
 
-bool flightDataModel::insertRows(int row, int count, const QModelIndex & /*parent*/)
+pathPlanData flightDataModel::defaultRow()
 {
-    pathPlanData *data;
+    pathPlanData data;
+
+    data.latPosition         = 0;
+    data.lngPosition         = 0;
+    data.disRelative         = 0;
+    data.beaRelative         = 0;
+    data.altitudeRelative    = 0;
+    data.isRelative          = true;
+    data.altitude            = 0;
+    data.velocity            = 0;
+    data.mode = 1;
+    data.mode_params[0]      = 0;
+    data.mode_params[1]      = 0;
+    data.mode_params[2]      = 0;
+    data.mode_params[3]      = 0;
+    data.condition           = 3;
+    data.condition_params[0] = 0;
+    data.condition_params[1] = 0;
+    data.condition_params[2] = 0;
+    data.condition_params[3] = 0;
+    data.command = 0;
+    data.jumpdestination     = 0;
+    data.errordestination    = 0;
+    data.locked = false;
+    return data;
+}
 
+bool pathPlanData::operator==(const pathPlanData &other) const
+{
+    for (int x = 0; x < 4; ++x) {
+        if (mode_params[x] != other.mode_params[x] || condition_params[x] != other.condition_params[x]) {
+            return false;
+        }
+    }
+    return wpDescritption == other.wpDescritption
+           && latPosition == other.latPosition
+           && lngPosition == other.lngPosition
+           && disRelative == other.disRelative
+           && beaRelative == other.beaRelative
+           && altitudeRelative == other.altitudeRelative
+           && isRelative == other.isRelative
+           && altitude == other.altitude
+           && velocity == other.velocity
+           && mode == other.mode
+           && condition == other.condition
+           && command == other.command
+           && jumpdestination == other.jumpdestination
+           && errordestination == other.errordestination
+           && locked == other.locked;
+}
+
+bool flightDataModel::insertRows(int row, int count, const QModelIndex & /*parent*/)
+{
     beginInsertRows(QModelIndex(), row, row + count - 1);
     for (int x = 0; x < count; ++x) {
-        data = new pathPlanData;
-        data->latPosition         = 0;
-        data->lngPosition         = 0;
-        data->disRelative         = 0;
-        data->beaRelative         = 0;
-        data->altitudeRelative    = 0;
-        data->isRelative          = true;
-        data->altitude            = 0;
-        data->velocity            = 0;
-        data->mode = 1;
-        data->mode_params[0]      = 0;
-        data->mode_params[1]      = 0;
-        data->mode_params[2]      = 0;
-        data->mode_params[3]      = 0;
-        data->condition           = 3;
-        data->condition_params[0] = 0;
-        data->condition_params[1] = 0;
-        data->condition_params[2] = 0;
-        data->condition_params[3] = 0;
-        data->command = 0;
-        data->jumpdestination     = 0;
-        data->errordestination    = 0;
-        data->locked = false;
+        pathPlanData data = defaultRow();
         if (rowCount() > 0) {
-            data->altitude            = this->data(this->index(rowCount() - 1, ALTITUDE)).toDouble();
-            data->altitudeRelative    = this->data(this->index(rowCount() - 1, ALTITUDERELATIVE)).toDouble();
-            data->isRelative          = this->data(this->index(rowCount() - 1, ISRELATIVE)).toBool();
-            data->velocity            = this->data(this->index(rowCount() - 1, VELOCITY)).toFloat();
-            data->mode = this->data(this->index(rowCount() - 1, MODE)).toInt();
-            data->mode_params[0]      = this->data(this->index(rowCount() - 1, MODE_PARAMS0)).toFloat();
-            data->mode_params[1]      = this->data(this->index(rowCount() - 1, MODE_PARAMS1)).toFloat();
-            data->mode_params[2]      = this->data(this->index(rowCount() - 1, MODE_PARAMS2)).toFloat();
-            data->mode_params[3]      = this->data(this->index(rowCount() - 1, MODE_PARAMS3)).toFloat();
-            data->condition           = this->data(this->index(rowCount() - 1, CONDITION)).toInt();
-            data->condition_params[0] = this->data(this->index(rowCount() - 1, CONDITION_PARAMS0)).toFloat();
-            data->condition_params[1] = this->data(this->index(rowCount() - 1, CONDITION_PARAMS1)).toFloat();
-            data->condition_params[2] = this->data(this->index(rowCount() - 1, CONDITION_PARAMS2)).toFloat();
-            data->condition_params[3] = this->data(this->index(rowCount() - 1, CONDITION_PARAMS3)).toFloat();
-            data->command = this->data(this->index(rowCount() - 1, COMMAND)).toInt();
-            data->errordestination    = this->data(this->index(rowCount() - 1, ERRORDESTINATION)).toInt();
+            const pathPlanData &last = dataStorage.last();
+            data.altitude            = last.altitude;
+            data.altitudeRelative    = last.altitudeRelative;
+            data.isRelative          = last.isRelative;
+            data.velocity            = last.velocity;
+            data.mode = last.mode;
+            data.mode_params[0]      = last.mode_params[0];
+            data.mode_params[1]      = last.mode_params[1];
+            data.mode_params[2]      = last.mode_params[2];
+            data.mode_params[3]      = last.mode_params[3];
+            data.condition           = last.condition;
+            data.condition_params[0] = last.condition_params[0];
+            data.condition_params[1] = last.condition_params[1];
+            data.condition_params[2] = last.condition_params[2];
+            data.condition_params[3] = last.condition_params[3];
+            data.command = last.command;
+            data.errordestination    = last.errordestination;
         }
         dataStorage.insert(row, data);
     }
     endInsertRows();
+    return true;
 }
 
 bool flightDataModel::removeRows(int row, int count, const QModelIndex & /*parent*/)
 {
-    if (row < 0) {
+    if (row < 0 || count < 1) {
         return false;
     }
     beginRemoveRows(QModelIndex(), row, row + count - 1);
-    for (int x = 0; x < count; ++x) {
-        delete dataStorage.at(row);
-        dataStorage.removeAt(row);
-    }
+    dataStorage.remove(row, count);
     endRemoveRows();
+    return true;
+}
+
+void flightDataModel::setPathPlan(const QVector<pathPlanData> &rows)
+{
+    int common = qMin(rows.size(), dataStorage.size());
+    int first  = -1;
+
+    for (int x = 0; x < common; ++x) {
+        if (dataStorage.at(x) == rows.at(x)) {
+            if (first >= 0) {
+                emit dataChanged(index(first, 0), index(x - 1, columnCount() - 1));
+                first = -1;
+            }
+            continue;
+        }
+        dataStorage[x] = rows.at(x);
+        if (first < 0) {
+            first = x;
+        }
+    }
+    if (first >= 0) {
+        emit dataChanged(index(first, 0), index(common - 1, columnCount() - 1));
+    }
+
+    if (rows.size() > dataStorage.size()) {
+        beginInsertRows(QModelIndex(), dataStorage.size(), rows.size() - 1);
+        for (int x = dataStorage.size(); x < rows.size(); ++x) {
+            dataStorage.append(rows.at(x));
+        }
+        endInsertRows();
+    } else if (rows.size() < dataStorage.size()) {
+        beginRemoveRows(QModelIndex(), rows.size(), dataStorage.size() - 1);
+        dataStorage.resize(rows.size());
+        endRemoveRows();
+    }
 }
 
 bool flightDataModel::writeToFile(QString fileName)
@@ -493,10 +557,11 @@ bool flightDataModel::writeToFile(QString fileName)
     QDomElement root = doc.createElement("waypoints");
     doc.appendChild(root);
 
-    foreach(pathPlanData * obj, dataStorage) {
-        QDomElement waypoint = doc.createElement("waypoint");
+    for (int x = 0; x < dataStorage.size(); ++x) {
+        const pathPlanData *obj = &dataStorage.at(x);
+        QDomElement waypoint    = doc.createElement("waypoint");
 
-        waypoint.setAttribute("number", dataStorage.indexOf(obj));
+        waypoint.setAttribute("number", x);
         root.appendChild(waypoint);
         QDomElement field = doc.createElement("field");
         field.setAttribute("value", obj->wpDescritption);
@@ -620,7 +685,6 @@ bool flightDataModel::writeToFile(QString fileName)
 void flightDataModel::readFromFile(QString fileName)
 {
     // TODO warning message
-    removeRows(0, rowCount());
     QFile file(fileName);
     file.open(QIODevice::ReadOnly);
     QDomDocument doc("PathPlan");
@@ -647,13 +711,15 @@ void flightDataModel::readFromFile(QString fileName)
         return;
     }
 
+    QVector<pathPlanData> rows;
     pathPlanData *data = NULL;
     QDomNode node = root.firstChild();
     while (!node.isNull()) {
         QDomElement e = node.toElement();
         if (e.tagName() == "waypoint") {
             QDomNode fieldNode = e.firstChild();
-            data = new pathPlanData;
+            rows.append(defaultRow());
+            data = &rows.last();
             while (!fieldNode.isNull()) {
                 QDomElement field = fieldNode.toElement();
                 if (field.tagName() == "field") {
@@ -709,10 +775,8 @@ void flightDataModel::readFromFile(QString fileName)
                 }
                 fieldNode = fieldNode.nextSibling();
             }
-            beginInsertRows(QModelIndex(), dataStorage.length(), dataStorage.length());
-            dataStorage.append(data);
-            endInsertRows();
         }
         node = node.nextSibling();
     }
+    setPathPlan(rows);
 }
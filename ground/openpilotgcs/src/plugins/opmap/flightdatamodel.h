@@ -27,6 +27,7 @@
 #ifndef FLIGHTDATAMODEL_H
 #define FLIGHTDATAMODEL_H
 #include <QAbstractTableModel>
+#include <QVector>
 #include "opmapcontrol/opmapcontrol.h"
 
 struct pathPlanData {
@@ -47,6 +48,12 @@ struct pathPlanData {
     int     jumpdestination;
     int     errordestination;
     bool    locked;
+
+    bool operator==(const pathPlanData &other) const;
+    bool operator!=(const pathPlanData &other) const
+    {
+        return !(*this == other);
+    }
 };
 
 class flightDataModel : public QAbstractTableModel {
@@ -70,8 +77,20 @@ public:
     bool removeRows(int row, int count, const QModelIndex & parent = QModelIndex());
     bool writeToFile(QString filename);
     void readFromFile(QString fileName);
+    /**
+     * @brief Replaces the whole path plan, only signalling the rows that differ
+     *
+     * Changed rows are reported with one dataChanged() per contiguous run, extra rows
+     * with a single rowsInserted() and missing ones with a single rowsRemoved().
+     */
+    void setPathPlan(const QVector<pathPlanData> &rows);
+    pathPlanData getRow(int row) const
+    {
+        return dataStorage.value(row, defaultRow());
+    }
+    static pathPlanData defaultRow();
 private:
-    QList<pathPlanData *> dataStorage;
+    QVector<pathPlanData> dataStorage;
     QVariant getColumnByIndex(const pathPlanData *row, const int index) const;
     bool setColumnByIndex(pathPlanData *row, const int index, const QVariant value);
 };
@@ -209,35 +209,51 @@ void modelMapProxy::rowsRemoved(const QModelIndex &parent, int first, int last)
 {
     Q_UNUSED(parent);
 
+    myMap->WPBeginBatch();
     for (int x = last; x > first - 1; x--) {
         myMap->WPDelete(x);
     }
+    myMap->WPEndBatch();
     refreshOverlays();
 }
 
 void modelMapProxy::dataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
 {
-    Q_UNUSED(bottomRight);
+    bool overlaysChanged = false;
 
-    WayPointItem *item = findWayPointNumber(topLeft.row());
-    if (!item) {
-        return;
+    myMap->WPBeginBatch();
+    for (int x = topLeft.row(); x <= bottomRight.row(); ++x) {
+        WayPointItem *item = findWayPointNumber(x);
+        if (!item) {
+            continue;
+        }
+        for (int column = topLeft.column(); column <= bottomRight.column(); ++column) {
+            overlaysChanged |= updateWayPoint(item, x, column);
+        }
     }
+    myMap->WPEndBatch();
+    if (overlaysChanged) {
+        refreshOverlays();
+    }
+}
+
+bool modelMapProxy::updateWayPoint(WayPointItem *item, int x, int column)
+{
     internals::PointLatLng latlng;
-    int x = topLeft.row();
     distBearingAltitude distBearing;
     double altitude;
     bool relative;
     QModelIndex index;
     QString desc;
-    switch (topLeft.column()) {
+
+    switch (column) {
     case flightDataModel::COMMAND:
     case flightDataModel::CONDITION:
     case flightDataModel::JUMPDESTINATION:
     case flightDataModel::ERRORDESTINATION:
     case flightDataModel::MODE:
-        refreshOverlays();
-        break;
+        return true;
+
     case flightDataModel::WPDESCRITPTION:
         index = model->index(x, flightDataModel::WPDESCRITPTION);
         desc  = index.data(Qt::DisplayRole).toString();
@@ -292,11 +308,13 @@ void modelMapProxy::dataChanged(const QModelIndex &topLeft, const QModelIndex &b
         item->setFlag(QGraphicsItem::ItemIsMovable, !index.data(Qt::DisplayRole).toBool());
         break;
     }
+    return false;
 }
 
 void modelMapProxy::rowsInserted(const QModelIndex &parent, int first, int last)
 {
     Q_UNUSED(parent);
+    myMap->WPBeginBatch();
     for (int x = first; x < last + 1; x++) {
         QModelIndex index;
         WayPointItem *item;
@@ -326,6 +344,7 @@ void modelMapProxy::rowsInserted(const QModelIndex &parent, int first, int last)
             item = myMap->WPInsert(latlng, altitude, desc, x);
         }
     }
+    myMap->WPEndBatch();
     refreshOverlays();
 }
 void modelMapProxy::deleteWayPoint(int number)
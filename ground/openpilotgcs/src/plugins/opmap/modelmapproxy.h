@@ -56,6 +56,7 @@ private slots:
     void selectedWPChanged(QList<WayPointItem *>);
 private:
     overlayType overlayTranslate(int type);
+    bool updateWayPoint(WayPointItem *item, int x, int column);
     void createOverlay(WayPointItem *from, WayPointItem *to, overlayType type, QColor color);
     void createOverlay(WayPointItem *from, HomeItem *to, modelMapProxy::overlayType type, QColor color);
     OPMapWidget *myMap;
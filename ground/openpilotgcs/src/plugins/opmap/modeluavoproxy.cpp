@@ -123,13 +123,14 @@ void modelUavoProxy::objectsToModel()
     Waypoint *wp;
     Waypoint::DataFields wpfields;
     PathAction *action;
-    QModelIndex index;
     double distance;
     double bearing;
 
     PathAction::DataFields actionfields;
+    QVector<pathPlanData> rows;
 
-    myModel->removeRows(0, myModel->rowCount());
+    // Build the whole plan first and let the model diff it, so unchanged
+    // waypoints cause no signals at all and the map is not rebuilt row by row
     for (int x = 0; x < objManager->getNumInstances(waypointObj->getObjID()); ++x) {
         wp = Waypoint::GetInstance(objManager, x);
         Q_ASSERT(wp);
@@ -137,66 +138,45 @@ void modelUavoProxy::objectsToModel()
             continue;
         }
         wpfields = wp->getData();
-        myModel->insertRow(x);
-        index    = myModel->index(x, flightDataModel::VELOCITY);
-        myModel->setData(index, wpfields.Velocity);
-        distance = sqrt(wpfields.Position[Waypoint::POSITION_NORTH] * wpfields.Position[Waypoint::POSITION_NORTH] +
-                        wpfields.Position[Waypoint::POSITION_EAST] * wpfields.Position[Waypoint::POSITION_EAST]);
-        bearing  = atan2(wpfields.Position[Waypoint::POSITION_EAST], wpfields.Position[Waypoint::POSITION_NORTH]) * 180 / M_PI;
-
-        if (bearing != bearing) {
-            bearing = 0;
-        }
-        index  = myModel->index(x, flightDataModel::DISRELATIVE);
-        myModel->setData(index, distance);
-        index  = myModel->index(x, flightDataModel::BEARELATIVE);
-        myModel->setData(index, bearing);
-        index  = myModel->index(x, flightDataModel::ALTITUDERELATIVE);
-        myModel->setData(index, (-1.0f) * wpfields.Position[Waypoint::POSITION_DOWN]);
-
-        action = PathAction::GetInstance(objManager, wpfields.Action);
+        action   = PathAction::GetInstance(objManager, wpfields.Action);
         Q_ASSERT(action);
         if (!action) {
             continue;
         }
         actionfields = action->getData();
 
-        index = myModel->index(x, flightDataModel::ISRELATIVE);
-        myModel->setData(index, true);
-
-        index = myModel->index(x, flightDataModel::COMMAND);
-        myModel->setData(index, actionfields.Command);
-
-        index = myModel->index(x, flightDataModel::CONDITION_PARAMS0);
-        myModel->setData(index, actionfields.ConditionParameters[0]);
-        index = myModel->index(x, flightDataModel::CONDITION_PARAMS1);
-        myModel->setData(index, actionfields.ConditionParameters[1]);
-        index = myModel->index(x, flightDataModel::CONDITION_PARAMS2);
-        myModel->setData(index, actionfields.ConditionParameters[2]);
-        index = myModel->index(x, flightDataModel::CONDITION_PARAMS3);
-        myModel->setData(index, actionfields.ConditionParameters[3]);
-
-        index = myModel->index(x, flightDataModel::CONDITION);
-        myModel->setData(index, actionfields.EndCondition);
-
-        index = myModel->index(x, flightDataModel::ERRORDESTINATION);
-        myModel->setData(index, actionfields.ErrorDestination + 1);
-
-        index = myModel->index(x, flightDataModel::JUMPDESTINATION);
-        myModel->setData(index, actionfields.JumpDestination + 1);
+        // lat/lng and absolute altitude are derived from the relative position by the map,
+        // keep the current ones so an unchanged waypoint compares equal
+        pathPlanData row     = myModel->getRow(rows.size());
+        pathPlanData blank   = flightDataModel::defaultRow();
+        row.wpDescritption   = blank.wpDescritption;
+        row.locked           = blank.locked;
 
-        index = myModel->index(x, flightDataModel::MODE);
-        myModel->setData(index, actionfields.Mode);
+        row.velocity         = wpfields.Velocity;
+        distance = sqrt(wpfields.Position[Waypoint::POSITION_NORTH] * wpfields.Position[Waypoint::POSITION_NORTH] +
+                        wpfields.Position[Waypoint::POSITION_EAST] * wpfields.Position[Waypoint::POSITION_EAST]);
+        bearing  = atan2(wpfields.Position[Waypoint::POSITION_EAST], wpfields.Position[Waypoint::POSITION_NORTH]) * 180 / M_PI;
 
-        index = myModel->index(x, flightDataModel::MODE_PARAMS0);
-        myModel->setData(index, actionfields.ModeParameters[0]);
-        index = myModel->index(x, flightDataModel::MODE_PARAMS1);
-        myModel->setData(index, actionfields.ModeParameters[1]);
-        index = myModel->index(x, flightDataModel::MODE_PARAMS2);
-        myModel->setData(index, actionfields.ModeParameters[2]);
-        index = myModel->index(x, flightDataModel::MODE_PARAMS3);
-        myModel->setData(index, actionfields.ModeParameters[3]);
+        if (bearing != bearing) {
+            bearing = 0;
+        }
+        row.disRelative      = distance;
+        row.beaRelative      = bearing;
+        row.altitudeRelative = (-1.0f) * wpfields.Position[Waypoint::POSITION_DOWN];
+        row.isRelative       = true;
+
+        row.command          = actionfields.Command;
+        row.condition        = actionfields.EndCondition;
+        row.errordestination = actionfields.ErrorDestination + 1;
+        row.jumpdestination  = actionfields.JumpDestination + 1;
+        row.mode = actionfields.Mode;
+        for (int i = 0; i < 4; ++i) {
+            row.condition_params[i] = actionfields.ConditionParameters[i];
+            row.mode_params[i]      = actionfields.ModeParameters[i];
+        }
+        rows.append(row);
     }
+    myModel->setPathPlan(rows);
 }
 int modelUavoProxy::addAction(PathAction *actionObj, PathAction::DataFields actionFields, int lastaction)
 {
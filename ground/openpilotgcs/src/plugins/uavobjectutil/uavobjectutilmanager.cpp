@@ -93,8 +93,15 @@ UAVObjectManager *UAVObjectUtilManager::getObjectManager()
  */
 void UAVObjectUtilManager::saveObjectToSD(UAVObject *obj)
 {
+    ObjectPersistence::DataFields data;
+
+    data.Operation  = ObjectPersistence::OPERATION_SAVE;
+    data.Selection  = ObjectPersistence::SELECTION_SINGLEOBJECT;
+    data.ObjectID   = obj->getObjID();
+    data.InstanceID = obj->getInstID();
+
     // Add to queue
-    queue.enqueue(obj);
+    queue.enqueue(data);
     qDebug() << "Enqueue object: " << obj->getName();
 
 
@@ -105,6 +112,49 @@ void UAVObjectUtilManager::saveObjectToSD(UAVObject *obj)
     }
 }
 
+/*
+   Add a request to the queue to have the board collect the settings
+   uploaded from now on, for saveCollectedSettingsToSD()
+ */
+void UAVObjectUtilManager::collectSettings()
+{
+    ObjectPersistence::DataFields data;
+
+    data.Operation  = ObjectPersistence::OPERATION_COLLECT;
+    data.Selection  = ObjectPersistence::SELECTION_COLLECTEDSETTINGS;
+    data.ObjectID   = 0;
+    data.InstanceID = 0;
+
+    queue.enqueue(data);
+    qDebug() << "Enqueue collect settings";
+
+    if (queue.length() == 1) {
+        saveNextObject();
+    }
+}
+
+/*
+   Add a request to the queue to save the settings uploaded since
+   collectSettings(). The board writes the changed ones in one go and
+   reloads all of them from flash to verify the save.
+ */
+void UAVObjectUtilManager::saveCollectedSettingsToSD()
+{
+    ObjectPersistence::DataFields data;
+
+    data.Operation  = ObjectPersistence::OPERATION_SAVE;
+    data.Selection  = ObjectPersistence::SELECTION_COLLECTEDSETTINGS;
+    data.ObjectID   = 0;
+    data.InstanceID = 0;
+
+    queue.enqueue(data);
+    qDebug() << "Enqueue save collected settings";
+
+    if (queue.length() == 1) {
+        saveNextObject();
+    }
+}
+
 void UAVObjectUtilManager::saveNextObject()
 {
     if (queue.isEmpty()) {
@@ -113,23 +163,16 @@ void UAVObjectUtilManager::saveNextObject()
 
     Q_ASSERT(saveState == IDLE);
 
-    // Get next object from the queue
-    UAVObject *obj = queue.head();
-    qDebug() << "Send save object request to board " << obj->getName();
+    // Get next request from the queue
+    ObjectPersistence::DataFields data = queue.head();
+    qDebug() << "Send object persistence request to board " << data.ObjectID;
 
     ObjectPersistence *objper = dynamic_cast<ObjectPersistence *>(getObjectManager()->getObject(ObjectPersistence::NAME));
     connect(objper, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(objectPersistenceTransactionCompleted(UAVObject *, bool)));
     connect(objper, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectPersistenceUpdated(UAVObject *)));
     saveState = AWAITING_ACK;
-    if (obj != NULL) {
-        ObjectPersistence::DataFields data;
-        data.Operation  = ObjectPersistence::OPERATION_SAVE;
-        data.Selection  = ObjectPersistence::SELECTION_SINGLEOBJECT;
-        data.ObjectID   = obj->getObjID();
-        data.InstanceID = obj->getInstID();
-        objper->setData(data);
-        objper->updated();
-    }
+    objper->setData(data);
+    objper->updated();
     // Now: we are going to get two "objectUpdated" messages (one coming from GCS, one coming from Flight, which
     // will confirm the object was properly received by both sides) and then one "transactionCompleted" indicating
     // that the Flight side did not only receive the object but it did receive it without error. Last we will get
@@ -158,7 +201,8 @@ void UAVObjectUtilManager::objectPersistenceTransactionCompleted(UAVObject *obj,
         // the queue:
         saveState = AWAITING_COMPLETED;
         disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(objectPersistenceTransactionCompleted(UAVObject *, bool)));
-        failureTimer.start(2000); // Create a timeout
+        // Saving a batch of settings can take a garbage collection on the board
+        failureTimer.start(queue.head().Selection == ObjectPersistence::SELECTION_SINGLEOBJECT ? 2000 : 10000); // Create a timeout
     } else {
         // Can be caused by timeout errors on sending.  Forget it and send next.
         qDebug() << "objectPersistenceTranscationCompleted (error)";
@@ -185,13 +229,12 @@ void UAVObjectUtilManager::objectPersistenceOperationFailed()
         ObjectPersistence *objectPersistence = ObjectPersistence::GetInstance(getObjectManager());
         Q_ASSERT(objectPersistence);
 
-        UAVObject *obj = queue.dequeue(); // We can now remove the object, it failed anyway.
-        Q_ASSERT(obj);
+        ObjectPersistence::DataFields data = queue.dequeue(); // We can now remove the object, it failed anyway.
 
         objectPersistence->disconnect(this);
 
         saveState = IDLE;
-        emit saveCompleted(obj->getObjID(), false);
+        emit saveCompleted(data.ObjectID, false);
 
         saveNextObject();
     }
@@ -216,8 +259,7 @@ void UAVObjectUtilManager::objectPersistenceUpdated(UAVObject *obj)
                objectPersistence.Operation == ObjectPersistence::OPERATION_COMPLETED) {
         failureTimer.stop();
         // Check right object saved
-        UAVObject *savingObj = queue.head();
-        if (objectPersistence.ObjectID != savingObj->getObjID()) {
+        if (objectPersistence.ObjectID != queue.head().ObjectID) {
             objectPersistenceOperationFailed();
             return;
         }
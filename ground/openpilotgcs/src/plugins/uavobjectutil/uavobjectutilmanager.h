@@ -65,15 +65,18 @@ public:
     static bool descriptionToStructure(QByteArray desc, deviceDescriptorStruct & struc);
     UAVObjectManager *getObjectManager();
     void saveObjectToSD(UAVObject *obj);
+    void collectSettings();
+    void saveCollectedSettingsToSD();
 protected:
     FirmwareIAPObj::DataFields getFirmwareIap();
 
 signals:
+    // objectID is 0 for collectSettings() and saveCollectedSettingsToSD()
     void saveCompleted(int objectID, bool status);
 
 private:
     QMutex *mutex;
-    QQueue<UAVObject *> queue;
+    QQueue<ObjectPersistence::DataFields> queue;
     enum { IDLE, AWAITING_ACK, AWAITING_COMPLETED } saveState;
     void saveNextObject();
     QTimer failureTimer;
@@ -75,6 +75,15 @@ void smartSaveButton::processOperation(QPushButton *button, bool save)
     bool error = false;
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectUtilManager *utilMngr     = pm->getObject<UAVObjectUtilManager>();
+    QList<UAVDataObject *> savedObjects;
+
+    // Have the board collect the settings uploaded below, so the save only
+    // writes those and not other settings that were applied but not saved
+    if (save && !persistenceRequest(utilMngr, true)) {
+        qDebug() << "Collecting of settings failed after 3 tries.";
+        error = true;
+        save  = false;
+    }
     foreach(UAVDataObject * obj, objects) {
         UAVObject::Metadata mdata = obj->getMetadata();
 
@@ -112,35 +121,17 @@ void smartSaveButton::processOperation(QPushButton *button, bool save)
             continue;
         }
 
-        sv_result = false;
-        current_objectID = obj->getObjID();
         if (save && (obj->isSettings())) {
-            for (int i = 0; i < 3; ++i) {
-                qDebug() << "Saving" << obj->getName() << "to board.";
-                connect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(saving_finished(int, bool)));
-                connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
-                utilMngr->saveObjectToSD(obj);
-
-                timer.start(3000);
-                loop.exec();
-                if (!timer.isActive()) {
-                    qDebug() << "Saving of" << obj->getName() << "timed out.";
-                }
-                timer.stop();
-
-                disconnect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(saving_finished(int, bool)));
-                disconnect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
-                if (sv_result) {
-                    qDebug() << "Saving of" << obj->getName() << "successful.";
-                    break;
-                }
-            }
-            if (sv_result == false) {
-                qDebug() << "Saving of" << obj->getName() << "failed after 3 tries.";
-                error = true;
-            }
+            savedObjects.append(obj);
         }
     }
+
+    // Commit the uploaded settings with a single request, the board writes
+    // the ones that changed and reads them back from flash before it acks
+    if (!savedObjects.isEmpty() && !persistenceRequest(utilMngr, false)) {
+        qDebug() << "Saving of settings failed after 3 tries.";
+        error = true;
+    }
     if (button) {
         button->setEnabled(true);
     }
@@ -157,6 +148,43 @@ void smartSaveButton::processOperation(QPushButton *button, bool save)
     emit endOp();
 }
 
+/**
+ * Send a collect or a save collected settings request to the board and wait
+ * for the result, retrying up to 3 times
+ */
+bool smartSaveButton::persistenceRequest(UAVObjectUtilManager *utilMngr, bool collect)
+{
+    QTimer timer;
+
+    timer.setSingleShot(true);
+    sv_result = false;
+    current_objectID = 0;
+    for (int i = 0; i < 3; ++i) {
+        qDebug() << (collect ? "Collecting settings on board." : "Saving settings to board.");
+        connect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(saving_finished(int, bool)));
+        connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+        if (collect) {
+            utilMngr->collectSettings();
+        } else {
+            utilMngr->saveCollectedSettingsToSD();
+        }
+
+        timer.start(10000);
+        loop.exec();
+        if (!timer.isActive()) {
+            qDebug() << "Settings request timed out.";
+        }
+        timer.stop();
+
+        disconnect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(saving_finished(int, bool)));
+        disconnect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+        if (sv_result) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void smartSaveButton::setObjects(QList<UAVDataObject *> list)
 {
     objects = list;
@@ -74,6 +74,8 @@ private slots:
     void saving_finished(int, bool);
 
 private:
+    bool persistenceRequest(UAVObjectUtilManager *utilMngr, bool collect);
+
     quint32 current_objectID;
     UAVDataObject *current_object;
     bool up_result;
@@ -64,6 +64,7 @@ void TelemetryManager::onStart()
     telemetryMon = new TelemetryMonitor(objMngr, telemetry);
     connect(telemetryMon, SIGNAL(connected()), this, SLOT(onConnect()));
     connect(telemetryMon, SIGNAL(disconnected()), this, SLOT(onDisconnect()));
+    connect(telemetryMon, SIGNAL(disconnected()), utalk, SLOT(resetRxState()));
 }
 
 
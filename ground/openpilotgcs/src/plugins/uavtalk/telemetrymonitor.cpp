@@ -189,6 +189,9 @@ void TelemetryMonitor::processStatsUpdates()
     gcsStats.RxFailures += telStats.rxErrors;
     gcsStats.TxFailures += telStats.txErrors;
     gcsStats.TxRetries  += telStats.txRetries;
+    // Ask the flight side to send multi-object frames
+    gcsStats.MultiObjectFrames = GCSTelemetryStats::MULTIOBJECTFRAMES_TRUE;
+    gcsStats.DeltaFrames = GCSTelemetryStats::DELTAFRAMES_TRUE;
 
     // Check for a connection timeout
     bool connectionTimeout;
@@ -108,6 +108,20 @@ void UAVTalk::resetStats()
     memset(&stats, 0, sizeof(ComStats));
 }
 
+/**
+ * Drop any partly received frame and the delta keyframes. Keyframe ids start
+ * over when the other side restarts, a delta must not be decoded against a
+ * keyframe from before the connection was lost.
+ */
+void UAVTalk::resetRxState()
+{
+    QMutexLocker locker(mutex);
+
+    rxState = STATE_SYNC;
+    rxPacketLength = 0;
+    deltaKeyframes.clear();
+}
+
 /**
  * Get the statistics counters
  */
@@ -321,6 +335,23 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
 
         // Search for object, if not found reset state machine
         rxObjId = (qint32)qFromLittleEndian<quint32>(rxTmpBuffer);
+
+        // Multi-object frames carry the records of several objects as payload
+        if (rxType == TYPE_OBJ_MULTI) {
+            rxLength = packetSize - rxPacketLength;
+            if (rxObjId != OBJID_MULTI || rxLength == 0 || rxLength >= MAX_PAYLOAD_LENGTH) {
+                stats.rxErrors++;
+                rxState = STATE_SYNC;
+                UAVTALK_QXTLOG_DEBUG("UAVTalk: ObjID->Sync (bad multi)");
+                break;
+            }
+            rxInstId = 0;
+            rxCount  = 0;
+            rxState  = STATE_DATA;
+            UAVTALK_QXTLOG_DEBUG("UAVTalk: ObjID->Data (multi)");
+            break;
+        }
+
         {
             UAVObject *rxObj = objMngr->getObject(rxObjId);
             if (rxObj == NULL && rxType != TYPE_OBJ_REQ) {
@@ -334,6 +365,10 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
             if (rxType == TYPE_OBJ_REQ || rxType == TYPE_ACK || rxType == TYPE_NACK) {
                 rxLength = 0;
                 rxInstanceLength = 0;
+            } else if (rxType == TYPE_OBJ_DELTA) {
+                // Delta frames only carry the fields that changed
+                rxInstanceLength = (rxObj->isSingleInstance() ? 0 : 2);
+                rxLength = packetSize - rxPacketLength - rxInstanceLength;
             } else {
                 rxLength = rxObj->getNumBytes();
                 rxInstanceLength = (rxObj->isSingleInstance() ? 0 : 2);
@@ -477,7 +512,6 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
  */
 bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length)
 {
-    Q_UNUSED(length);
     UAVObject *obj    = NULL;
     bool error        = false;
     bool allInstances = (instId == ALL_INSTANCES);
@@ -557,6 +591,24 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *
             }
         }
         break;
+    case TYPE_OBJ_MULTI:
+        error = !receiveMultiObject(data, length);
+        break;
+    case TYPE_OBJ_DELTA:
+        // All instances, not allowed for delta messages
+        if (!allInstances) {
+            // Decode the object and update its data
+            obj = receiveDeltaObject(objId, instId, data, length);
+            // Check if an ack is pending
+            if (obj != NULL) {
+                updateAck(obj);
+            } else {
+                error = true;
+            }
+        } else {
+            error = true;
+        }
+        break;
     default:
         error = true;
     }
@@ -564,6 +616,112 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *
     return !error;
 }
 
+/**
+ * Receive the records of a multi-object frame, each one is handled like an object received
+ * in a TYPE_OBJ message. Records of unknown objects are skipped.
+ * \param[in] data Frame payload
+ * \param[in] length Payload length
+ * \return Success (true), Failure (false)
+ */
+bool UAVTalk::receiveMultiObject(quint8 *data, qint32 length)
+{
+    bool error  = false;
+    qint32 offset = 0;
+
+    while (offset + MULTI_RECORD_HEADER_LENGTH <= length) {
+        quint8 *record = &data[offset];
+        quint32 objId  = qFromLittleEndian<quint32>(record);
+        quint8 recordLength = record[4];
+
+        offset += MULTI_RECORD_HEADER_LENGTH + recordLength;
+        if (offset > length) {
+            return false;
+        }
+
+        UAVObject *tobj = objMngr->getObject(objId);
+        if (tobj == NULL) {
+            // Object the GCS does not know, the length lets us step over it
+            continue;
+        }
+        int instanceLength = tobj->isSingleInstance() ? 0 : 2;
+        if (recordLength != instanceLength + tobj->getNumBytes()) {
+            error = true;
+            continue;
+        }
+        quint16 instId = 0;
+        if (instanceLength) {
+            instId = qFromLittleEndian<quint16>(&record[MULTI_RECORD_HEADER_LENGTH]);
+            if (instId == ALL_INSTANCES) {
+                error = true;
+                continue;
+            }
+        }
+
+        UAVObject *obj = updateObject(objId, instId, &record[MULTI_RECORD_HEADER_LENGTH + instanceLength]);
+        if (obj != NULL) {
+            updateAck(obj);
+        } else {
+            error = true;
+        }
+    }
+    return !error && offset == length;
+}
+
+/**
+ * Receive a delta frame. Keyframes are kept to decode the deltas that follow them,
+ * deltas for a keyframe that was missed are dropped.
+ * \param[in] objId Object ID
+ * \param[in] instId Instance ID
+ * \param[in] data Frame payload
+ * \param[in] length Payload length
+ * \return The updated object, NULL on failure
+ */
+UAVObject *UAVTalk::receiveDeltaObject(quint32 objId, quint16 instId, quint8 *data, qint32 length)
+{
+    UAVObject *tobj = objMngr->getObject(objId);
+
+    if (tobj == NULL || length < 1) {
+        return NULL;
+    }
+    qint32 numBytes = tobj->getNumBytes();
+    DeltaKeyframe &keyframe = deltaKeyframes[((quint64)objId << 16) | instId];
+
+    if (data[0] & DELTA_KEYFRAME) {
+        if (length != 1 + numBytes) {
+            return NULL;
+        }
+        keyframe.id   = data[0] & DELTA_ID_MASK;
+        keyframe.data = QByteArray((const char *)&data[1], numBytes);
+        return updateObject(objId, instId, &data[1]);
+    }
+
+    // The fields are in packing order, which gives the field boundaries
+    QList<UAVObjectField *> fields = tobj->getFields();
+    qint32 bitmapLength = (fields.length() + 7) / 8;
+    if (keyframe.data.isEmpty() || data[0] != keyframe.id || length < 1 + bitmapLength) {
+        return NULL;
+    }
+
+    // Patch the changed fields into a copy of the keyframe
+    QByteArray decoded = keyframe.data;
+    qint32 pos    = 1 + bitmapLength;
+    qint32 offset = 0;
+    for (int n = 0; n < fields.length(); offset += fields[n++]->getNumBytes()) {
+        if (data[1 + n / 8] & (1 << (n % 8))) {
+            qint32 size = fields[n]->getNumBytes();
+            if (pos + size > length || offset + size > numBytes) {
+                return NULL;
+            }
+            memcpy(decoded.data() + offset, &data[pos], size);
+            pos += size;
+        }
+    }
+    if (pos != length) {
+        return NULL;
+    }
+    return updateObject(objId, instId, (quint8 *)decoded.data());
+}
+
 /**
  * Update the data of an object from a byte array (unpack).
  * If the object instance could not be found in the list, then a
@@ -60,6 +60,9 @@ public:
     ComStats getStats();
     void resetStats();
 
+public slots:
+    void resetRxState();
+
 signals:
     void transactionCompleted(UAVObject *obj, bool success);
 
@@ -74,6 +77,11 @@ private:
         bool allInstances;
     } Transaction;
 
+    typedef struct {
+        quint8     id;
+        QByteArray data;
+    } DeltaKeyframe;
+
     // Constants
     static const int TYPE_MASK    = 0xF8;
     static const int TYPE_VER     = 0x20;
@@ -82,6 +90,8 @@ private:
     static const int TYPE_OBJ_ACK = (TYPE_VER | 0x02);
     static const int TYPE_ACK     = (TYPE_VER | 0x03);
     static const int TYPE_NACK    = (TYPE_VER | 0x04);
+    static const int TYPE_OBJ_MULTI = (TYPE_VER | 0x05);
+    static const int TYPE_OBJ_DELTA = (TYPE_VER | 0x06);
 
     static const int MIN_HEADER_LENGTH  = 8; // sync(1), type (1), size(2), object ID(4)
     static const int MAX_HEADER_LENGTH  = 10; // sync(1), type (1), size(2), object ID (4), instance ID(2, not used in single objects)
@@ -95,6 +105,17 @@ private:
     static const quint16 ALL_INSTANCES  = 0xFFFF;
     static const quint16 OBJID_NOTFOUND = 0x0000;
 
+    // Multi-object frames carry OBJID_MULTI in the object id field and a payload of records:
+    // object ID(4), record length(1), instance ID(2, not used in single objects), data
+    static const quint32 OBJID_MULTI    = 0xFFFFFFFF;
+    static const int MULTI_RECORD_HEADER_LENGTH = 5;
+
+    // Delta frames start their payload with a keyframe byte. Keyframes set DELTA_KEYFRAME in it and
+    // carry the whole object. Deltas carry the id of their keyframe, a bitmap with one bit per field
+    // and the fields that differ from the keyframe.
+    static const quint8 DELTA_KEYFRAME  = 0x80;
+    static const quint8 DELTA_ID_MASK   = 0x7F;
+
     static const int TX_BUFFER_SIZE     = 2 * 1024;
     static const quint8 crc_table[256];
 
@@ -106,6 +127,7 @@ private:
     UAVObjectManager *objMngr;
     QMutex *mutex;
     QMap<quint32, Transaction *> transMap;
+    QHash<quint64, DeltaKeyframe> deltaKeyframes;
     quint8 rxBuffer[MAX_PACKET_LENGTH];
     quint8 txBuffer[MAX_PACKET_LENGTH];
     // Variables used by the receive state machine
@@ -132,6 +154,8 @@ private:
     bool objectTransaction(UAVObject *obj, quint8 type, bool allInstances);
     bool processInputByte(quint8 rxbyte);
     bool receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length);
+    bool receiveMultiObject(quint8 *data, qint32 length);
+    UAVObject *receiveDeltaObject(quint32 objId, quint16 instId, quint8 *data, qint32 length);
     UAVObject *updateObject(quint32 objId, quint16 instId, quint8 *data);
     void updateAck(UAVObject *obj);
     void updateNack(UAVObject *obj);
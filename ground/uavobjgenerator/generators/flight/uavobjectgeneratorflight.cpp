@@ -228,6 +228,24 @@ bool UAVObjectGeneratorFlight::process_object(ObjectInfo *info)
     }
     outCode.replace(QString("$(INITFIELDS)"), initfields);
 
+    // Replace the $(FIELDSIZES) and $(REGISTERFIELDSIZES) tags, only objects sent as field deltas need the table
+    QString fieldsizes;
+    QString registerfieldsizes;
+    if (info->isDeltaEncoded) {
+        QStringList sizes;
+        for (int n = 0; n < info->fields.length(); ++n) {
+            sizes.append(QString().setNum(info->fields[n]->numBytes * info->fields[n]->numElements));
+        }
+        fieldsizes.append("\n// Size of each field in packing order, used to send field deltas\n");
+        fieldsizes.append(QString("static const uint16_t fieldSizes[] = { %1 };\n").arg(sizes.join(", ")));
+        registerfieldsizes.append("\n    // Register the field boundaries\n");
+        registerfieldsizes.append("    if (handle) {\n");
+        registerfieldsizes.append("        UAVObjSetFieldSizes(handle, fieldSizes, NELEMENTS(fieldSizes));\n");
+        registerfieldsizes.append("    }\n");
+    }
+    outCode.replace(QString("$(FIELDSIZES)"), fieldsizes);
+    outCode.replace(QString("$(REGISTERFIELDSIZES)"), registerfieldsizes);
+
     // Replace the $(SETGETFIELDS) tag
     QString setgetfields;
     for (int n = 0; n < info->fields.length(); ++n) {
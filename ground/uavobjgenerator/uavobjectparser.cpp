@@ -612,6 +612,31 @@ QString UAVObjectParser::processObjectAttributes(QDomNode & node, ObjectInfo *in
         return QString("Object:singleinstance attribute value is invalid");
     }
 
+    // Get numinstances attribute if present, it only sizes flight storage so it is not part of the hash
+    info->numInstances = 1;
+    attr = attributes.namedItem("numinstances");
+    if (!attr.isNull()) {
+        bool ok;
+        info->numInstances = attr.nodeValue().toInt(&ok);
+        if (!ok || info->numInstances < 1) {
+            return QString("Object:numinstances attribute value is invalid");
+        }
+        if (info->isSingleInst && info->numInstances != 1) {
+            return QString("Object:numinstances attribute requires singleinstance=\"false\"");
+        }
+    }
+
+    // Get delta attribute if present, it only changes how telemetry sends the object so it is not part of the hash
+    info->isDeltaEncoded = false;
+    attr = attributes.namedItem("delta");
+    if (!attr.isNull()) {
+        if (attr.nodeValue().compare(QString("true")) == 0) {
+            info->isDeltaEncoded = true;
+        } else if (attr.nodeValue().compare(QString("false")) != 0) {
+            return QString("Object:delta attribute value is invalid");
+        }
+    }
+
     // Get settings attribute
     attr = attributes.namedItem("settings");
     if (attr.isNull()) {
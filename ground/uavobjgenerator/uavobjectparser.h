@@ -83,7 +83,9 @@ typedef struct  {
     QString    filename;
     quint32    id;
     bool       isSingleInst;
+    int        numInstances; /** Instances the flight side allocates storage for up front **/
     bool       isSettings;
+    bool       isDeltaEncoded; /** Telemetry may send the object as field deltas **/
     AccessMode gcsAccess;
     AccessMode flightAccess;
     bool       flightTelemetryAcked;